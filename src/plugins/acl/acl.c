@@ -39,6 +39,7 @@
 
 #include "fa_node.h"
 #include "public_inlines.h"
+#include "dtree_lookup.h"
 
 acl_main_t acl_main;
 
@@ -271,6 +272,91 @@ policy_notify_acl_change (acl_main_t * am, u32 acl_num)
   try_increment_acl_policy_epoch (am, acl_num, 1);
 }
 
+/*
+ * The rules between the common head and tail of the old and the new
+ * rule vector, taken from both. A session whose verdict may differ
+ * under the new rules matches at least one of them.
+ */
+static acl_rule_t *
+acl_changed_rules (acl_rule_t * old_rules, acl_rule_t * new_rules,
+		   acl_rule_t * changed_rules)
+{
+  u32 n_old = vec_len (old_rules);
+  u32 n_new = vec_len (new_rules);
+  u32 head = 0, tail = 0, i;
+
+  while (head < n_old && head < n_new
+	 && !memcmp (&old_rules[head], &new_rules[head], sizeof (acl_rule_t)))
+    head++;
+  while (tail < n_old - head && tail < n_new - head
+	 && !memcmp (&old_rules[n_old - 1 - tail],
+		     &new_rules[n_new - 1 - tail], sizeof (acl_rule_t)))
+    tail++;
+
+  for (i = head; i < n_old - tail; i++)
+    vec_add1 (changed_rules, old_rules[i]);
+  for (i = head; i < n_new - tail; i++)
+    vec_add1 (changed_rules, new_rules[i]);
+  return changed_rules;
+}
+
+static void
+policy_reclassify_acl_change (acl_main_t * am, u32 acl_num,
+			      acl_rule_t * old_rules)
+{
+  uword *sw_if_index_bitmap[2] = { 0, 0 };
+  acl_rule_t *changed_rules;
+  u32 *p_swi;
+
+  changed_rules = acl_changed_rules (old_rules, am->acls[acl_num].rules, 0);
+  if (acl_num < vec_len (am->input_sw_if_index_vec_by_acl))
+    vec_foreach (p_swi, am->input_sw_if_index_vec_by_acl[acl_num])
+      sw_if_index_bitmap[1] =
+	clib_bitmap_set (sw_if_index_bitmap[1], *p_swi, 1);
+  if (acl_num < vec_len (am->output_sw_if_index_vec_by_acl))
+    vec_foreach (p_swi, am->output_sw_if_index_vec_by_acl[acl_num])
+      sw_if_index_bitmap[0] =
+	clib_bitmap_set (sw_if_index_bitmap[0], *p_swi, 1);
+
+  aclp_post_reclassify_request (am, sw_if_index_bitmap, changed_rules);
+
+  clib_bitmap_free (sw_if_index_bitmap[0]);
+  clib_bitmap_free (sw_if_index_bitmap[1]);
+  vec_free (changed_rules);
+}
+
+static void
+policy_reclassify_acl_list_change (acl_main_t * am, u32 sw_if_index,
+				   int is_input, u32 * old_acls,
+				   u32 * new_acls)
+{
+  uword *sw_if_index_bitmap[2] = { 0, 0 };
+  acl_rule_t *changed_rules = 0;
+  u32 n_old = vec_len (old_acls);
+  u32 n_new = vec_len (new_acls);
+  u32 head = 0, tail = 0, i;
+
+  /* the ACLs in the middle moved, appeared or disappeared */
+  while (head < n_old && head < n_new && old_acls[head] == new_acls[head])
+    head++;
+  while (tail < n_old - head && tail < n_new - head
+	 && old_acls[n_old - 1 - tail] == new_acls[n_new - 1 - tail])
+    tail++;
+  for (i = head; i < n_old - tail; i++)
+    changed_rules =
+      acl_changed_rules (0, am->acls[old_acls[i]].rules, changed_rules);
+  for (i = head; i < n_new - tail; i++)
+    changed_rules =
+      acl_changed_rules (0, am->acls[new_acls[i]].rules, changed_rules);
+
+  sw_if_index_bitmap[is_input] =
+    clib_bitmap_set (sw_if_index_bitmap[is_input], sw_if_index, 1);
+  aclp_post_reclassify_request (am, sw_if_index_bitmap, changed_rules);
+
+  clib_bitmap_free (sw_if_index_bitmap[is_input]);
+  vec_free (changed_rules);
+}
+
 
 static void
 validate_and_reset_acl_counters (acl_main_t * am, u32 acl_index)
@@ -322,6 +408,7 @@ acl_add_list (u32 count, vl_api_acl_rule_t rules[],
   acl_list_t *a;
   acl_rule_t *r;
   acl_rule_t *acl_new_rules = 0;
+  acl_rule_t *acl_old_rules = 0;
   size_t tag_len;
   int i;
 
@@ -403,19 +490,24 @@ acl_add_list (u32 count, vl_api_acl_rule_t rules[],
   else
     {
       a = am->acls + *acl_list_index;
-      /* Get rid of the old rules */
-      if (a->rules)
-	vec_free (a->rules);
+      /* Get rid of the old rules once we know what changed */
+      acl_old_rules = a->rules;
     }
   a->rules = acl_new_rules;
   memcpy (a->tag, tag, tag_len + 1);
   if (am->trace_acl > 255)
     warning_acl_print_acl (am->vlib_main, am, *acl_list_index);
-  if (am->reclassify_sessions)
+  if (am->reclassify_sessions_incremental)
+    {
+      /* only look again at the sessions the changed rules might match */
+      policy_reclassify_acl_change (am, *acl_list_index, acl_old_rules);
+    }
+  else if (am->reclassify_sessions)
     {
       /* a change in an ACLs if they are applied may mean a new policy epoch */
       policy_notify_acl_change (am, *acl_list_index);
     }
+  vec_free (acl_old_rules);
   validate_and_reset_acl_counters (am, *acl_list_index);
   acl_plugin_lookup_context_notify_acl_change (*acl_list_index);
   return 0;
@@ -630,6 +722,7 @@ acl_interface_set_inout_acl_list (acl_main_t * am, u32 sw_if_index,
   uword *seen_acl_bitmap = 0;
   uword *old_seen_acl_bitmap = 0;
   uword *change_acl_bitmap = 0;
+  u32 *old_acl_vec = 0;
   int acln;
   int rv = 0;
 
@@ -703,11 +796,17 @@ acl_interface_set_inout_acl_list (acl_main_t * am, u32 sw_if_index,
   }
 /* *INDENT-ON* */
 
-  vec_free ((*pinout_acl_vec_by_sw_if_index)[sw_if_index]);
+  old_acl_vec = (*pinout_acl_vec_by_sw_if_index)[sw_if_index];
   (*pinout_acl_vec_by_sw_if_index)[sw_if_index] =
     vec_dup (vec_acl_list_index);
 
-  if (am->reclassify_sessions)
+  if (am->reclassify_sessions_incremental)
+    {
+      /* only look again at the sessions the moved ACLs might match */
+      policy_reclassify_acl_list_change (am, sw_if_index, is_input,
+					 old_acl_vec, vec_acl_list_index);
+    }
+  else if (am->reclassify_sessions)
     {
       /* re-applying ACLs means a new policy epoch */
       increment_policy_epoch (am, sw_if_index, is_input);
@@ -755,6 +854,7 @@ acl_interface_set_inout_acl_list (acl_main_t * am, u32 sw_if_index,
 				      vec_len (vec_acl_list_index) > 0);
 
 done:
+  vec_free (old_acl_vec);
   clib_bitmap_free (change_acl_bitmap);
   clib_bitmap_free (seen_acl_bitmap);
   clib_bitmap_free (old_seen_acl_bitmap);
@@ -2565,6 +2665,7 @@ acl_set_aclplugin_fn (vlib_main_t * vm,
   u32 val = 0;
   u32 eh_val = 0;
   uword memory_size = 0;
+  acl_lookup_engine_t engine;
   acl_main_t *am = &acl_main;
 
   if (unformat (input, "skip-ipv6-extension-header %u %u", &eh_val, &val))
@@ -2580,14 +2681,55 @@ acl_set_aclplugin_fn (vlib_main_t * vm,
       am->use_hash_acl_matching = (val != 0);
       goto done;
     }
+  if (unformat (input, "lookup-engine %U", unformat_acl_lookup_engine,
+		&engine))
+    {
+      if (unformat (input, "lc_index %u", &val))
+	{
+	  if (acl_dtree_lc_set_engine (am, val, engine))
+	    error = clib_error_return (0, "lookup context %u not found", val);
+	}
+      else
+	{
+	  acl_lookup_context_t *acontext;
+	  am->default_lookup_engine = engine;
+	  pool_foreach (acontext, am->acl_lookup_contexts)
+	    acl_dtree_lc_set_engine (am, acontext - am->acl_lookup_contexts,
+				     engine);
+	}
+      goto done;
+    }
   if (unformat (input, "l4-match-nonfirst-fragment %u", &val))
     {
       am->l4_match_nonfirst_fragment = (val != 0);
       goto done;
     }
+  if (unformat (input, "reclassify-sessions incremental %u", &val))
+    {
+      if (val && !am->reclassify_sessions)
+	error = clib_error_return (
+	  0, "incremental reclassify requires reclassify-sessions 1");
+      else
+	am->reclassify_sessions_incremental = (val != 0);
+      goto done;
+    }
+  if (unformat (input, "reclassify-sessions budget %u", &val))
+    {
+      am->reclassify_sessions_budget = clib_max (val, 1);
+      goto done;
+    }
+  if (unformat (input, "reclassify-sessions max-changed-rules %u", &val))
+    {
+      am->reclassify_max_changed_rules = val;
+      goto done;
+    }
   if (unformat (input, "reclassify-sessions %u", &val))
     {
-      am->reclassify_sessions = (val != 0);
+      if (!val && am->reclassify_sessions_incremental)
+	error = clib_error_return (
+	  0, "disable reclassify-sessions incremental first");
+      else
+	am->reclassify_sessions = (val != 0);
       goto done;
     }
   if (unformat (input, "event-trace"))
@@ -3425,6 +3567,15 @@ acl_plugin_show_sessions (acl_main_t * am,
 		       pw->rcvd_session_change_requests);
       vlib_cli_output (vm, "  sent session change requests: %d",
 		       pw->sent_session_change_requests);
+      vlib_cli_output (vm, "  reclassify in process: %d",
+		       pw->reclassify_in_process);
+      vlib_cli_output (vm, "  reclassify requests: %lu",
+		       pw->cnt_reclassify_requests);
+      vlib_cli_output (vm,
+		       "  reclassify sessions checked: %lu matched changed rules: %lu deleted: %lu",
+		       pw->cnt_reclassify_sessions_checked,
+		       pw->cnt_reclassify_sessions_matched,
+		       pw->cnt_reclassify_sessions_deleted);
     }
   vlib_cli_output (vm, "\n\nConn cleaner thread counters:");
 #define _(cnt, desc) vlib_cli_output(vm, "             %20lu: %s", am->cnt, desc);
@@ -3440,6 +3591,11 @@ acl_plugin_show_sessions (acl_main_t * am,
 		   ((f64) am->fa_current_cleaner_timer_wait_interval) *
 		   1000.0 / (f64) vm->clib_time.clocks_per_second);
   vlib_cli_output (vm, "Reclassify sessions: %d", am->reclassify_sessions);
+  vlib_cli_output (vm,
+		   "Reclassify sessions incrementally: %d budget %u max changed rules %u",
+		   am->reclassify_sessions_incremental,
+		   am->reclassify_sessions_budget,
+		   am->reclassify_max_changed_rules);
 }
 
 static clib_error_t *
@@ -3476,6 +3632,7 @@ acl_show_aclplugin_tables_fn (vlib_main_t * vm,
   int show_applied_info = 0;
   int show_mask_type = 0;
   int show_bihash = 0;
+  int show_dtree = 0;
   u32 show_bihash_verbose = 0;
 
   if (unformat (input, "acl"))
@@ -3499,16 +3656,22 @@ acl_show_aclplugin_tables_fn (vlib_main_t * vm,
       show_bihash = 1;
       unformat (input, "verbose %u", &show_bihash_verbose);
     }
+  else if (unformat (input, "dtree"))
+    {
+      show_dtree = 1;
+      unformat (input, "lc_index %u", &lc_index);
+    }
 
   if (!
       (show_mask_type || show_acl_hash_info || show_applied_info
-       || show_bihash))
+       || show_bihash || show_dtree))
     {
       /* if no qualifiers specified, show all */
       show_mask_type = 1;
       show_acl_hash_info = 1;
       show_applied_info = 1;
       show_bihash = 1;
+      show_dtree = 1;
     }
   vlib_cli_output (vm, "Stats counters enabled for interface ACLs: %d",
 		   acl_main.interface_acl_counters_enabled);
@@ -3522,10 +3685,44 @@ acl_show_aclplugin_tables_fn (vlib_main_t * vm,
     acl_plugin_show_tables_applied_info (lc_index);
   if (show_bihash)
     acl_plugin_show_tables_bihash (show_bihash_verbose);
+  if (show_dtree)
+    acl_plugin_show_tables_dtree_info (lc_index);
 
   return error;
 }
 
+static clib_error_t *
+acl_test_aclplugin_lookup_engine_fn (vlib_main_t * vm,
+				     unformat_input_t * input,
+				     vlib_cli_command_t * cmd)
+{
+  u32 lc_index = ~0;
+  u32 n_lookups = 100000;
+  int is_ip6 = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "lc_index %u", &lc_index))
+	;
+      else if (unformat (input, "count %u", &n_lookups))
+	;
+      else if (unformat (input, "ip6"))
+	is_ip6 = 1;
+      else if (unformat (input, "ip4"))
+	is_ip6 = 0;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+  if (lc_index == ~0)
+    return clib_error_return (0, "expecting lc_index");
+  if (n_lookups == 0)
+    return clib_error_return (0, "expecting non-zero count");
+
+  acl_plugin_dtree_benchmark (lc_index, is_ip6, n_lookups);
+  return 0;
+}
+
 static clib_error_t *
 acl_clear_aclplugin_fn (vlib_main_t * vm,
 			unformat_input_t * input, vlib_cli_command_t * cmd)
@@ -3540,7 +3737,7 @@ acl_clear_aclplugin_fn (vlib_main_t * vm,
  /* *INDENT-OFF* */
 VLIB_CLI_COMMAND (aclplugin_set_command, static) = {
     .path = "set acl-plugin",
-    .short_help = "set acl-plugin session timeout {{udp idle}|tcp {idle|transient}} <seconds>",
+    .short_help = "set acl-plugin {session timeout {{udp idle}|tcp {idle|transient}} <seconds> | lookup-engine {hash|dtree} [lc_index <N>] | reclassify-sessions {<0|1>|incremental <0|1>|budget <N>|max-changed-rules <N>}}",
     .function = acl_set_aclplugin_fn,
 };
 
@@ -3588,10 +3785,25 @@ VLIB_CLI_COMMAND (aclplugin_show_sessions_command, static) = {
 
 VLIB_CLI_COMMAND (aclplugin_show_tables_command, static) = {
     .path = "show acl-plugin tables",
-    .short_help = "show acl-plugin tables [ acl [index N] | applied [ lc_index N ] | mask | hash [verbose N] ]",
+    .short_help = "show acl-plugin tables [ acl [index N] | applied [ lc_index N ] | mask | hash [verbose N] | dtree [ lc_index N ] ]",
     .function = acl_show_aclplugin_tables_fn,
 };
 
+/*?
+ * Compare the hash and the decision tree lookups on a given lookup context.
+ *  Random packets are generated from the applied ACEs, looked up
+ *  with both engines and the results and the costs are compared.
+ *
+ * @cliexpar
+ * <b><em> test acl-plugin lookup-engine lc_index 0 count 100000 ip4 </b></em>
+ * @cliexend
+ ?*/
+VLIB_CLI_COMMAND (aclplugin_test_lookup_engine_command, static) = {
+    .path = "test acl-plugin lookup-engine",
+    .short_help = "test acl-plugin lookup-engine lc_index <N> [count <N>] [ip4|ip6]",
+    .function = acl_test_aclplugin_lookup_engine_fn,
+};
+
 VLIB_CLI_COMMAND (aclplugin_show_macip_acl_command, static) = {
     .path = "show acl-plugin macip acl",
     .short_help = "show acl-plugin macip acl [index N]",
@@ -3682,6 +3894,9 @@ acl_plugin_config (vlib_main_t * vm, unformat_input_t * input)
   u32 reclassify_sessions;
   u32 use_tuple_merge;
   u32 tuple_merge_split_threshold;
+  u32 dtree_leaf_size;
+  uword dtree_max_memory;
+  acl_lookup_engine_t lookup_engine;
 
   while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
     {
@@ -3725,14 +3940,35 @@ acl_plugin_config (vlib_main_t * vm, unformat_input_t * input)
 	     &tuple_merge_split_threshold))
 	am->tuple_merge_split_threshold = tuple_merge_split_threshold;
 
+      else if (unformat (input, "reclassify sessions incremental"))
+	am->reclassify_sessions_incremental = 1;
+      else if (unformat (input, "reclassify sessions budget %d",
+			 &reclassify_sessions))
+	am->reclassify_sessions_budget = clib_max (reclassify_sessions, 1);
+      else if (unformat (input, "reclassify sessions max changed rules %d",
+			 &reclassify_sessions))
+	am->reclassify_max_changed_rules = reclassify_sessions;
       else if (unformat (input, "reclassify sessions %d",
 			 &reclassify_sessions))
 	am->reclassify_sessions = reclassify_sessions;
+      else if (unformat (input, "lookup engine %U",
+			 unformat_acl_lookup_engine, &lookup_engine))
+	am->default_lookup_engine = lookup_engine;
+      else if (unformat (input, "dtree leaf size %d", &dtree_leaf_size))
+	am->dtree_leaf_size = dtree_leaf_size;
+      else
+	if (unformat
+	    (input, "dtree max memory %U", unformat_memory_size,
+	     &dtree_max_memory))
+	am->dtree_max_memory = dtree_max_memory;
 
       else
 	return clib_error_return (0, "unknown input '%U'",
 				  format_unformat_error, input);
     }
+  if (am->reclassify_sessions_incremental && !am->reclassify_sessions)
+    return clib_error_return (0, "'reclassify sessions incremental' "
+				 "requires 'reclassify sessions 1'");
   return 0;
 }
 
@@ -3776,6 +4012,10 @@ acl_init (vlib_main_t * vm)
     ACL_FA_CONN_TABLE_DEFAULT_HASH_MEMORY_SIZE;
   am->fa_conn_table_max_entries = ACL_FA_CONN_TABLE_DEFAULT_MAX_ENTRIES;
   am->reclassify_sessions = 0;
+  am->reclassify_sessions_incremental = 0;
+  am->reclassify_sessions_budget = ACL_FA_DEFAULT_RECLASSIFY_SESSIONS_BUDGET;
+  am->reclassify_max_changed_rules =
+    ACL_FA_DEFAULT_RECLASSIFY_MAX_CHANGED_RULES;
   vlib_thread_main_t *tm = vlib_get_thread_main ();
 
   am->fa_min_deleted_sessions_per_interval =
@@ -3827,6 +4067,10 @@ acl_init (vlib_main_t * vm)
   /* Set the default threshold */
   am->tuple_merge_split_threshold = TM_SPLIT_THRESHOLD;
 
+  am->default_lookup_engine = ACL_LOOKUP_ENGINE_HASH;
+  am->dtree_leaf_size = ACL_DTREE_DEFAULT_LEAF_SIZE;
+  am->dtree_max_memory = ACL_DTREE_DEFAULT_MAX_MEMORY;
+
   am->interface_acl_user_id =
     acl_plugin.register_user_module ("interface ACL", "sw_if_index",
 				     "is_input");
@@ -32,6 +32,7 @@
 #include "types.h"
 #include "fa_node.h"
 #include "hash_lookup_types.h"
+#include "dtree_lookup_types.h"
 #include "lookup_context.h"
 
 #define  ACL_PLUGIN_VERSION_MAJOR 1
@@ -168,6 +169,18 @@ typedef struct {
   /* whether we need to take the epoch of the session into account */
   int reclassify_sessions;
 
+  /*
+   * Rather than bumping the policy epoch, compute the changed rules
+   * and let the workers reclassify only the sessions they may affect.
+   */
+  int reclassify_sessions_incremental;
+  /* Above this many changed rules, reclassify all sessions of the interface */
+#define ACL_FA_DEFAULT_RECLASSIFY_MAX_CHANGED_RULES 64
+  u32 reclassify_max_changed_rules;
+  /* Max number of session pool slots a worker visits per interrupt */
+#define ACL_FA_DEFAULT_RECLASSIFY_SESSIONS_BUDGET 8192
+  u32 reclassify_sessions_budget;
+
 
 
   /* Total count of interface+direction pairs enabled */
@@ -189,6 +202,17 @@ typedef struct {
   /* vec of vectors of all info of all mask types present in ACEs contained in each lc_index */
   hash_applied_mask_info_t **hash_applied_mask_info_vec_by_lc_index;
 
+  /* The lookup engine assigned to the newly created lookup contexts */
+  acl_lookup_engine_t default_lookup_engine;
+
+  /* decision tree engine state per lc_index */
+  acl_dtree_lc_info_t *dtree_lc_info_by_lc_index;
+
+  /* Max number of rules in a decision tree leaf */
+  u32 dtree_leaf_size;
+  /* Max memory a single decision tree may take before we give up on it */
+  uword dtree_max_memory;
+
   /*
    * Classify tables used to grab the packets for the ACL check,
    * and serving as the 5-tuple session tables at the same time
@@ -378,5 +402,6 @@ typedef enum {
 
 void aclp_post_session_change_request(acl_main_t *am, u32 target_thread, u32 target_session, acl_fa_sess_req_t request_type);
 void aclp_swap_wip_and_pending_session_change_requests(acl_main_t *am, u32 target_thread);
+void aclp_post_reclassify_request(acl_main_t *am, uword **sw_if_index_bitmap_by_is_input, acl_rule_t *changed_rules);
 
 #endif
@@ -0,0 +1,761 @@
+/*
+ *------------------------------------------------------------------
+ * Copyright (c) 2023 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *------------------------------------------------------------------
+ */
+
+/*
+ * Decision tree (HyperSplit-style) lookup engine.
+ *
+ * Each rule is projected onto a box in a five-dimensional space
+ * (source/destination address, protocol, source/destination port).
+ * The tree recursively cuts the space with a single threshold
+ * on one dimension per node, choosing the dimension and the threshold
+ * which split the rules most evenly. The rules which straddle the cut
+ * are copied to both sides, so the build is bounded by a memory budget;
+ * if it is exceeded, the lookup context keeps using the hash engine.
+ *
+ * The trees are built from the applied ACE vector maintained by the hash
+ * engine, so the match result is the same applied entry index the hash
+ * lookup would return. Any change invalidates the trees, the dataplane
+ * falls back to the hash lookup and a process rebuilds the trees
+ * in the background, then publishes them.
+ */
+
+#include <stddef.h>
+
+#include <vlib/vlib.h>
+#include <vnet/vnet.h>
+#include <vppinfra/random.h>
+#include <acl/acl.h>
+
+#include "dtree_lookup.h"
+#include "public_inlines.h"
+
+/* hold down the rebuild so a burst of changes results in a single build */
+#define ACL_DTREE_REBUILD_HOLDDOWN_SEC 0.01
+
+typedef enum {
+  ACL_DTREE_EVENT_REBUILD = 1,
+} acl_dtree_event_t;
+
+typedef struct {
+  u64 lo[ACL_DTREE_N_DIMS];
+  u64 hi[ACL_DTREE_N_DIMS];
+  /* the rule can be fully described by the box above */
+  u8 is_exact;
+  u32 applied_entry_index;
+  acl_rule_t rule;
+} acl_dtree_build_rule_t;
+
+typedef struct {
+  acl_dtree_t *dt;
+  acl_dtree_build_rule_t *rules;
+  /* scratch vector for the threshold selection */
+  u64 *endpoints;
+  u32 leaf_size;
+  uword max_memory;
+  int overflow;
+} acl_dtree_build_ctx_t;
+
+vlib_node_registration_t acl_dtree_rebuild_process_node;
+
+static char *acl_lookup_engine_names[] = {
+  [ACL_LOOKUP_ENGINE_HASH] = "hash",
+  [ACL_LOOKUP_ENGINE_DTREE] = "dtree",
+};
+
+u8 *
+format_acl_lookup_engine (u8 * s, va_list * args)
+{
+  acl_lookup_engine_t engine = va_arg (*args, acl_lookup_engine_t);
+
+  if (engine < ACL_N_LOOKUP_ENGINES)
+    return format (s, "%s", acl_lookup_engine_names[engine]);
+  return format (s, "unknown(%d)", engine);
+}
+
+uword
+unformat_acl_lookup_engine (unformat_input_t * input, va_list * args)
+{
+  acl_lookup_engine_t *engine = va_arg (*args, acl_lookup_engine_t *);
+
+  if (unformat (input, "hash"))
+    *engine = ACL_LOOKUP_ENGINE_HASH;
+  else if (unformat (input, "dtree"))
+    *engine = ACL_LOOKUP_ENGINE_DTREE;
+  else
+    return 0;
+  return 1;
+}
+
+static void
+acl_dtree_free (acl_dtree_t * dt)
+{
+  vec_free (dt->nodes);
+  vec_free (dt->leaf_rules);
+  clib_memset (dt, 0, sizeof (*dt));
+}
+
+static void
+acl_dtree_prefix_range (ip46_address_t * addr, u8 prefixlen, int is_ip6,
+			u64 * lo, u64 * hi)
+{
+  if (is_ip6)
+    {
+      u64 a = clib_net_to_host_u64 (addr->ip6.as_u64[0]);
+      u8 plen = clib_min (prefixlen, 64);
+      u64 mask = plen ? (~0ULL << (64 - plen)) : 0;
+      *lo = a & mask;
+      *hi = a | ~mask;
+    }
+  else
+    {
+      u32 a = clib_net_to_host_u32 (addr->ip4.as_u32);
+      u8 plen = clib_min (prefixlen, 32);
+      u32 mask = plen ? (~0U << (32 - plen)) : 0;
+      *lo = a & mask;
+      *hi = (u32) (a | ~mask);
+    }
+}
+
+static void
+acl_dtree_full_box (int is_ip6, u64 * lo, u64 * hi)
+{
+  u64 addr_max = is_ip6 ? ~0ULL : 0xffffffffULL;
+
+  clib_memset (lo, 0, sizeof (u64) * ACL_DTREE_N_DIMS);
+  hi[ACL_DTREE_DIM_SRC_ADDR] = addr_max;
+  hi[ACL_DTREE_DIM_DST_ADDR] = addr_max;
+  hi[ACL_DTREE_DIM_PROTO] = 255;
+  hi[ACL_DTREE_DIM_SRC_PORT] = 65535;
+  hi[ACL_DTREE_DIM_DST_PORT] = 65535;
+}
+
+/*
+ * Project the rule onto the box. Returns 0 if the rule can never match.
+ */
+static int
+acl_dtree_rule_to_box (acl_rule_t * r, acl_dtree_build_rule_t * br)
+{
+  int is_ip6 = r->is_ipv6;
+
+  acl_dtree_full_box (is_ip6, br->lo, br->hi);
+  acl_dtree_prefix_range (&r->src, r->src_prefixlen, is_ip6,
+			  &br->lo[ACL_DTREE_DIM_SRC_ADDR],
+			  &br->hi[ACL_DTREE_DIM_SRC_ADDR]);
+  acl_dtree_prefix_range (&r->dst, r->dst_prefixlen, is_ip6,
+			  &br->lo[ACL_DTREE_DIM_DST_ADDR],
+			  &br->hi[ACL_DTREE_DIM_DST_ADDR]);
+  if (r->proto)
+    {
+      if ((r->src_port_or_type_first > r->src_port_or_type_last) ||
+	  (r->dst_port_or_code_first > r->dst_port_or_code_last))
+	return 0;
+      br->lo[ACL_DTREE_DIM_PROTO] = br->hi[ACL_DTREE_DIM_PROTO] = r->proto;
+      br->lo[ACL_DTREE_DIM_SRC_PORT] = r->src_port_or_type_first;
+      br->hi[ACL_DTREE_DIM_SRC_PORT] = r->src_port_or_type_last;
+      br->lo[ACL_DTREE_DIM_DST_PORT] = r->dst_port_or_code_first;
+      br->hi[ACL_DTREE_DIM_DST_PORT] = r->dst_port_or_code_last;
+    }
+  /*
+   * An L3-only rule with the prefixes fitting into the projection matches
+   * every packet within its box - the rules after it in a leaf it covers
+   * can never be hit.
+   */
+  br->is_exact = (r->proto == 0) &&
+    (!is_ip6 || ((r->src_prefixlen <= 64) && (r->dst_prefixlen <= 64)));
+  br->rule = *r;
+  return 1;
+}
+
+static int
+acl_dtree_rule_covers_box (acl_dtree_build_rule_t * br, u64 * box_lo,
+			   u64 * box_hi)
+{
+  int dim;
+
+  if (!br->is_exact)
+    return 0;
+  for (dim = 0; dim < ACL_DTREE_N_DIMS; dim++)
+    if ((br->lo[dim] > box_lo[dim]) || (br->hi[dim] < box_hi[dim]))
+      return 0;
+  return 1;
+}
+
+static int
+acl_dtree_u64_cmp (void *a1, void *a2)
+{
+  u64 *v1 = a1, *v2 = a2;
+  return (*v1 > *v2) - (*v1 < *v2);
+}
+
+/*
+ * Pick the threshold for a given dimension: the median of the rule
+ * boundaries falling within the box. Returns 0 if all of the rules
+ * span the whole box in this dimension, so cutting it makes no sense.
+ */
+static int
+acl_dtree_pick_threshold (acl_dtree_build_ctx_t * ctx, u32 * rule_indices,
+			  int dim, u64 box_lo, u64 box_hi, u64 * threshold)
+{
+  u32 *ri;
+
+  vec_reset_length (ctx->endpoints);
+  vec_foreach (ri, rule_indices)
+  {
+    acl_dtree_build_rule_t *br = vec_elt_at_index (ctx->rules, *ri);
+    if (br->lo[dim] > box_lo)
+      vec_add1 (ctx->endpoints, br->lo[dim] - 1);
+    if (br->hi[dim] < box_hi)
+      vec_add1 (ctx->endpoints, br->hi[dim]);
+  }
+  if (vec_len (ctx->endpoints) == 0)
+    return 0;
+
+  vec_sort_with_function (ctx->endpoints, acl_dtree_u64_cmp);
+  *threshold = ctx->endpoints[vec_len (ctx->endpoints) / 2];
+  return 1;
+}
+
+static int
+acl_dtree_check_memory (acl_dtree_build_ctx_t * ctx)
+{
+  acl_dtree_t *dt = ctx->dt;
+
+  dt->memory_size = vec_len (dt->nodes) * sizeof (dt->nodes[0]) +
+    vec_len (dt->leaf_rules) * sizeof (dt->leaf_rules[0]);
+  if (dt->memory_size > ctx->max_memory)
+    ctx->overflow = 1;
+  return ctx->overflow;
+}
+
+static u32
+acl_dtree_build_node (acl_dtree_build_ctx_t * ctx, u32 * rule_indices,
+		      u64 * box_lo, u64 * box_hi, u32 depth)
+{
+  acl_dtree_t *dt = ctx->dt;
+  acl_dtree_node_t *node;
+  u32 node_index = vec_len (dt->nodes);
+  u32 n_rules = vec_len (rule_indices);
+  u32 *left = 0, *right = 0;
+  u32 *ri;
+  int dim, best_dim = -1;
+  u64 best_threshold = 0;
+  u32 best_cost = ~0, best_max = ~0;
+  u32 i, child0, child1;
+  u64 saved;
+
+  vec_add2 (dt->nodes, node, 1);
+  dt->max_depth = clib_max (dt->max_depth, depth);
+  if (acl_dtree_check_memory (ctx))
+    return node_index;
+
+  /* drop the rules shadowed by a rule covering the whole box */
+  for (i = 0; i < n_rules; i++)
+    {
+      acl_dtree_build_rule_t *br =
+	vec_elt_at_index (ctx->rules, rule_indices[i]);
+      if (acl_dtree_rule_covers_box (br, box_lo, box_hi))
+	{
+	  n_rules = i + 1;
+	  vec_set_len (rule_indices, n_rules);
+	  break;
+	}
+    }
+
+  if ((n_rules > ctx->leaf_size) && (depth < ACL_DTREE_MAX_DEPTH))
+    {
+      for (dim = 0; dim < ACL_DTREE_N_DIMS; dim++)
+	{
+	  u64 threshold;
+	  u32 n_left = 0, n_right = 0;
+
+	  if (!acl_dtree_pick_threshold (ctx, rule_indices, dim,
+					 box_lo[dim], box_hi[dim],
+					 &threshold))
+	    continue;
+
+	  for (i = 0; i < n_rules; i++)
+	    {
+	      acl_dtree_build_rule_t *br =
+		vec_elt_at_index (ctx->rules, rule_indices[i]);
+	      n_left += (br->lo[dim] <= threshold);
+	      n_right += (br->hi[dim] > threshold);
+	    }
+	  if ((n_left == n_rules) && (n_right == n_rules))
+	    continue;
+
+	  /* minimize the replication, then the size of the bigger side */
+	  if ((n_left + n_right < best_cost) ||
+	      ((n_left + n_right == best_cost) &&
+	       (clib_max (n_left, n_right) < best_max)))
+	    {
+	      best_cost = n_left + n_right;
+	      best_max = clib_max (n_left, n_right);
+	      best_dim = dim;
+	      best_threshold = threshold;
+	    }
+	}
+    }
+
+  if (best_dim < 0)
+    {
+      node->dim = ACL_DTREE_DIM_LEAF;
+      node->threshold = 0;
+      node->first_rule = vec_len (dt->leaf_rules);
+      node->n_rules = n_rules;
+      for (i = 0; i < n_rules; i++)
+	{
+	  acl_dtree_build_rule_t *br =
+	    vec_elt_at_index (ctx->rules, rule_indices[i]);
+	  acl_dtree_leaf_rule_t *lr;
+	  vec_add2 (dt->leaf_rules, lr, 1);
+	  lr->applied_entry_index = br->applied_entry_index;
+	  lr->rule = br->rule;
+	}
+      dt->n_leaves++;
+      acl_dtree_check_memory (ctx);
+      return node_index;
+    }
+
+  node->dim = best_dim;
+  node->threshold = best_threshold;
+
+  for (i = 0; i < n_rules; i++)
+    {
+      ri = vec_elt_at_index (rule_indices, i);
+      acl_dtree_build_rule_t *br = vec_elt_at_index (ctx->rules, *ri);
+      if (br->lo[best_dim] <= best_threshold)
+	vec_add1 (left, *ri);
+      if (br->hi[best_dim] > best_threshold)
+	vec_add1 (right, *ri);
+    }
+
+  saved = box_hi[best_dim];
+  box_hi[best_dim] = best_threshold;
+  child0 = acl_dtree_build_node (ctx, left, box_lo, box_hi, depth + 1);
+  box_hi[best_dim] = saved;
+  vec_free (left);
+
+  saved = box_lo[best_dim];
+  box_lo[best_dim] = best_threshold + 1;
+  child1 = acl_dtree_build_node (ctx, right, box_lo, box_hi, depth + 1);
+  box_lo[best_dim] = saved;
+  vec_free (right);
+
+  /* the node vector might have been reallocated by now */
+  node = vec_elt_at_index (dt->nodes, node_index);
+  node->child[0] = child0;
+  node->child[1] = child1;
+  return node_index;
+}
+
+/*
+ * Build the tree for one address family out of the applied ACEs.
+ * Returns 0 on success, -1 if the memory budget was exceeded.
+ */
+static int
+acl_dtree_build (acl_main_t * am, u32 lc_index, int is_ip6, acl_dtree_t * dt)
+{
+  acl_dtree_build_ctx_t ctx = { 0 };
+  applied_hash_ace_entry_t *pae;
+  acl_dtree_build_rule_t *br;
+  u64 box_lo[ACL_DTREE_N_DIMS], box_hi[ACL_DTREE_N_DIMS];
+  u32 *rule_indices = 0;
+  int rv;
+
+  acl_dtree_free (dt);
+  ctx.dt = dt;
+  ctx.leaf_size = am->dtree_leaf_size;
+  ctx.max_memory = am->dtree_max_memory;
+
+  if (lc_index < vec_len (am->hash_entry_vec_by_lc_index))
+    {
+      vec_foreach (pae, am->hash_entry_vec_by_lc_index[lc_index])
+      {
+	acl_rule_t *r = &am->acls[pae->acl_index].rules[pae->ace_index];
+	if (r->is_ipv6 != is_ip6)
+	  continue;
+	vec_add2 (ctx.rules, br, 1);
+	if (!acl_dtree_rule_to_box (r, br))
+	  {
+	    vec_dec_len (ctx.rules, 1);
+	    continue;
+	  }
+	br->applied_entry_index =
+	  pae - am->hash_entry_vec_by_lc_index[lc_index];
+	vec_add1 (rule_indices, vec_len (ctx.rules) - 1);
+      }
+    }
+  dt->n_rules = vec_len (rule_indices);
+
+  acl_dtree_full_box (is_ip6, box_lo, box_hi);
+  acl_dtree_build_node (&ctx, rule_indices, box_lo, box_hi, 0);
+
+  rv = ctx.overflow ? -1 : 0;
+  vec_free (rule_indices);
+  vec_free (ctx.rules);
+  vec_free (ctx.endpoints);
+  return rv;
+}
+
+static void
+acl_dtree_lc_rebuild (acl_main_t * am, u32 lc_index)
+{
+  acl_dtree_lc_info_t *dli =
+    vec_elt_at_index (am->dtree_lc_info_by_lc_index, lc_index);
+  f64 start = vlib_time_now (am->vlib_main);
+  int is_ip6;
+
+  /* the dataplane is not using the trees while they are not ready */
+  ASSERT (!dli->is_ready);
+  dli->needs_rebuild = 0;
+  dli->build_failed = 0;
+  for (is_ip6 = 0; is_ip6 <= 1; is_ip6++)
+    {
+      if (acl_dtree_build (am, lc_index, is_ip6, &dli->tree[is_ip6]))
+	{
+	  acl_log_warn ("lc_index %d: decision tree for %s exceeds %U, "
+			"using hash lookup", lc_index,
+			is_ip6 ? "IPv6" : "IPv4", format_memory_size,
+			am->dtree_max_memory);
+	  dli->build_failed = 1;
+	  acl_dtree_free (&dli->tree[0]);
+	  acl_dtree_free (&dli->tree[1]);
+	  break;
+	}
+    }
+  dli->n_builds++;
+  dli->last_build_time = vlib_time_now (am->vlib_main) - start;
+  if (dli->build_failed)
+    return;
+
+  /* make sure the trees are visible before the dataplane starts to use them */
+  CLIB_MEMORY_STORE_BARRIER ();
+  dli->is_ready = 1;
+}
+
+static uword
+acl_dtree_rebuild_process (vlib_main_t * vm, vlib_node_runtime_t * rt,
+			   vlib_frame_t * f)
+{
+  acl_main_t *am = &acl_main;
+  uword *event_data = 0;
+  acl_dtree_lc_info_t *dli;
+
+  while (1)
+    {
+      vlib_process_wait_for_event (vm);
+      (void) vlib_process_get_events (vm, &event_data);
+      vec_reset_length (event_data);
+
+      vlib_process_suspend (vm, ACL_DTREE_REBUILD_HOLDDOWN_SEC);
+
+      /* no suspension below, so the applied ACEs can not change under us */
+      vec_foreach (dli, am->dtree_lc_info_by_lc_index)
+      {
+	u32 lc_index = dli - am->dtree_lc_info_by_lc_index;
+	if (!dli->needs_rebuild)
+	  continue;
+	if (pool_is_free_index (am->acl_lookup_contexts, lc_index) ||
+	    (dli->engine != ACL_LOOKUP_ENGINE_DTREE))
+	  {
+	    dli->needs_rebuild = 0;
+	    continue;
+	  }
+	acl_dtree_lc_rebuild (am, lc_index);
+      }
+    }
+  return 0;
+}
+
+VLIB_REGISTER_NODE (acl_dtree_rebuild_process_node) = {
+  .function = acl_dtree_rebuild_process,
+  .type = VLIB_NODE_TYPE_PROCESS,
+  .name = "acl-plugin-dtree-rebuild-process",
+};
+
+void
+acl_dtree_lc_init (acl_main_t * am, u32 lc_index)
+{
+  acl_dtree_lc_info_t *dli;
+
+  vec_validate (am->dtree_lc_info_by_lc_index, lc_index);
+  dli = vec_elt_at_index (am->dtree_lc_info_by_lc_index, lc_index);
+  clib_memset (dli, 0, sizeof (*dli));
+  dli->engine = am->default_lookup_engine;
+}
+
+void
+acl_dtree_lc_free (acl_main_t * am, u32 lc_index)
+{
+  acl_dtree_lc_info_t *dli;
+
+  if (lc_index >= vec_len (am->dtree_lc_info_by_lc_index))
+    return;
+  dli = vec_elt_at_index (am->dtree_lc_info_by_lc_index, lc_index);
+  dli->is_ready = 0;
+  dli->needs_rebuild = 0;
+  acl_dtree_free (&dli->tree[0]);
+  acl_dtree_free (&dli->tree[1]);
+}
+
+void
+acl_dtree_lc_invalidate (acl_main_t * am, u32 lc_index)
+{
+  acl_dtree_lc_info_t *dli;
+
+  if (lc_index >= vec_len (am->dtree_lc_info_by_lc_index))
+    return;
+  dli = vec_elt_at_index (am->dtree_lc_info_by_lc_index, lc_index);
+  dli->is_ready = 0;
+  if (dli->engine != ACL_LOOKUP_ENGINE_DTREE)
+    return;
+  dli->needs_rebuild = 1;
+  vlib_process_signal_event (am->vlib_main,
+			     acl_dtree_rebuild_process_node.index,
+			     ACL_DTREE_EVENT_REBUILD, lc_index);
+}
+
+int
+acl_dtree_lc_set_engine (acl_main_t * am, u32 lc_index,
+			 acl_lookup_engine_t engine)
+{
+  acl_dtree_lc_info_t *dli;
+
+  if (pool_is_free_index (am->acl_lookup_contexts, lc_index))
+    return VNET_API_ERROR_NO_SUCH_ENTRY;
+  if (engine >= ACL_N_LOOKUP_ENGINES)
+    return VNET_API_ERROR_INVALID_VALUE;
+
+  if (lc_index >= vec_len (am->dtree_lc_info_by_lc_index))
+    acl_dtree_lc_init (am, lc_index);
+  dli = vec_elt_at_index (am->dtree_lc_info_by_lc_index, lc_index);
+  if (dli->engine == engine)
+    return 0;
+
+  acl_dtree_lc_free (am, lc_index);
+  dli->engine = engine;
+  dli->build_failed = 0;
+  acl_dtree_lc_invalidate (am, lc_index);
+  return 0;
+}
+
+static void
+acl_dtree_print_tree (vlib_main_t * vm, char *name, acl_dtree_t * dt)
+{
+  vlib_cli_output (vm,
+		   "  %s tree: rules %d nodes %d leaves %d leaf rules %d "
+		   "max depth %d memory %U", name, dt->n_rules,
+		   vec_len (dt->nodes), dt->n_leaves,
+		   vec_len (dt->leaf_rules), dt->max_depth,
+		   format_memory_size, dt->memory_size);
+}
+
+void
+acl_plugin_show_tables_dtree_info (u32 lc_index)
+{
+  acl_main_t *am = &acl_main;
+  vlib_main_t *vm = am->vlib_main;
+  acl_dtree_lc_info_t *dli;
+
+  vlib_cli_output (vm, "Decision tree lookup: default engine %U, "
+		   "leaf size %d, max memory %U",
+		   format_acl_lookup_engine, am->default_lookup_engine,
+		   am->dtree_leaf_size, format_memory_size,
+		   am->dtree_max_memory);
+  vec_foreach (dli, am->dtree_lc_info_by_lc_index)
+  {
+    u32 lci = dli - am->dtree_lc_info_by_lc_index;
+    if (((lc_index != ~0) && (lc_index != lci)) ||
+	pool_is_free_index (am->acl_lookup_contexts, lci))
+      continue;
+    vlib_cli_output (vm, "lc_index %d: engine %U ready %d pending %d "
+		     "failed %d builds %d last build %.3f ms", lci,
+		     format_acl_lookup_engine, dli->engine, dli->is_ready,
+		     dli->needs_rebuild, dli->build_failed, dli->n_builds,
+		     dli->last_build_time * 1e3);
+    if (dli->engine != ACL_LOOKUP_ENGINE_DTREE)
+      continue;
+    acl_dtree_print_tree (vm, "ip4", &dli->tree[0]);
+    acl_dtree_print_tree (vm, "ip6", &dli->tree[1]);
+  }
+}
+
+static u16
+acl_dtree_random_in_range (u32 * seed, u16 first, u16 last)
+{
+  if (last <= first)
+    return first;
+  return first + (random_u32 (seed) % ((u32) last - first + 1));
+}
+
+static void
+acl_dtree_random_addr (u32 * seed, ip46_address_t * rule_addr, u8 prefixlen,
+		       int is_ip6, fa_5tuple_t * pkt, int index)
+{
+  if (is_ip6)
+    {
+      ip6_address_t mask;
+      int i;
+
+      ip6_address_mask_from_width (&mask, prefixlen);
+      for (i = 0; i < 4; i++)
+	pkt->ip6_addr[index].as_u32[i] =
+	  (rule_addr->ip6.as_u32[i] & mask.as_u32[i]) |
+	  (random_u32 (seed) & ~mask.as_u32[i]);
+    }
+  else
+    {
+      ip4_address_t mask;
+
+      ip4_preflen_to_mask (prefixlen, &mask);
+      pkt->ip4_addr[index].as_u32 =
+	(rule_addr->ip4.as_u32 & mask.as_u32) |
+	(random_u32 (seed) & ~mask.as_u32);
+    }
+}
+
+/*
+ * Generate the packets aimed at the applied rules of the lookup context,
+ * run them through both the hash and the decision tree lookups,
+ * compare the results and report the cost of each.
+ */
+void
+acl_plugin_dtree_benchmark (u32 lc_index, int is_ip6, u32 n_lookups)
+{
+  acl_main_t *am = &acl_main;
+  vlib_main_t *vm = am->vlib_main;
+  applied_hash_ace_entry_t *paes;
+  acl_dtree_t dt = { 0 };
+  fa_5tuple_t *pkts = 0, *pkt;
+  u32 *hash_results = 0, *dtree_results = 0;
+  u32 *rule_indices = 0;
+  u32 seed = 0xdeadbeef;
+  u32 i, n_mismatch = 0, n_hash_hits = 0;
+  u64 t0, hash_clocks, dtree_clocks;
+  f64 build_time;
+
+  if (pool_is_free_index (am->acl_lookup_contexts, lc_index) ||
+      (lc_index >= vec_len (am->hash_entry_vec_by_lc_index)))
+    {
+      vlib_cli_output (vm, "lc_index %d has no applied ACEs", lc_index);
+      return;
+    }
+  paes = am->hash_entry_vec_by_lc_index[lc_index];
+  for (i = 0; i < vec_len (paes); i++)
+    if (am->acls[paes[i].acl_index].rules[paes[i].ace_index].is_ipv6 ==
+	is_ip6)
+      vec_add1 (rule_indices, i);
+  if (vec_len (rule_indices) == 0)
+    {
+      vlib_cli_output (vm, "lc_index %d has no %s ACEs", lc_index,
+		       is_ip6 ? "IPv6" : "IPv4");
+      return;
+    }
+
+  build_time = vlib_time_now (vm);
+  if (acl_dtree_build (am, lc_index, is_ip6, &dt))
+    {
+      vlib_cli_output (vm, "decision tree exceeds %U", format_memory_size,
+		       am->dtree_max_memory);
+      goto done;
+    }
+  build_time = vlib_time_now (vm) - build_time;
+
+  vec_validate (pkts, n_lookups - 1);
+  vec_validate (hash_results, n_lookups - 1);
+  vec_validate (dtree_results, n_lookups - 1);
+  vec_foreach (pkt, pkts)
+  {
+    u32 j = rule_indices[random_u32 (&seed) % vec_len (rule_indices)];
+    acl_rule_t *r = &am->acls[paes[j].acl_index].rules[paes[j].ace_index];
+    clib_memset (pkt, 0, sizeof (*pkt));
+    acl_dtree_random_addr (&seed, &r->src, r->src_prefixlen, is_ip6, pkt, 0);
+    acl_dtree_random_addr (&seed, &r->dst, r->dst_prefixlen, is_ip6, pkt, 1);
+    if (r->proto)
+      {
+	pkt->l4.proto = r->proto;
+	pkt->l4.port[0] =
+	  acl_dtree_random_in_range (&seed, r->src_port_or_type_first,
+				     r->src_port_or_type_last);
+	pkt->l4.port[1] =
+	  acl_dtree_random_in_range (&seed, r->dst_port_or_code_first,
+				     r->dst_port_or_code_last);
+      }
+    else
+      {
+	pkt->l4.proto = (random_u32 (&seed) & 1) ? IP_PROTOCOL_TCP :
+	  IP_PROTOCOL_UDP;
+	pkt->l4.port[0] = random_u32 (&seed);
+	pkt->l4.port[1] = random_u32 (&seed);
+      }
+    pkt->pkt.l4_valid = 1;
+    pkt->pkt.is_ip6 = is_ip6;
+    pkt->pkt.lc_index = lc_index;
+  }
+
+  t0 = clib_cpu_time_now ();
+  for (i = 0; i < n_lookups; i++)
+    hash_results[i] =
+      multi_acl_match_get_applied_ace_index (am, is_ip6, &pkts[i]);
+  hash_clocks = clib_cpu_time_now () - t0;
+
+  t0 = clib_cpu_time_now ();
+  for (i = 0; i < n_lookups; i++)
+    dtree_results[i] =
+      acl_dtree_match_get_applied_ace_index (&dt, is_ip6, &pkts[i]);
+  dtree_clocks = clib_cpu_time_now () - t0;
+
+  for (i = 0; i < n_lookups; i++)
+    {
+      u32 hash_result = hash_results[i] < vec_len (paes) ? hash_results[i] :
+	~0;
+      n_hash_hits += (hash_result != ~0);
+      if (hash_result != dtree_results[i])
+	{
+	  if (n_mismatch == 0)
+	    vlib_cli_output (vm, "first mismatch at lookup %d: hash %d "
+			     "dtree %d", i, hash_result, dtree_results[i]);
+	  n_mismatch++;
+	}
+    }
+
+  vlib_cli_output (vm, "lc_index %d %s: %d ACEs, %d lookups, %d hits",
+		   lc_index, is_ip6 ? "ip6" : "ip4", vec_len (rule_indices),
+		   n_lookups, n_hash_hits);
+  acl_dtree_print_tree (vm, is_ip6 ? "ip6" : "ip4", &dt);
+  vlib_cli_output (vm, "  dtree build time: %.3f ms", build_time * 1e3);
+  vlib_cli_output (vm, "  hash:  %.2f clocks/lookup",
+		   (f64) hash_clocks / n_lookups);
+  vlib_cli_output (vm, "  dtree: %.2f clocks/lookup",
+		   (f64) dtree_clocks / n_lookups);
+  vlib_cli_output (vm, "  mismatches: %d", n_mismatch);
+
+done:
+  acl_dtree_free (&dt);
+  vec_free (pkts);
+  vec_free (hash_results);
+  vec_free (dtree_results);
+  vec_free (rule_indices);
+}
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
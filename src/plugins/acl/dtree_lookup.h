@@ -0,0 +1,45 @@
+/*
+ *------------------------------------------------------------------
+ * Copyright (c) 2023 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *------------------------------------------------------------------
+ */
+
+#ifndef _ACL_DTREE_LOOKUP_H_
+#define _ACL_DTREE_LOOKUP_H_
+
+#include <stddef.h>
+#include "lookup_context.h"
+#include "acl.h"
+
+/*
+ * Create/destroy the decision tree state of a lookup context.
+ */
+void acl_dtree_lc_init(acl_main_t *am, u32 lc_index);
+void acl_dtree_lc_free(acl_main_t *am, u32 lc_index);
+
+/*
+ * The applied ACEs of the lookup context have changed: stop using
+ * the trees and schedule the rebuild in the background.
+ */
+void acl_dtree_lc_invalidate(acl_main_t *am, u32 lc_index);
+
+int acl_dtree_lc_set_engine(acl_main_t *am, u32 lc_index, acl_lookup_engine_t engine);
+
+format_function_t format_acl_lookup_engine;
+unformat_function_t unformat_acl_lookup_engine;
+
+void acl_plugin_show_tables_dtree_info (u32 lc_index);
+void acl_plugin_dtree_benchmark (u32 lc_index, int is_ip6, u32 n_lookups);
+
+#endif
@@ -0,0 +1,96 @@
+/*
+ *------------------------------------------------------------------
+ * Copyright (c) 2023 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *------------------------------------------------------------------
+ */
+
+#ifndef _ACL_DTREE_LOOKUP_TYPES_H_
+#define _ACL_DTREE_LOOKUP_TYPES_H_
+
+#include "types.h"
+#include <plugins/acl/exported_types.h>
+
+/*
+ * The dimensions the decision tree cuts on. Each of them is projected
+ * onto a u64 range: IPv4 addresses in host byte order, IPv6 addresses
+ * by their upper 64 bits in host byte order. The leaves always verify
+ * the full rule, so the projection only needs to be a superset.
+ */
+typedef enum {
+  ACL_DTREE_DIM_SRC_ADDR = 0,
+  ACL_DTREE_DIM_DST_ADDR,
+  ACL_DTREE_DIM_PROTO,
+  ACL_DTREE_DIM_SRC_PORT,
+  ACL_DTREE_DIM_DST_PORT,
+  ACL_DTREE_N_DIMS,
+} acl_dtree_dim_t;
+
+#define ACL_DTREE_DIM_LEAF 0xff
+
+/* Default number of rules in a leaf below which we stop cutting */
+#define ACL_DTREE_DEFAULT_LEAF_SIZE 8
+/* Hard limit on the depth of the tree */
+#define ACL_DTREE_MAX_DEPTH 40
+/* Default memory budget for a single tree */
+#define ACL_DTREE_DEFAULT_MAX_MEMORY (64 << 20)
+
+typedef struct {
+  /* values <= threshold go to child[0], the rest to child[1] */
+  u64 threshold;
+  union {
+    /* inner node: indices of the children in the node vector */
+    u32 child[2];
+    /* leaf: the slice of the leaf rule vector to verify in order */
+    struct {
+      u32 first_rule;
+      u32 n_rules;
+    };
+  };
+  /* the dimension to test, or ACL_DTREE_DIM_LEAF */
+  u8 dim;
+} acl_dtree_node_t;
+
+typedef struct {
+  /* index of the applied ACE within hash_entry_vec_by_lc_index */
+  u32 applied_entry_index;
+  /* a local copy of the rule, to avoid chasing pointers when verifying */
+  acl_rule_t rule;
+} acl_dtree_leaf_rule_t;
+
+typedef struct {
+  /* node 0 is the root */
+  acl_dtree_node_t *nodes;
+  acl_dtree_leaf_rule_t *leaf_rules;
+  /* Debug Information */
+  u32 n_rules;
+  u32 n_leaves;
+  u32 max_depth;
+  uword memory_size;
+} acl_dtree_t;
+
+typedef struct {
+  /* the selected lookup engine for this lookup context */
+  u8 engine;
+  /* the trees reflect the applied ACEs and may be used by the dataplane */
+  volatile u8 is_ready;
+  /* the applied ACEs have changed since the trees were built */
+  u8 needs_rebuild;
+  /* the last build exceeded the memory budget, the hash engine is used */
+  u8 build_failed;
+  u32 n_builds;
+  f64 last_build_time;
+  acl_dtree_t tree[2];		/* [is_ip6] */
+} acl_dtree_lc_info_t;
+
+#endif
@@ -63,6 +63,21 @@ typedef void (*acl_plugin_put_lookup_context_index_fn_t) (u32 lc_index);
 
 typedef int (*acl_plugin_set_acl_vec_for_context_fn_t) (u32 lc_index, u32 *acl_list);
 
+/*
+ * The engines which can be used to match the packets within a lookup context.
+ * The hash engine is the default. The decision tree engine is built
+ * in the background after each change, with the hash engine used
+ * in the meantime, and is meant for large rule sets with many port ranges.
+ */
+
+typedef enum {
+  ACL_LOOKUP_ENGINE_HASH = 0,
+  ACL_LOOKUP_ENGINE_DTREE,
+  ACL_N_LOOKUP_ENGINES,
+} acl_lookup_engine_t;
+
+typedef int (*acl_plugin_set_lookup_engine_for_context_fn_t) (u32 lc_index, acl_lookup_engine_t engine);
+
 typedef void (*acl_plugin_fill_5tuple_fn_t) (u32 lc_index, vlib_buffer_t * b0, int is_ip6, int is_input,
                                 int is_l2_path, fa_5tuple_opaque_t * p5tuple_pkt);
 
@@ -82,7 +97,8 @@ _(get_lookup_context_index)            \
 _(put_lookup_context_index)            \
 _(set_acl_vec_for_context)             \
 _(fill_5tuple)                         \
-_(match_5tuple)                        
+_(match_5tuple)                        \
+_(set_lookup_engine_for_context)
 
 #define _(name) acl_plugin_ ## name ## _fn_t name;
 typedef struct {
@@ -6,6 +6,7 @@
 #include <vppinfra/bihash_40_8.h>
 
 #include <plugins/acl/exported_types.h>
+#include <plugins/acl/types.h>
 
 // #define FA_NODE_VERBOSE_DEBUG 3
 
@@ -117,7 +118,8 @@ typedef struct {
   u8 link_list_id;        /* +1 bytes = 17 */
   u8 deleted;             /* +1 bytes = 18 */
   u8 is_ip6;              /* +1 bytes = 19 */
-  u8 reserved1[5];        /* +5 bytes = 24 */
+  u8 tcp_flags_initial;   /* +1 bytes = 20 */
+  u8 reserved1[4];        /* +4 bytes = 24 */
   u64 reserved2[5];       /* +5*8 bytes = 64 */
 } fa_session_t;
 
@@ -223,6 +225,22 @@ typedef struct {
    * Set to copy of a "generation" counter in main thread so we can sync the interrupts.
    */
   int interrupt_generation;
+  /*
+   * Incremental reclassification in progress: the sessions on these
+   * interfaces whose 5-tuple matches any of the changed rules
+   * (or any session, if reclassify_all_sessions is set) are
+   * looked up again, starting at the pool index reclassify_cursor.
+   */
+  u32 reclassify_in_process;
+  u32 reclassify_cursor;
+  uword *reclassify_sw_if_index_bitmap[2];	/* [is_input] */
+  acl_rule_t *reclassify_rules;
+  u8 reclassify_all_sessions;
+  /* incremental reclassification counters */
+  u64 cnt_reclassify_requests;
+  u64 cnt_reclassify_sessions_checked;
+  u64 cnt_reclassify_sessions_matched;
+  u64 cnt_reclassify_sessions_deleted;
    /*
     * work in progress data for the pipelined node operation
     */
@@ -18,6 +18,7 @@
 #include <vlib/unix/plugin.h>
 #include <plugins/acl/public_inlines.h>
 #include "hash_lookup.h"
+#include "dtree_lookup.h"
 #include "elog_acl_trace.h"
 
 /* check if a given ACL exists */
@@ -117,6 +118,7 @@ static int acl_plugin_get_lookup_context_index (u32 acl_user_id, u32 val1, u32 v
 
   u32 new_context_id = acontext - am->acl_lookup_contexts;
   vec_add1(am->acl_users[acl_user_id].lookup_contexts, new_context_id);
+  acl_dtree_lc_init(am, new_context_id);
 
   return new_context_id;
 }
@@ -203,6 +205,7 @@ static void acl_plugin_put_lookup_context_index (u32 lc_index)
   ASSERT(index != ~0);
 
   vec_del1(am->acl_users[acontext->context_user_id].lookup_contexts, index);
+  acl_dtree_lc_free(am, lc_index);
   unapply_acl_vec(lc_index, acontext->acl_indices);
   unlock_acl_vec(lc_index, acontext->acl_indices);
   vec_free(acontext->acl_indices);
@@ -254,6 +257,7 @@ static int acl_plugin_set_acl_vec_for_context (u32 lc_index, u32 *acl_list)
   u32 *old_acl_vector = acontext->acl_indices;
   acontext->acl_indices = vec_dup(acl_list);
 
+  acl_dtree_lc_invalidate(am, lc_index);
   unapply_acl_vec(lc_index, old_acl_vector);
   unlock_acl_vec(lc_index, old_acl_vector);
   lock_acl_vec(lc_index, acontext->acl_indices);
@@ -280,6 +284,12 @@ void acl_plugin_lookup_context_notify_acl_change(u32 acl_num)
     /* this is a deletion notification */
     hash_acl_delete(am, acl_num);
   }
+  if (acl_num < vec_len(am->lc_index_vec_by_acl)) {
+    u32 *lc_index;
+    vec_foreach(lc_index, am->lc_index_vec_by_acl[acl_num]) {
+      acl_dtree_lc_invalidate(am, *lc_index);
+    }
+  }
 }
 
 
@@ -302,6 +312,15 @@ static int acl_plugin_match_5tuple (u32 lc_index,
   return acl_plugin_match_5tuple_inline (&acl_main, lc_index, pkt_5tuple, is_ip6, r_action, r_acl_pos_p, r_acl_match_p, r_rule_match_p, trace_bitmap);
 }
 
+/*
+ * Select the engine used to match the packets within a given context.
+ */
+static int acl_plugin_set_lookup_engine_for_context (u32 lc_index, acl_lookup_engine_t engine)
+{
+  acl_main_t *am = &acl_main;
+  return acl_dtree_lc_set_engine(am, lc_index, engine);
+}
+
 
 void
 acl_plugin_show_lookup_user (u32 user_index)
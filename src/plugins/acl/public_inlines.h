@@ -649,6 +649,87 @@ hash_multi_acl_match_5tuple (void *p_acl_main, u32 lc_index, fa_5tuple_t * pkt_5
 
 
 
+always_inline void
+acl_dtree_fill_key (fa_5tuple_t * match, int is_ip6, u64 * key)
+{
+  if (is_ip6)
+    {
+      key[ACL_DTREE_DIM_SRC_ADDR] =
+	clib_net_to_host_u64 (match->ip6_addr[0].as_u64[0]);
+      key[ACL_DTREE_DIM_DST_ADDR] =
+	clib_net_to_host_u64 (match->ip6_addr[1].as_u64[0]);
+    }
+  else
+    {
+      key[ACL_DTREE_DIM_SRC_ADDR] =
+	clib_net_to_host_u32 (match->ip4_addr[0].as_u32);
+      key[ACL_DTREE_DIM_DST_ADDR] =
+	clib_net_to_host_u32 (match->ip4_addr[1].as_u32);
+    }
+  key[ACL_DTREE_DIM_PROTO] = match->l4.proto;
+  key[ACL_DTREE_DIM_SRC_PORT] = match->l4.port[0];
+  key[ACL_DTREE_DIM_DST_PORT] = match->l4.port[1];
+}
+
+/*
+ * Walk the tree down to a leaf, then verify the rules within the leaf,
+ * which are sorted by the applied entry index, so the first hit wins.
+ */
+always_inline u32
+acl_dtree_match_get_applied_ace_index (acl_dtree_t * dt, int is_ip6, fa_5tuple_t * match)
+{
+  u64 key[ACL_DTREE_N_DIMS];
+  acl_dtree_node_t *node;
+  acl_dtree_leaf_rule_t *lr;
+  u32 i;
+
+  if (PREDICT_FALSE (vec_len (dt->nodes) == 0))
+    return ~0;
+
+  acl_dtree_fill_key (match, is_ip6, key);
+
+  node = dt->nodes;
+  while (node->dim != ACL_DTREE_DIM_LEAF)
+    node = dt->nodes + node->child[key[node->dim] > node->threshold];
+
+  lr = dt->leaf_rules + node->first_rule;
+  for (i = 0; i < node->n_rules; i++)
+    {
+      if (single_rule_match_5tuple (&lr[i].rule, is_ip6, match))
+	return lr[i].applied_entry_index;
+    }
+  return ~0;
+}
+
+always_inline int
+dtree_lookup_is_ready (acl_main_t * am, u32 lc_index)
+{
+  return ((lc_index < vec_len (am->dtree_lc_info_by_lc_index)) &&
+	  am->dtree_lc_info_by_lc_index[lc_index].is_ready);
+}
+
+always_inline int
+dtree_multi_acl_match_5tuple (void *p_acl_main, u32 lc_index, fa_5tuple_t * pkt_5tuple,
+                       int is_ip6, u8 *action, u32 *acl_pos_p, u32 * acl_match_p,
+                       u32 * rule_match_p, u32 * trace_bitmap)
+{
+  acl_main_t *am = p_acl_main;
+  applied_hash_ace_entry_t **applied_hash_aces = vec_elt_at_index(am->hash_entry_vec_by_lc_index, lc_index);
+  acl_dtree_lc_info_t *dli = vec_elt_at_index(am->dtree_lc_info_by_lc_index, lc_index);
+  u32 match_index = acl_dtree_match_get_applied_ace_index(&dli->tree[is_ip6], is_ip6, pkt_5tuple);
+  if (match_index < vec_len((*applied_hash_aces))) {
+    applied_hash_ace_entry_t *pae = vec_elt_at_index((*applied_hash_aces), match_index);
+    pae->hitcount++;
+    *acl_pos_p = pae->acl_position;
+    *acl_match_p = pae->acl_index;
+    *rule_match_p = pae->ace_index;
+    *action = pae->action;
+    return 1;
+  }
+  return 0;
+}
+
+
 always_inline int
 acl_plugin_match_5tuple_inline (void *p_acl_main, u32 lc_index,
                                            fa_5tuple_opaque_t * pkt_5tuple,
@@ -671,6 +752,9 @@ acl_plugin_match_5tuple_inline (void *p_acl_main, u32 lc_index,
        */
       return linear_multi_acl_match_5tuple(p_acl_main, lc_index, pkt_5tuple_internal, is_ip6, r_action,
                                  r_acl_pos_p, r_acl_match_p, r_rule_match_p, trace_bitmap);
+    } else if (dtree_lookup_is_ready(am, lc_index)) {
+      return dtree_multi_acl_match_5tuple(p_acl_main, lc_index, pkt_5tuple_internal, is_ip6, r_action,
+                                 r_acl_pos_p, r_acl_match_p, r_rule_match_p, trace_bitmap);
     } else {
       return hash_multi_acl_match_5tuple(p_acl_main, lc_index, pkt_5tuple_internal, is_ip6, r_action,
                                  r_acl_pos_p, r_acl_match_p, r_rule_match_p, trace_bitmap);
@@ -706,6 +790,9 @@ acl_plugin_match_5tuple_inline_and_count (void *p_acl_main, u32 lc_index,
        */
       ret = linear_multi_acl_match_5tuple(p_acl_main, lc_index, pkt_5tuple_internal, is_ip6, r_action,
                                  r_acl_pos_p, r_acl_match_p, r_rule_match_p, trace_bitmap);
+    } else if (dtree_lookup_is_ready(am, lc_index)) {
+      ret = dtree_multi_acl_match_5tuple(p_acl_main, lc_index, pkt_5tuple_internal, is_ip6, r_action,
+                                 r_acl_pos_p, r_acl_match_p, r_rule_match_p, trace_bitmap);
     } else {
       ret = hash_multi_acl_match_5tuple(p_acl_main, lc_index, pkt_5tuple_internal, is_ip6, r_action,
                                  r_acl_pos_p, r_acl_match_p, r_rule_match_p, trace_bitmap);
@@ -407,6 +407,189 @@ aclp_swap_wip_and_pending_session_change_requests (acl_main_t * am,
 }
 
 
+/*
+ * Called on the main thread with the workers stopped at the barrier:
+ * hand the changed rules and the affected interfaces to each worker
+ * which has sessions on any of them. The requests coalesce, and the
+ * walk restarts so the sessions already visited see the new rules.
+ */
+void
+aclp_post_reclassify_request (acl_main_t * am,
+			      uword ** sw_if_index_bitmap_by_is_input,
+			      acl_rule_t * changed_rules)
+{
+  acl_fa_per_worker_data_t *pw;
+  int is_input;
+
+  if (!am->fa_sessions_hash_is_initialized || 0 == vec_len (changed_rules))
+    return;
+
+  vec_foreach (pw, am->per_worker_data)
+  {
+    int is_affected = 0;
+    for (is_input = 0; is_input < 2; is_input++)
+      {
+	uword *affected;
+
+	/* and-ing two empty bitmaps is not safe */
+	if (clib_bitmap_is_zero (sw_if_index_bitmap_by_is_input[is_input]))
+	  continue;
+	affected =
+	  clib_bitmap_dup_and (sw_if_index_bitmap_by_is_input[is_input],
+			       pw->serviced_sw_if_index_bitmap);
+	if (!clib_bitmap_is_zero (affected))
+	  {
+	    pw->reclassify_sw_if_index_bitmap[is_input] =
+	      clib_bitmap_or (pw->reclassify_sw_if_index_bitmap[is_input],
+			      affected);
+	    is_affected = 1;
+	  }
+	clib_bitmap_free (affected);
+      }
+    if (!is_affected)
+      continue;
+
+    if (!pw->reclassify_all_sessions)
+      {
+	if (vec_len (pw->reclassify_rules) + vec_len (changed_rules) >
+	    am->reclassify_max_changed_rules)
+	  {
+	    /* too many to check one by one, just look them all up */
+	    vec_free (pw->reclassify_rules);
+	    pw->reclassify_all_sessions = 1;
+	  }
+	else
+	  vec_append (pw->reclassify_rules, changed_rules);
+      }
+    pw->reclassify_cursor = 0;
+    pw->reclassify_in_process = 1;
+    pw->cnt_reclassify_requests++;
+    send_one_worker_interrupt (am->vlib_main, am, pw - am->per_worker_data);
+  }
+}
+
+/*
+ * Look the session up again in the lookup context of its interface,
+ * the way its first packet would be. Return 1 if it must be deleted.
+ */
+static int
+acl_fa_reclassify_one_session (acl_main_t * am,
+			       acl_fa_per_worker_data_t * pw,
+			       fa_session_t * sess, int is_input)
+{
+  u32 *lc_index_by_sw_if_index = is_input ?
+    am->input_lc_index_by_sw_if_index : am->output_lc_index_by_sw_if_index;
+  fa_5tuple_t pkt_5tuple;
+  acl_rule_t *r;
+  u32 lc_index;
+  u8 action = 0;
+  u32 acl_pos, acl_match, rule_match, trace_bitmap;
+  int is_candidate = pw->reclassify_all_sessions;
+
+  if (sess->sw_if_index >= vec_len (lc_index_by_sw_if_index))
+    return 0;
+  lc_index = lc_index_by_sw_if_index[sess->sw_if_index];
+  /* no ACLs anymore - the interface cleanup takes care of the sessions */
+  if (~0 == lc_index)
+    return 0;
+
+  pkt_5tuple = sess->info;
+  pkt_5tuple.pkt.as_u64 = 0;
+  pkt_5tuple.pkt.is_ip6 = sess->is_ip6;
+  pkt_5tuple.pkt.l4_valid = 1;
+  if (IPPROTO_TCP == pkt_5tuple.l4.proto)
+    {
+      /*
+       * the flags of the packet which created the session: the flags
+       * seen over its lifetime would fail e.g. a SYN-only permit rule
+       */
+      pkt_5tuple.pkt.tcp_flags = sess->tcp_flags_initial;
+      pkt_5tuple.pkt.tcp_flags_valid = 1;
+    }
+
+  /*
+   * If none of the changed rules match, the first matching rule
+   * is the same as it was when the session was created.
+   */
+  if (!is_candidate)
+    vec_foreach (r, pw->reclassify_rules)
+    {
+      if (single_rule_match_5tuple (r, sess->is_ip6, &pkt_5tuple))
+	{
+	  is_candidate = 1;
+	  break;
+	}
+    }
+  if (!is_candidate)
+    return 0;
+
+  pw->cnt_reclassify_sessions_matched++;
+  acl_plugin_match_5tuple_inline (am, lc_index,
+				  (fa_5tuple_opaque_t *) & pkt_5tuple,
+				  sess->is_ip6, &action, &acl_pos, &acl_match,
+				  &rule_match, &trace_bitmap);
+  /* only permit+reflect creates the sessions */
+  return (2 != action);
+}
+
+/*
+ * Walk up to the budget of session pool slots. Return 1 if there
+ * is more work to do.
+ */
+static int
+acl_fa_reclassify_sessions (acl_main_t * am, u16 thread_index, u64 now)
+{
+  acl_fa_per_worker_data_t *pw = &am->per_worker_data[thread_index];
+  u32 n_slots = vec_len (pw->fa_sessions_pool);
+  u32 budget = am->reclassify_sessions_budget;
+
+  while (budget-- > 0 && pw->reclassify_cursor < n_slots)
+    {
+      u32 session_index = pw->reclassify_cursor++;
+      fa_session_t *sess;
+      int is_input;
+
+      if (pool_is_free_index (pw->fa_sessions_pool, session_index))
+	continue;
+      sess = pool_elt_at_index (pw->fa_sessions_pool, session_index);
+      if (sess->deleted)
+	continue;
+      is_input = (sess->info.l4.l4_flags & FA_SK_L4_FLAG_IS_INPUT) ? 1 : 0;
+      if (!clib_bitmap_get (pw->reclassify_sw_if_index_bitmap[is_input],
+			    sess->sw_if_index))
+	continue;
+
+      pw->cnt_reclassify_sessions_checked++;
+      if (acl_fa_reclassify_one_session (am, pw, sess, is_input))
+	{
+	  fa_full_session_id_t sess_id = {.session_index = session_index,
+	    .thread_index = thread_index
+	  };
+	  u32 sw_if_index = sess->sw_if_index;
+	  vec_validate (pw->fa_session_epoch_change_by_sw_if_index,
+			sw_if_index);
+	  vec_elt (pw->fa_session_epoch_change_by_sw_if_index, sw_if_index)++;
+	  if (acl_fa_conn_list_delete_session (am, sess_id, now))
+	    acl_fa_two_stage_delete_session (am, sw_if_index, sess_id, now);
+	  pw->cnt_reclassify_sessions_deleted++;
+	}
+    }
+
+  if (pw->reclassify_cursor < n_slots)
+    return 1;
+
+  elog_acl_maybe_trace_X1 (am,
+			   "acl_fa_reclassify_sessions: done, checked %lu sessions total",
+			   "i8", pw->cnt_reclassify_sessions_checked);
+  clib_bitmap_zero (pw->reclassify_sw_if_index_bitmap[0]);
+  clib_bitmap_zero (pw->reclassify_sw_if_index_bitmap[1]);
+  vec_reset_length (pw->reclassify_rules);
+  pw->reclassify_all_sessions = 0;
+  pw->reclassify_in_process = 0;
+  return 0;
+}
+
+
 static int
 purgatory_has_connections (vlib_main_t * vm, acl_main_t * am,
 			   int thread_index)
@@ -546,6 +729,12 @@ acl_fa_worker_conn_cleaner_process (vlib_main_t * vm,
 			       "i8i4i4", now, ((u32) pw->interrupt_is_needed),
 			       ((u32) pw->interrupt_is_unwanted));
     }
+  if (pw->reclassify_in_process
+      && acl_fa_reclassify_sessions (am, thread_index, now))
+    {
+      /* the policy changed under the sessions, keep going */
+      send_one_worker_interrupt (vm, am, thread_index);
+    }
   /* be persistent about quickly deleting the connections from the purgatory */
   if (purgatory_has_connections (vm, am, thread_index))
     {
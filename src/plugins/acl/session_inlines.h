@@ -551,6 +551,8 @@ acl_fa_add_session (acl_main_t * am, int is_input, int is_ip6,
   sess->last_active_time = now;
   sess->sw_if_index = sw_if_index;
   sess->tcp_flags_seen.as_u16 = 0;
+  /* the flags of the packet the ACL lookup matched, for reclassify */
+  sess->tcp_flags_initial = p5tuple->pkt.tcp_flags;
   sess->thread_index = thread_index;
   sess->link_list_id = ACL_TIMEOUT_UNUSED;
   sess->link_prev_idx = FA_SESSION_BOGUS_INDEX;
@@ -24,6 +24,18 @@
 
 #define AF_XDP_NUM_RX_QUEUES_ALL        ((u16)-1)
 
+/* multi-buffer (fragmented) packets support, Linux 6.6+ */
+#ifndef XDP_USE_SG
+#define XDP_USE_SG (1 << 4)
+#endif
+#ifndef XDP_PKT_CONTD
+#define XDP_PKT_CONTD (1 << 0)
+#endif
+
+/* max buffers of a multi-buffer packet: the Linux MAX_SKB_FRAGS fragments
+ * plus the head, the limit for both xdp frags on rx and af_xdp tx */
+#define AF_XDP_MAX_FRAGS (17 + 1)
+
 #define af_xdp_log(lvl, dev, f, ...) \
   vlib_log(lvl, af_xdp_main.log_class, "%v: " f, (dev)->name, ##__VA_ARGS__)
 
@@ -33,7 +45,9 @@
   _ (2, ADMIN_UP, "admin-up")                                                 \
   _ (3, LINK_UP, "link-up")                                                   \
   _ (4, ZEROCOPY, "zero-copy")                                                \
-  _ (5, SYSCALL_LOCK, "syscall-lock")
+  _ (5, SYSCALL_LOCK, "syscall-lock")                                         \
+  _ (6, MULTI_BUFFER, "multi-buffer")                                         \
+  _ (7, SHARED_UMEM, "shared-umem")
 
 enum
 {
@@ -119,7 +133,7 @@ typedef struct
 
   char *netns;
 
-  struct xsk_umem **umem;
+  struct xsk_umem **umem; /* 1 per queue, or a single one if shared */
   struct xsk_socket **xsk;
 
   struct bpf_object *bpf_obj;
@@ -148,6 +162,8 @@ typedef enum
 typedef enum
 {
   AF_XDP_CREATE_FLAGS_NO_SYSCALL_LOCK = 1,
+  AF_XDP_CREATE_FLAGS_MULTI_BUFFER = 2,
+  AF_XDP_CREATE_FLAGS_SHARED_UMEM = 4,
 } af_xdp_create_flag_t;
 
 typedef struct
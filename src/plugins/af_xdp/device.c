@@ -38,6 +38,10 @@
 #define XDP_UMEM_MIN_CHUNK_SIZE 2048
 #endif
 
+#ifndef BPF_F_XDP_HAS_FRAGS
+#define BPF_F_XDP_HAS_FRAGS (1U << 5)
+#endif
+
 af_xdp_main_t af_xdp_main;
 
 typedef struct
@@ -78,6 +82,25 @@ af_xdp_set_max_frame_size (vnet_main_t *vnm, vnet_hw_interface_t *hw,
 {
   af_xdp_main_t *am = &af_xdp_main;
   af_xdp_device_t *ad = vec_elt_at_index (am->devices, hw->dev_instance);
+  u32 max_frame_size;
+
+  /* with multi-buffer, frames larger than a buffer are received and sent as
+   * buffer chains, one umem chunk per fragment: the Linux netdev MTU is left
+   * to the Linux side */
+  if (ad->flags & AF_XDP_DEVICE_F_MULTI_BUFFER)
+    {
+      max_frame_size = AF_XDP_MAX_FRAGS *
+		       vlib_buffer_get_default_data_size (vlib_get_main ());
+      if (frame_size <= max_frame_size)
+	return 0;
+      af_xdp_log (VLIB_LOG_LEVEL_ERR, ad,
+		  "frame size %u above %u (%u fragments of %u bytes)",
+		  frame_size, max_frame_size, AF_XDP_MAX_FRAGS,
+		  vlib_buffer_get_default_data_size (vlib_get_main ()));
+      return vnet_error (VNET_ERR_INVALID_VALUE,
+			 "frame size above the max of %u", max_frame_size);
+    }
+
   af_xdp_log (VLIB_LOG_LEVEL_ERR, ad, "set mtu not supported yet");
   return vnet_error (VNET_ERR_UNSUPPORTED, 0);
 }
@@ -246,6 +269,9 @@ af_xdp_load_program (af_xdp_create_if_args_t * args, af_xdp_device_t * ad)
     goto err1;
 
   bpf_program__set_type (bpf_prog, BPF_PROG_TYPE_XDP);
+  if (ad->flags & AF_XDP_DEVICE_F_MULTI_BUFFER)
+    bpf_program__set_flags (bpf_prog, bpf_program__flags (bpf_prog) |
+					BPF_F_XDP_HAS_FRAGS);
 
   if (bpf_object__load (ad->bpf_obj))
     goto err1;
@@ -284,8 +310,11 @@ af_xdp_create_queue (vlib_main_t *vm, af_xdp_create_if_args_t *args,
   socklen_t optlen;
   const int is_rx = qid < ad->rxq_num;
   const int is_tx = qid < ad->txq_num;
+  const int is_shared = (ad->flags & AF_XDP_DEVICE_F_SHARED_UMEM) && qid > 0;
 
-  umem = vec_elt_at_index (ad->umem, qid);
+  /* when sharing the UMEM, it is registered once by queue 0 and every other
+   * queue binds to it with its own fill and completion rings */
+  umem = vec_elt_at_index (ad->umem, is_shared ? 0 : qid);
   xsk = vec_elt_at_index (ad->xsk, qid);
   rxq = vec_elt_at_index (ad->rxqs, qid);
   txq = vec_elt_at_index (ad->txqs, qid);
@@ -307,9 +336,10 @@ af_xdp_create_queue (vlib_main_t *vm, af_xdp_create_if_args_t *args,
     sizeof (vlib_buffer_t) + vlib_buffer_get_default_data_size (vm);
   umem_config.frame_headroom = sizeof (vlib_buffer_t);
   umem_config.flags = XDP_UMEM_UNALIGNED_CHUNK_FLAG;
-  if (xsk_umem__create
-      (umem, uword_to_pointer (vm->buffer_main->buffer_mem_start, void *),
-       vm->buffer_main->buffer_mem_size, fq, cq, &umem_config))
+  if (!is_shared &&
+      xsk_umem__create (
+	umem, uword_to_pointer (vm->buffer_main->buffer_mem_start, void *),
+	vm->buffer_main->buffer_mem_size, fq, cq, &umem_config))
     {
       uword sys_page_size = clib_mem_get_page_size ();
       args->rv = VNET_API_ERROR_SYSCALL_ERROR_1;
@@ -341,16 +371,24 @@ af_xdp_create_queue (vlib_main_t *vm, af_xdp_create_if_args_t *args,
       sock_config.bind_flags |= XDP_ZEROCOPY;
       break;
     }
+  if (ad->flags & AF_XDP_DEVICE_F_MULTI_BUFFER)
+    sock_config.bind_flags |= XDP_USE_SG;
   if (args->prog)
     sock_config.libbpf_flags = XSK_LIBBPF_FLAGS__INHIBIT_PROG_LOAD;
-  if (xsk_socket__create
-      (xsk, ad->linux_ifname, qid, *umem, rx, tx, &sock_config))
+  if (is_shared ? xsk_socket__create_shared (xsk, ad->linux_ifname, qid,
+					     *umem, rx, tx, fq, cq,
+					     &sock_config) :
+		  xsk_socket__create (xsk, ad->linux_ifname, qid, *umem, rx,
+				      tx, &sock_config))
     {
       args->rv = VNET_API_ERROR_SYSCALL_ERROR_2;
       args->error =
 	clib_error_return_unix (0,
 				"xsk_socket__create() failed (is linux netdev %s up?)",
 				ad->linux_ifname);
+      if (ad->flags & AF_XDP_DEVICE_F_MULTI_BUFFER)
+	args->error = clib_error_return (
+	  args->error, "(multi-buffer requires Linux 6.6 or later)");
       goto err1;
     }
 
@@ -416,9 +454,11 @@ af_xdp_create_queue (vlib_main_t *vm, af_xdp_create_if_args_t *args,
 err2:
   xsk_socket__delete (*xsk);
 err1:
-  xsk_umem__delete (*umem);
+  if (!is_shared)
+    xsk_umem__delete (*umem);
 err0:
-  *umem = 0;
+  if (!is_shared)
+    *umem = 0;
   *xsk = 0;
   return -1;
 }
@@ -634,6 +674,12 @@ af_xdp_create_if (vlib_main_t * vm, af_xdp_create_if_args_t * args)
       0 == (args->flags & AF_XDP_CREATE_FLAGS_NO_SYSCALL_LOCK))
     ad->flags |= AF_XDP_DEVICE_F_SYSCALL_LOCK;
 
+  if (args->flags & AF_XDP_CREATE_FLAGS_MULTI_BUFFER)
+    ad->flags |= AF_XDP_DEVICE_F_MULTI_BUFFER;
+
+  if (args->flags & AF_XDP_CREATE_FLAGS_SHARED_UMEM)
+    ad->flags |= AF_XDP_DEVICE_F_SHARED_UMEM;
+
   ad->linux_ifname = (char *) format (0, "%s", args->linux_ifname);
   vec_validate (ad->linux_ifname, IFNAMSIZ - 1);	/* libbpf expects ifname to be at least IFNAMSIZ */
 
@@ -658,7 +704,10 @@ af_xdp_create_if (vlib_main_t * vm, af_xdp_create_if_args_t * args)
   ad->rxq_num = rxq_num;
   ad->txq_num = txq_num;
 
-  vec_validate_aligned (ad->umem, q_num - 1, CLIB_CACHE_LINE_BYTES);
+  vec_validate_aligned (ad->umem,
+			(ad->flags & AF_XDP_DEVICE_F_SHARED_UMEM) ? 0 :
+								    q_num - 1,
+			CLIB_CACHE_LINE_BYTES);
   vec_validate_aligned (ad->xsk, q_num - 1, CLIB_CACHE_LINE_BYTES);
   vec_validate_aligned (ad->rxqs, q_num - 1, CLIB_CACHE_LINE_BYTES);
   vec_validate_aligned (ad->txqs, q_num - 1, CLIB_CACHE_LINE_BYTES);
@@ -678,7 +727,7 @@ af_xdp_create_if (vlib_main_t * vm, af_xdp_create_if_args_t * args)
 		      "create interface failed to create queue qid=%d", i);
 
 	  /* fixup vectors length */
-	  vec_set_len (ad->umem, i);
+	  vec_set_len (ad->umem, clib_min (i, vec_len (ad->umem)));
 	  vec_set_len (ad->xsk, i);
 	  vec_set_len (ad->rxqs, i);
 	  vec_set_len (ad->txqs, i);
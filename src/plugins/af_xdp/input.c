@@ -273,10 +273,57 @@ af_xdp_device_input_bufs (vlib_main_t *vm, const af_xdp_device_t *ad,
       n -= 1;
     }
 
-  xsk_ring_cons__release (&rxq->rx, n_rx);
   return bytes;
 }
 
+static_always_inline u32
+af_xdp_device_input_mb_complete (af_xdp_rxq_t *rxq, u32 n_rx, const u32 idx)
+{
+  /* only consume whole packets: the fragments of a trailing packet whose
+   * last descriptor is not available yet are left in the ring */
+  while (n_rx &&
+	 xsk_ring_cons__rx_desc (&rxq->rx, idx + n_rx - 1)->options &
+	   XDP_PKT_CONTD)
+    n_rx--;
+  return n_rx;
+}
+
+static_always_inline u32
+af_xdp_device_input_mb_chain (vlib_main_t *vm, af_xdp_rxq_t *rxq, u32 *bis,
+			      const u32 n_rx, u32 idx)
+{
+  const u32 mask = rxq->rx.mask;
+  u32 i = 0, n_pkts = 0;
+
+  /* fragments of a packet are chained onto the buffer of its 1st descriptor
+   * and buffer indices are compacted in place, so that bis[] only contains
+   * packet heads */
+  while (i < n_rx)
+    {
+      const struct xdp_desc *desc = xsk_ring_cons__rx_desc (&rxq->rx, idx);
+      vlib_buffer_t *hb = vlib_get_buffer (vm, bis[i]), *b = hb;
+
+      hb->total_length_not_including_first_buffer = 0;
+      hb->flags |= VLIB_BUFFER_TOTAL_LENGTH_VALID;
+      bis[n_pkts++] = bis[i++];
+      idx = (idx + 1) & mask;
+
+      while (desc->options & XDP_PKT_CONTD)
+	{
+	  ASSERT (i < n_rx);
+	  desc = xsk_ring_cons__rx_desc (&rxq->rx, idx);
+	  b->flags |= VLIB_BUFFER_NEXT_PRESENT;
+	  b->next_buffer = bis[i];
+	  b = vlib_get_buffer (vm, bis[i]);
+	  hb->total_length_not_including_first_buffer += b->current_length;
+	  i++;
+	  idx = (idx + 1) & mask;
+	}
+    }
+
+  return n_pkts;
+}
+
 static_always_inline uword
 af_xdp_device_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 			    vlib_frame_t *frame, af_xdp_device_t *ad, u16 qid)
@@ -285,10 +332,19 @@ af_xdp_device_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   af_xdp_rxq_t *rxq = vec_elt_at_index (ad->rxqs, qid);
   vlib_buffer_t bt;
   u32 next_index, *to_next, n_left_to_next;
-  u32 n_rx_packets, n_rx_bytes;
+  u32 n_rx_packets, n_rx_desc, n_rx_bytes;
   u32 idx;
 
-  n_rx_packets = xsk_ring_cons__peek (&rxq->rx, VLIB_FRAME_SIZE, &idx);
+  n_rx_desc = xsk_ring_cons__peek (&rxq->rx, VLIB_FRAME_SIZE, &idx);
+
+  if (PREDICT_FALSE (ad->flags & AF_XDP_DEVICE_F_MULTI_BUFFER) && n_rx_desc)
+    {
+      u32 n = af_xdp_device_input_mb_complete (rxq, n_rx_desc, idx);
+      xsk_ring_cons__cancel (&rxq->rx, n_rx_desc - n);
+      n_rx_desc = n;
+    }
+
+  n_rx_packets = n_rx_desc;
 
   if (PREDICT_FALSE (0 == n_rx_packets))
     goto refill;
@@ -301,7 +357,11 @@ af_xdp_device_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   vlib_get_new_next_frame (vm, node, next_index, to_next, n_left_to_next);
 
   n_rx_bytes =
-    af_xdp_device_input_bufs (vm, ad, rxq, to_next, n_rx_packets, &bt, idx);
+    af_xdp_device_input_bufs (vm, ad, rxq, to_next, n_rx_desc, &bt, idx);
+  if (PREDICT_FALSE (ad->flags & AF_XDP_DEVICE_F_MULTI_BUFFER))
+    n_rx_packets =
+      af_xdp_device_input_mb_chain (vm, rxq, to_next, n_rx_desc, idx);
+  xsk_ring_cons__release (&rxq->rx, n_rx_desc);
   af_xdp_device_input_ethernet (vm, node, next_index, ad->sw_if_index,
 				ad->hw_if_index);
 
@@ -235,6 +235,72 @@ wrap_around:
   return n_tx;
 }
 
+static_always_inline u32
+af_xdp_device_output_tx_try_mb (vlib_main_t *vm,
+				const vlib_node_runtime_t *node,
+				af_xdp_device_t *ad, af_xdp_txq_t *txq,
+				u32 n_tx, u32 *bi, u32 *n_desc_ret)
+{
+  const uword start = vm->buffer_main->buffer_mem_start;
+  u32 n_free = xsk_prod_nb_free (&txq->tx, n_tx);
+  u32 n_pkts, n_desc, idx, i;
+  struct xdp_desc *desc;
+
+  /* each buffer of a chain uses its own descriptor: count how many whole
+   * packets fit in the ring */
+  for (n_pkts = 0, n_desc = 0; n_pkts < n_tx; n_pkts++)
+    {
+      vlib_buffer_t *b = vlib_get_buffer (vm, bi[n_pkts]);
+      u32 n_segs = 1;
+      while (b->flags & VLIB_BUFFER_NEXT_PRESENT)
+	{
+	  b = vlib_get_buffer (vm, b->next_buffer);
+	  n_segs++;
+	}
+      if (n_desc + n_segs > n_free)
+	{
+	  n_free = xsk_prod_nb_free (&txq->tx, n_desc + n_segs);
+	  if (n_desc + n_segs > n_free)
+	    break;
+	}
+      n_desc += n_segs;
+    }
+
+  *n_desc_ret = n_desc;
+
+  /* if ring is full, do nothing */
+  if (PREDICT_FALSE (0 == n_desc))
+    return 0;
+
+  n_desc = xsk_ring_prod__reserve (&txq->tx, n_desc, &idx);
+  ASSERT (n_desc == *n_desc_ret);
+
+  for (i = 0; i < n_pkts; i++)
+    {
+      vlib_buffer_t *b = vlib_get_buffer (vm, bi[i]);
+      for (;;)
+	{
+	  const u32 flags = b->flags;
+	  const u32 next = b->next_buffer;
+	  desc = xsk_ring_prod__tx_desc (&txq->tx, idx++);
+	  desc->addr =
+	    ((sizeof (vlib_buffer_t) + b->current_data)
+	     << XSK_UNALIGNED_BUF_OFFSET_SHIFT) |
+	    (pointer_to_uword (b) - start);
+	  desc->len = b->current_length;
+	  desc->options = flags & VLIB_BUFFER_NEXT_PRESENT ? XDP_PKT_CONTD : 0;
+	  if (!(flags & VLIB_BUFFER_NEXT_PRESENT))
+	    break;
+	  /* every descriptor is completed separately: unchain the buffers so
+	   * that each one is freed on its own */
+	  b->flags &= ~VLIB_BUFFER_NEXT_PRESENT;
+	  b = vlib_get_buffer (vm, next);
+	}
+    }
+
+  return n_pkts;
+}
+
 VNET_DEVICE_CLASS_TX_FN (af_xdp_device_class) (vlib_main_t * vm,
 					       vlib_node_runtime_t * node,
 					       vlib_frame_t * frame)
@@ -246,7 +312,7 @@ VNET_DEVICE_CLASS_TX_FN (af_xdp_device_class) (vlib_main_t * vm,
   const int shared_queue = tf->shared_queue;
   af_xdp_txq_t *txq = vec_elt_at_index (ad->txqs, tf->queue_id);
   u32 *from;
-  u32 n, n_tx;
+  u32 n, n_tx, n_desc, n_desc_tot = 0;
   int i;
 
   from = vlib_frame_vector_args (frame);
@@ -259,12 +325,17 @@ VNET_DEVICE_CLASS_TX_FN (af_xdp_device_class) (vlib_main_t * vm,
     {
       u32 n_enq;
       af_xdp_device_output_free (vm, node, txq);
-      n_enq =
-	af_xdp_device_output_tx_try (vm, node, ad, txq, n_tx - n, from + n);
+      if (PREDICT_FALSE (ad->flags & AF_XDP_DEVICE_F_MULTI_BUFFER))
+	n_enq = af_xdp_device_output_tx_try_mb (vm, node, ad, txq, n_tx - n,
+						from + n, &n_desc);
+      else
+	n_enq = n_desc = af_xdp_device_output_tx_try (vm, node, ad, txq,
+						      n_tx - n, from + n);
       n += n_enq;
+      n_desc_tot += n_desc;
     }
 
-  af_xdp_device_output_tx_db (vm, node, ad, txq, n);
+  af_xdp_device_output_tx_db (vm, node, ad, txq, n_desc_tot);
 
   if (shared_queue)
     clib_spinlock_unlock (&txq->lock);
@@ -25,6 +25,10 @@ STATIC_ASSERT ((0 == (CRYPTO_SW_SCHEDULER_QUEUE_SIZE &
 		      (CRYPTO_SW_SCHEDULER_QUEUE_SIZE - 1))),
 	       "CRYPTO_SW_SCHEDULER_QUEUE_SIZE is not pow2");
 
+/* queue latency histogram, bucket n counts frames that waited
+ * [2^(n-1), 2^n) microseconds before being picked up, bucket 0 < 1us */
+#define CRYPTO_SW_SCHEDULER_N_LATENCY_BUCKETS 16
+
 typedef enum crypto_sw_scheduler_queue_type_t_
 {
   CRYPTO_SW_SCHED_QUEUE_TYPE_ENCRYPT = 0,
@@ -38,13 +42,14 @@ typedef struct
   u32 head;
   u32 tail;
   vnet_crypto_async_frame_t **jobs;
+  /* cpu time each job was enqueued at */
+  u64 *enqueue_time;
 } crypto_sw_scheduler_queue_t;
 
 typedef struct
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
   crypto_sw_scheduler_queue_t queue[CRYPTO_SW_SCHED_QUEUE_N_TYPES];
-  u32 last_serve_lcore_id;
   u8 last_serve_encrypt;
   u8 last_return_queue;
   vnet_crypto_op_t *crypto_ops;
@@ -53,11 +58,18 @@ typedef struct
   vnet_crypto_op_t *chained_integ_ops;
   vnet_crypto_op_chunk_t *chunks;
   u8 self_crypto_enabled;
+
+  /* frames processed by this thread, and how many of them were taken
+   * from another thread's queue */
+  u64 n_processed;
+  u64 n_stolen;
+  u64 queue_latency[CRYPTO_SW_SCHEDULER_N_LATENCY_BUCKETS];
 } crypto_sw_scheduler_per_thread_data_t;
 
 typedef struct
 {
   u32 crypto_engine_index;
+  f64 us_per_cpu_clock;
   crypto_sw_scheduler_per_thread_data_t *per_thread_data;
   vnet_crypto_key_t *keys;
 } crypto_sw_scheduler_main_t;
@@ -94,6 +94,8 @@ crypto_sw_scheduler_frame_enqueue (vlib_main_t *vm,
     }
 
   current_queue->jobs[head & CRYPTO_SW_SCHEDULER_QUEUE_MASK] = frame;
+  current_queue->enqueue_time[head & CRYPTO_SW_SCHEDULER_QUEUE_MASK] =
+    clib_cpu_time_now ();
   head += 1;
   CLIB_MEMORY_STORE_BARRIER ();
   current_queue->head = head;
@@ -446,79 +448,158 @@ crypto_sw_scheduler_process_aead (vlib_main_t *vm,
       return -1;
     }
 
+    /* claim the oldest pending frame of the queue */
     static_always_inline vnet_crypto_async_frame_t *
-    crypto_sw_scheduler_dequeue (vlib_main_t *vm, u32 *nb_elts_processed,
-				 u32 *enqueue_thread_idx)
+    crypto_sw_scheduler_claim (crypto_sw_scheduler_queue_t *q,
+			       u64 *enqueue_time)
     {
-      crypto_sw_scheduler_main_t *cm = &crypto_sw_scheduler_main;
-      crypto_sw_scheduler_per_thread_data_t *ptd =
-	cm->per_thread_data + vm->thread_index;
-      vnet_crypto_async_frame_t *f = 0;
-      crypto_sw_scheduler_queue_t *current_queue = 0;
-      u32 tail, head;
-      u8 found = 0;
+      vnet_crypto_async_frame_t *f;
+      u32 tail = q->tail;
+      u32 head = q->head;
+      u32 j;
+
+      /* Skip this queue unless tail < head or head has overflowed
+       * and tail has not. At the point where tail overflows (== 0),
+       * the largest possible value of head is (queue size - 1).
+       * Prior to that, the largest possible value of head is
+       * (queue size - 2).
+       */
+      if ((tail > head) && (head >= CRYPTO_SW_SCHEDULER_QUEUE_MASK))
+	return 0;
 
-      /* get a pending frame to process */
-      if (ptd->self_crypto_enabled)
+      for (j = tail; j != head; j++)
 	{
-	  u32 i = ptd->last_serve_lcore_id + 1;
+	  f = q->jobs[j & CRYPTO_SW_SCHEDULER_QUEUE_MASK];
 
-	  while (1)
-	    {
-	      crypto_sw_scheduler_per_thread_data_t *st;
-	      u32 j;
+	  if (!f)
+	    continue;
 
-	      if (i >= vec_len (cm->per_thread_data))
-		i = 0;
+	  if (clib_atomic_bool_cmp_and_swap (
+		&f->state, VNET_CRYPTO_FRAME_STATE_PENDING,
+		VNET_CRYPTO_FRAME_STATE_WORK_IN_PROGRESS))
+	    {
+	      *enqueue_time = q->enqueue_time[j & CRYPTO_SW_SCHEDULER_QUEUE_MASK];
+	      return f;
+	    }
+	}
 
-	      st = cm->per_thread_data + i;
+      return 0;
+    }
 
-	      if (ptd->last_serve_encrypt)
-		current_queue = &st->queue[CRYPTO_SW_SCHED_QUEUE_TYPE_DECRYPT];
-	      else
-		current_queue = &st->queue[CRYPTO_SW_SCHED_QUEUE_TYPE_ENCRYPT];
+    /* number of frames in the queue still waiting to be claimed */
+    static_always_inline u32
+    crypto_sw_scheduler_queue_pending (crypto_sw_scheduler_queue_t *q)
+    {
+      vnet_crypto_async_frame_t *f;
+      u32 tail = q->tail;
+      u32 head = q->head;
+      u32 j, n = 0;
 
-	      tail = current_queue->tail;
-	      head = current_queue->head;
+      if ((tail > head) && (head >= CRYPTO_SW_SCHEDULER_QUEUE_MASK))
+	return 0;
 
-	      /* Skip this queue unless tail < head or head has overflowed
-	       * and tail has not. At the point where tail overflows (== 0),
-	       * the largest possible value of head is (queue size - 1).
-	       * Prior to that, the largest possible value of head is
-	       * (queue size - 2).
-	       */
-	      if ((tail > head) && (head >= CRYPTO_SW_SCHEDULER_QUEUE_MASK))
-		goto skip_queue;
+      for (j = tail; j != head; j++)
+	{
+	  f = q->jobs[j & CRYPTO_SW_SCHEDULER_QUEUE_MASK];
+	  n += f && f->state == VNET_CRYPTO_FRAME_STATE_PENDING;
+	}
 
-	      for (j = tail; j != head; j++)
-		{
+      return n;
+    }
 
-		  f = current_queue->jobs[j & CRYPTO_SW_SCHEDULER_QUEUE_MASK];
+    /*
+     * Take work from the other threads when our own queue is empty:
+     * from the most loaded queue on our numa node first, then from the
+     * most loaded remote one.
+     */
+    static_always_inline vnet_crypto_async_frame_t *
+    crypto_sw_scheduler_steal (vlib_main_t *vm, crypto_sw_scheduler_main_t *cm,
+			       crypto_sw_scheduler_queue_type_t qt,
+			       u64 *enqueue_time)
+    {
+      crypto_sw_scheduler_queue_t *local = 0, *remote = 0, *q;
+      u32 local_depth = 0, remote_depth = 0, depth, i;
+      vnet_crypto_async_frame_t *f = 0;
 
-		  if (!f)
-		    continue;
+      for (i = 0; i < vec_len (cm->per_thread_data); i++)
+	{
+	  if (i == vm->thread_index)
+	    continue;
 
-		  if (clib_atomic_bool_cmp_and_swap (
-			&f->state, VNET_CRYPTO_FRAME_STATE_PENDING,
-			VNET_CRYPTO_FRAME_STATE_WORK_IN_PROGRESS))
-		    {
-		      found = 1;
-		      break;
-		    }
-		}
+	  q = &cm->per_thread_data[i].queue[qt];
+	  depth = crypto_sw_scheduler_queue_pending (q);
 
-	    skip_queue:
-	      if (found || i == ptd->last_serve_lcore_id)
+	  if (vlib_get_main_by_index (i)->numa_node == vm->numa_node)
+	    {
+	      if (depth > local_depth)
 		{
-		  CLIB_MEMORY_STORE_BARRIER ();
-		  ptd->last_serve_encrypt = !ptd->last_serve_encrypt;
-		  break;
+		  local_depth = depth;
+		  local = q;
 		}
-
-	      i++;
 	    }
+	  else if (depth > remote_depth)
+	    {
+	      remote_depth = depth;
+	      remote = q;
+	    }
+	}
+
+      if (local)
+	f = crypto_sw_scheduler_claim (local, enqueue_time);
+      if (!f && remote)
+	f = crypto_sw_scheduler_claim (remote, enqueue_time);
+
+      return f;
+    }
+
+    static_always_inline void
+    crypto_sw_scheduler_account (crypto_sw_scheduler_main_t *cm,
+				 crypto_sw_scheduler_per_thread_data_t *ptd,
+				 vnet_crypto_async_frame_t *f, u64 enqueue_time,
+				 u32 thread_index)
+    {
+      u64 us = (clib_cpu_time_now () - enqueue_time) * cm->us_per_cpu_clock;
+      u32 bucket = us ? 1 + min_log2 (us) : 0;
 
-	  ptd->last_serve_lcore_id = i;
+      bucket = clib_min (bucket, CRYPTO_SW_SCHEDULER_N_LATENCY_BUCKETS - 1);
+      ptd->queue_latency[bucket]++;
+      ptd->n_processed++;
+      ptd->n_stolen += f->enqueue_thread_index != thread_index;
+    }
+
+    static_always_inline vnet_crypto_async_frame_t *
+    crypto_sw_scheduler_dequeue (vlib_main_t *vm, u32 *nb_elts_processed,
+				 u32 *enqueue_thread_idx)
+    {
+      crypto_sw_scheduler_main_t *cm = &crypto_sw_scheduler_main;
+      crypto_sw_scheduler_per_thread_data_t *ptd =
+	cm->per_thread_data + vm->thread_index;
+      vnet_crypto_async_frame_t *f = 0;
+      crypto_sw_scheduler_queue_t *current_queue = 0;
+      u32 tail;
+      u64 enqueue_time = 0;
+      u8 found = 0;
+
+      /* get a pending frame to process, our own first */
+      if (ptd->self_crypto_enabled)
+	{
+	  crypto_sw_scheduler_queue_type_t qt =
+	    ptd->last_serve_encrypt ? CRYPTO_SW_SCHED_QUEUE_TYPE_DECRYPT :
+				      CRYPTO_SW_SCHED_QUEUE_TYPE_ENCRYPT;
+
+	  f = crypto_sw_scheduler_claim (&ptd->queue[qt], &enqueue_time);
+	  if (!f)
+	    f = crypto_sw_scheduler_steal (vm, cm, qt, &enqueue_time);
+
+	  CLIB_MEMORY_STORE_BARRIER ();
+	  ptd->last_serve_encrypt = !ptd->last_serve_encrypt;
+
+	  if (f)
+	    {
+	      found = 1;
+	      crypto_sw_scheduler_account (cm, ptd, f, enqueue_time,
+					   vm->thread_index);
+	    }
 	}
 
       if (found)
@@ -642,15 +723,23 @@ sw_scheduler_show_workers (vlib_main_t * vm, unformat_input_t * input,
 			   vlib_cli_command_t * cmd)
 {
   crypto_sw_scheduler_main_t *cm = &crypto_sw_scheduler_main;
+  crypto_sw_scheduler_per_thread_data_t *ptd;
   u32 i;
 
-  vlib_cli_output (vm, "%-7s%-20s%-8s", "ID", "Name", "Crypto");
+  vlib_cli_output (vm, "%-7s%-20s%-8s%-12s%-12s%-8s%-8s", "ID", "Name",
+		   "Crypto", "Processed", "Stolen", "Enc-q", "Dec-q");
   for (i = 1; i < vlib_thread_main.n_vlib_mains; i++)
     {
-      vlib_cli_output (vm, "%-7d%-20s%-8s", vlib_get_worker_index (i),
-		       (vlib_worker_threads + i)->name,
-		       cm->
-		       per_thread_data[i].self_crypto_enabled ? "on" : "off");
+      ptd = cm->per_thread_data + i;
+      vlib_cli_output (
+	vm, "%-7d%-20s%-8s%-12lu%-12lu%-8u%-8u", vlib_get_worker_index (i),
+	(vlib_worker_threads + i)->name,
+	ptd->self_crypto_enabled ? "on" : "off", ptd->n_processed,
+	ptd->n_stolen,
+	crypto_sw_scheduler_queue_pending (
+	  &ptd->queue[CRYPTO_SW_SCHED_QUEUE_TYPE_ENCRYPT]),
+	crypto_sw_scheduler_queue_pending (
+	  &ptd->queue[CRYPTO_SW_SCHED_QUEUE_TYPE_DECRYPT]));
     }
 
   return 0;
@@ -673,6 +762,79 @@ VLIB_CLI_COMMAND (cmd_show_sw_scheduler_workers, static) = {
 };
 /* *INDENT-ON* */
 
+static clib_error_t *
+sw_scheduler_show_latency (vlib_main_t *vm, unformat_input_t *input,
+			   vlib_cli_command_t *cmd)
+{
+  crypto_sw_scheduler_main_t *cm = &crypto_sw_scheduler_main;
+  crypto_sw_scheduler_per_thread_data_t *ptd;
+  u32 i, j;
+
+  vec_foreach_index (i, cm->per_thread_data)
+    {
+      ptd = cm->per_thread_data + i;
+      if (!ptd->n_processed)
+	continue;
+
+      vlib_cli_output (vm, "%s: %lu frames", (vlib_worker_threads + i)->name,
+		       ptd->n_processed);
+      for (j = 0; j < CRYPTO_SW_SCHEDULER_N_LATENCY_BUCKETS; j++)
+	{
+	  if (!ptd->queue_latency[j])
+	    continue;
+	  if (j == 0)
+	    vlib_cli_output (vm, "  %10s us %lu", "< 1", ptd->queue_latency[j]);
+	  else if (j == CRYPTO_SW_SCHEDULER_N_LATENCY_BUCKETS - 1)
+	    vlib_cli_output (vm, "  >= %7u us %lu", 1 << (j - 1),
+			     ptd->queue_latency[j]);
+	  else
+	    vlib_cli_output (vm, "  %5u-%-5u us %lu", 1 << (j - 1), 1 << j,
+			     ptd->queue_latency[j]);
+	}
+    }
+
+  return 0;
+}
+
+/*?
+ * This command displays how long frames waited in the sw_scheduler
+ * queues before a thread picked them up.
+ *
+ * @cliexpar
+ * Example of how to show the queue latency:
+ * @cliexstart{show sw_scheduler latency}
+ * @cliexend
+?*/
+VLIB_CLI_COMMAND (cmd_show_sw_scheduler_latency, static) = {
+  .path = "show sw_scheduler latency",
+  .short_help = "show sw_scheduler latency",
+  .function = sw_scheduler_show_latency,
+  .is_mp_safe = 1,
+};
+
+static clib_error_t *
+sw_scheduler_clear_counters (vlib_main_t *vm, unformat_input_t *input,
+			     vlib_cli_command_t *cmd)
+{
+  crypto_sw_scheduler_main_t *cm = &crypto_sw_scheduler_main;
+  crypto_sw_scheduler_per_thread_data_t *ptd;
+
+  vec_foreach (ptd, cm->per_thread_data)
+    {
+      ptd->n_processed = 0;
+      ptd->n_stolen = 0;
+      clib_memset (ptd->queue_latency, 0, sizeof (ptd->queue_latency));
+    }
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (cmd_clear_sw_scheduler_counters, static) = {
+  .path = "clear sw_scheduler counters",
+  .short_help = "clear sw_scheduler counters",
+  .function = sw_scheduler_clear_counters,
+};
+
 clib_error_t *
 sw_scheduler_cli_init (vlib_main_t * vm)
 {
@@ -693,6 +855,8 @@ crypto_sw_scheduler_init (vlib_main_t * vm)
   vec_validate_aligned (cm->per_thread_data, tm->n_vlib_mains - 1,
 			CLIB_CACHE_LINE_BYTES);
 
+  cm->us_per_cpu_clock = 1e6 * vm->clib_time.seconds_per_clock;
+
   vec_foreach (ptd, cm->per_thread_data)
   {
     ptd->self_crypto_enabled = 1;
@@ -703,6 +867,9 @@ crypto_sw_scheduler_init (vlib_main_t * vm)
     vec_validate_aligned (ptd->queue[CRYPTO_SW_SCHED_QUEUE_TYPE_DECRYPT].jobs,
 			  CRYPTO_SW_SCHEDULER_QUEUE_SIZE - 1,
 			  CLIB_CACHE_LINE_BYTES);
+    vec_validate_aligned (
+      ptd->queue[CRYPTO_SW_SCHED_QUEUE_TYPE_DECRYPT].enqueue_time,
+      CRYPTO_SW_SCHEDULER_QUEUE_SIZE - 1, CLIB_CACHE_LINE_BYTES);
 
     ptd->queue[CRYPTO_SW_SCHED_QUEUE_TYPE_ENCRYPT].head = 0;
     ptd->queue[CRYPTO_SW_SCHED_QUEUE_TYPE_ENCRYPT].tail = 0;
@@ -713,6 +880,9 @@ crypto_sw_scheduler_init (vlib_main_t * vm)
     vec_validate_aligned (ptd->queue[CRYPTO_SW_SCHED_QUEUE_TYPE_ENCRYPT].jobs,
 			  CRYPTO_SW_SCHEDULER_QUEUE_SIZE - 1,
 			  CLIB_CACHE_LINE_BYTES);
+    vec_validate_aligned (
+      ptd->queue[CRYPTO_SW_SCHED_QUEUE_TYPE_ENCRYPT].enqueue_time,
+      CRYPTO_SW_SCHEDULER_QUEUE_SIZE - 1, CLIB_CACHE_LINE_BYTES);
   }
 
   cm->crypto_engine_index =
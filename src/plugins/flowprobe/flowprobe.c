@@ -465,24 +465,22 @@ flowprobe_create_state_tables (u32 active_timer)
   /* Decide how many worker threads we have */
   num_threads = 1 /* main thread */  + tm->n_threads;
 
-  /* Hash table per worker */
-  fm->ht_log2len = FLOWPROBE_LOG2_HASHSIZE;
+  vec_validate (fm->export_pending_per_worker, num_threads - 1);
 
   /* Init per worker flow state and timer wheels */
   if (active_timer)
     {
       vec_validate (fm->timers_per_worker, num_threads - 1);
       vec_validate (fm->expired_passive_per_worker, num_threads - 1);
-      vec_validate (fm->hash_per_worker, num_threads - 1);
+      vec_validate (fm->flow_cache_per_worker, num_threads - 1);
       vec_validate (fm->pool_per_worker, num_threads - 1);
 
       for (i = 0; i < num_threads; i++)
 	{
-	  int j;
-	  pool_alloc (fm->pool_per_worker[i], 1 << fm->ht_log2len);
-	  vec_resize (fm->hash_per_worker[i], 1 << fm->ht_log2len);
-	  for (j = 0; j < (1 << fm->ht_log2len); j++)
-	    fm->hash_per_worker[i][j] = ~0;
+	  pool_alloc (fm->pool_per_worker[i], fm->flow_cache_buckets);
+	  clib_bihash_init_8_8 (&fm->flow_cache_per_worker[i],
+				"flowprobe flow cache", fm->flow_cache_buckets,
+				fm->flow_cache_memory);
 	  fm->timers_per_worker[i] =
 	    clib_mem_alloc (sizeof (TWT (tw_timer_wheel)));
 	  tw_timer_wheel_init_2t_1w_2048sl (fm->timers_per_worker[i],
@@ -888,6 +886,27 @@ flowprobe_params (flowprobe_main_t * fm, u8 record_l2,
   return 0;
 }
 
+static int
+flowprobe_set_sampling (flowprobe_main_t *fm, u32 sampling_rate,
+			bool is_random)
+{
+  vlib_thread_main_t *tm = &vlib_thread_main;
+  u32 i;
+
+  if (sampling_rate == 0)
+    sampling_rate = 1;
+
+  fm->sampling_rate = sampling_rate;
+  fm->sampling_random = is_random;
+
+  /* Restart the deterministic samplers, the workers pick this up on their
+   * next packet */
+  for (i = 0; i < 1 + tm->n_threads; i++)
+    fm->sampler_per_worker[i].countdown = 0;
+
+  return 0;
+}
+
 void
 vl_api_flowprobe_params_t_handler (vl_api_flowprobe_params_t * mp)
 {
@@ -940,6 +959,19 @@ out:
   REPLY_MACRO (VL_API_FLOWPROBE_SET_PARAMS_REPLY);
 }
 
+void
+vl_api_flowprobe_set_sampling_t_handler (vl_api_flowprobe_set_sampling_t *mp)
+{
+  flowprobe_main_t *fm = &flowprobe_main;
+  vl_api_flowprobe_set_sampling_reply_t *rmp;
+  int rv;
+
+  rv = flowprobe_set_sampling (fm, clib_net_to_host_u32 (mp->sampling_rate),
+			       mp->is_random);
+
+  REPLY_MACRO (VL_API_FLOWPROBE_SET_SAMPLING_REPLY);
+}
+
 void
 vl_api_flowprobe_get_params_t_handler (vl_api_flowprobe_get_params_t *mp)
 {
@@ -961,6 +993,8 @@ vl_api_flowprobe_get_params_t_handler (vl_api_flowprobe_get_params_t *mp)
     rmp->record_flags = record_flags;
     rmp->active_timer = htonl (fm->active_timer);
     rmp->passive_timer = htonl (fm->passive_timer);
+    rmp->sampling_rate = htonl (fm->sampling_rate);
+    rmp->sampling_random = fm->sampling_random;
   }));
   // clang-format on
 }
@@ -1076,13 +1110,16 @@ flowprobe_show_stats_fn (vlib_main_t * vm,
 
   vlib_cli_output (vm, "IPFIX table statistics");
   vlib_cli_output (vm, "Flow entry size: %d\n", sizeof (flowprobe_entry_t));
-  vlib_cli_output (vm, "Flow pool size per thread: %d\n",
-		   0x1 << FLOWPROBE_LOG2_HASHSIZE);
+  vlib_cli_output (vm, "Flow cache buckets per thread: %d\n",
+		   fm->flow_cache_buckets);
 
   for (i = 0; i < vec_len (fm->pool_per_worker); i++)
-    vlib_cli_output (vm, "Pool utilisation thread %d is %d%%\n", i,
-		     (100 * pool_elts (fm->pool_per_worker[i])) /
-		     (0x1 << FLOWPROBE_LOG2_HASHSIZE));
+    {
+      vlib_cli_output (vm, "Flows on thread %d: %d\n", i,
+		       pool_elts (fm->pool_per_worker[i]));
+      vlib_cli_output (vm, "%U", format_bihash_8_8,
+		       &fm->flow_cache_per_worker[i], 0 /* verbose */);
+    }
   return 0;
 }
 
@@ -1191,6 +1228,34 @@ flowprobe_show_feature_command_fn (vlib_main_t * vm,
   return 0;
 }
 
+static clib_error_t *
+flowprobe_sampling_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			       vlib_cli_command_t *cmd)
+{
+  flowprobe_main_t *fm = &flowprobe_main;
+  u32 sampling_rate = ~0;
+  bool is_random = false;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "%u", &sampling_rate))
+	;
+      else if (unformat (input, "random"))
+	is_random = true;
+      else if (unformat (input, "deterministic"))
+	is_random = false;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  if (sampling_rate == ~0)
+    return clib_error_return (0, "Please specify the sampling rate...");
+
+  flowprobe_set_sampling (fm, sampling_rate, is_random);
+  return 0;
+}
+
 static clib_error_t *
 flowprobe_params_command_fn (vlib_main_t * vm,
 			     unformat_input_t * input,
@@ -1246,6 +1311,9 @@ flowprobe_show_params_command_fn (vlib_main_t * vm,
 
   vlib_cli_output (vm, "%U", format_flowprobe_params, flags, active_timer,
 		   passive_timer);
+  if (fm->sampling_rate > 1)
+    vlib_cli_output (vm, " sampling: 1:%u %s", fm->sampling_rate,
+		     fm->sampling_random ? "random" : "deterministic");
   return 0;
 }
 
@@ -1277,6 +1345,12 @@ VLIB_CLI_COMMAND (flowprobe_params_command, static) = {
   .function = flowprobe_params_command_fn,
 };
 
+VLIB_CLI_COMMAND (flowprobe_sampling_command, static) = {
+  .path = "flowprobe sampling",
+  .short_help = "flowprobe sampling <rate> [random|deterministic]",
+  .function = flowprobe_sampling_command_fn,
+};
+
 VLIB_CLI_COMMAND (flowprobe_show_feature_command, static) = {
     .path = "show flowprobe feature",
     .short_help =
@@ -1344,8 +1418,8 @@ timer_process (vlib_main_t * vm, vlib_node_runtime_t * rt, vlib_frame_t * f)
 	    {
 	      vlib_node_set_interrupt_pending (worker_vm,
 					       flowprobe_walker_node.index);
-	      sleep_duration =
-		(fm->expired_passive_per_worker[i] > 0) ? 1e-4 : 0.1;
+	      if (vec_len (fm->expired_passive_per_worker[i]) > 0)
+		sleep_duration = 1e-4;
 	    }
 	}
       vlib_process_suspend (vm, sleep_duration);
@@ -1402,14 +1476,43 @@ flowprobe_init (vlib_main_t * vm)
 		    num_threads - 1);
     }
 
+  vec_validate_aligned (fm->sampler_per_worker, num_threads - 1,
+			CLIB_CACHE_LINE_BYTES);
+  for (i = 0; i < num_threads; i++)
+    fm->sampler_per_worker[i].seed = random_default_seed () + i;
+
   fm->active_timer = FLOWPROBE_TIMER_ACTIVE;
   fm->passive_timer = FLOWPROBE_TIMER_PASSIVE;
+  fm->sampling_rate = 1;
+  fm->flow_cache_buckets = FLOWPROBE_CACHE_NUM_BUCKETS;
+  fm->flow_cache_memory = FLOWPROBE_CACHE_MEMORY_SIZE;
 
   return error;
 }
 
 VLIB_INIT_FUNCTION (flowprobe_init);
 
+static clib_error_t *
+flowprobe_config (vlib_main_t *vm, unformat_input_t *input)
+{
+  flowprobe_main_t *fm = &flowprobe_main;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "flow-cache-buckets %u", &fm->flow_cache_buckets))
+	;
+      else if (unformat (input, "flow-cache-memory %U", unformat_memory_size,
+			 &fm->flow_cache_memory))
+	;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+  return 0;
+}
+
+VLIB_CONFIG_FUNCTION (flowprobe_config, "flowprobe");
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
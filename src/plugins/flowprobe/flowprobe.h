@@ -26,11 +26,15 @@
 #include <vnet/ipfix-export/flow_report.h>
 #include <vnet/ipfix-export/flow_report_classify.h>
 #include <vppinfra/tw_timer_2t_1w_2048sl.h>
+#include <vppinfra/bihash_8_8.h>
 
 /* Default timers in seconds */
 #define FLOWPROBE_TIMER_ACTIVE   (15)
 #define FLOWPROBE_TIMER_PASSIVE  120	// XXXX: FOR TESTING (30*60)
-#define FLOWPROBE_LOG2_HASHSIZE  (18)
+
+/* Default per worker flow cache sizing */
+#define FLOWPROBE_CACHE_NUM_BUCKETS (64 << 10)
+#define FLOWPROBE_CACHE_MEMORY_SIZE (32 << 20)
 
 typedef enum
 {
@@ -121,6 +125,16 @@ typedef struct
   } prot;
 } flowprobe_entry_t;
 
+/** Per CPU packet sampling state */
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  /** packets left to skip before the next deterministic sample */
+  u32 countdown;
+  /** seed for random sampling */
+  u32 seed;
+} flowprobe_sampler_t;
+
 /**
  * @file
  * @brief flow-per-packet plugin header file
@@ -138,14 +152,22 @@ typedef struct
   u64 nanosecond_time_0;
   f64 vlib_time_0;
 
-  /** Per CPU flow-state */
-  u8 ht_log2len;		/* Hash table size is 2^log2len */
-  u32 **hash_per_worker;
+  /** Per CPU flow-state, the cache maps a flow key digest to a pool index */
+  clib_bihash_8_8_t *flow_cache_per_worker;
+  u32 flow_cache_buckets;
+  uword flow_cache_memory;
   flowprobe_entry_t **pool_per_worker;
   /* *INDENT-OFF* */
   TWT (tw_timer_wheel) ** timers_per_worker;
   /* *INDENT-ON* */
   u32 **expired_passive_per_worker;
+  /** Flows due for an active timer export, sent once per frame */
+  u32 **export_pending_per_worker;
+  flowprobe_sampler_t *sampler_per_worker;
+
+  /** Meter one packet out of sampling_rate, 1 meters all of them */
+  u32 sampling_rate;
+  bool sampling_random;
 
   flowprobe_record_t record;
   u32 active_timer;
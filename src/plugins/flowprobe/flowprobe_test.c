@@ -322,6 +322,39 @@ api_flowprobe_set_params (vat_main_t *vam)
   return ret;
 }
 
+static int
+api_flowprobe_set_sampling (vat_main_t *vam)
+{
+  unformat_input_t *i = vam->input;
+  vl_api_flowprobe_set_sampling_t *mp;
+  u32 sampling_rate = 1;
+  u8 is_random = 0;
+  int ret;
+
+  while (unformat_check_input (i) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (i, "%u", &sampling_rate))
+	;
+      else if (unformat (i, "random"))
+	is_random = 1;
+      else
+	break;
+    }
+
+  /* Construct the API message */
+  M (FLOWPROBE_SET_SAMPLING, mp);
+  mp->sampling_rate = ntohl (sampling_rate);
+  mp->is_random = is_random;
+
+  /* send it... */
+  S (mp);
+
+  /* Wait for a reply... */
+  W (ret);
+
+  return ret;
+}
+
 static int
 api_flowprobe_get_params (vat_main_t *vam)
 {
@@ -357,6 +390,9 @@ vl_api_flowprobe_get_params_reply_t_handler (
   if (mp->record_flags & FLOWPROBE_RECORD_FLAG_L4)
     out = format (out, " l4");
 
+  out = format (out, ", sampling: 1:%u%s", ntohl (mp->sampling_rate),
+		mp->sampling_random ? " random" : "");
+
   out = format (out, "\n%c", 0);
   fformat (vam->ofp, (char *) out);
   vec_free (out);
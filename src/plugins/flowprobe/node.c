@@ -17,7 +17,6 @@
 #include <vlib/vlib.h>
 #include <vnet/vnet.h>
 #include <vppinfra/crc32.h>
-#include <vppinfra/xxhash.h>
 #include <vppinfra/error.h>
 #include <flowprobe/flowprobe.h>
 #include <vnet/ip/ip6_packet.h>
@@ -106,12 +105,13 @@ vlib_node_registration_t flowprobe_output_ip4_node;
 vlib_node_registration_t flowprobe_output_ip6_node;
 vlib_node_registration_t flowprobe_output_l2_node;
 
-/* No counters at the moment */
 #define foreach_flowprobe_error			\
 _(COLLISION, "Hash table collisions")		\
 _(BUFFER, "Buffer allocation error")		\
 _(EXPORTED_PACKETS, "Exported packets")		\
-_(INPATH, "Exported packets in path")
+_(INPATH, "Exported packets in path")		\
+_(NOT_SAMPLED, "Packets not sampled")		\
+_(CACHE_FULL, "Flow cache full")
 
 typedef enum
 {
@@ -292,68 +292,75 @@ flowprobe_l4_add (vlib_buffer_t * to_b, flowprobe_entry_t * e, u16 offset)
   return offset - start;
 }
 
-static inline u32
+/*
+ * The flow key does not fit any bihash key size, the cache is keyed on a
+ * 64 bit digest of it instead. The two halves are CRCs of the key words
+ * taken in opposite orders, so that flows differing only by swapped
+ * fields (e.g. both directions of a connection) don't collide. The full
+ * key is still compared on a hit.
+ */
+static inline u64
 flowprobe_hash (flowprobe_key_t * k)
 {
-  flowprobe_main_t *fm = &flowprobe_main;
-  u32 h = 0;
-
 #ifdef clib_crc32c_uses_intrinsics
-  h = clib_crc32c ((u8 *) k, sizeof (*k));
-#else
-  int i;
-  u64 tmp = 0;
-  for (i = 0; i < sizeof (*k) / 8; i++)
-    tmp ^= ((u64 *) k)[i];
+  u64 *w = (u64 *) k;
+  u32 lo = 0, hi = 0;
+  int i, n = sizeof (*k) / sizeof (u64);
 
-  h = clib_xxhash (tmp);
-#endif
+  for (i = 0; i < n; i++)
+    {
+      lo = clib_crc32c_u64 (lo, w[i]);
+      hi = clib_crc32c_u64 (hi, w[n - 1 - i]);
+    }
 
-  return h >> (32 - fm->ht_log2len);
+  return (u64) hi << 32 | lo;
+#else
+  return hash_memory (k, sizeof (*k), 0);
+#endif
 }
 
 flowprobe_entry_t *
-flowprobe_lookup (u32 my_cpu_number, flowprobe_key_t * k, u32 * poolindex,
-		  bool * collision)
+flowprobe_lookup (u32 my_cpu_number, flowprobe_key_t * k, u64 hash,
+		  u32 * poolindex, bool * collision)
 {
   flowprobe_main_t *fm = &flowprobe_main;
   flowprobe_entry_t *e;
-  u32 h;
+  clib_bihash_kv_8_8_t kv = { .key = hash };
 
-  h = (fm->active_timer) ? flowprobe_hash (k) : 0;
+  /* Lookup in the flow cache */
+  if (clib_bihash_search_inline_8_8 (&fm->flow_cache_per_worker[my_cpu_number],
+				     &kv))
+    return 0;
 
-  /* Lookup in the flow state pool */
-  *poolindex = fm->hash_per_worker[my_cpu_number][h];
-  if (*poolindex != ~0)
-    {
-      e = pool_elt_at_index (fm->pool_per_worker[my_cpu_number], *poolindex);
-      if (e)
-	{
-	  /* Verify key or report collision */
-	  if (memcmp (k, &e->key, sizeof (flowprobe_key_t)))
-	    *collision = true;
-	  return e;
-	}
-    }
+  *poolindex = kv.value;
+  e = pool_elt_at_index (fm->pool_per_worker[my_cpu_number], *poolindex);
 
-  return 0;
+  /* Verify key or report collision */
+  if (memcmp (k, &e->key, sizeof (flowprobe_key_t)))
+    *collision = true;
+  return e;
 }
 
 flowprobe_entry_t *
-flowprobe_create (u32 my_cpu_number, flowprobe_key_t * k, u32 * poolindex)
+flowprobe_create (u32 my_cpu_number, flowprobe_key_t * k, u64 hash,
+		  u32 * poolindex)
 {
   flowprobe_main_t *fm = &flowprobe_main;
-  u32 h;
-
+  clib_bihash_kv_8_8_t kv = { .key = hash };
   flowprobe_entry_t *e;
 
-  /* Get my index */
-  h = (fm->active_timer) ? flowprobe_hash (k) : 0;
-
   pool_get (fm->pool_per_worker[my_cpu_number], e);
   *poolindex = e - fm->pool_per_worker[my_cpu_number];
-  fm->hash_per_worker[my_cpu_number][h] = *poolindex;
 
+  kv.value = *poolindex;
+  if (clib_bihash_add_del_8_8 (&fm->flow_cache_per_worker[my_cpu_number], &kv,
+			       1 /* is_add */))
+    {
+      pool_put (fm->pool_per_worker[my_cpu_number], e);
+      return 0;
+    }
+
+  clib_memset (e, 0, sizeof (*e));
   e->key = *k;
 
   if (fm->passive_timer > 0)
@@ -491,13 +498,14 @@ add_to_flow_record_state (vlib_main_t *vm, vlib_node_runtime_t *node,
     }
 
   flowprobe_entry_t *e = 0;
+  u32 poolindex = ~0;
   f64 now = vlib_time_now (vm);
   if (fm->active_timer > 0)
     {
-      u32 poolindex = ~0;
       bool collision = false;
+      u64 hash = flowprobe_hash (&k);
 
-      e = flowprobe_lookup (my_cpu_number, &k, &poolindex, &collision);
+      e = flowprobe_lookup (my_cpu_number, &k, hash, &poolindex, &collision);
       if (collision)
 	{
 	  /* Flush data and clean up entry for reuse. */
@@ -510,7 +518,13 @@ add_to_flow_record_state (vlib_main_t *vm, vlib_node_runtime_t *node,
 	}
       if (!e)			/* Create new entry */
 	{
-	  e = flowprobe_create (my_cpu_number, &k, &poolindex);
+	  e = flowprobe_create (my_cpu_number, &k, hash, &poolindex);
+	  if (PREDICT_FALSE (!e))
+	    {
+	      vlib_node_increment_counter (vm, node->node_index,
+					   FLOWPROBE_ERROR_CACHE_FULL, 1);
+	      return;
+	    }
 	  e->last_exported = now;
 	  e->flow_start = timestamp;
 	}
@@ -523,16 +537,43 @@ add_to_flow_record_state (vlib_main_t *vm, vlib_node_runtime_t *node,
 
   if (e)
     {
-      /* Updating entry */
-      e->packetcount++;
-      e->octetcount += octets;
+      /* Updating entry, a sampled packet stands for sampling_rate ones */
+      e->packetcount += fm->sampling_rate;
+      e->octetcount += (u64) octets * fm->sampling_rate;
       e->last_updated = now;
       e->flow_end = timestamp;
       e->prot.tcp.flags |= tcp_flags;
-      if (fm->active_timer == 0
-	  || (now > e->last_exported + fm->active_timer))
+      if (fm->active_timer == 0)
 	flowprobe_export_entry (vm, e);
+      else if (now > e->last_exported + fm->active_timer)
+	{
+	  /* Assembled with the other due flows at the end of the frame */
+	  e->last_exported = now;
+	  vec_add1 (fm->export_pending_per_worker[my_cpu_number], poolindex);
+	}
+    }
+}
+
+/*
+ * 1:N packet sampling, either every N-th packet or each packet with a
+ * 1/N probability. Returns true if the packet is to be metered.
+ */
+static_always_inline bool
+flowprobe_sample (flowprobe_main_t *fm, flowprobe_sampler_t *s)
+{
+  if (PREDICT_TRUE (fm->sampling_rate <= 1))
+    return true;
+
+  if (fm->sampling_random)
+    return (random_u32 (&s->seed) % fm->sampling_rate) == 0;
+
+  if (s->countdown)
+    {
+      s->countdown--;
+      return false;
     }
+  s->countdown = fm->sampling_rate - 1;
+  return true;
 }
 
 static u16
@@ -744,6 +785,26 @@ flowprobe_export_entry (vlib_main_t * vm, flowprobe_entry_t * e)
     flowprobe_export_send (vm, b0, which);
 }
 
+/* Assemble the records of all the flows due for an active timer export */
+static void
+flowprobe_export_pending (vlib_main_t *vm, flowprobe_main_t *fm)
+{
+  u32 my_cpu_number = vm->thread_index;
+  u32 *pending = fm->export_pending_per_worker[my_cpu_number];
+  flowprobe_entry_t *pool = fm->pool_per_worker[my_cpu_number];
+  u32 i, n = vec_len (pending);
+
+  for (i = 0; i < n; i++)
+    {
+      if (i + 1 < n)
+	CLIB_PREFETCH (pool_elt_at_index (pool, pending[i + 1]),
+		       sizeof (flowprobe_entry_t), LOAD);
+      flowprobe_export_entry (vm, pool_elt_at_index (pool, pending[i]));
+    }
+
+  vec_reset_length (fm->export_pending_per_worker[my_cpu_number]);
+}
+
 uword
 flowprobe_node_fn (vlib_main_t *vm, vlib_node_runtime_t *node,
 		   vlib_frame_t *frame, flowprobe_variant_t which,
@@ -752,7 +813,9 @@ flowprobe_node_fn (vlib_main_t *vm, vlib_node_runtime_t *node,
   u32 n_left_from, *from, *to_next;
   flowprobe_next_t next_index;
   flowprobe_main_t *fm = &flowprobe_main;
+  flowprobe_sampler_t *sampler = &fm->sampler_per_worker[vm->thread_index];
   timestamp_nsec_t timestamp;
+  u32 n_not_sampled = 0;
 
   unix_time_now_nsec_fraction (&timestamp.sec, &timestamp.nsec);
 
@@ -807,22 +870,32 @@ flowprobe_node_fn (vlib_main_t *vm, vlib_node_runtime_t *node,
 	  u16 ethertype0 = clib_net_to_host_u16 (eh0->type);
 
 	  if (PREDICT_TRUE ((b0->flags & VNET_BUFFER_F_FLOW_REPORT) == 0))
-	    add_to_flow_record_state (
-	      vm, node, fm, b0, timestamp, len0,
-	      flowprobe_get_variant (which, fm->context[which].flags,
-				     ethertype0),
-	      direction, 0);
+	    {
+	      if (flowprobe_sample (fm, sampler))
+		add_to_flow_record_state (
+		  vm, node, fm, b0, timestamp, len0,
+		  flowprobe_get_variant (which, fm->context[which].flags,
+					 ethertype0),
+		  direction, 0);
+	      else
+		n_not_sampled++;
+	    }
 
 	  len1 = vlib_buffer_length_in_chain (vm, b1);
 	  ethernet_header_t *eh1 = vlib_buffer_get_current (b1);
 	  u16 ethertype1 = clib_net_to_host_u16 (eh1->type);
 
 	  if (PREDICT_TRUE ((b1->flags & VNET_BUFFER_F_FLOW_REPORT) == 0))
-	    add_to_flow_record_state (
-	      vm, node, fm, b1, timestamp, len1,
-	      flowprobe_get_variant (which, fm->context[which].flags,
-				     ethertype1),
-	      direction, 0);
+	    {
+	      if (flowprobe_sample (fm, sampler))
+		add_to_flow_record_state (
+		  vm, node, fm, b1, timestamp, len1,
+		  flowprobe_get_variant (which, fm->context[which].flags,
+					 ethertype1),
+		  direction, 0);
+	      else
+		n_not_sampled++;
+	    }
 
 	  /* verify speculative enqueues, maybe switch current next frame */
 	  vlib_validate_buffer_enqueue_x2 (vm, node, next_index,
@@ -855,16 +928,21 @@ flowprobe_node_fn (vlib_main_t *vm, vlib_node_runtime_t *node,
 
 	  if (PREDICT_TRUE ((b0->flags & VNET_BUFFER_F_FLOW_REPORT) == 0))
 	    {
-	      flowprobe_trace_t *t = 0;
-	      if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)
-				 && (b0->flags & VLIB_BUFFER_IS_TRACED)))
-		t = vlib_add_trace (vm, node, b0, sizeof (*t));
-
-	      add_to_flow_record_state (
-		vm, node, fm, b0, timestamp, len0,
-		flowprobe_get_variant (which, fm->context[which].flags,
-				       ethertype0),
-		direction, t);
+	      if (flowprobe_sample (fm, sampler))
+		{
+		  flowprobe_trace_t *t = 0;
+		  if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE) &&
+				     (b0->flags & VLIB_BUFFER_IS_TRACED)))
+		    t = vlib_add_trace (vm, node, b0, sizeof (*t));
+
+		  add_to_flow_record_state (
+		    vm, node, fm, b0, timestamp, len0,
+		    flowprobe_get_variant (which, fm->context[which].flags,
+					   ethertype0),
+		    direction, t);
+		}
+	      else
+		n_not_sampled++;
 	    }
 
 	  /* verify speculative enqueue, maybe switch current next frame */
@@ -875,6 +953,14 @@ flowprobe_node_fn (vlib_main_t *vm, vlib_node_runtime_t *node,
 
       vlib_put_next_frame (vm, node, next_index, n_left_to_next);
     }
+
+  if (vec_len (fm->export_pending_per_worker[vm->thread_index]))
+    flowprobe_export_pending (vm, fm);
+
+  if (n_not_sampled)
+    vlib_node_increment_counter (vm, node->node_index,
+				 FLOWPROBE_ERROR_NOT_SAMPLED, n_not_sampled);
+
   return frame->n_vectors;
 }
 
@@ -961,15 +1047,14 @@ flowprobe_delete_by_index (u32 my_cpu_number, u32 poolindex)
 {
   flowprobe_main_t *fm = &flowprobe_main;
   flowprobe_entry_t *e;
-  u32 h;
+  clib_bihash_kv_8_8_t kv;
 
   e = pool_elt_at_index (fm->pool_per_worker[my_cpu_number], poolindex);
 
-  /* Get my index */
-  h = flowprobe_hash (&e->key);
-
-  /* Reset hash */
-  fm->hash_per_worker[my_cpu_number][h] = ~0;
+  /* Remove from the flow cache */
+  kv.key = flowprobe_hash (&e->key);
+  clib_bihash_add_del_8_8 (&fm->flow_cache_per_worker[my_cpu_number], &kv,
+			   0 /* is_add */);
 
   pool_put_index (fm->pool_per_worker[my_cpu_number], poolindex);
 }
@@ -1009,9 +1094,9 @@ flowprobe_walker_process (vlib_main_t * vm,
   tw_timer_expire_timers_2t_1w_2048sl (fm->timers_per_worker[cpu_index],
 				       start_time);
 
+  u32 exported = 0;
   vec_foreach (i, fm->expired_passive_per_worker[cpu_index])
   {
-    u32 exported = 0;
     f64 now = vlib_time_now (vm);
     if (now > start_time + 100e-6
 	|| exported > FLOW_MAXIMUM_EXPORT_ENTRIES - 1)
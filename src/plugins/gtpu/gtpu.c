@@ -355,24 +355,26 @@ int vnet_gtpu_add_mod_del_tunnel
   gtpu_main_t *gtm = &gtpu_main;
   gtpu_tunnel_t *t = 0;
   vnet_main_t *vnm = gtm->vnet_main;
-  uword *p;
   u32 hw_if_index = ~0;
   u32 sw_if_index = ~0;
-  gtpu4_tunnel_key_t key4;
-  gtpu6_tunnel_key_t key6;
+  clib_bihash_kv_8_8_t kv4;
+  clib_bihash_kv_24_8_t kv6;
   bool is_ip6 = !ip46_address_is_ip4 (&a->dst);
+  int found;
 
+  /* decap src in key is encap dst in config */
   if (!is_ip6)
     {
-      key4.src = a->dst.ip4.as_u32;	/* decap src in key is encap dst in config */
-      key4.teid = clib_host_to_net_u32 (a->teid);
-      p = hash_get (gtm->gtpu4_tunnel_by_key, key4.as_u64);
+      gtpu4_tunnel_make_kv (&kv4, a->dst.ip4.as_u32,
+			    clib_host_to_net_u32 (a->teid));
+      found = !clib_bihash_search_inline_8_8 (&gtm->gtpu4_tunnel_by_key, &kv4);
     }
   else
     {
-      key6.src = a->dst.ip6;
-      key6.teid = clib_host_to_net_u32 (a->teid);
-      p = hash_get_mem (gtm->gtpu6_tunnel_by_key, &key6);
+      gtpu6_tunnel_make_kv (&kv6, &a->dst.ip6,
+			    clib_host_to_net_u32 (a->teid));
+      found =
+	!clib_bihash_search_inline_24_8 (&gtm->gtpu6_tunnel_by_key, &kv6);
     }
 
   if (a->opn == GTPU_ADD_TUNNEL)
@@ -380,7 +382,7 @@ int vnet_gtpu_add_mod_del_tunnel
       l2input_main_t *l2im = &l2input_main;
 
       /* adding a tunnel: tunnel must not already exist */
-      if (p)
+      if (found)
 	return VNET_API_ERROR_TUNNEL_EXIST;
 
       /*if not set explicitly, default to l2 */
@@ -407,11 +409,26 @@ int vnet_gtpu_add_mod_del_tunnel
       t->flow_index = ~0;
 
       /* copy the key */
+      int add_failed;
       if (is_ip6)
-	hash_set_mem_alloc (&gtm->gtpu6_tunnel_by_key, &key6,
-			    t - gtm->tunnels);
+	{
+	  kv6.value = t - gtm->tunnels;
+	  add_failed = clib_bihash_add_del_24_8 (&gtm->gtpu6_tunnel_by_key,
+						 &kv6, 1 /* is_add */);
+	}
       else
-	hash_set (gtm->gtpu4_tunnel_by_key, key4.as_u64, t - gtm->tunnels);
+	{
+	  kv4.value = t - gtm->tunnels;
+	  add_failed = clib_bihash_add_del_8_8 (&gtm->gtpu4_tunnel_by_key,
+						&kv4, 1 /* is_add */);
+	}
+
+      if (add_failed)
+	{
+	  vec_free (t->rewrite);
+	  pool_put (gtm->tunnels, t);
+	  return VNET_API_ERROR_TABLE_TOO_BIG;
+	}
 
       vnet_hw_interface_t *hi;
       if (vec_len (gtm->free_gtpu_tunnel_hw_if_indices) > 0)
@@ -566,10 +583,10 @@ int vnet_gtpu_add_mod_del_tunnel
   else
     {
       /* mod-tteid or deleting a tunnel: tunnel must exist */
-      if (!p)
+      if (!found)
 	return VNET_API_ERROR_NO_SUCH_ENTRY;
 
-      t = pool_elt_at_index (gtm->tunnels, p[0]);
+      t = pool_elt_at_index (gtm->tunnels, is_ip6 ? kv6.value : kv4.value);
       sw_if_index = t->sw_if_index;
 
       if (a->opn == GTPU_UPD_TTEID)
@@ -595,9 +612,11 @@ int vnet_gtpu_add_mod_del_tunnel
       gtm->tunnel_index_by_sw_if_index[t->sw_if_index] = ~0;
 
       if (!is_ip6)
-	hash_unset (gtm->gtpu4_tunnel_by_key, key4.as_u64);
+	clib_bihash_add_del_8_8 (&gtm->gtpu4_tunnel_by_key, &kv4,
+				 0 /* is_add */);
       else
-	hash_unset_mem_free (&gtm->gtpu6_tunnel_by_key, &key6);
+	clib_bihash_add_del_24_8 (&gtm->gtpu6_tunnel_by_key, &kv6,
+				  0 /* is_add */);
 
       if (!ip46_address_is_multicast (&t->dst))
 	{
@@ -914,6 +933,16 @@ show_gtpu_tunnel_command_fn (vlib_main_t * vm,
 {
   gtpu_main_t *gtm = &gtpu_main;
   gtpu_tunnel_t *t;
+  u8 raw = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "raw"))
+	raw = 1;
+      else
+	return clib_error_return (0, "parse error: '%U'",
+				  format_unformat_error, input);
+    }
 
   if (pool_elts (gtm->tunnels) == 0)
     vlib_cli_output (vm, "No gtpu tunnels configured...");
@@ -923,6 +952,14 @@ show_gtpu_tunnel_command_fn (vlib_main_t * vm,
     vlib_cli_output (vm, "%U", format_gtpu_tunnel, t);
   }
 
+  if (raw)
+    {
+      vlib_cli_output (vm, "Raw IPv4 Hash Table:\n%U\n", format_bihash_8_8,
+		       &gtm->gtpu4_tunnel_by_key, 1 /* verbose */);
+      vlib_cli_output (vm, "Raw IPv6 Hash Table:\n%U\n", format_bihash_24_8,
+		       &gtm->gtpu6_tunnel_by_key, 1 /* verbose */);
+    }
+
   return 0;
 }
 
@@ -934,11 +971,12 @@ show_gtpu_tunnel_command_fn (vlib_main_t * vm,
  * @cliexstart{show gtpu tunnel}
  * [0] src 10.0.3.1 dst 10.0.3.3 teid 13 tx-teid 55 encap_fib_index 0 sw_if_index 5 decap_next l2
  * @cliexend
+ * Use 'raw' to also dump the tunnel lookup tables.
  ?*/
 /* *INDENT-OFF* */
 VLIB_CLI_COMMAND (show_gtpu_tunnel_command, static) = {
     .path = "show gtpu tunnel",
-    .short_help = "show gtpu tunnel",
+    .short_help = "show gtpu tunnel [raw]",
     .function = show_gtpu_tunnel_command_fn,
 };
 /* *INDENT-ON* */
@@ -1253,10 +1291,9 @@ gtpu_init (vlib_main_t * vm)
   vnet_flow_get_range (gtm->vnet_main, "gtpu", 1024 * 1024,
 		       &gtm->flow_id_start);
 
-  /* initialize the ip6 hash */
-  gtm->gtpu6_tunnel_by_key = hash_create_mem (0,
-					      sizeof (gtpu6_tunnel_key_t),
-					      sizeof (uword));
+  gtm->tunnel_hash_buckets = GTPU_HASH_NUM_BUCKETS;
+  gtm->tunnel_hash_memory = GTPU_HASH_MEMORY_SIZE;
+
   gtm->vtep_table = vtep_table_create ();
   gtm->mcast_shared = hash_create_mem (0,
 				       sizeof (ip46_address_t),
@@ -1269,6 +1306,39 @@ gtpu_init (vlib_main_t * vm)
 
 VLIB_INIT_FUNCTION (gtpu_init);
 
+static clib_error_t *
+gtpu_config (vlib_main_t * vm, unformat_input_t * input)
+{
+  gtpu_main_t *gtm = &gtpu_main;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "tunnel-hash-buckets %u",
+		    &gtm->tunnel_hash_buckets))
+	;
+      else if (unformat (input, "tunnel-hash-memory %U",
+			 unformat_memory_size, &gtm->tunnel_hash_memory))
+	;
+      else
+	return clib_error_return (0, "unknown input '%U'",
+				  format_unformat_error, input);
+    }
+
+  /*
+   * The tunnel tables are bounded-index hashes: lookups in the decap
+   * nodes never take a lock and adding a tunnel never rehashes the
+   * whole table, so they are sized once here for the expected scale.
+   */
+  clib_bihash_init_8_8 (&gtm->gtpu4_tunnel_by_key, "gtpu4",
+			gtm->tunnel_hash_buckets, gtm->tunnel_hash_memory);
+  clib_bihash_init_24_8 (&gtm->gtpu6_tunnel_by_key, "gtpu6",
+			 gtm->tunnel_hash_buckets, gtm->tunnel_hash_memory);
+
+  return 0;
+}
+
+VLIB_CONFIG_FUNCTION (gtpu_config, "gtpu");
+
 /* *INDENT-OFF* */
 VLIB_PLUGIN_REGISTER () = {
     .version = VPP_BUILD_VER,
@@ -21,6 +21,8 @@
 #include <vppinfra/lock.h>
 #include <vppinfra/error.h>
 #include <vppinfra/hash.h>
+#include <vppinfra/bihash_8_8.h>
+#include <vppinfra/bihash_24_8.h>
 #include <vnet/vnet.h>
 #include <vnet/ip/ip.h>
 #include <vnet/ip/vtep.h>
@@ -125,6 +127,28 @@ typedef CLIB_PACKED
 }) gtpu6_tunnel_key_t;
 /* *INDENT-ON* */
 
+static_always_inline void
+gtpu4_tunnel_make_kv (clib_bihash_kv_8_8_t *kv, u32 src, u32 teid)
+{
+  gtpu4_tunnel_key_t key4 = { .src = src, .teid = teid };
+
+  kv->key = key4.as_u64;
+  kv->value = ~0ULL;
+}
+
+static_always_inline void
+gtpu6_tunnel_make_kv (clib_bihash_kv_24_8_t *kv, const ip6_address_t *src,
+		      u32 teid)
+{
+  kv->key[0] = src->as_u64[0];
+  kv->key[1] = src->as_u64[1];
+  kv->key[2] = teid;
+  kv->value = ~0ULL;
+}
+
+#define GTPU_HASH_NUM_BUCKETS (64 * 1024)
+#define GTPU_HASH_MEMORY_SIZE (32 << 20)
+
 typedef struct
 {
   /* Required for pool_get_aligned  */
@@ -208,8 +232,12 @@ typedef struct
   gtpu_tunnel_t *tunnels;
 
   /* lookup tunnel by key */
-  uword *gtpu4_tunnel_by_key;	/* keyed on ipv4.dst + teid */
-  uword *gtpu6_tunnel_by_key;	/* keyed on ipv6.dst + teid */
+  clib_bihash_8_8_t gtpu4_tunnel_by_key;  /* keyed on ipv4.dst + teid */
+  clib_bihash_24_8_t gtpu6_tunnel_by_key; /* keyed on ipv6.dst + teid */
+
+  /* tunnel hash sizing, from the startup config */
+  u32 tunnel_hash_buckets;
+  uword tunnel_hash_memory;
 
   /* local VTEP IPs ref count used by gtpu-bypass node to check if
      received gtpu packet DIP matches any local VTEP address */
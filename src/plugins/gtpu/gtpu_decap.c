@@ -53,6 +53,78 @@ validate_gtpu_fib (vlib_buffer_t *b, gtpu_tunnel_t *t, u32 is_ip4)
   return t->encap_fib_index == vlib_buffer_get_ip_fib_index (b, is_ip4);
 }
 
+/*
+ * Resolve the tunnels of a whole frame before decapsulating it. All the
+ * hashes are computed first and their buckets prefetched, so that with a
+ * large tunnel table the searches overlap their cache misses instead of
+ * stalling once per packet. Packets with no matching tunnel get ~0.
+ */
+static_always_inline void
+gtpu4_lookup_tunnels (vlib_main_t *vm, gtpu_main_t *gtm, u32 *from,
+		      u32 n_left, u32 *tunnel_indices)
+{
+  clib_bihash_kv_8_8_t kv[VLIB_FRAME_SIZE];
+  u64 hashes[VLIB_FRAME_SIZE];
+  u32 i;
+
+  for (i = 0; i < n_left; i++)
+    {
+      vlib_buffer_t *b = vlib_get_buffer (vm, from[i]);
+      gtpu_header_t *gtpu = vlib_buffer_get_current (b);
+      ip4_header_t *ip4 = (void *) ((u8 *) gtpu - sizeof (udp_header_t) -
+				    sizeof (ip4_header_t));
+
+      gtpu4_tunnel_make_kv (&kv[i], ip4->src_address.as_u32, gtpu->teid);
+      hashes[i] = clib_bihash_hash_8_8 (&kv[i]);
+      clib_bihash_prefetch_bucket_8_8 (&gtm->gtpu4_tunnel_by_key, hashes[i]);
+    }
+
+  for (i = 0; i < n_left; i++)
+    clib_bihash_prefetch_data_8_8 (&gtm->gtpu4_tunnel_by_key, hashes[i]);
+
+  for (i = 0; i < n_left; i++)
+    {
+      if (clib_bihash_search_inline_with_hash_8_8 (&gtm->gtpu4_tunnel_by_key,
+						   hashes[i], &kv[i]))
+	tunnel_indices[i] = ~0;
+      else
+	tunnel_indices[i] = kv[i].value;
+    }
+}
+
+static_always_inline void
+gtpu6_lookup_tunnels (vlib_main_t *vm, gtpu_main_t *gtm, u32 *from,
+		      u32 n_left, u32 *tunnel_indices)
+{
+  clib_bihash_kv_24_8_t kv[VLIB_FRAME_SIZE];
+  u64 hashes[VLIB_FRAME_SIZE];
+  u32 i;
+
+  for (i = 0; i < n_left; i++)
+    {
+      vlib_buffer_t *b = vlib_get_buffer (vm, from[i]);
+      gtpu_header_t *gtpu = vlib_buffer_get_current (b);
+      ip6_header_t *ip6 = (void *) ((u8 *) gtpu - sizeof (udp_header_t) -
+				    sizeof (ip6_header_t));
+
+      gtpu6_tunnel_make_kv (&kv[i], &ip6->src_address, gtpu->teid);
+      hashes[i] = clib_bihash_hash_24_8 (&kv[i]);
+      clib_bihash_prefetch_bucket_24_8 (&gtm->gtpu6_tunnel_by_key, hashes[i]);
+    }
+
+  for (i = 0; i < n_left; i++)
+    clib_bihash_prefetch_data_24_8 (&gtm->gtpu6_tunnel_by_key, hashes[i]);
+
+  for (i = 0; i < n_left; i++)
+    {
+      if (clib_bihash_search_inline_with_hash_24_8 (
+	    &gtm->gtpu6_tunnel_by_key, hashes[i], &kv[i]))
+	tunnel_indices[i] = ~0;
+      else
+	tunnel_indices[i] = kv[i].value;
+    }
+}
+
 always_inline uword
 gtpu_input (vlib_main_t * vm,
              vlib_node_runtime_t * node,
@@ -63,21 +135,19 @@ gtpu_input (vlib_main_t * vm,
   gtpu_main_t * gtm = &gtpu_main;
   vnet_main_t * vnm = gtm->vnet_main;
   vnet_interface_main_t * im = &vnm->interface_main;
-  u32 last_tunnel_index = ~0;
-  gtpu4_tunnel_key_t last_key4;
-  gtpu6_tunnel_key_t last_key6;
+  u32 tunnel_indices[VLIB_FRAME_SIZE], *ti = tunnel_indices;
   u32 pkts_decapsulated = 0;
   u32 thread_index = vlib_get_thread_index();
   u32 stats_sw_if_index, stats_n_packets, stats_n_bytes;
 
-  if (is_ip4)
-    last_key4.as_u64 = ~0;
-  else
-    clib_memset (&last_key6, 0xff, sizeof (last_key6));
-
   from = vlib_frame_vector_args (from_frame);
   n_left_from = from_frame->n_vectors;
 
+  if (is_ip4)
+    gtpu4_lookup_tunnels (vm, gtm, from, n_left_from, tunnel_indices);
+  else
+    gtpu6_lookup_tunnels (vm, gtm, from, n_left_from, tunnel_indices);
+
   next_index = node->cached_next_index;
   stats_sw_if_index = node->runtime_data[0];
   stats_n_packets = stats_n_bytes = 0;
@@ -97,11 +167,10 @@ gtpu_input (vlib_main_t * vm,
           ip6_header_t * ip6_0, * ip6_1;
           gtpu_header_t * gtpu0, * gtpu1;
           u32 gtpu_hdr_len0, gtpu_hdr_len1;
-	  uword * p0, * p1;
-          u32 tunnel_index0, tunnel_index1;
+          u32 tunnel_index0, tunnel_index1, ti0, ti1;
           gtpu_tunnel_t * t0, * t1, * mt0 = NULL, * mt1 = NULL;
-          gtpu4_tunnel_key_t key4_0, key4_1;
-          gtpu6_tunnel_key_t key6_0, key6_1;
+          clib_bihash_kv_8_8_t kv4_0, kv4_1;
+          clib_bihash_kv_24_8_t kv6_0, kv6_1;
           u32 error0, error1;
 	  u32 sw_if_index0, sw_if_index1, len0, len1;
           u8 has_space0, has_space1;
@@ -123,9 +192,12 @@ gtpu_input (vlib_main_t * vm,
 
 	  bi0 = from[0];
 	  bi1 = from[1];
+	  ti0 = ti[0];
+	  ti1 = ti[1];
 	  to_next[0] = bi0;
 	  to_next[1] = bi1;
 	  from += 2;
+	  ti += 2;
 	  to_next += 2;
 	  n_left_to_next -= 2;
 	  n_left_from -= 2;
@@ -177,25 +249,16 @@ gtpu_input (vlib_main_t * vm,
 
 	  /* Manipulate packet 0 */
           if (is_ip4) {
-            key4_0.src = ip4_0->src_address.as_u32;
-            key4_0.teid = gtpu0->teid;
-
  	    /* Make sure GTPU tunnel exist according to packet SIP and teid
- 	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path */
-           if (PREDICT_FALSE (key4_0.as_u64 != last_key4.as_u64))
+ 	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path.
+ 	     * The lookup was done for the whole frame up front */
+            if (PREDICT_FALSE (ti0 == ~0))
               {
-                p0 = hash_get (gtm->gtpu4_tunnel_by_key, key4_0.as_u64);
-                if (PREDICT_FALSE (p0 == NULL))
-                  {
-                    error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
-                    next0 = GTPU_INPUT_NEXT_DROP;
-                    goto trace0;
-                  }
-                last_key4.as_u64 = key4_0.as_u64;
-                tunnel_index0 = last_tunnel_index = p0[0];
+                error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
+                next0 = GTPU_INPUT_NEXT_DROP;
+                goto trace0;
               }
-            else
-              tunnel_index0 = last_tunnel_index;
+            tunnel_index0 = ti0;
 	    t0 = pool_elt_at_index (gtm->tunnels, tunnel_index0);
 
 	    /* Validate GTPU tunnel encap-fib index against packet */
@@ -211,13 +274,13 @@ gtpu_input (vlib_main_t * vm,
 	      goto next0; /* valid packet */
 	    if (PREDICT_FALSE (ip4_address_is_multicast (&ip4_0->dst_address)))
 	      {
-		key4_0.src = ip4_0->dst_address.as_u32;
-		key4_0.teid = gtpu0->teid;
 		/* Make sure mcast GTPU tunnel exist by packet DIP and teid */
-		p0 = hash_get (gtm->gtpu4_tunnel_by_key, key4_0.as_u64);
-		if (PREDICT_TRUE (p0 != NULL))
+		gtpu4_tunnel_make_kv (&kv4_0, ip4_0->dst_address.as_u32,
+				      gtpu0->teid);
+		if (PREDICT_TRUE (!clib_bihash_search_inline_8_8 (
+		      &gtm->gtpu4_tunnel_by_key, &kv4_0)))
 		  {
-		    mt0 = pool_elt_at_index (gtm->tunnels, p0[0]);
+		    mt0 = pool_elt_at_index (gtm->tunnels, kv4_0.value);
 		    goto next0; /* valid packet */
 		  }
 	      }
@@ -226,26 +289,16 @@ gtpu_input (vlib_main_t * vm,
 	    goto trace0;
 
          } else /* !is_ip4 */ {
-            key6_0.src.as_u64[0] = ip6_0->src_address.as_u64[0];
-            key6_0.src.as_u64[1] = ip6_0->src_address.as_u64[1];
-            key6_0.teid = gtpu0->teid;
-
  	    /* Make sure GTPU tunnel exist according to packet SIP and teid
- 	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path */
-            if (PREDICT_FALSE (memcmp(&key6_0, &last_key6, sizeof(last_key6)) != 0))
+ 	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path.
+ 	     * The lookup was done for the whole frame up front */
+            if (PREDICT_FALSE (ti0 == ~0))
               {
-                p0 = hash_get_mem (gtm->gtpu6_tunnel_by_key, &key6_0);
-                if (PREDICT_FALSE (p0 == NULL))
-                  {
-                    error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
-                    next0 = GTPU_INPUT_NEXT_DROP;
-                    goto trace0;
-                  }
-                clib_memcpy_fast (&last_key6, &key6_0, sizeof(key6_0));
-                tunnel_index0 = last_tunnel_index = p0[0];
+                error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
+                next0 = GTPU_INPUT_NEXT_DROP;
+                goto trace0;
               }
-            else
-              tunnel_index0 = last_tunnel_index;
+            tunnel_index0 = ti0;
 	    t0 = pool_elt_at_index (gtm->tunnels, tunnel_index0);
 
 	    /* Validate GTPU tunnel encap-fib index against packet */
@@ -262,13 +315,12 @@ gtpu_input (vlib_main_t * vm,
 		goto next0; /* valid packet */
 	    if (PREDICT_FALSE (ip6_address_is_multicast (&ip6_0->dst_address)))
 	      {
-		key6_0.src.as_u64[0] = ip6_0->dst_address.as_u64[0];
-		key6_0.src.as_u64[1] = ip6_0->dst_address.as_u64[1];
-		key6_0.teid = gtpu0->teid;
-		p0 = hash_get_mem (gtm->gtpu6_tunnel_by_key, &key6_0);
-		if (PREDICT_TRUE (p0 != NULL))
+		gtpu6_tunnel_make_kv (&kv6_0, &ip6_0->dst_address,
+				      gtpu0->teid);
+		if (PREDICT_TRUE (!clib_bihash_search_inline_24_8 (
+		      &gtm->gtpu6_tunnel_by_key, &kv6_0)))
 		  {
-		    mt0 = pool_elt_at_index (gtm->tunnels, p0[0]);
+		    mt0 = pool_elt_at_index (gtm->tunnels, kv6_0.value);
 		    goto next0; /* valid packet */
 		  }
 	      }
@@ -335,25 +387,16 @@ gtpu_input (vlib_main_t * vm,
 
           /* Manipulate packet 1 */
           if (is_ip4) {
-            key4_1.src = ip4_1->src_address.as_u32;
-            key4_1.teid = gtpu1->teid;
-
  	    /* Make sure GTPU tunnel exist according to packet SIP and teid
- 	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path */
-	    if (PREDICT_FALSE (key4_1.as_u64 != last_key4.as_u64))
+ 	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path.
+ 	     * The lookup was done for the whole frame up front */
+            if (PREDICT_FALSE (ti1 == ~0))
               {
-                p1 = hash_get (gtm->gtpu4_tunnel_by_key, key4_1.as_u64);
-                if (PREDICT_FALSE (p1 == NULL))
-                  {
-                    error1 = GTPU_ERROR_NO_SUCH_TUNNEL;
-                    next1 = GTPU_INPUT_NEXT_DROP;
-                    goto trace1;
-                  }
-                last_key4.as_u64 = key4_1.as_u64;
-                tunnel_index1 = last_tunnel_index = p1[0];
+                error1 = GTPU_ERROR_NO_SUCH_TUNNEL;
+                next1 = GTPU_INPUT_NEXT_DROP;
+                goto trace1;
               }
-            else
-              tunnel_index1 = last_tunnel_index;
+            tunnel_index1 = ti1;
  	    t1 = pool_elt_at_index (gtm->tunnels, tunnel_index1);
 
 	    /* Validate GTPU tunnel encap-fib index against packet */
@@ -369,13 +412,13 @@ gtpu_input (vlib_main_t * vm,
 	      goto next1; /* valid packet */
 	    if (PREDICT_FALSE (ip4_address_is_multicast (&ip4_1->dst_address)))
 	      {
-		key4_1.src = ip4_1->dst_address.as_u32;
-		key4_1.teid = gtpu1->teid;
 		/* Make sure mcast GTPU tunnel exist by packet DIP and teid */
-		p1 = hash_get (gtm->gtpu4_tunnel_by_key, key4_1.as_u64);
-		if (PREDICT_TRUE (p1 != NULL))
+		gtpu4_tunnel_make_kv (&kv4_1, ip4_1->dst_address.as_u32,
+				      gtpu1->teid);
+		if (PREDICT_TRUE (!clib_bihash_search_inline_8_8 (
+		      &gtm->gtpu4_tunnel_by_key, &kv4_1)))
 		  {
-		    mt1 = pool_elt_at_index (gtm->tunnels, p1[0]);
+		    mt1 = pool_elt_at_index (gtm->tunnels, kv4_1.value);
 		    goto next1; /* valid packet */
 		  }
 	      }
@@ -384,28 +427,16 @@ gtpu_input (vlib_main_t * vm,
 	    goto trace1;
 
          } else /* !is_ip4 */ {
-            key6_1.src.as_u64[0] = ip6_1->src_address.as_u64[0];
-            key6_1.src.as_u64[1] = ip6_1->src_address.as_u64[1];
-            key6_1.teid = gtpu1->teid;
-
  	    /* Make sure GTPU tunnel exist according to packet SIP and teid
- 	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path */
-            if (PREDICT_FALSE (memcmp(&key6_1, &last_key6, sizeof(last_key6)) != 0))
+ 	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path.
+ 	     * The lookup was done for the whole frame up front */
+            if (PREDICT_FALSE (ti1 == ~0))
               {
-                p1 = hash_get_mem (gtm->gtpu6_tunnel_by_key, &key6_1);
-
-                if (PREDICT_FALSE (p1 == NULL))
-                  {
-                    error1 = GTPU_ERROR_NO_SUCH_TUNNEL;
-                    next1 = GTPU_INPUT_NEXT_DROP;
-                    goto trace1;
-                  }
-
-                clib_memcpy_fast (&last_key6, &key6_1, sizeof(key6_1));
-                tunnel_index1 = last_tunnel_index = p1[0];
+                error1 = GTPU_ERROR_NO_SUCH_TUNNEL;
+                next1 = GTPU_INPUT_NEXT_DROP;
+                goto trace1;
               }
-            else
-              tunnel_index1 = last_tunnel_index;
+            tunnel_index1 = ti1;
  	    t1 = pool_elt_at_index (gtm->tunnels, tunnel_index1);
 
 	    /* Validate GTPU tunnel encap-fib index against packet */
@@ -422,13 +453,12 @@ gtpu_input (vlib_main_t * vm,
 		goto next1; /* valid packet */
 	    if (PREDICT_FALSE (ip6_address_is_multicast (&ip6_1->dst_address)))
 	      {
-		key6_1.src.as_u64[0] = ip6_1->dst_address.as_u64[0];
-		key6_1.src.as_u64[1] = ip6_1->dst_address.as_u64[1];
-		key6_1.teid = gtpu1->teid;
-		p1 = hash_get_mem (gtm->gtpu6_tunnel_by_key, &key6_1);
-		if (PREDICT_TRUE (p1 != NULL))
+		gtpu6_tunnel_make_kv (&kv6_1, &ip6_1->dst_address,
+				      gtpu1->teid);
+		if (PREDICT_TRUE (!clib_bihash_search_inline_24_8 (
+		      &gtm->gtpu6_tunnel_by_key, &kv6_1)))
 		  {
-		    mt1 = pool_elt_at_index (gtm->tunnels, p1[0]);
+		    mt1 = pool_elt_at_index (gtm->tunnels, kv6_1.value);
 		    goto next1; /* valid packet */
 		  }
 	      }
@@ -500,19 +530,20 @@ gtpu_input (vlib_main_t * vm,
           ip6_header_t * ip6_0;
           gtpu_header_t * gtpu0;
           u32 gtpu_hdr_len0;
-	  uword * p0;
-          u32 tunnel_index0;
+          u32 tunnel_index0, ti0;
           gtpu_tunnel_t * t0, * mt0 = NULL;
-          gtpu4_tunnel_key_t key4_0;
-          gtpu6_tunnel_key_t key6_0;
+          clib_bihash_kv_8_8_t kv4_0;
+          clib_bihash_kv_24_8_t kv6_0;
           u32 error0;
 	  u32 sw_if_index0, len0;
           u8 has_space0;
           u8 ver0;
 
 	  bi0 = from[0];
+	  ti0 = ti[0];
 	  to_next[0] = bi0;
 	  from += 1;
+	  ti += 1;
 	  to_next += 1;
 	  n_left_from -= 1;
 	  n_left_to_next -= 1;
@@ -550,25 +581,16 @@ gtpu_input (vlib_main_t * vm,
             }
 
           if (is_ip4) {
-            key4_0.src = ip4_0->src_address.as_u32;
-            key4_0.teid = gtpu0->teid;
-
  	    /* Make sure GTPU tunnel exist according to packet SIP and teid
- 	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path */
-            if (PREDICT_FALSE (key4_0.as_u64 != last_key4.as_u64))
+ 	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path.
+ 	     * The lookup was done for the whole frame up front */
+            if (PREDICT_FALSE (ti0 == ~0))
               {
-                p0 = hash_get (gtm->gtpu4_tunnel_by_key, key4_0.as_u64);
-                if (PREDICT_FALSE (p0 == NULL))
-                  {
-                    error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
-                    next0 = GTPU_INPUT_NEXT_DROP;
-                    goto trace00;
-                  }
-                last_key4.as_u64 = key4_0.as_u64;
-                tunnel_index0 = last_tunnel_index = p0[0];
+                error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
+                next0 = GTPU_INPUT_NEXT_DROP;
+                goto trace00;
               }
-            else
-              tunnel_index0 = last_tunnel_index;
+            tunnel_index0 = ti0;
 	    t0 = pool_elt_at_index (gtm->tunnels, tunnel_index0);
 
 	    /* Validate GTPU tunnel encap-fib index against packet */
@@ -584,13 +606,13 @@ gtpu_input (vlib_main_t * vm,
 	      goto next00; /* valid packet */
 	    if (PREDICT_FALSE (ip4_address_is_multicast (&ip4_0->dst_address)))
 	      {
-		key4_0.src = ip4_0->dst_address.as_u32;
-		key4_0.teid = gtpu0->teid;
 		/* Make sure mcast GTPU tunnel exist by packet DIP and teid */
-		p0 = hash_get (gtm->gtpu4_tunnel_by_key, key4_0.as_u64);
-		if (PREDICT_TRUE (p0 != NULL))
+		gtpu4_tunnel_make_kv (&kv4_0, ip4_0->dst_address.as_u32,
+				      gtpu0->teid);
+		if (PREDICT_TRUE (!clib_bihash_search_inline_8_8 (
+		      &gtm->gtpu4_tunnel_by_key, &kv4_0)))
 		  {
-		    mt0 = pool_elt_at_index (gtm->tunnels, p0[0]);
+		    mt0 = pool_elt_at_index (gtm->tunnels, kv4_0.value);
 		    goto next00; /* valid packet */
 		  }
 	      }
@@ -599,26 +621,16 @@ gtpu_input (vlib_main_t * vm,
 	    goto trace00;
 
           } else /* !is_ip4 */ {
-            key6_0.src.as_u64[0] = ip6_0->src_address.as_u64[0];
-            key6_0.src.as_u64[1] = ip6_0->src_address.as_u64[1];
-            key6_0.teid = gtpu0->teid;
-
  	    /* Make sure GTPU tunnel exist according to packet SIP and teid
- 	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path */
-            if (PREDICT_FALSE (memcmp(&key6_0, &last_key6, sizeof(last_key6)) != 0))
+ 	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path.
+ 	     * The lookup was done for the whole frame up front */
+            if (PREDICT_FALSE (ti0 == ~0))
               {
-                p0 = hash_get_mem (gtm->gtpu6_tunnel_by_key, &key6_0);
-                if (PREDICT_FALSE (p0 == NULL))
-                  {
-                    error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
-                    next0 = GTPU_INPUT_NEXT_DROP;
-                    goto trace00;
-                  }
-                clib_memcpy_fast (&last_key6, &key6_0, sizeof(key6_0));
-                tunnel_index0 = last_tunnel_index = p0[0];
+                error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
+                next0 = GTPU_INPUT_NEXT_DROP;
+                goto trace00;
               }
-            else
-              tunnel_index0 = last_tunnel_index;
+            tunnel_index0 = ti0;
 	    t0 = pool_elt_at_index (gtm->tunnels, tunnel_index0);
 
 	    /* Validate GTPU tunnel encap-fib index against packet */
@@ -635,13 +647,12 @@ gtpu_input (vlib_main_t * vm,
 		goto next00; /* valid packet */
 	    if (PREDICT_FALSE (ip6_address_is_multicast (&ip6_0->dst_address)))
 	      {
-		key6_0.src.as_u64[0] = ip6_0->dst_address.as_u64[0];
-		key6_0.src.as_u64[1] = ip6_0->dst_address.as_u64[1];
-		key6_0.teid = gtpu0->teid;
-		p0 = hash_get_mem (gtm->gtpu6_tunnel_by_key, &key6_0);
-		if (PREDICT_TRUE (p0 != NULL))
+		gtpu6_tunnel_make_kv (&kv6_0, &ip6_0->dst_address,
+				      gtpu0->teid);
+		if (PREDICT_TRUE (!clib_bihash_search_inline_24_8 (
+		      &gtm->gtpu6_tunnel_by_key, &kv6_0)))
 		  {
-		    mt0 = pool_elt_at_index (gtm->tunnels, p0[0]);
+		    mt0 = pool_elt_at_index (gtm->tunnels, kv6_0.value);
 		    goto next00; /* valid packet */
 		  }
 	      }
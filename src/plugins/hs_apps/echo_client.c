@@ -224,7 +224,7 @@ static uword
 ec_node_fn (vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame)
 {
   u32 *conn_indices, *conns_this_batch, nconns_this_batch;
-  int thread_index = vm->thread_index, i, delete_session;
+  int thread_index = vm->thread_index, i, j, delete_session;
   ec_main_t *ecm = &ec_main;
   ec_worker_t *wrk;
   ec_session_t *es;
@@ -286,6 +286,8 @@ ec_node_fn (vlib_main_t *vm, vlib_node_runtime_t *node, vlib_frame_t *frame)
       if (es->bytes_to_send > 0)
 	{
 	  send_data_chunk (ecm, es);
+	  for (j = 1; j < ecm->dgram_burst && es->bytes_to_send > 0; j++)
+	    send_data_chunk (ecm, es);
 	  delete_session = 0;
 	}
 
@@ -352,7 +354,9 @@ ec_reset_runtime_config (ec_main_t *ecm)
   ecm->test_bytes = 0;
   ecm->test_failed = 0;
   ecm->tls_engine = CRYPTO_ENGINE_OPENSSL;
+  ecm->crypto_flags = 0;
   ecm->no_copy = 0;
+  ecm->dgram_burst = 1;
   ecm->run_test = EC_STARTING;
   ecm->ready_connections = 0;
   ecm->connect_conn_index = 0;
@@ -852,6 +856,7 @@ ec_connect_rpc (void *args)
 	  session_endpoint_alloc_ext_cfg (&a->sep_ext,
 					  TRANSPORT_ENDPT_EXT_CFG_CRYPTO);
 	  a->sep_ext.ext_cfg->crypto.ckpair_index = ecm->ckpair_index;
+	  a->sep_ext.ext_cfg->crypto.flags = ecm->crypto_flags;
 	}
 
       rv = vnet_connect (a);
@@ -968,6 +973,10 @@ ec_command_fn (vlib_main_t *vm, unformat_input_t *input,
 	ecm->test_bytes = 1;
       else if (unformat (line_input, "tls-engine %d", &ecm->tls_engine))
 	;
+      else if (unformat (line_input, "tls-no-resume"))
+	ecm->crypto_flags |= TRANSPORT_ENDPT_CRYPTO_CFG_F_NO_RESUME;
+      else if (unformat (line_input, "dgram-burst %u", &ecm->dgram_burst))
+	;
       else
 	{
 	  error = clib_error_return (0, "failed: unknown input `%U'",
@@ -1126,7 +1135,8 @@ VLIB_CLI_COMMAND (ec_command, static) = {
     "[test-timeout <time>][syn-timeout <time>][no-return][fifo-size <size>]"
     "[private-segment-count <count>][private-segment-size <bytes>[m|g]]"
     "[preallocate-fifos][preallocate-sessions][client-batch <batch-size>]"
-    "[uri <tcp://ip/port>][test-bytes][no-output]",
+    "[uri <tcp://ip/port>][test-bytes][no-output][dgram-burst <n>]"
+    "[tls-no-resume]",
   .function = ec_command_fn,
   .is_mp_safe = 1,
 };
@@ -85,9 +85,11 @@ typedef struct
   u64 private_segment_size;		/**< size of private fifo segs */
   u32 tls_engine;			/**< TLS engine mbedtls/openssl */
   u8 is_dgram;
+  u32 dgram_burst;			/**< Dgrams sent per session per run */
   u32 no_copy;				/**< Don't memcpy data to tx fifo */
   u32 quic_streams;			/**< QUIC streams per connection */
   u32 ckpair_index;			/**< Cert key pair for tls/quic */
+  u32 crypto_flags;			/**< Transport endpoint crypto flags */
   u64 attach_flags;			/**< App attach flags */
   u8 *appns_id;				/**< App namespaces id */
   u64 appns_secret;			/**< App namespace secret */
@@ -48,7 +48,9 @@ typedef struct
   char *server_uri;		/**< Server URI */
   u32 tls_engine;		/**< TLS engine: mbedtls/openssl */
   u32 ckpair_index;		/**< Cert and key for tls/quic */
+  u32 crypto_flags;		/**< Transport endpoint crypto flags */
   u8 is_dgram;			/**< set if transport is dgram */
+  u8 use_buffers;		/**< Receive tcp payload as vlib buffers */
 
   /*
    * Test state
@@ -176,6 +178,113 @@ echo_server_builtin_server_rx_callback_no_echo (session_t * s)
   return 0;
 }
 
+/*
+ * Buffer mode no-echo, free the received buffers without touching the data.
+ */
+static int
+echo_server_rx_buffers_callback_no_echo (session_t *s)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  u32 bis[VLIB_FRAME_SIZE], n_bis;
+
+  do
+    {
+      n_bis = 0;
+      while (n_bis < VLIB_FRAME_SIZE &&
+	     svm_fifo_dequeue_buffer (s->rx_fifo, ~0, &bis[n_bis]) > 0)
+	n_bis++;
+      vlib_buffer_free (vm, bis, n_bis);
+    }
+  while (n_bis == VLIB_FRAME_SIZE);
+
+  return 0;
+}
+
+static void
+echo_server_program_rx_retry (session_t *s)
+{
+  echo_server_main_t *esm = &echo_server_main;
+  u32 thread_index = s->thread_index;
+
+  /* Program self-tap to retry */
+  if (svm_fifo_set_event (s->rx_fifo))
+    {
+      if (session_send_io_evt_to_thread (s->rx_fifo,
+					 SESSION_IO_EVT_BUILTIN_RX))
+	clib_warning ("failed to enqueue self-tap");
+
+      vec_validate (esm->rx_retries[thread_index], s->session_index);
+      if (esm->rx_retries[thread_index][s->session_index] == 500000)
+	{
+	  clib_warning ("session stuck: %U", format_session, s, 2);
+	}
+      if (esm->rx_retries[thread_index][s->session_index] < 500001)
+	esm->rx_retries[thread_index][s->session_index]++;
+    }
+}
+
+/*
+ * Buffer mode echo. Payload is copied once, straight from the received
+ * buffers into the tx fifo, instead of going through the rx fifo and the
+ * per-thread rx buffer.
+ */
+static int
+echo_server_rx_buffers_callback (session_t *s)
+{
+  echo_server_main_t *esm = &echo_server_main;
+  u32 bis[VLIB_FRAME_SIZE], n_bis = 0, max_enqueue, n_written = 0;
+  vlib_main_t *vm = vlib_get_main ();
+  svm_fifo_t *tx_fifo = s->tx_fifo;
+  vlib_buffer_t *b;
+  int len;
+
+  max_enqueue = svm_fifo_max_enqueue_prod (tx_fifo);
+  while ((len = svm_fifo_dequeue_buffer (s->rx_fifo, max_enqueue,
+					 &bis[n_bis])) > 0)
+    {
+      b = vlib_get_buffer (vm, bis[n_bis]);
+      while (1)
+	{
+	  svm_fifo_enqueue (tx_fifo, b->current_length,
+			    vlib_buffer_get_current (b));
+	  if (!(b->flags & VLIB_BUFFER_NEXT_PRESENT))
+	    break;
+	  b = vlib_get_buffer (vm, b->next_buffer);
+	}
+      max_enqueue -= len;
+      n_written += len;
+      if (++n_bis == VLIB_FRAME_SIZE)
+	{
+	  vlib_buffer_free (vm, bis, n_bis);
+	  n_bis = 0;
+	}
+    }
+  vlib_buffer_free (vm, bis, n_bis);
+
+  /* Next segment is larger than the space left, copy what fits */
+  if (len == 0 && max_enqueue)
+    {
+      u8 *rx_buf;
+
+      vec_validate (esm->rx_buf[s->thread_index], max_enqueue);
+      rx_buf = esm->rx_buf[s->thread_index];
+      len = svm_fifo_dequeue_w_buffer (s->rx_fifo, max_enqueue, rx_buf);
+      svm_fifo_enqueue (tx_fifo, len, rx_buf);
+      n_written += len;
+    }
+
+  if (n_written && svm_fifo_set_event (tx_fifo))
+    app_send_io_evt_to_vpp (esm->vpp_queue[s->thread_index],
+			    tx_fifo->shr->master_session_index,
+			    SESSION_IO_EVT_TX, 0 /* noblock */);
+
+  /* No space in tx fifo for the next segment */
+  if (PREDICT_FALSE (svm_fifo_max_dequeue_cons_maybe_buffer (s->rx_fifo)))
+    echo_server_program_rx_retry (s);
+
+  return 0;
+}
+
 int
 echo_server_rx_callback (session_t * s)
 {
@@ -225,22 +334,7 @@ echo_server_rx_callback (session_t * s)
       /* XXX timeout for session that are stuck */
 
     rx_event:
-      /* Program self-tap to retry */
-      if (svm_fifo_set_event (rx_fifo))
-	{
-	  if (session_send_io_evt_to_thread (rx_fifo,
-					     SESSION_IO_EVT_BUILTIN_RX))
-	    clib_warning ("failed to enqueue self-tap");
-
-	  vec_validate (esm->rx_retries[s->thread_index], s->session_index);
-	  if (esm->rx_retries[thread_index][s->session_index] == 500000)
-	    {
-	      clib_warning ("session stuck: %U", format_session, s, 2);
-	    }
-	  if (esm->rx_retries[thread_index][s->session_index] < 500001)
-	    esm->rx_retries[thread_index][s->session_index]++;
-	}
-
+      echo_server_program_rx_retry (s);
       return 0;
     }
 
@@ -314,7 +408,11 @@ echo_server_attach (u8 * appns_id, u64 appns_flags, u64 appns_secret)
   clib_memset (a, 0, sizeof (*a));
   clib_memset (options, 0, sizeof (options));
 
-  if (esm->no_echo)
+  if (esm->use_buffers)
+    echo_server_session_cb_vft.builtin_app_rx_callback =
+      esm->no_echo ? echo_server_rx_buffers_callback_no_echo :
+		     echo_server_rx_buffers_callback;
+  else if (esm->no_echo)
     echo_server_session_cb_vft.builtin_app_rx_callback =
       echo_server_builtin_server_rx_callback_no_echo;
   else
@@ -339,6 +437,8 @@ echo_server_attach (u8 * appns_id, u64 appns_flags, u64 appns_secret)
     esm->prealloc_fifos ? esm->prealloc_fifos : 1;
 
   a->options[APP_OPTIONS_FLAGS] = APP_OPTIONS_FLAGS_IS_BUILTIN;
+  if (esm->use_buffers)
+    a->options[APP_OPTIONS_FLAGS] |= APP_OPTIONS_FLAGS_USE_FIFO_BUFFER;
   if (appns_id)
     {
       a->namespace_id = appns_id;
@@ -406,6 +506,7 @@ echo_server_listen ()
       session_endpoint_alloc_ext_cfg (&args->sep_ext,
 				      TRANSPORT_ENDPT_EXT_CFG_CRYPTO);
       args->sep_ext.ext_cfg->crypto.ckpair_index = esm->ckpair_index;
+      args->sep_ext.ext_cfg->crypto.flags = esm->crypto_flags;
     }
 
   if (args->sep_ext.transport_proto == TRANSPORT_PROTO_UDP)
@@ -468,12 +569,14 @@ echo_server_create_command_fn (vlib_main_t * vm, unformat_input_t * input,
   clib_error_t *error = 0;
 
   esm->no_echo = 0;
+  esm->use_buffers = 0;
   esm->fifo_size = 64 << 10;
   esm->rcv_buffer_size = 128 << 10;
   esm->prealloc_fifos = 0;
   esm->private_segment_count = 0;
   esm->private_segment_size = 512 << 20;
   esm->tls_engine = CRYPTO_ENGINE_OPENSSL;
+  esm->crypto_flags = 0;
   vec_free (esm->server_uri);
 
   while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
@@ -482,6 +585,8 @@ echo_server_create_command_fn (vlib_main_t * vm, unformat_input_t * input,
 	server_uri_set = 1;
       else if (unformat (input, "no-echo"))
 	esm->no_echo = 1;
+      else if (unformat (input, "use-buffers"))
+	esm->use_buffers = 1;
       else if (unformat (input, "fifo-size %d", &esm->fifo_size))
 	esm->fifo_size <<= 10;
       else if (unformat (input, "rcv-buf-size %d", &esm->rcv_buffer_size))
@@ -509,6 +614,8 @@ echo_server_create_command_fn (vlib_main_t * vm, unformat_input_t * input,
 	is_stop = 1;
       else if (unformat (input, "tls-engine %d", &esm->tls_engine))
 	;
+      else if (unformat (input, "tls-no-resume"))
+	esm->crypto_flags |= TRANSPORT_ENDPT_CRYPTO_CFG_F_NO_RESUME;
       else
 	{
 	  error = clib_error_return (0, "failed: unknown input `%U'",
@@ -550,6 +657,11 @@ echo_server_create_command_fn (vlib_main_t * vm, unformat_input_t * input,
     }
   esm->transport_proto = sep.transport_proto;
   esm->is_dgram = (sep.transport_proto == TRANSPORT_PROTO_UDP);
+  if (esm->use_buffers && sep.transport_proto != TRANSPORT_PROTO_TCP)
+    {
+      error = clib_error_return (0, "use-buffers only supported for tcp");
+      goto cleanup;
+    }
 
   rv = echo_server_create (vm, appns_id, appns_flags, appns_secret);
   if (rv)
@@ -572,7 +684,7 @@ VLIB_CLI_COMMAND (echo_server_create_command, static) =
   .short_help = "test echo server proto <proto> [no echo][fifo-size <mbytes>]"
       "[rcv-buf-size <bytes>][prealloc-fifos <count>]"
       "[private-segment-count <count>][private-segment-size <bytes[m|g]>]"
-      "[uri <tcp://ip/port>]",
+      "[uri <tcp://ip/port>][use-buffers][tls-no-resume]",
   .function = echo_server_create_command_fn,
 };
 /* *INDENT-ON* */
@@ -16,11 +16,11 @@
 #include <http/http.h>
 #include <vnet/session/session.h>
 #include <http/http_timer.h>
+#include <http/http_parse.h>
 
 static http_main_t http_main;
 
 #define HTTP_FIFO_THRESH (16 << 10)
-#define CONTENT_LEN_STR	 "Content-Length: "
 
 /* HTTP state machine result */
 typedef enum http_sm_result_t_
@@ -404,25 +404,27 @@ read_http_message (http_conn_t *hc)
   return 0;
 }
 
-static int
-v_find_index (u8 *vec, u32 offset, char *str)
+/**
+ * Map n_bytes from the start of the rx fifo. Data is parsed in place unless
+ * it wraps in the fifo, in which case it is linearized in rx_buf.
+ */
+static u8 *
+http_rx_fifo_map (http_conn_t *hc, svm_fifo_t *f, u32 n_bytes, u32 *len)
 {
-  int start_index = offset;
-  u32 slen = (u32) strnlen_s_inline (str, 16);
-  u32 vlen = vec_len (vec);
-
-  ASSERT (slen > 0);
+  svm_fifo_seg_t seg;
+  u32 n_segs = 1;
 
-  if (vlen <= slen)
-    return -1;
-
-  for (; start_index < (vlen - slen); start_index++)
+  svm_fifo_segments (f, 0, &seg, &n_segs, n_bytes);
+  if (seg.len >= n_bytes)
     {
-      if (!memcmp (vec + start_index, str, slen))
-	return start_index;
+      *len = seg.len;
+      return seg.data;
     }
 
-  return -1;
+  vec_validate (hc->rx_buf, n_bytes - 1);
+  svm_fifo_peek (f, 0, n_bytes, hc->rx_buf);
+  *len = n_bytes;
+  return hc->rx_buf;
 }
 
 /**
@@ -433,52 +435,85 @@ state_srv_wait_method (http_conn_t *hc, transport_send_params_t *sp)
 {
   http_status_code_t ec;
   app_worker_t *app_wrk;
+  http_parse_t hp;
   http_msg_t msg;
-  session_t *as;
-  int i, rv;
-  u32 len;
-  u8 *buf;
+  session_t *as, *ts;
+  svm_fifo_seg_t seg;
+  u32 max_deq, len, n_segs = 1;
+  u8 *data, *buf;
+  u64 msg_len;
+  int rv;
 
-  rv = read_http_message (hc);
+  ts = session_get_from_handle (hc->h_tc_session_handle);
+  max_deq = svm_fifo_max_dequeue_cons (ts->rx_fifo);
 
   /* Nothing yet, wait for data or timer expire */
-  if (rv)
+  if (!max_deq)
     return HTTP_SM_STOP;
 
-  if (vec_len (hc->rx_buf) < 8)
+  /* Message head is usually contiguous, try parsing from the first
+   * fifo segment before linearizing everything that was received */
+  svm_fifo_segments (ts->rx_fifo, 0, &seg, &n_segs, max_deq);
+  data = seg.data;
+  len = seg.len;
+  rv = http_parse_request (data, len, &hp);
+  if (rv == HTTP_PARSE_INCOMPLETE && len < max_deq)
     {
-      ec = HTTP_STATUS_BAD_REQUEST;
-      goto error;
+      data = http_rx_fifo_map (hc, ts->rx_fifo, max_deq, &len);
+      rv = http_parse_request (data, len, &hp);
     }
 
-  if ((i = v_find_index (hc->rx_buf, 0, "GET ")) >= 0)
+  switch (rv)
     {
-      hc->method = HTTP_REQ_GET;
-      hc->rx_buf_offset = i + 5;
-
-      i = v_find_index (hc->rx_buf, hc->rx_buf_offset, "HTTP");
-      if (i < 0)
+    case HTTP_PARSE_OK:
+      break;
+    case HTTP_PARSE_INCOMPLETE:
+      /* Wait for more data, unless it cannot fit in the fifo */
+      if (svm_fifo_max_enqueue (ts->rx_fifo))
 	{
-	  ec = HTTP_STATUS_BAD_REQUEST;
-	  goto error;
+	  vec_reset_length (hc->rx_buf);
+	  return HTTP_SM_STOP;
 	}
-
-      len = i - hc->rx_buf_offset - 1;
-    }
-  else if ((i = v_find_index (hc->rx_buf, 0, "POST ")) >= 0)
-    {
-      hc->method = HTTP_REQ_POST;
-      hc->rx_buf_offset = i + 6;
-      len = vec_len (hc->rx_buf) - hc->rx_buf_offset - 1;
-    }
-  else
-    {
+      ec = HTTP_STATUS_BAD_REQUEST;
+      goto error;
+    case HTTP_PARSE_BAD_METHOD:
       HTTP_DBG (0, "Unknown http method");
       ec = HTTP_STATUS_METHOD_NOT_ALLOWED;
       goto error;
+    case HTTP_PARSE_UNSUPPORTED:
+      HTTP_DBG (0, "Unsupported transfer coding");
+      ec = HTTP_STATUS_NOT_IMPLEMENTED;
+      goto error;
+    default:
+      ec = HTTP_STATUS_BAD_REQUEST;
+      goto error;
+    }
+
+  /* Whole request is handed to the app at once, so it must fit the fifo */
+  if (hp.content_length > svm_fifo_size (ts->rx_fifo) - hp.head_len)
+    {
+      HTTP_DBG (0, "Content-Length %lu too large", hp.content_length);
+      ec = HTTP_STATUS_PAYLOAD_TOO_LARGE;
+      goto error;
     }
 
-  buf = &hc->rx_buf[hc->rx_buf_offset];
+  msg_len = (u64) hp.head_len + hp.content_length;
+  if (msg_len > max_deq)
+    {
+      vec_reset_length (hc->rx_buf);
+      return HTTP_SM_STOP;
+    }
+  if (msg_len > len)
+    data = http_rx_fifo_map (hc, ts->rx_fifo, msg_len, &len);
+
+  hc->method = hp.method;
+  hc->conn_close = hp.connection_close;
+  buf = data + hp.target_offset;
+  if (hp.method == HTTP_REQ_GET)
+    len = hp.target_len;
+  else
+    /* POST passes the rest of the request, headers and body included */
+    len = msg_len - hp.target_offset;
 
   msg.type = HTTP_MSG_REQUEST;
   msg.method_type = hc->method;
@@ -493,13 +528,19 @@ state_srv_wait_method (http_conn_t *hc, transport_send_params_t *sp)
   if (rv < 0 || rv != sizeof (msg) + len)
     {
       clib_warning ("failed app enqueue");
-      /* This should not happen as we only handle 1 request per session,
+      /* This should not happen as we only handle 1 request at a time,
        * and fifo is allocated, but going forward we should consider
        * rescheduling */
       return HTTP_SM_ERROR;
     }
 
-  vec_free (hc->rx_buf);
+  /* Request consumed, pipelined requests stay in the fifo until the reply
+   * to this one is sent */
+  svm_fifo_dequeue_drop (ts->rx_fifo, msg_len);
+  if (svm_fifo_is_empty (ts->rx_fifo))
+    svm_fifo_unset_event (ts->rx_fifo);
+  vec_reset_length (hc->rx_buf);
+
   hc->http_state = HTTP_STATE_WAIT_APP;
 
   app_wrk = app_worker_get_if_valid (as->app_wrk_index);
@@ -509,6 +550,9 @@ state_srv_wait_method (http_conn_t *hc, transport_send_params_t *sp)
 
 error:
 
+  /* Drop unparsed data, otherwise transport resets instead of closing */
+  svm_fifo_dequeue_drop_all (ts->rx_fifo);
+  vec_reset_length (hc->rx_buf);
   send_error (hc, ec);
   session_transport_closing_notify (&hc->connection);
   http_disconnect_transport (hc);
@@ -661,63 +705,20 @@ state_srv_send_more_data (http_conn_t *hc, transport_send_params_t *sp)
       /* Finished transaction, back to HTTP_STATE_WAIT_METHOD */
       hc->http_state = HTTP_STATE_WAIT_METHOD;
       http_buffer_free (&hc->tx_buf);
-    }
-
-  return HTTP_SM_STOP;
-}
-
-static int
-parse_http_header (http_conn_t *hc, int *content_length)
-{
-  unformat_input_t input;
-  int i, len;
-  u8 *line;
-
-  if ((i = v_find_index (hc->rx_buf, hc->rx_buf_offset, "200 OK") < 0))
-    {
-      clib_warning ("bad response code");
-      return -1;
-    }
-
-  i = v_find_index (hc->rx_buf, hc->rx_buf_offset, CONTENT_LEN_STR);
-  if (i < 0)
-    {
-      clib_warning ("cannot find '%s' in the header!", CONTENT_LEN_STR);
-      return -1;
-    }
-
-  hc->rx_buf_offset = i;
-
-  i = v_find_index (hc->rx_buf, hc->rx_buf_offset, "\n");
-  if (i < 0)
-    {
-      clib_warning ("end of line missing; incomplete data");
-      return -1;
-    }
-
-  len = i - hc->rx_buf_offset;
-  line = vec_new (u8, len);
-  clib_memcpy (line, hc->rx_buf + hc->rx_buf_offset, len);
 
-  unformat_init_vector (&input, line);
-  if (!unformat (&input, CONTENT_LEN_STR "%d", content_length))
-    {
-      clib_warning ("failed to unformat content length!");
-      return -1;
-    }
-  unformat_free (&input);
+      if (hc->conn_close)
+	{
+	  session_transport_closing_notify (&hc->connection);
+	  http_disconnect_transport (hc);
+	  return HTTP_SM_STOP;
+	}
 
-  /* skip rest of the header */
-  hc->rx_buf_offset += len;
-  i = v_find_index (hc->rx_buf, hc->rx_buf_offset, "<html>");
-  if (i < 0)
-    {
-      clib_warning ("<html> tag not found");
-      return -1;
+      /* Serve pipelined requests received meanwhile */
+      if (svm_fifo_max_dequeue_cons (ts->rx_fifo))
+	return HTTP_SM_CONTINUE;
     }
-  hc->rx_buf_offset = i;
 
-  return 0;
+  return HTTP_SM_STOP;
 }
 
 static int
@@ -726,20 +727,25 @@ state_cln_wait_method (http_conn_t *hc, transport_send_params_t *sp)
   session_t *as;
   http_msg_t msg;
   app_worker_t *app_wrk;
-  int rv, content_length;
+  http_parse_t hp;
+  int rv;
 
   rv = read_http_message (hc);
   if (rv)
     return HTTP_SM_STOP;
 
+  rv = http_parse_response (hc->rx_buf, vec_len (hc->rx_buf), &hp);
+  if (rv == HTTP_PARSE_INCOMPLETE)
+    return HTTP_SM_STOP;
+
   msg.type = HTTP_MSG_REPLY;
   msg.content_type = HTTP_CONTENT_TEXT_HTML;
   msg.code = HTTP_STATUS_OK;
   msg.data.type = HTTP_MSG_DATA_INLINE;
   msg.data.len = 0;
 
-  rv = parse_http_header (hc, &content_length);
-  if (rv)
+  if (rv != HTTP_PARSE_OK || hp.status_code != 200 ||
+      !http_parse_header_find (&hp, hc->rx_buf, "content-length"))
     {
       clib_warning ("failed to parse http reply");
       session_transport_closing_notify (&hc->connection);
@@ -747,8 +753,10 @@ state_cln_wait_method (http_conn_t *hc, transport_send_params_t *sp)
       return -1;
     }
 
-  msg.data.len = content_length;
-  u32 dlen = vec_len (hc->rx_buf) - hc->rx_buf_offset;
+  hc->rx_buf_offset = hp.head_len;
+  msg.data.len = hp.content_length;
+  u32 dlen = clib_min (vec_len (hc->rx_buf) - hc->rx_buf_offset,
+		       hp.content_length);
   as = session_get_from_handle (hc->h_pa_session_handle);
   svm_fifo_seg_t segs[2] = { { (u8 *) &msg, sizeof (msg) },
 			     { &hc->rx_buf[hc->rx_buf_offset], dlen } };
@@ -761,7 +769,7 @@ state_cln_wait_method (http_conn_t *hc, transport_send_params_t *sp)
     }
   hc->rx_buf_offset += dlen;
   hc->http_state = HTTP_STATE_IO_MORE_DATA;
-  hc->to_recv = content_length - dlen;
+  hc->to_recv = hp.content_length - dlen;
 
   if (hc->rx_buf_offset == vec_len (hc->rx_buf))
     {
@@ -847,6 +855,9 @@ state_cln_recv_more_data (http_conn_t *hc, transport_send_params_t *sp)
   if (max_deq == 0)
     return HTTP_SM_STOP;
 
+  /* Data past the body belongs to the next response */
+  max_deq = clib_min (max_deq, hc->to_recv);
+
   ASSERT (vec_len (hc->rx_buf) == 0);
   ASSERT (hc->rx_buf_offset == 0);
 
@@ -959,11 +970,9 @@ http_req_run_state_machine (http_conn_t *hc, transport_send_params_t *sp)
 static int
 http_ts_server_rx_callback (session_t *ts, http_conn_t *hc)
 {
+  /* Pipelined request, handled once the current reply is sent */
   if (hc->http_state != HTTP_STATE_WAIT_METHOD)
-    {
-      clib_warning ("tcp data in req state %u", hc->http_state);
-      return 0;
-    }
+    return 0;
 
   http_req_run_state_machine (hc, 0);
 
@@ -173,7 +173,9 @@ typedef enum http_content_type_
   _ (400, BAD_REQUEST, "400 Bad Request")                                     \
   _ (404, NOT_FOUND, "404 Not Found")                                         \
   _ (405, METHOD_NOT_ALLOWED, "405 Method Not Allowed")                       \
-  _ (500, INTERNAL_ERROR, "500 Internal Server Error")
+  _ (413, PAYLOAD_TOO_LARGE, "413 Payload Too Large")                         \
+  _ (500, INTERNAL_ERROR, "500 Internal Server Error")                        \
+  _ (501, NOT_IMPLEMENTED, "501 Not Implemented")
 
 typedef enum http_status_code_
 {
@@ -229,11 +231,12 @@ typedef struct http_tc_
    */
   http_state_t http_state;
   http_req_method_t method;
+  u8 conn_close;
   u8 *rx_buf;
   u32 rx_buf_offset;
   http_buffer_t tx_buf;
   u8 is_client;
-  u32 to_recv;
+  u64 to_recv;
   u32 bytes_dequeued;
 } http_conn_t;
 
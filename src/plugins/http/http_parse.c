@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2022 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <http/http_parse.h>
+
+#define HTTP_PARSE_MAX_CONTENT_LENGTH (1ULL << 40)
+
+#define foreach_http_parse_method                                             \
+  _ (GET, "GET")                                                              \
+  _ (POST, "POST")
+
+static inline int
+http_parse_is_ows (u8 c)
+{
+  return c == ' ' || c == '\t';
+}
+
+static inline int
+http_parse_token_is (u8 *s, u32 len, char *token)
+{
+  u32 token_len = strlen (token);
+  return len == token_len && !strncasecmp ((char *) s, token, len);
+}
+
+/**
+ * Find the line starting at offset
+ *
+ * @return offset of next line or -1 if line is not complete. Line length,
+ *         without the CRLF or bare LF terminator, is written to line_len.
+ */
+static inline int
+http_parse_line (u8 *data, u32 len, u32 offset, u32 *line_len)
+{
+  int i;
+
+  i = http_find_byte (data + offset, len - offset, '\n');
+  if (i < 0)
+    return -1;
+
+  *line_len = i;
+  if (i && data[offset + i - 1] == '\r')
+    *line_len -= 1;
+
+  return offset + i + 1;
+}
+
+static http_parse_rv_t
+http_parse_content_length (u8 *s, u32 len, http_parse_t *hp)
+{
+  u64 value = 0;
+  u32 i;
+
+  if (!len)
+    return HTTP_PARSE_BAD_MSG;
+
+  for (i = 0; i < len; i++)
+    {
+      if (s[i] < '0' || s[i] > '9')
+	return HTTP_PARSE_BAD_MSG;
+      value = value * 10 + (s[i] - '0');
+      if (value > HTTP_PARSE_MAX_CONTENT_LENGTH)
+	return HTTP_PARSE_BAD_MSG;
+    }
+
+  /* Conflicting lengths could be used to smuggle requests */
+  if (hp->content_length != ~0ULL && hp->content_length != value)
+    return HTTP_PARSE_BAD_MSG;
+
+  hp->content_length = value;
+  return HTTP_PARSE_OK;
+}
+
+static void
+http_parse_connection (u8 *s, u32 len, http_parse_t *hp)
+{
+  u32 start = 0, end;
+  int comma;
+
+  /* Comma separated list of connection options */
+  while (start < len)
+    {
+      comma = http_find_byte (s + start, len - start, ',');
+      end = comma < 0 ? len : start + comma;
+      while (start < end && http_parse_is_ows (s[start]))
+	start++;
+      while (end > start && http_parse_is_ows (s[end - 1]))
+	end--;
+      if (http_parse_token_is (s + start, end - start, "close"))
+	hp->connection_close = 1;
+      else if (http_parse_token_is (s + start, end - start, "keep-alive"))
+	hp->connection_close = 0;
+      if (comma < 0)
+	break;
+      start += comma + 1;
+    }
+}
+
+static http_parse_rv_t
+http_parse_headers (u8 *data, u32 len, u32 offset, http_parse_t *hp)
+{
+  u32 line_len, value_start, value_end;
+  http_parse_header_t *h;
+  http_parse_rv_t rv;
+  int next, colon;
+  u8 *name;
+
+  hp->n_headers = 0;
+  hp->content_length = ~0ULL;
+  /* HTTP/1.0 connections are not persistent by default */
+  hp->connection_close = hp->minor_version == 0;
+
+  while (1)
+    {
+      next = http_parse_line (data, len, offset, &line_len);
+      if (next < 0)
+	return HTTP_PARSE_INCOMPLETE;
+
+      /* Empty line terminates the head */
+      if (!line_len)
+	break;
+
+      /* Obsolete line folding is not supported */
+      if (http_parse_is_ows (data[offset]))
+	return HTTP_PARSE_BAD_MSG;
+
+      colon = http_find_byte (data + offset, line_len, ':');
+      if (colon <= 0 || http_parse_is_ows (data[offset + colon - 1]))
+	return HTTP_PARSE_BAD_MSG;
+
+      value_start = offset + colon + 1;
+      value_end = offset + line_len;
+      while (value_start < value_end && http_parse_is_ows (data[value_start]))
+	value_start++;
+      while (value_end > value_start &&
+	     http_parse_is_ows (data[value_end - 1]))
+	value_end--;
+
+      name = data + offset;
+      if (http_parse_token_is (name, colon, "content-length"))
+	{
+	  rv = http_parse_content_length (data + value_start,
+					  value_end - value_start, hp);
+	  if (rv != HTTP_PARSE_OK)
+	    return rv;
+	}
+      else if (http_parse_token_is (name, colon, "connection"))
+	http_parse_connection (data + value_start, value_end - value_start,
+			       hp);
+      else if (http_parse_token_is (name, colon, "transfer-encoding"))
+	return HTTP_PARSE_UNSUPPORTED;
+
+      /* Headers beyond the table size are parsed but not recorded */
+      if (hp->n_headers < HTTP_PARSE_MAX_HEADERS)
+	{
+	  h = &hp->headers[hp->n_headers++];
+	  h->name_offset = offset;
+	  h->name_len = colon;
+	  h->value_offset = value_start;
+	  h->value_len = value_end - value_start;
+	}
+
+      offset = next;
+    }
+
+  hp->head_len = next;
+  if (hp->content_length == ~0ULL)
+    hp->content_length = 0;
+
+  return HTTP_PARSE_OK;
+}
+
+static http_parse_rv_t
+http_parse_version (u8 *s, u32 len, http_parse_t *hp)
+{
+  if (len != 8 || memcmp (s, "HTTP/1.", 7) || s[7] < '0' || s[7] > '9')
+    return HTTP_PARSE_BAD_MSG;
+
+  hp->minor_version = s[7] - '0';
+  return HTTP_PARSE_OK;
+}
+
+/**
+ * Parse request start line and headers
+ *
+ * Parsing is done in place, request target and header table reference the
+ * data by offset. Only the message head needs to be available, caller uses
+ * head_len and content_length to find the end of the request.
+ */
+http_parse_rv_t
+http_parse_request (u8 *data, u32 len, http_parse_t *hp)
+{
+  u32 offset = 0, line_len, target;
+  int next, sp;
+
+  /* Ignore empty lines ahead of the request line */
+  while (offset < len && (data[offset] == '\r' || data[offset] == '\n'))
+    offset++;
+
+  next = http_parse_line (data, len, offset, &line_len);
+  if (next < 0)
+    return HTTP_PARSE_INCOMPLETE;
+
+  sp = http_find_byte (data + offset, line_len, ' ');
+  if (sp <= 0)
+    return HTTP_PARSE_BAD_MSG;
+
+#define _(m, s)                                                               \
+  if (sp == sizeof (s) - 1 && !memcmp (data + offset, s, sp))                 \
+    hp->method = HTTP_REQ_##m;                                                \
+  else
+  foreach_http_parse_method
+#undef _
+    return HTTP_PARSE_BAD_METHOD;
+
+  target = offset + sp + 1;
+  line_len -= sp + 1;
+  sp = http_find_byte (data + target, line_len, ' ');
+  if (sp <= 0)
+    return HTTP_PARSE_BAD_MSG;
+
+  if (http_parse_version (data + target + sp + 1, line_len - sp - 1, hp))
+    return HTTP_PARSE_BAD_MSG;
+
+  /* Apps expect the path without the leading slash */
+  hp->target_offset = target;
+  hp->target_len = sp;
+  if (data[target] == '/')
+    {
+      hp->target_offset += 1;
+      hp->target_len -= 1;
+    }
+
+  return http_parse_headers (data, len, next, hp);
+}
+
+/**
+ * Parse response status line and headers
+ */
+http_parse_rv_t
+http_parse_response (u8 *data, u32 len, http_parse_t *hp)
+{
+  u32 line_len;
+  u8 *code;
+  int next;
+
+  next = http_parse_line (data, len, 0, &line_len);
+  if (next < 0)
+    return HTTP_PARSE_INCOMPLETE;
+
+  /* HTTP/1.x SP 3DIGIT SP reason-phrase */
+  if (line_len < 12 || data[8] != ' ' ||
+      http_parse_version (data, 8, hp) != HTTP_PARSE_OK)
+    return HTTP_PARSE_BAD_MSG;
+
+  code = data + 9;
+  if (code[0] < '1' || code[0] > '5' || code[1] < '0' || code[1] > '9' ||
+      code[2] < '0' || code[2] > '9' || (line_len > 12 && code[3] != ' '))
+    return HTTP_PARSE_BAD_MSG;
+
+  hp->status_code =
+    (code[0] - '0') * 100 + (code[1] - '0') * 10 + (code[2] - '0');
+  hp->target_offset = hp->target_len = 0;
+
+  return http_parse_headers (data, len, next, hp);
+}
+
+/**
+ * Look up header in parsed message, name comparison is case insensitive
+ */
+http_parse_header_t *
+http_parse_header_find (http_parse_t *hp, u8 *data, char *name)
+{
+  http_parse_header_t *h;
+  int i;
+
+  for (i = 0; i < hp->n_headers; i++)
+    {
+      h = &hp->headers[i];
+      if (http_parse_token_is (data + h->name_offset, h->name_len, name))
+	return h;
+    }
+
+  return 0;
+}
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
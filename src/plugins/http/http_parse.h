@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2022 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_PLUGINS_HTTP_HTTP_PARSE_H_
+#define SRC_PLUGINS_HTTP_HTTP_PARSE_H_
+
+#include <vppinfra/clib.h>
+#include <vppinfra/vector.h>
+#include <http/http.h>
+
+#define HTTP_PARSE_MAX_HEADERS 32
+
+typedef enum http_parse_rv_
+{
+  HTTP_PARSE_OK = 0,
+  HTTP_PARSE_INCOMPLETE,   /**< message head not fully received yet */
+  HTTP_PARSE_BAD_MSG,	   /**< malformed start line or headers */
+  HTTP_PARSE_BAD_METHOD,   /**< request method not supported */
+  HTTP_PARSE_UNSUPPORTED,  /**< valid but unsupported, e.g. chunked body */
+} http_parse_rv_t;
+
+/* Offsets are relative to the start of the parsed message */
+typedef struct http_parse_header_
+{
+  u32 name_offset;
+  u32 name_len;
+  u32 value_offset;
+  u32 value_len;
+} http_parse_header_t;
+
+typedef struct http_parse_
+{
+  http_req_method_t method;	/**< request method */
+  u32 status_code;		/**< response status code */
+  u32 target_offset;		/**< request target, without leading '/' */
+  u32 target_len;
+  u32 head_len;			/**< start line and headers, incl. blank line */
+  u64 content_length;		/**< body length, 0 if none */
+  u8 minor_version;		/**< HTTP/1.x */
+  u8 connection_close;		/**< peer does not want a persistent conn */
+  u8 n_headers;
+  http_parse_header_t headers[HTTP_PARSE_MAX_HEADERS];
+} http_parse_t;
+
+/**
+ * Find first occurrence of byte in buffer
+ *
+ * @return index of the byte or -1 if not found
+ */
+static_always_inline int
+http_find_byte (u8 *data, u32 len, u8 byte)
+{
+  u32 i = 0;
+
+#if defined(CLIB_HAVE_VEC256)
+  u8x32 splat32 = u8x32_splat (byte);
+  for (; i + 32 <= len; i += 32)
+    {
+      u32 bmp;
+      bmp = u8x32_msb_mask (u8x32_load_unaligned (data + i) == splat32);
+      if (bmp)
+	return i + count_trailing_zeros (bmp);
+    }
+#endif
+#if defined(CLIB_HAVE_VEC128) && defined(CLIB_HAVE_VEC128_MSB_MASK)
+  u8x16 splat16 = u8x16_splat (byte);
+  for (; i + 16 <= len; i += 16)
+    {
+      u32 bmp;
+      bmp = u8x16_msb_mask (u8x16_load_unaligned (data + i) == splat16);
+      if (bmp)
+	return i + count_trailing_zeros (bmp);
+    }
+#endif
+  for (; i < len; i++)
+    if (data[i] == byte)
+      return i;
+
+  return -1;
+}
+
+http_parse_rv_t http_parse_request (u8 *data, u32 len, http_parse_t *hp);
+http_parse_rv_t http_parse_response (u8 *data, u32 len, http_parse_t *hp);
+http_parse_header_t *http_parse_header_find (http_parse_t *hp, u8 *data,
+					     char *name);
+
+#endif /* SRC_PLUGINS_HTTP_HTTP_PARSE_H_ */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
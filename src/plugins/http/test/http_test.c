@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2022 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vlib/vlib.h>
+#include <http/http_parse.h>
+
+#define HTTP_TEST_I(_cond, _comment, _args...)                                \
+  ({                                                                          \
+    int _evald = (_cond);                                                     \
+    if (!(_evald))                                                            \
+      {                                                                       \
+	fformat (stderr, "FAIL:%d: " _comment "\n", __LINE__, ##_args);       \
+      }                                                                       \
+    else                                                                      \
+      {                                                                       \
+	fformat (stderr, "PASS:%d: " _comment "\n", __LINE__, ##_args);       \
+      }                                                                       \
+    _evald;                                                                   \
+  })
+
+#define HTTP_TEST(_cond, _comment, _args...)                                  \
+  {                                                                           \
+    if (!HTTP_TEST_I (_cond, _comment, ##_args))                              \
+      {                                                                       \
+	return 1;                                                             \
+      }                                                                       \
+  }
+
+static int
+http_test_find_byte (vlib_main_t *vm, unformat_input_t *input)
+{
+  u8 data[100];
+  int i, j, rv;
+
+  /* Cover the 32 and 16 byte vector loops and the scalar tail */
+  clib_memset (data, 'a', sizeof (data));
+  for (i = 0; i <= sizeof (data); i++)
+    {
+      rv = http_find_byte (data, i, '\n');
+      HTTP_TEST ((rv == -1), "no match in %d bytes", i);
+      for (j = 0; j < i; j++)
+	{
+	  data[j] = '\n';
+	  rv = http_find_byte (data, i, '\n');
+	  data[j] = 'a';
+	  if (rv != j)
+	    break;
+	}
+      HTTP_TEST ((j == i), "match at every offset of %d bytes", i);
+    }
+
+  return 0;
+}
+
+static int
+http_test_parse_pipelined (vlib_main_t *vm, unformat_input_t *input)
+{
+  http_parse_header_t *h;
+  http_parse_t hp;
+  u8 *data = 0;
+  u32 offset;
+  int rv;
+
+  data = format (data,
+		 "GET /index.html HTTP/1.1\r\n"
+		 "Host: example.com\r\n"
+		 "User-Agent: a-user-agent-longer-than-one-vector\r\n"
+		 "\r\n"
+		 "POST /form HTTP/1.1\r\n"
+		 "Content-Length: 5\r\n"
+		 "Connection: close\r\n"
+		 "\r\n"
+		 "hello"
+		 "GET /last HTTP/1.0\r\n"
+		 "\r\n");
+
+  rv = http_parse_request (data, vec_len (data), &hp);
+  HTTP_TEST ((rv == HTTP_PARSE_OK), "first request should parse: %d", rv);
+  HTTP_TEST ((hp.method == HTTP_REQ_GET), "first request is a GET");
+  HTTP_TEST ((hp.target_len == 10 &&
+	      !memcmp (data + hp.target_offset, "index.html", 10)),
+	     "first target is index.html");
+  HTTP_TEST ((hp.content_length == 0), "first request has no body");
+  HTTP_TEST ((!hp.connection_close), "HTTP/1.1 is persistent by default");
+  h = http_parse_header_find (&hp, data, "user-agent");
+  HTTP_TEST ((h && h->value_len == 35), "user-agent header found");
+  offset = hp.head_len + hp.content_length;
+
+  rv = http_parse_request (data + offset, vec_len (data) - offset, &hp);
+  HTTP_TEST ((rv == HTTP_PARSE_OK), "second request should parse: %d", rv);
+  HTTP_TEST ((hp.method == HTTP_REQ_POST), "second request is a POST");
+  HTTP_TEST ((hp.content_length == 5), "second request has a 5 byte body");
+  HTTP_TEST ((hp.connection_close), "second request closes connection");
+  HTTP_TEST ((!memcmp (data + offset + hp.head_len, "hello", 5)),
+	     "body follows the head");
+  offset += hp.head_len + hp.content_length;
+
+  rv = http_parse_request (data + offset, vec_len (data) - offset, &hp);
+  HTTP_TEST ((rv == HTTP_PARSE_OK), "third request should parse: %d", rv);
+  HTTP_TEST ((hp.target_len == 4 &&
+	      !memcmp (data + offset + hp.target_offset, "last", 4)),
+	     "third target is last");
+  HTTP_TEST ((hp.connection_close), "HTTP/1.0 is not persistent");
+  HTTP_TEST ((offset + hp.head_len == vec_len (data)),
+	     "all requests consumed");
+
+  vec_free (data);
+  return 0;
+}
+
+static int
+http_test_parse_split (vlib_main_t *vm, unformat_input_t *input)
+{
+  http_parse_t hp;
+  u8 *data = 0;
+  u32 i, head_len;
+  int rv;
+
+  data = format (data, "POST /upload HTTP/1.1\r\n"
+		       "Host: example.com\r\n"
+		       "Content-Type: application/x-www-form-urlencoded\r\n"
+		       "Content-Length: 11\r\n"
+		       "\r\n");
+  head_len = vec_len (data);
+  data = format (data, "hello world");
+
+  /* Head received in two parts, split at every offset */
+  for (i = 0; i < head_len; i++)
+    {
+      rv = http_parse_request (data, i, &hp);
+      if (rv != HTTP_PARSE_INCOMPLETE)
+	break;
+    }
+  HTTP_TEST ((i == head_len), "partial head should be incomplete, %u/%u", i,
+	     head_len);
+
+  rv = http_parse_request (data, head_len, &hp);
+  HTTP_TEST ((rv == HTTP_PARSE_OK), "complete head should parse: %d", rv);
+  HTTP_TEST ((hp.head_len == head_len && hp.content_length == 11),
+	     "head and body length");
+
+  /* Bare LF line endings are accepted too */
+  vec_reset_length (data);
+  data = format (data, "GET / HTTP/1.1\nHost: example.com\n\n");
+  rv = http_parse_request (data, vec_len (data) - 1, &hp);
+  HTTP_TEST ((rv == HTTP_PARSE_INCOMPLETE), "LF head without blank line");
+  rv = http_parse_request (data, vec_len (data), &hp);
+  HTTP_TEST ((rv == HTTP_PARSE_OK && hp.head_len == vec_len (data)),
+	     "LF head should parse: %d", rv);
+
+  vec_free (data);
+  return 0;
+}
+
+static int
+http_test_parse_content_length (vlib_main_t *vm, unformat_input_t *input)
+{
+  char *bad[] = {
+    "99999999999999999999999", /* overflows u64 */
+    "1099511627777",	       /* above the parser limit */
+    "12a",
+    "-1",
+    "0x10",
+    "1 2",
+    "",
+  };
+  http_parse_t hp;
+  u8 *data = 0;
+  int i, rv;
+
+  for (i = 0; i < ARRAY_LEN (bad); i++)
+    {
+      vec_reset_length (data);
+      data = format (data, "POST / HTTP/1.1\r\nContent-Length: %s\r\n\r\n",
+		     bad[i]);
+      rv = http_parse_request (data, vec_len (data), &hp);
+      HTTP_TEST ((rv == HTTP_PARSE_BAD_MSG),
+		 "Content-Length '%s' should be rejected: %d", bad[i], rv);
+    }
+
+  vec_reset_length (data);
+  data = format (data, "POST / HTTP/1.1\r\nContent-Length: 1099511627776\r\n"
+		       "\r\n");
+  rv = http_parse_request (data, vec_len (data), &hp);
+  HTTP_TEST ((rv == HTTP_PARSE_OK && hp.content_length == 1ULL << 40),
+	     "Content-Length above 4GB should be kept as u64: %d", rv);
+
+  /* Conflicting lengths could be used to smuggle requests */
+  vec_reset_length (data);
+  data = format (data, "POST / HTTP/1.1\r\nContent-Length: 5\r\n"
+		       "Content-Length: 6\r\n\r\n");
+  rv = http_parse_request (data, vec_len (data), &hp);
+  HTTP_TEST ((rv == HTTP_PARSE_BAD_MSG), "conflicting lengths: %d", rv);
+
+  vec_reset_length (data);
+  data = format (data, "POST / HTTP/1.1\r\nContent-Length: 5\r\n"
+		       "content-length:  5 \r\n\r\n");
+  rv = http_parse_request (data, vec_len (data), &hp);
+  HTTP_TEST ((rv == HTTP_PARSE_OK && hp.content_length == 5),
+	     "repeated equal lengths: %d", rv);
+
+  vec_reset_length (data);
+  data = format (data, "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n"
+		       "\r\n");
+  rv = http_parse_request (data, vec_len (data), &hp);
+  HTTP_TEST ((rv == HTTP_PARSE_UNSUPPORTED), "transfer coding: %d", rv);
+
+  vec_reset_length (data);
+  data = format (data, "HTTP/1.1 200 OK\r\nContent-Length: 5000000000\r\n"
+		       "\r\n");
+  rv = http_parse_response (data, vec_len (data), &hp);
+  HTTP_TEST ((rv == HTTP_PARSE_OK && hp.status_code == 200 &&
+	      hp.content_length == 5000000000ULL),
+	     "response Content-Length above 4GB: %d", rv);
+
+  vec_free (data);
+  return 0;
+}
+
+static int
+http_test_parse_invalid (vlib_main_t *vm, unformat_input_t *input)
+{
+  char *bad[] = {
+    "GET\r\n\r\n",
+    "GET /\r\n\r\n",
+    "GET / HTTP/2.0\r\n\r\n",
+    "GET / HTTP/1.1\r\nHost example.com\r\n\r\n",
+    "GET / HTTP/1.1\r\nHost : example.com\r\n\r\n",
+    "GET / HTTP/1.1\r\nHost: example.com\r\n folded\r\n\r\n",
+  };
+  http_parse_t hp;
+  int i, rv;
+
+  for (i = 0; i < ARRAY_LEN (bad); i++)
+    {
+      rv = http_parse_request ((u8 *) bad[i], strlen (bad[i]), &hp);
+      HTTP_TEST ((rv == HTTP_PARSE_BAD_MSG), "request %d should be rejected",
+		 i);
+    }
+
+  rv = http_parse_request ((u8 *) "PUT / HTTP/1.1\r\n\r\n", 18, &hp);
+  HTTP_TEST ((rv == HTTP_PARSE_BAD_METHOD), "unsupported method: %d", rv);
+
+  return 0;
+}
+
+static clib_error_t *
+http_test (vlib_main_t *vm, unformat_input_t *input,
+	   vlib_cli_command_t *cmd_arg)
+{
+  int res = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "find-byte"))
+	res = http_test_find_byte (vm, input);
+      else if (unformat (input, "pipelined"))
+	res = http_test_parse_pipelined (vm, input);
+      else if (unformat (input, "split"))
+	res = http_test_parse_split (vm, input);
+      else if (unformat (input, "content-length"))
+	res = http_test_parse_content_length (vm, input);
+      else if (unformat (input, "invalid"))
+	res = http_test_parse_invalid (vm, input);
+      else if (unformat (input, "all"))
+	{
+	  if ((res = http_test_find_byte (vm, input)))
+	    goto done;
+	  if ((res = http_test_parse_pipelined (vm, input)))
+	    goto done;
+	  if ((res = http_test_parse_split (vm, input)))
+	    goto done;
+	  if ((res = http_test_parse_content_length (vm, input)))
+	    goto done;
+	  if ((res = http_test_parse_invalid (vm, input)))
+	    goto done;
+	}
+      else
+	break;
+    }
+
+done:
+  if (res)
+    return clib_error_return (0, "HTTP unit test failed");
+  return 0;
+}
+
+VLIB_CLI_COMMAND (http_test_command, static) = {
+  .path = "test http parser",
+  .short_help = "http parser unit tests",
+  .function = http_test,
+};
+
+#include <vlib/unix/plugin.h>
+#include <vpp/app/version.h>
+
+VLIB_PLUGIN_REGISTER () = {
+  .version = VPP_BUILD_VER,
+  .description = "HTTP - Unit Test",
+  .default_disabled = 1,
+};
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -174,6 +174,8 @@ memif_create_command_fn (vlib_main_t * vm, unformat_input_t * input,
 	args.is_zero_copy = 0;
       else if (unformat (line_input, "use-dma"))
 	args.use_dma = 1;
+      else if (unformat (line_input, "offload"))
+	args.offload = 1;
       else if (unformat (line_input, "mode ip"))
 	args.mode = MEMIF_INTERFACE_MODE_IP;
       else if (unformat (line_input, "hw-addr %U",
@@ -218,7 +220,7 @@ VLIB_CLI_COMMAND (memif_create_command, static) = {
                 "[ring-size <size>] [buffer-size <size>] "
 		"[hw-addr <mac-address>] "
 		"<master|slave> [rx-queues <number>] [tx-queues <number>] "
-		"[mode ip] [secret <string>]",
+		"[mode ip] [secret <string>] [offload]",
   .function = memif_create_command_fn,
 };
 /* *INDENT-ON* */
@@ -449,6 +451,8 @@ memif_show_command_fn (vlib_main_t * vm, unformat_input_t * input,
 		       "buffer-size %u num-regions %u",
 		       mif->run.num_s2m_rings, mif->run.num_m2s_rings,
 		       mif->run.buffer_size, vec_len (mif->regions));
+      if (mif->run.features & MEMIF_FEATURE_OFFLOAD)
+	vlib_cli_output (vm, "  offload negotiated");
 
       if (mif->local_disc_string)
 	vlib_cli_output (vm, "  local-disc-reason \"%s\"",
@@ -24,13 +24,17 @@
 #include <vlib/vlib.h>
 #include <vlib/unix/unix.h>
 #include <vnet/ethernet/ethernet.h>
+#include <vnet/ip/ip4_packet.h>
+#include <vnet/tcp/tcp_packet.h>
+#include <vnet/udp/udp_packet.h>
 
 #include <memif/memif.h>
 #include <memif/private.h>
 
 #define foreach_memif_tx_func_error                                           \
   _ (NO_FREE_SLOTS, no_free_slots, ERROR, "no free tx slots")                 \
-  _ (ROLLBACK, rollback, ERROR, "no enough space in tx buffers")
+  _ (ROLLBACK, rollback, ERROR, "no enough space in tx buffers")              \
+  _ (NO_HEADROOM, no_headroom, ERROR, "no headroom for offload header")
 
 typedef enum
 {
@@ -96,6 +100,48 @@ memif_add_copy_op (memif_per_thread_data_t * ptd, void *data, u32 len,
   co->buffer_vec_index = buffer_vec_index;
 }
 
+static_always_inline void
+memif_fill_offload_hdr (vlib_buffer_t *b, memif_offload_hdr_t *hdr)
+{
+  vnet_buffer_oflags_t oflags = 0;
+  int is_gso = (b->flags & VNET_BUFFER_F_GSO) != 0;
+
+  clib_memset (hdr, 0, sizeof (*hdr));
+
+  if (b->flags & VNET_BUFFER_F_OFFLOAD)
+    oflags = vnet_buffer (b)->oflags;
+
+  /* ip4 header checksum is cheap, compute it here */
+  if (oflags & VNET_BUFFER_OFFLOAD_F_IP_CKSUM)
+    {
+      ip4_header_t *ip4 =
+	(ip4_header_t *) (b->data + vnet_buffer (b)->l3_hdr_offset);
+      ip4->checksum = ip4_header_checksum (ip4);
+    }
+
+  if (!is_gso && !(oflags & (VNET_BUFFER_OFFLOAD_F_TCP_CKSUM |
+			     VNET_BUFFER_OFFLOAD_F_UDP_CKSUM)))
+    return;
+
+  hdr->flags = MEMIF_OFFLOAD_F_NEEDS_CSUM;
+  hdr->l3_offset = vnet_buffer (b)->l3_hdr_offset - b->current_data;
+  hdr->csum_start = vnet_buffer (b)->l4_hdr_offset - b->current_data;
+  if (oflags & VNET_BUFFER_OFFLOAD_F_UDP_CKSUM)
+    hdr->csum_offset = STRUCT_OFFSET_OF (udp_header_t, checksum);
+  else
+    hdr->csum_offset = STRUCT_OFFSET_OF (tcp_header_t, checksum);
+
+  /* only tcp segmentation is advertised */
+  if (is_gso && !(oflags & VNET_BUFFER_OFFLOAD_F_UDP_CKSUM))
+    {
+      hdr->gso_type = (b->flags & VNET_BUFFER_F_IS_IP4) ?
+			MEMIF_OFFLOAD_GSO_TCPV4 :
+			MEMIF_OFFLOAD_GSO_TCPV6;
+      hdr->gso_size = vnet_buffer2 (b)->gso_size;
+      hdr->hdr_len = hdr->csum_start + vnet_buffer2 (b)->gso_l4_hdr_sz;
+    }
+}
+
 static_always_inline uword
 memif_interface_tx_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 			   u32 *buffers, memif_if_t *mif,
@@ -111,6 +157,7 @@ memif_interface_tx_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   memif_region_index_t last_region = ~0;
   void *last_region_shm = 0;
   u16 head, tail;
+  int offload = (mif->run.features & MEMIF_FEATURE_OFFLOAD) != 0;
 
   ring = mq->ring;
   ring_size = 1 << mq->log2_ring_size;
@@ -162,6 +209,13 @@ retry:
 	vlib_prefetch_buffer_header (vlib_get_buffer (vm, buffers[3]), LOAD);
       bi0 = buffers[0];
 
+      if (PREDICT_FALSE (offload))
+	{
+	  memif_fill_offload_hdr (vlib_get_buffer (vm, bi0), mb0);
+	  dst_off += sizeof (memif_offload_hdr_t);
+	  dst_left -= sizeof (memif_offload_hdr_t);
+	}
+
     next_in_chain:
 
       b0 = vlib_get_buffer (vm, bi0);
@@ -291,6 +345,7 @@ memif_interface_tx_zc_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   int n_retries = 5;
   vlib_buffer_t *b0;
   u16 head, tail;
+  int offload = (mif->run.features & MEMIF_FEATURE_OFFLOAD) != 0;
 
 retry:
   tail = __atomic_load_n (&ring->tail, __ATOMIC_ACQUIRE);
@@ -321,6 +376,27 @@ retry:
 
       bi0 = buffers[0];
 
+      if (PREDICT_FALSE (offload))
+	{
+	  /* prepend the header in the buffer headroom, drop if it is used up */
+	  memif_offload_hdr_t hdr;
+	  b0 = vlib_get_buffer (vm, bi0);
+	  if (PREDICT_FALSE (b0->current_data - (i16) sizeof (hdr) <
+			     -VLIB_BUFFER_PRE_DATA_SIZE))
+	    {
+	      vlib_buffer_free_one (vm, bi0);
+	      vlib_error_count (vm, node->node_index,
+				MEMIF_TX_ERROR_NO_HEADROOM, 1);
+	      buffers++;
+	      n_left--;
+	      continue;
+	    }
+	  memif_fill_offload_hdr (b0, &hdr);
+	  b0->current_data -= sizeof (hdr);
+	  b0->current_length += sizeof (hdr);
+	  clib_memcpy_fast (vlib_buffer_get_current (b0), &hdr, sizeof (hdr));
+	}
+
     next_in_chain:
       s0 = slot & mask;
       d0 = &ring->desc[s0];
@@ -342,6 +418,12 @@ retry:
 	      /* revert to last fully processed packet */
 	      free_slots += slots_in_packet;
 	      slot -= slots_in_packet;
+	      if (PREDICT_FALSE (offload))
+		{
+		  b0 = vlib_get_buffer (vm, buffers[0]);
+		  b0->current_data += sizeof (memif_offload_hdr_t);
+		  b0->current_length -= sizeof (memif_offload_hdr_t);
+		}
 	      goto no_free_slots;
 	    }
 
@@ -119,7 +119,10 @@ memif_disconnect (memif_if_t * mif, clib_error_t * err)
   /* set interface down */
   mif->flags &= ~(MEMIF_IF_FLAG_CONNECTED | MEMIF_IF_FLAG_CONNECTING);
   if (mif->hw_if_index != ~0)
-    vnet_hw_interface_set_flags (vnm, mif->hw_if_index, 0);
+    {
+      vnet_hw_interface_set_flags (vnm, mif->hw_if_index, 0);
+      vnet_hw_if_unset_caps (vnm, mif->hw_if_index, MEMIF_OFFLOAD_CAPS);
+    }
 
   /* close connection socket */
   if (mif->sock && mif->sock->fd)
@@ -440,6 +443,20 @@ memif_connect (memif_if_t * mif)
 				CLIB_CACHE_LINE_BYTES);
 	}
     }
+
+  if (mif->run.features & MEMIF_FEATURE_OFFLOAD)
+    {
+      memif_per_thread_data_t *ptd;
+
+      vec_foreach (ptd, mm->per_thread_data)
+	vec_validate_aligned (ptd->offload_hdrs, MEMIF_RX_VECTOR_SZ - 1,
+			      CLIB_CACHE_LINE_BYTES);
+      /* peer takes care of checksums and segmentation */
+      vnet_hw_if_set_caps (vnm, mif->hw_if_index, MEMIF_OFFLOAD_CAPS);
+    }
+  else
+    vnet_hw_if_unset_caps (vnm, mif->hw_if_index, MEMIF_OFFLOAD_CAPS);
+
   if (with_barrier)
     vlib_worker_thread_barrier_release (vm);
 
@@ -996,6 +1013,13 @@ memif_create_if (vlib_main_t *vm, memif_create_if_args_t *args)
 
   msf = vec_elt_at_index (mm->socket_files, p[0]);
 
+  if (args->offload && args->use_dma)
+    {
+      err = vnet_error (VNET_ERR_INVALID_ARGUMENT,
+			"offload is not supported together with dma");
+      goto done;
+    }
+
   /* existing socket file can be either master or slave but cannot be both */
   if (msf->ref_cnt > 0)
     {
@@ -1166,6 +1190,9 @@ memif_create_if (vlib_main_t *vm, memif_create_if_args_t *args)
   if (args->use_dma)
     mif->flags |= MEMIF_IF_FLAG_USE_DMA;
 
+  if (args->offload)
+    mif->flags |= MEMIF_IF_FLAG_OFFLOAD;
+
   vnet_hw_if_set_caps (vnm, mif->hw_if_index, VNET_HW_IF_CAP_INT_MODE);
   vnet_hw_if_set_input_node (vnm, mif->hw_if_index, memif_input_node.index);
   mhash_set (&msf->dev_instance_by_id, &mif->id, mif->dev_instance, 0);
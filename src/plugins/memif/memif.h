@@ -66,6 +66,14 @@ typedef uint16_t memif_ring_index_t;
 typedef uint32_t memif_interface_id_t;
 typedef uint16_t memif_version_t;
 typedef uint8_t memif_log2_ring_size_t;
+typedef uint32_t memif_features_t;
+
+/*
+ *  Protocol features, advertised by master in hello, requested by slave in
+ *  init and granted by master in connected message
+ */
+
+#define MEMIF_FEATURE_OFFLOAD (1 << 0) /* descriptors carry offload header */
 
 /*
  *  Socket messages
@@ -80,6 +88,7 @@ typedef struct __attribute__ ((packed))
   memif_ring_index_t max_m2s_ring;
   memif_ring_index_t max_s2m_ring;
   memif_log2_ring_size_t max_log2_ring_size;
+  memif_features_t features;
 } memif_msg_hello_t;
 
 typedef struct __attribute__ ((packed))
@@ -89,6 +98,7 @@ typedef struct __attribute__ ((packed))
   memif_interface_mode_t mode:8;
   uint8_t secret[MEMIF_SECRET_SIZE];
   uint8_t name[32];
+  memif_features_t features;
 } memif_msg_init_t;
 
 typedef struct __attribute__ ((packed))
@@ -116,6 +126,7 @@ typedef struct __attribute__ ((packed))
 typedef struct __attribute__ ((packed))
 {
   uint8_t if_name[32];
+  memif_features_t features;
 } memif_msg_connected_t;
 
 typedef struct __attribute__ ((packed))
@@ -159,6 +170,31 @@ typedef struct __attribute__ ((packed))
 _Static_assert (sizeof (memif_desc_t) == 16,
 		"Size of memif_dsct_t must be 16 bytes");
 
+/*
+ * With MEMIF_FEATURE_OFFLOAD, data of the first descriptor of each packet
+ * starts with this header, modelled after virtio_net_hdr. All offsets are
+ * relative to the start of the packet, following the header.
+ */
+
+typedef struct __attribute__ ((packed))
+{
+  uint8_t flags;
+#define MEMIF_OFFLOAD_F_NEEDS_CSUM (1 << 0) /* l4 checksum not computed */
+  uint8_t gso_type;
+#define MEMIF_OFFLOAD_GSO_NONE	0
+#define MEMIF_OFFLOAD_GSO_TCPV4 1
+#define MEMIF_OFFLOAD_GSO_TCPV6 4
+  uint16_t hdr_len;	/* l2 + l3 + l4 header length, for gso */
+  uint16_t gso_size;	/* segment payload size */
+  uint16_t csum_start;	/* l4 header offset */
+  uint16_t csum_offset; /* checksum offset from csum_start */
+  uint16_t l3_offset;
+  uint32_t reserved;
+} memif_offload_hdr_t;
+
+_Static_assert (sizeof (memif_offload_hdr_t) == 16,
+		"Size of memif_offload_hdr_t must be 16 bytes");
+
 #define MEMIF_CACHELINE_ALIGN_MARK(mark) \
   uint8_t mark[0] __attribute__((aligned(MEMIF_CACHELINE_SIZE)))
 
@@ -26,6 +26,7 @@
 #include <vnet/ethernet/ethernet.h>
 #include <vnet/interface/rx_queue_funcs.h>
 #include <vnet/feature/feature.h>
+#include <vnet/udp/udp_packet.h>
 
 #include <memif/memif.h>
 #include <memif/private.h>
@@ -105,6 +106,47 @@ memif_trace_buffer (vlib_main_t * vm, vlib_node_runtime_t * node,
     }
 }
 
+static_always_inline void
+memif_offload_hdr_to_buffer (vlib_buffer_t *b, memif_offload_hdr_t *hdr)
+{
+  vnet_buffer_oflags_t oflags;
+  u8 *data = vlib_buffer_get_current (b);
+
+  if (PREDICT_TRUE (!(hdr->flags & MEMIF_OFFLOAD_F_NEEDS_CSUM)))
+    return;
+
+  /* ignore headers pointing past the first buffer */
+  if (PREDICT_FALSE (hdr->csum_start <= hdr->l3_offset ||
+		     hdr->csum_start + hdr->csum_offset + sizeof (u16) >
+		       b->current_length))
+    return;
+
+  vnet_buffer (b)->l2_hdr_offset = b->current_data;
+  vnet_buffer (b)->l3_hdr_offset = b->current_data + hdr->l3_offset;
+  vnet_buffer (b)->l4_hdr_offset = b->current_data + hdr->csum_start;
+  b->flags |= VNET_BUFFER_F_L2_HDR_OFFSET_VALID |
+	      VNET_BUFFER_F_L3_HDR_OFFSET_VALID |
+	      VNET_BUFFER_F_L4_HDR_OFFSET_VALID;
+  b->flags |= ((data[hdr->l3_offset] & 0xf0) == 0x40) ? VNET_BUFFER_F_IS_IP4 :
+							  VNET_BUFFER_F_IS_IP6;
+
+  /* data comes from local memory, the checksum is filled in on the way out */
+  b->flags |=
+    VNET_BUFFER_F_L4_CHECKSUM_COMPUTED | VNET_BUFFER_F_L4_CHECKSUM_CORRECT;
+  oflags = (hdr->csum_offset == STRUCT_OFFSET_OF (udp_header_t, checksum)) ?
+	     VNET_BUFFER_OFFLOAD_F_UDP_CKSUM :
+	     VNET_BUFFER_OFFLOAD_F_TCP_CKSUM;
+  vnet_buffer_offload_flags_set (b, oflags);
+
+  if (hdr->gso_type != MEMIF_OFFLOAD_GSO_NONE && hdr->gso_size &&
+      hdr->hdr_len > hdr->csum_start)
+    {
+      vnet_buffer2 (b)->gso_size = hdr->gso_size;
+      vnet_buffer2 (b)->gso_l4_hdr_sz = hdr->hdr_len - hdr->csum_start;
+      b->flags |= VNET_BUFFER_F_GSO;
+    }
+}
+
 static_always_inline void
 memif_add_copy_op (memif_per_thread_data_t * ptd, void *data, u32 len,
 		   u16 buffer_offset, u16 buffer_vec_index)
@@ -235,7 +277,7 @@ memif_validate_desc_data (memif_per_thread_data_t *ptd, memif_if_t *mif,
 
 static_always_inline u32
 memif_process_desc (vlib_main_t *vm, vlib_node_runtime_t *node,
-		    memif_per_thread_data_t *ptd, memif_if_t *mif)
+		    memif_per_thread_data_t *ptd, memif_if_t *mif, int offload)
 {
   u16 buffer_size = vlib_buffer_get_default_data_size (vm);
   int is_ip = mif->mode == MEMIF_INTERFACE_MODE_IP;
@@ -261,11 +303,26 @@ memif_process_desc (vlib_main_t *vm, vlib_node_runtime_t *node,
       src_off = 0;
       dst_off = start_offset;
 
+      if (PREDICT_FALSE (offload) && !desc_status[i + 1].err)
+	{
+	  /* first descriptor starts with the offload header */
+	  if (PREDICT_FALSE (desc_len[i + 1] < sizeof (memif_offload_hdr_t)))
+	    memif_desc_status_set_err (desc_status + i + 1,
+				       MEMIF_DESC_STATUS_ERR_ZERO_LENGTH);
+	  else
+	    {
+	      clib_memcpy_fast (ptd->offload_hdrs + (po - ptd->packet_ops),
+				desc_data[i + 1], sizeof (memif_offload_hdr_t));
+	      src_off = sizeof (memif_offload_hdr_t);
+	      packet_len -= sizeof (memif_offload_hdr_t);
+	    }
+	}
+
     next_slot:
       i++; /* next descriptor */
-      n_bytes_left = desc_len[i];
+      n_bytes_left = desc_len[i] - src_off;
 
-      packet_len += n_bytes_left;
+      packet_len += desc_len[i];
       mb0 = desc_data[i];
 
       if (PREDICT_FALSE (desc_status[i].err))
@@ -512,6 +569,7 @@ memif_device_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   i16 start_offset;
   memif_copy_op_t *co;
   int is_slave = (mif->flags & MEMIF_IF_FLAG_IS_SLAVE) != 0;
+  int offload = (mif->run.features & MEMIF_FEATURE_OFFLOAD) != 0;
   int is_simple = 1;
   int i;
 
@@ -557,10 +615,19 @@ memif_device_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   if (ptd->xor_status != 0)
     is_simple = 0;
 
+  /* offload header needs to be stripped */
+  if (offload)
+    is_simple = 0;
+
   if (is_simple)
     n_buffers = ptd->n_packets;
+  else if (offload)
+    {
+      n_buffers = memif_process_desc (vm, node, ptd, mif, /* offload */ 1);
+      ptd->n_rx_bytes -= ptd->n_packets * sizeof (memif_offload_hdr_t);
+    }
   else
-    n_buffers = memif_process_desc (vm, node, ptd, mif);
+    n_buffers = memif_process_desc (vm, node, ptd, mif, /* offload */ 0);
 
   if (PREDICT_FALSE (n_buffers == 0))
     {
@@ -677,6 +744,11 @@ memif_device_input_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	memif_fill_buffer_mdata (vm, node, ptd, mif, to_next_bufs, nexts, 0);
     }
 
+  if (offload)
+    for (i = 0; i < ptd->n_packets; i++)
+      memif_offload_hdr_to_buffer (vlib_get_buffer (vm, to_next_bufs[i]),
+				   ptd->offload_hdrs + i);
+
   /* packet trace if enabled */
   if (PREDICT_FALSE ((n_trace = vlib_get_trace_count (vm, node))))
     {
@@ -770,6 +842,7 @@ memif_device_input_zc_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   u64 offset;
   u32 buffer_length;
   u16 n_alloc, n_from;
+  int offload = (mif->run.features & MEMIF_FEATURE_OFFLOAD) != 0;
 
   mq = vec_elt_at_index (mif->rx_queues, qid);
   ring = mq->ring;
@@ -806,7 +879,21 @@ memif_device_input_zc_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
       hb = b0 = vlib_get_buffer (vm, bi0);
       b0->current_data = start_offset;
       b0->current_length = d0->length;
-      n_rx_bytes += d0->length;
+
+      if (PREDICT_FALSE (offload))
+	{
+	  memif_offload_hdr_t *hdr = ptd->offload_hdrs + n_rx_packets - 1;
+	  if (PREDICT_TRUE (b0->current_length >= sizeof (*hdr)))
+	    {
+	      clib_memcpy_fast (hdr, vlib_buffer_get_current (b0),
+				sizeof (*hdr));
+	      b0->current_data += sizeof (*hdr);
+	      b0->current_length -= sizeof (*hdr);
+	    }
+	  else
+	    clib_memset (hdr, 0, sizeof (*hdr));
+	}
+      n_rx_bytes += b0->current_length;
 
       cur_slot++;
       n_slots--;
@@ -840,6 +927,11 @@ memif_device_input_zc_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   /* release slots from the ring */
   mq->last_tail = cur_slot;
 
+  if (offload)
+    for (u32 i = 0; i < n_rx_packets; i++)
+      memif_offload_hdr_to_buffer (vlib_get_buffer (vm, ptd->buffers[i]),
+				   ptd->offload_hdrs + i);
+
   n_from = n_rx_packets;
   buffers = ptd->buffers;
 
@@ -1235,7 +1327,7 @@ memif_device_input_inline_dma (vlib_main_t *vm, vlib_node_runtime_t *node,
     memif_validate_desc_data (&dma_info->data, mif, n_desc,
 			      /* is_ethernet */ 0);
 
-  n_buffers = memif_process_desc (vm, node, ptd, mif);
+  n_buffers = memif_process_desc (vm, node, ptd, mif, /* offload */ 0);
 
   if (PREDICT_FALSE (n_buffers == 0))
     {
@@ -30,6 +30,8 @@
 #define MEMIF_MAX_REGION		256
 #define MEMIF_MAX_LOG2_RING_SIZE	14
 
+#define MEMIF_OFFLOAD_CAPS (VNET_HW_IF_CAP_TX_CKSUM | VNET_HW_IF_CAP_TCP_GSO)
+
 
 #define memif_log_debug(dev, f, ...) do {                               \
   memif_if_t *_dev = (memif_if_t *) dev;                                \
@@ -168,7 +170,8 @@ typedef struct
   _ (4, DELETING, "deleting")                                                 \
   _ (5, ZERO_COPY, "zero-copy")                                               \
   _ (6, ERROR, "error")                                                       \
-  _ (7, USE_DMA, "use_dma")
+  _ (7, USE_DMA, "use_dma")                                                   \
+  _ (8, OFFLOAD, "offload")
 
 typedef enum
 {
@@ -218,6 +221,7 @@ typedef struct
     u8 num_s2m_rings;
     u8 num_m2s_rings;
     u16 buffer_size;
+    memif_features_t features;
   } run;
 
   /* disconnect strings */
@@ -284,6 +288,9 @@ typedef struct
   u16 *desc_len;
   memif_desc_status_t *desc_status;
 
+  /* offload headers of received packets */
+  memif_offload_hdr_t *offload_hdrs;
+
   /* buffer template */
   vlib_buffer_t buffer_template;
 } memif_per_thread_data_t;
@@ -339,6 +346,7 @@ typedef struct
   u8 is_master;
   u8 is_zero_copy;
   u8 use_dma;
+  u8 offload;
   memif_interface_mode_t mode:8;
   memif_log2_ring_size_t log2_ring_size;
   u16 buffer_size;
@@ -108,6 +108,7 @@ memif_msg_enq_hello (clib_socket_t * sock)
   h->max_s2m_ring = MEMIF_MAX_S2M_RING;
   h->max_region = MEMIF_MAX_REGION;
   h->max_log2_ring_size = MEMIF_MAX_LOG2_RING_SIZE;
+  h->features = MEMIF_FEATURE_OFFLOAD;
   memif_msg_snprintf (h->name, sizeof (h->name), "VPP %s", VPP_BUILD_VER);
   return clib_socket_sendmsg (sock, &msg, sizeof (memif_msg_t), 0, 0);
 }
@@ -124,6 +125,7 @@ memif_msg_enq_init (memif_if_t * mif)
   i->version = MEMIF_VERSION;
   i->id = mif->id;
   i->mode = mif->mode;
+  i->features = mif->run.features;
   memif_msg_snprintf (i->name, sizeof (i->name), "VPP %s", VPP_BUILD_VER);
   if (mif->secret)
     memif_msg_strlcpy (i->secret, sizeof (i->secret), mif->secret);
@@ -190,6 +192,7 @@ memif_msg_enq_connected (memif_if_t * mif)
 
   e->msg.type = MEMIF_MSG_TYPE_CONNECTED;
   e->fd = -1;
+  c->features = mif->run.features;
   memif_msg_snprintf (c->if_name, sizeof (c->if_name), "%U",
 		      format_memif_device_name, mif->dev_instance);
 }
@@ -224,6 +227,11 @@ memif_msg_receive_hello (memif_if_t * mif, memif_msg_t * msg)
 				      mif->cfg.log2_ring_size);
   mif->run.buffer_size = mif->cfg.buffer_size;
 
+  /* request the features master supports and we want */
+  mif->run.features = 0;
+  if (mif->flags & MEMIF_IF_FLAG_OFFLOAD)
+    mif->run.features |= h->features & MEMIF_FEATURE_OFFLOAD;
+
   mif->remote_name = memif_str2vec (h->name, sizeof (h->name));
 
   return 0;
@@ -275,6 +283,11 @@ memif_msg_receive_init (memif_if_t ** mifp, memif_msg_t * msg,
       goto error;
     }
 
+  /* grant the requested features which are enabled here */
+  mif->run.features = 0;
+  if (mif->flags & MEMIF_IF_FLAG_OFFLOAD)
+    mif->run.features |= i->features & MEMIF_FEATURE_OFFLOAD;
+
   mif->sock = sock;
   hash_set (msf->dev_instance_by_fd, mif->sock->fd, mif->dev_instance);
   mif->remote_name = memif_str2vec (i->name, sizeof (i->name));
@@ -397,6 +410,8 @@ memif_msg_receive_connected (memif_if_t * mif, memif_msg_t * msg)
   clib_error_t *err;
   memif_msg_connected_t *c = &msg->connected;
 
+  mif->run.features &= c->features;
+
   if ((err = memif_connect (mif)))
     return err;
 
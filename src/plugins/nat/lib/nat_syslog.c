@@ -90,6 +90,57 @@ nat_syslog_nat44_apmdel (u32 ssubix, u32 sfibix, ip4_address_t * isaddr,
 			  proto, 0, 0);
 }
 
+static inline void
+nat_syslog_nat44_port_block (u32 sfibix, ip4_address_t *isaddr,
+			     ip4_address_t *xsaddr, u16 start_port,
+			     u16 end_port, u8 is_add)
+{
+  syslog_msg_t syslog_msg;
+  fib_table_t *fib;
+
+  if (!syslog_is_enabled ())
+    return;
+
+  if (syslog_severity_filter_block (APMADD_APMDEL_SEVERITY))
+    return;
+
+  syslog_msg_init (&syslog_msg, NAT_FACILITY, APMADD_APMDEL_SEVERITY,
+		   NAT_APPNAME, is_add ? APMADD_MSGID : APMDEL_MSGID);
+
+  syslog_msg_sd_init (&syslog_msg, NAPMAP_SDID);
+  syslog_msg_add_sd_param (&syslog_msg, SSUBIX_SDPARAM_NAME, "%d", 0);
+  fib = fib_table_get (sfibix, FIB_PROTOCOL_IP4);
+  syslog_msg_add_sd_param (&syslog_msg, SVLAN_SDPARAM_NAME, "%d",
+			   fib->ft_table_id);
+  syslog_msg_add_sd_param (&syslog_msg, IATYP_SDPARAM_NAME, IATYP_IPV4);
+  syslog_msg_add_sd_param (&syslog_msg, ISADDR_SDPARAM_NAME, "%U",
+			   format_ip4_address, isaddr);
+  syslog_msg_add_sd_param (&syslog_msg, XATYP_SDPARAM_NAME, IATYP_IPV4);
+  syslog_msg_add_sd_param (&syslog_msg, XSADDR_SDPARAM_NAME, "%U",
+			   format_ip4_address, xsaddr);
+  /* the whole block is reported as a port range */
+  syslog_msg_add_sd_param (&syslog_msg, XSPORT_SDPARAM_NAME, "%d-%d",
+			   start_port, end_port);
+
+  syslog_msg_send (&syslog_msg);
+}
+
+void
+nat_syslog_nat44_pbadd (u32 sfibix, ip4_address_t *isaddr,
+			ip4_address_t *xsaddr, u16 start_port, u16 end_port)
+{
+  nat_syslog_nat44_port_block (sfibix, isaddr, xsaddr, start_port, end_port,
+			       1);
+}
+
+void
+nat_syslog_nat44_pbdel (u32 sfibix, ip4_address_t *isaddr,
+			ip4_address_t *xsaddr, u16 start_port, u16 end_port)
+{
+  nat_syslog_nat44_port_block (sfibix, isaddr, xsaddr, start_port, end_port,
+			       0);
+}
+
 void
 nat_syslog_dslite_apmadd (u32 ssubix, ip6_address_t * sv6enc,
 			  ip4_address_t * isaddr, u16 isport,
@@ -224,6 +224,13 @@ nat44_ed_free_session_data (snat_main_t *sm, snat_session_t *s,
     nat_affinity_unlock (s->ext_host_addr, s->out2in.addr, s->proto,
 			 s->out2in.port);
 
+  if (nat44_ed_is_port_block_session (s))
+    {
+      /* logged per port block, not per session */
+      nat44_ed_port_block_session_del (sm, s, thread_index);
+      return;
+    }
+
   if (!is_ha)
     nat_syslog_nat44_sdel (0, s->in2out.fib_index, &s->in2out.addr,
 			   s->in2out.port, &s->ext_host_nat_addr,
@@ -240,6 +247,138 @@ nat44_ed_free_session_data (snat_main_t *sm, snat_session_t *s,
     }
 }
 
+nat44_ed_port_block_t *
+nat44_ed_port_block_get (snat_main_t *sm, u32 thread_index, snat_session_t *s,
+			 ip4_address_t out_addr)
+{
+  snat_main_per_thread_data_t *tsm =
+    vec_elt_at_index (sm->per_thread_data, thread_index);
+  nat44_ed_port_block_address_t *pa;
+  nat44_ed_port_block_key_t key;
+  nat44_ed_port_block_t *pb;
+  u32 n_blocks, block_index;
+  uword *p;
+
+  key.in_addr = s->in2out.addr;
+  key.in_fib_index = s->in2out.fib_index;
+  key.out_addr = out_addr;
+
+  p = hash_get_mem (tsm->port_block_index_by_key, &key);
+  if (p)
+    return pool_elt_at_index (tsm->port_blocks, p[0]);
+
+  n_blocks = sm->port_per_thread / sm->port_block_size;
+  if (!n_blocks)
+    return 0;
+
+  p = hash_get (tsm->port_block_address_index_by_addr, out_addr.as_u32);
+  if (p)
+    {
+      pa = pool_elt_at_index (tsm->port_block_addresses, p[0]);
+    }
+  else
+    {
+      pool_get_zero (tsm->port_block_addresses, pa);
+      pa->addr = out_addr;
+      hash_set (tsm->port_block_address_index_by_addr, out_addr.as_u32,
+		pa - tsm->port_block_addresses);
+    }
+
+  block_index = clib_bitmap_first_clear (pa->busy_blocks);
+  if (block_index >= n_blocks)
+    return 0;
+  pa->busy_blocks = clib_bitmap_set (pa->busy_blocks, block_index, 1);
+
+  pool_get_zero (tsm->port_blocks, pb);
+  pb->key = key;
+  pb->block_index = block_index;
+  pb->start_port = ED_USER_PORT_OFFSET +
+		   sm->port_per_thread * tsm->snat_thread_index +
+		   block_index * sm->port_block_size;
+  pb->end_port = pb->start_port + sm->port_block_size - 1;
+  hash_set_mem_alloc (&tsm->port_block_index_by_key, &pb->key,
+		      pb - tsm->port_blocks);
+
+  nat_ipfix_logging_nat44_port_block_alloc (
+    thread_index, key.in_addr.as_u32, out_addr.as_u32, pb->start_port,
+    pb->end_port, key.in_fib_index);
+  nat_syslog_nat44_pbadd (key.in_fib_index, &key.in_addr, &key.out_addr,
+			  pb->start_port, pb->end_port);
+
+  return pb;
+}
+
+static void
+nat44_ed_port_block_log_free (u32 thread_index, nat44_ed_port_block_t *pb)
+{
+  nat_ipfix_logging_nat44_port_block_dealloc (
+    thread_index, pb->key.in_addr.as_u32, pb->key.out_addr.as_u32,
+    pb->start_port, pb->end_port, pb->key.in_fib_index);
+  nat_syslog_nat44_pbdel (pb->key.in_fib_index, &pb->key.in_addr,
+			  &pb->key.out_addr, pb->start_port, pb->end_port);
+}
+
+void
+nat44_ed_port_block_free (snat_main_t *sm, u32 thread_index,
+			  nat44_ed_port_block_t *pb)
+{
+  snat_main_per_thread_data_t *tsm =
+    vec_elt_at_index (sm->per_thread_data, thread_index);
+  nat44_ed_port_block_address_t *pa;
+  uword *p;
+
+  ASSERT (pb->n_sessions == 0);
+
+  nat44_ed_port_block_log_free (thread_index, pb);
+
+  p = hash_get (tsm->port_block_address_index_by_addr,
+		pb->key.out_addr.as_u32);
+  if (p)
+    {
+      pa = pool_elt_at_index (tsm->port_block_addresses, p[0]);
+      pa->busy_blocks =
+	clib_bitmap_set (pa->busy_blocks, pb->block_index, 0);
+      if (clib_bitmap_is_zero (pa->busy_blocks))
+	{
+	  hash_unset (tsm->port_block_address_index_by_addr,
+		      pa->addr.as_u32);
+	  clib_bitmap_free (pa->busy_blocks);
+	  pool_put (tsm->port_block_addresses, pa);
+	}
+    }
+
+  hash_unset_mem_free (&tsm->port_block_index_by_key, &pb->key);
+  pool_put (tsm->port_blocks, pb);
+}
+
+void
+nat44_ed_port_block_session_del (snat_main_t *sm, snat_session_t *s,
+				 u32 thread_index)
+{
+  snat_main_per_thread_data_t *tsm =
+    vec_elt_at_index (sm->per_thread_data, thread_index);
+  nat44_ed_port_block_key_t key;
+  nat44_ed_port_block_t *pb;
+  uword *p;
+
+  key.in_addr = s->in2out.addr;
+  key.in_fib_index = s->in2out.fib_index;
+  key.out_addr = s->out2in.addr;
+
+  s->flags &= ~SNAT_SESSION_FLAG_PORT_BLOCK;
+
+  p = hash_get_mem (tsm->port_block_index_by_key, &key);
+  if (!p)
+    {
+      nat_elog_warn (sm, "port block not found");
+      return;
+    }
+  pb = pool_elt_at_index (tsm->port_blocks, p[0]);
+  ASSERT (pb->n_sessions > 0);
+  if (--pb->n_sessions == 0)
+    nat44_ed_port_block_free (sm, thread_index, pb);
+}
+
 static ip_interface_address_t *
 nat44_ed_get_ip_interface_address (u32 sw_if_index, ip4_address_t addr)
 {
@@ -2431,8 +2570,17 @@ nat44_plugin_enable (nat44_config_t c)
 
   fail_if_enabled ();
 
+  /* each worker carves the blocks out of its own port range */
+  if (c.port_block_size > sm->port_per_thread)
+    {
+      nat_log_err ("port block size exceeds ports per thread (%u)",
+		   sm->port_per_thread);
+      return VNET_API_ERROR_INVALID_VALUE;
+    }
+
   sm->forwarding_enabled = 0;
   sm->mss_clamping = 0;
+  sm->port_block_size = c.port_block_size;
 
   if (!c.sessions)
     c.sessions = 63 * 1024;
@@ -2697,6 +2845,7 @@ nat44_plugin_disable ()
   nat44_ed_db_free ();
 
   clib_memset (&sm->rconfig, 0, sizeof (sm->rconfig));
+  sm->port_block_size = 0;
 
   nat_affinity_disable ();
 
@@ -3281,6 +3430,10 @@ nat44_ed_worker_db_init (snat_main_per_thread_data_t *tsm, u32 translations)
   pool_alloc (tsm->sessions, translations);
   pool_alloc (tsm->lru_pool, translations);
 
+  tsm->port_block_index_by_key =
+    hash_create_mem (0, sizeof (nat44_ed_port_block_key_t), sizeof (uword));
+  tsm->port_block_address_index_by_addr = hash_create (0, sizeof (uword));
+
   pool_get (tsm->lru_pool, head);
   tsm->tcp_trans_lru_head_index = head - tsm->lru_pool;
   clib_dlist_init (tsm->lru_pool, tsm->tcp_trans_lru_head_index);
@@ -3330,9 +3483,28 @@ nat44_ed_db_init ()
 static void
 nat44_ed_worker_db_free (snat_main_per_thread_data_t *tsm)
 {
+  u32 thread_index = tsm - snat_main.per_thread_data;
+  nat44_ed_port_block_address_t *pa;
+  nat44_ed_port_block_t *pb;
+
   pool_free (tsm->lru_pool);
   pool_free (tsm->sessions);
   pool_free (tsm->per_vrf_sessions_pool);
+
+  /* sessions are dropped without logging, blocks still are */
+  pool_foreach (pb, tsm->port_blocks)
+    {
+      nat44_ed_port_block_log_free (thread_index, pb);
+      hash_unset_mem_free (&tsm->port_block_index_by_key, &pb->key);
+    }
+  hash_free (tsm->port_block_index_by_key);
+  pool_free (tsm->port_blocks);
+  pool_foreach (pa, tsm->port_block_addresses)
+    {
+      clib_bitmap_free (pa->busy_blocks);
+    }
+  pool_free (tsm->port_block_addresses);
+  hash_free (tsm->port_block_address_index_by_addr);
 }
 
 static void
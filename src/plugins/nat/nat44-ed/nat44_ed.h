@@ -68,6 +68,8 @@ typedef struct
   u32 inside_vrf;
   u32 outside_vrf;
   u32 sessions;
+  /* 0 = per session port allocation, otherwise ports per block */
+  u16 port_block_size;
 } nat44_config_t;
 
 typedef enum
@@ -169,6 +171,7 @@ format_function_t format_nat44_ed_tcp_state;
 #define SNAT_SESSION_FLAG_AFFINITY	     (1 << 6)
 #define SNAT_SESSION_FLAG_EXACT_ADDRESS	     (1 << 7)
 #define SNAT_SESSION_FLAG_HAIRPINNING	     (1 << 8)
+#define SNAT_SESSION_FLAG_PORT_BLOCK	     (1 << 9)
 
 /* NAT interface flags */
 #define NAT_INTERFACE_FLAG_IS_INSIDE 1
@@ -348,6 +351,32 @@ typedef struct
   u32 addr_len;
 } snat_address_t;
 
+typedef struct
+{
+  ip4_address_t in_addr;
+  u32 in_fib_index;
+  ip4_address_t out_addr;
+} nat44_ed_port_block_key_t;
+
+typedef struct
+{
+  nat44_ed_port_block_key_t key;
+  /* index of the block within the thread port range */
+  u16 block_index;
+  /* first and last port of the block, host byte order */
+  u16 start_port;
+  u16 end_port;
+  /* number of sessions using ports from the block */
+  u32 n_sessions;
+} nat44_ed_port_block_t;
+
+typedef struct
+{
+  ip4_address_t addr;
+  /* blocks of the thread port range in use on this address */
+  uword *busy_blocks;
+} nat44_ed_port_block_address_t;
+
 typedef struct
 {
   /* backend IP address */
@@ -471,6 +500,14 @@ typedef struct
 
   per_vrf_sessions_t *per_vrf_sessions_pool;
 
+  /* Port block allocation, owned by the thread */
+  nat44_ed_port_block_t *port_blocks;
+  /* nat44_ed_port_block_key_t -> port block index */
+  uword *port_block_index_by_key;
+  nat44_ed_port_block_address_t *port_block_addresses;
+  /* external address -> port block address index */
+  uword *port_block_address_index_by_addr;
+
 } snat_main_per_thread_data_t;
 
 struct snat_main_s;
@@ -507,6 +544,9 @@ typedef struct snat_main_s
   u32 *workers;
   u16 port_per_thread;
 
+  /* Port block allocation, 0 = disabled */
+  u16 port_block_size;
+
   /* Per thread data */
   snat_main_per_thread_data_t *per_thread_data;
 
@@ -742,6 +782,16 @@ nat44_ed_is_exact_address_session (snat_session_t *s)
   return s->flags & SNAT_SESSION_FLAG_EXACT_ADDRESS;
 }
 
+/** \brief Check if NAT session uses a port from a port block.
+    @param s NAT session
+    @return true if the session external port belongs to a port block
+*/
+always_inline bool
+nat44_ed_is_port_block_session (snat_session_t *s)
+{
+  return s->flags & SNAT_SESSION_FLAG_PORT_BLOCK;
+}
+
 /** \brief Check if NAT interface is inside.
     @param i NAT interface
     @return true if inside interface
@@ -891,6 +941,35 @@ int nat44_ed_del_session (snat_main_t *sm, ip4_address_t *addr, u16 port,
 void nat44_ed_free_session_data (snat_main_t *sm, snat_session_t *s,
 				 u32 thread_index, u8 is_ha);
 
+/**
+ * @brief Get the port block of the session inside address on the given
+ *        external address, allocating a free block of the thread port
+ *        range if the inside address has none yet
+ *
+ * @param sm           snat global configuration data
+ * @param thread_index thread index
+ * @param s            NAT session with in2out address and fib set
+ * @param out_addr     external address
+ * @return port block or 0 if the thread has no free block left
+ */
+nat44_ed_port_block_t *nat44_ed_port_block_get (snat_main_t *sm,
+						u32 thread_index,
+						snat_session_t *s,
+						ip4_address_t out_addr);
+
+/**
+ * @brief Release a port block which has no sessions
+ */
+void nat44_ed_port_block_free (snat_main_t *sm, u32 thread_index,
+			       nat44_ed_port_block_t *pb);
+
+/**
+ * @brief Drop the session reference on its port block, releasing the
+ *        block with its last session
+ */
+void nat44_ed_port_block_session_del (snat_main_t *sm, snat_session_t *s,
+				      u32 thread_index);
+
 /**
  * @brief Set NAT44 session limit (session limit, vrf id)
  *
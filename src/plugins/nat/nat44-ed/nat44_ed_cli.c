@@ -39,6 +39,7 @@ nat44_ed_enable_disable_command_fn (vlib_main_t *vm, unformat_input_t *input,
 
   nat44_config_t c = { 0 };
   u8 enable_set = 0, enable = 0;
+  u32 port_block_size;
 
   if (!unformat_user (input, unformat_line_input, line_input))
     return clib_error_return (0, NAT44_ED_EXPECTED_ARGUMENT);
@@ -49,6 +50,15 @@ nat44_ed_enable_disable_command_fn (vlib_main_t *vm, unformat_input_t *input,
 	;
       else if (unformat (line_input, "outside-vrf %u", &c.outside_vrf));
       else if (unformat (line_input, "sessions %u", &c.sessions));
+      else if (unformat (line_input, "port-block-size %u", &port_block_size))
+	{
+	  if (port_block_size > 0xffff)
+	    {
+	      error = clib_error_return (0, "port-block-size out of range");
+	      goto done;
+	    }
+	  c.port_block_size = port_block_size;
+	}
       else if (!enable_set)
 	{
 	  enable_set = 1;
@@ -1484,6 +1494,46 @@ nat44_show_interface_address_command_fn (vlib_main_t * vm,
   return 0;
 }
 
+static clib_error_t *
+nat44_show_port_blocks_command_fn (vlib_main_t *vm, unformat_input_t *input,
+				   vlib_cli_command_t *cmd)
+{
+  snat_main_per_thread_data_t *tsm;
+  snat_main_t *sm = &snat_main;
+  nat44_ed_port_block_t *pb;
+  int i;
+
+  if (!sm->port_block_size)
+    {
+      vlib_cli_output (vm, "port block allocation disabled");
+      return 0;
+    }
+
+  vlib_cli_output (vm, "NAT44 ED port blocks (%u ports per block):",
+		   sm->port_block_size);
+
+  vec_foreach_index (i, sm->per_thread_data)
+    {
+      tsm = vec_elt_at_index (sm->per_thread_data, i);
+
+      vlib_cli_output (vm, "-------- thread %d %s: %d port blocks --------",
+		       i, vlib_worker_threads[i].name,
+		       pool_elts (tsm->port_blocks));
+
+      pool_foreach (pb, tsm->port_blocks)
+	{
+	  vlib_cli_output (
+	    vm, "  %U fib %u -> %U ports %u-%u sessions %u",
+	    format_ip4_address, &pb->key.in_addr,
+	    fib_table_get_table_id (pb->key.in_fib_index, FIB_PROTOCOL_IP4),
+	    format_ip4_address, &pb->key.out_addr, pb->start_port,
+	    pb->end_port, pb->n_sessions);
+	}
+    }
+
+  return 0;
+}
+
 static clib_error_t *
 nat44_show_sessions_command_fn (vlib_main_t * vm, unformat_input_t * input,
 				vlib_cli_command_t * cmd)
@@ -1848,6 +1898,8 @@ done:
  *  vpp# nat44 plugin disable
  * To set inside-vrf outside-vrf, use:
  *  vpp# nat44 plugin enable inside-vrf <id> outside-vrf <id>
+ * To allocate outside ports in blocks of 256 per inside address, use:
+ *  vpp# nat44 plugin enable port-block-size 256
  * @cliexend
 ?*/
 VLIB_CLI_COMMAND (nat44_ed_enable_disable_command, static) = {
@@ -1855,7 +1907,7 @@ VLIB_CLI_COMMAND (nat44_ed_enable_disable_command, static) = {
   .function = nat44_ed_enable_disable_command_fn,
   .short_help =
     "nat44 plugin <enable [sessions <max-number>] [inside-vrf <vrf-id>] "
-    "[outside-vrf <vrf-id>]>|disable",
+    "[outside-vrf <vrf-id>] [port-block-size <n>]>|disable",
 };
 
 /*?
@@ -2287,6 +2339,22 @@ VLIB_CLI_COMMAND (nat44_show_sessions_command, static) = {
   .function = nat44_show_sessions_command_fn,
 };
 
+/*?
+ * @cliexpar
+ * @cliexstart{show nat44 port blocks}
+ * Show the outside port blocks allocated to inside addresses.
+ *  vpp# show nat44 port blocks
+ *  NAT44 ED port blocks (256 ports per block):
+ *  -------- thread 0 vpp_main: 1 port blocks --------
+ *    10.0.0.3 fib 0 -> 1.2.3.4 ports 1024-1279 sessions 2
+ * @cliexend
+?*/
+VLIB_CLI_COMMAND (nat44_show_port_blocks_command, static) = {
+  .path = "show nat44 port blocks",
+  .short_help = "show nat44 port blocks",
+  .function = nat44_show_port_blocks_command_fn,
+};
+
 /*?
  * @cliexpar
  * @cliexstart{set nat44 session limit}
@@ -96,6 +96,57 @@ format_nat_in2out_ed_trace (u8 * s, va_list * args)
   return s;
 }
 
+static int
+nat_ed_alloc_port_from_port_block (snat_main_t *sm, u8 proto,
+				   u32 thread_index, snat_address_t *a,
+				   snat_session_t *s,
+				   ip4_address_t *outside_addr,
+				   u16 *outside_port)
+{
+  nat44_ed_port_block_t *pb;
+  u16 port, port_offset, n_ports;
+  u32 i;
+
+  pb = nat44_ed_port_block_get (sm, thread_index, s, a->addr);
+  if (!pb)
+    return 1;
+
+  /* Backup original match in case of failure */
+  const nat_6t_t match = s->o2i.match;
+
+  s->o2i.match.daddr = a->addr;
+  n_ports = pb->end_port - pb->start_port + 1;
+  /* first try port suggested by caller, then walk the whole block, it is
+   * small enough and exhausting it means the inside address is done */
+  port = clib_net_to_host_u16 (*outside_port);
+  if (port < pb->start_port || port > pb->end_port)
+    port = pb->start_port + snat_random_port (0, n_ports - 1);
+  port_offset = port - pb->start_port;
+  for (i = 0; i < n_ports; i++)
+    {
+      port = pb->start_port + (port_offset + i) % n_ports;
+      if (IP_PROTOCOL_ICMP == proto)
+	{
+	  s->o2i.match.sport = clib_host_to_net_u16 (port);
+	}
+      s->o2i.match.dport = clib_host_to_net_u16 (port);
+      if (0 == nat_ed_ses_o2i_flow_hash_add_del (sm, thread_index, s, 2))
+	{
+	  pb->n_sessions++;
+	  s->flags |= SNAT_SESSION_FLAG_PORT_BLOCK;
+	  *outside_addr = a->addr;
+	  *outside_port = clib_host_to_net_u16 (port);
+	  return 0;
+	}
+    }
+
+  /* Revert match */
+  s->o2i.match = match;
+  if (!pb->n_sessions)
+    nat44_ed_port_block_free (sm, thread_index, pb);
+  return 1;
+}
+
 static int
 nat_ed_alloc_addr_and_port_with_snat_address (
   snat_main_t *sm, u8 proto, u32 thread_index, snat_address_t *a,
@@ -105,6 +156,10 @@ nat_ed_alloc_addr_and_port_with_snat_address (
   const u16 port_thread_offset =
     (port_per_thread * snat_thread_index) + ED_USER_PORT_OFFSET;
 
+  if (sm->port_block_size)
+    return nat_ed_alloc_port_from_port_block (sm, proto, thread_index, a, s,
+					      outside_addr, outside_port);
+
   /* Backup original match in case of failure */
   const nat_6t_t match = s->o2i.match;
 
@@ -599,15 +654,19 @@ slow_path_ed (vlib_main_t *vm, snat_main_t *sm, vlib_buffer_t *b,
       goto error;
     }
 
-  /* log NAT event */
-  nat_ipfix_logging_nat44_ses_create (
-    thread_index, s->in2out.addr.as_u32, s->out2in.addr.as_u32, s->proto,
-    s->in2out.port, s->out2in.port, s->in2out.fib_index);
-
-  nat_syslog_nat44_sadd (0, s->in2out.fib_index, &s->in2out.addr,
-			 s->in2out.port, &s->ext_host_nat_addr,
-			 s->ext_host_nat_port, &s->out2in.addr, s->out2in.port,
-			 &s->ext_host_addr, s->ext_host_port, s->proto, 0);
+  /* log NAT event, port block sessions are logged with their block */
+  if (!nat44_ed_is_port_block_session (s))
+    {
+      nat_ipfix_logging_nat44_ses_create (
+	thread_index, s->in2out.addr.as_u32, s->out2in.addr.as_u32, s->proto,
+	s->in2out.port, s->out2in.port, s->in2out.fib_index);
+
+      nat_syslog_nat44_sadd (0, s->in2out.fib_index, &s->in2out.addr,
+			     s->in2out.port, &s->ext_host_nat_addr,
+			     s->ext_host_nat_port, &s->out2in.addr,
+			     s->out2in.port, &s->ext_host_addr,
+			     s->ext_host_port, s->proto, 0);
+    }
 
   per_vrf_sessions_register_session (s, thread_index);
 
@@ -616,6 +675,8 @@ slow_path_ed (vlib_main_t *vm, snat_main_t *sm, vlib_buffer_t *b,
 error:
   if (s)
     {
+      if (nat44_ed_is_port_block_session (s))
+	nat44_ed_port_block_session_del (sm, s, thread_index);
       nat_ed_session_delete (sm, s, thread_index, 1);
     }
   *sessionp = s = NULL;
@@ -702,23 +702,29 @@ is_interface_addr (snat_main_t *sm, vlib_node_runtime_t *node,
 always_inline void
 nat44_ed_session_reopen (u32 thread_index, snat_session_t *s)
 {
-  nat_syslog_nat44_sdel (0, s->in2out.fib_index, &s->in2out.addr,
-			 s->in2out.port, &s->ext_host_nat_addr,
-			 s->ext_host_nat_port, &s->out2in.addr, s->out2in.port,
-			 &s->ext_host_addr, s->ext_host_port, s->proto,
-			 nat44_ed_is_twice_nat_session (s));
-
-  nat_ipfix_logging_nat44_ses_delete (
-    thread_index, s->in2out.addr.as_u32, s->out2in.addr.as_u32, s->proto,
-    s->in2out.port, s->out2in.port, s->in2out.fib_index);
-  nat_ipfix_logging_nat44_ses_create (
-    thread_index, s->in2out.addr.as_u32, s->out2in.addr.as_u32, s->proto,
-    s->in2out.port, s->out2in.port, s->in2out.fib_index);
-
-  nat_syslog_nat44_sadd (0, s->in2out.fib_index, &s->in2out.addr,
-			 s->in2out.port, &s->ext_host_nat_addr,
-			 s->ext_host_nat_port, &s->out2in.addr, s->out2in.port,
-			 &s->ext_host_addr, s->ext_host_port, s->proto, 0);
+  /* port block sessions are logged with their block, which stays */
+  if (!nat44_ed_is_port_block_session (s))
+    {
+      nat_syslog_nat44_sdel (0, s->in2out.fib_index, &s->in2out.addr,
+			     s->in2out.port, &s->ext_host_nat_addr,
+			     s->ext_host_nat_port, &s->out2in.addr,
+			     s->out2in.port, &s->ext_host_addr,
+			     s->ext_host_port, s->proto,
+			     nat44_ed_is_twice_nat_session (s));
+
+      nat_ipfix_logging_nat44_ses_delete (
+	thread_index, s->in2out.addr.as_u32, s->out2in.addr.as_u32, s->proto,
+	s->in2out.port, s->out2in.port, s->in2out.fib_index);
+      nat_ipfix_logging_nat44_ses_create (
+	thread_index, s->in2out.addr.as_u32, s->out2in.addr.as_u32, s->proto,
+	s->in2out.port, s->out2in.port, s->in2out.fib_index);
+
+      nat_syslog_nat44_sadd (0, s->in2out.fib_index, &s->in2out.addr,
+			     s->in2out.port, &s->ext_host_nat_addr,
+			     s->ext_host_nat_port, &s->out2in.addr,
+			     s->out2in.port, &s->ext_host_addr,
+			     s->ext_host_port, s->proto, 0);
+    }
   s->total_pkts = 0;
   s->total_bytes = 0;
 }
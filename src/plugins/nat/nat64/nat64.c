@@ -215,7 +215,7 @@ nat64_get_worker_out2in (vlib_buffer_t * b, ip4_header_t * ip)
 
   /* worker by outside port  (TCP/UDP) */
   port = clib_net_to_host_u16 (port);
-  if (port > 1024)
+  if (port >= 1024)
     return get_thread_idx_by_port (port);
 
   return vlib_get_thread_index ();
@@ -227,6 +227,7 @@ nat64_init (vlib_main_t * vm)
   nat64_main_t *nm = &nat64_main;
   vlib_thread_main_t *tm = vlib_get_thread_main ();
   ip4_add_del_interface_address_callback_t cb4;
+  nat64_main_per_thread_data_t *ptd;
   vlib_node_t *node;
 
   clib_memset (nm, 0, sizeof (*nm));
@@ -308,6 +309,11 @@ nat64_init (vlib_main_t * vm)
       nm->port_per_thread = (0xffff - 1024) / _vec_len (nm->workers);
     }
 
+  vec_validate_aligned (nm->per_thread_data, tm->n_vlib_mains - 1,
+			CLIB_CACHE_LINE_BYTES);
+  vec_foreach (ptd, nm->per_thread_data)
+    ptd->random_seed = random_default_seed () ^ (ptd - nm->per_thread_data);
+
   /* Init IPFIX logging */
   nat_ipfix_logging_init (vm);
 
@@ -408,11 +414,12 @@ nat64_add_del_pool_addr (u32 thread_index,
 	  fib_table_find_or_create_and_lock (FIB_PROTOCOL_IP6, vrf_id,
 					     nm->fib_src_hi);
 #define _(N, id, n, s) \
-      clib_memset (a->busy_##n##_port_refcounts, 0, sizeof(a->busy_##n##_port_refcounts)); \
-      a->busy_##n##_ports = 0; \
-      vec_validate_init_empty (a->busy_##n##_ports_per_thread, tm->n_vlib_mains - 1, 0);
+      clib_memset (a->busy_##n##_port_refcounts, 0, sizeof(a->busy_##n##_port_refcounts));
       foreach_nat_protocol
 #undef _
+      a->per_thread = 0;
+      vec_validate_aligned (a->per_thread, tm->n_vlib_mains - 1,
+			    CLIB_CACHE_LINE_BYTES);
     }
   else
     {
@@ -432,6 +439,7 @@ nat64_add_del_pool_addr (u32 thread_index,
                                    db->st.st_entries_num);
         }
       /* *INDENT-ON* */
+      vec_free (a->per_thread);
       vec_del1 (nm->addr_pool, i);
     }
 
@@ -666,13 +674,13 @@ nat64_interfaces_walk (nat64_interface_walk_fn_t fn, void *ctx)
 
 // TODO: plugin independent
 static_always_inline u16
-nat64_random_port (u16 min, u16 max)
+nat64_random_port (u32 thread_index, u16 min, u16 max)
 {
   nat64_main_t *nm = &nat64_main;
   u32 rwide;
   u16 r;
 
-  rwide = random_u32 (&nm->random_seed);
+  rwide = random_u32 (&nm->per_thread_data[thread_index].random_seed);
   r = rwide & 0xFFFF;
   if (r >= min && r <= max)
     return r;
@@ -700,7 +708,7 @@ nat64_alloc_addr_and_port_default (nat64_address_t * addresses,
 	{
 #define _(N, j, n, s) \
         case NAT_PROTOCOL_##N: \
-          if (a->busy_##n##_ports_per_thread[thread_index] < port_per_thread) \
+          if (a->per_thread[thread_index].busy_##n##_ports < port_per_thread) \
             { \
               if (a->fib_index == fib_index) \
                 { \
@@ -708,12 +716,11 @@ nat64_alloc_addr_and_port_default (nat64_address_t * addresses,
                     { \
                       portnum = (port_per_thread * \
                         nat_thread_index) + \
-                        nat64_random_port(0, port_per_thread - 1) + 1024; \
+                        nat64_random_port(thread_index, 0, port_per_thread - 1) + 1024; \
                       if (a->busy_##n##_port_refcounts[portnum]) \
                         continue; \
-		      --a->busy_##n##_port_refcounts[portnum]; \
-                      a->busy_##n##_ports_per_thread[thread_index]++; \
-                      a->busy_##n##_ports++; \
+		      ++a->busy_##n##_port_refcounts[portnum]; \
+                      a->per_thread[thread_index].busy_##n##_ports++; \
                       *addr = a->addr; \
                       *port = clib_host_to_net_u16(portnum); \
                       return 0; \
@@ -744,12 +751,11 @@ nat64_alloc_addr_and_port_default (nat64_address_t * addresses,
             { \
               portnum = (port_per_thread * \
                 nat_thread_index) + \
-                nat64_random_port(0, port_per_thread - 1) + 1024; \
+                nat64_random_port(thread_index, 0, port_per_thread - 1) + 1024; \
 	      if (a->busy_##n##_port_refcounts[portnum]) \
                 continue; \
 	      ++a->busy_##n##_port_refcounts[portnum]; \
-              a->busy_##n##_ports_per_thread[thread_index]++; \
-              a->busy_##n##_ports++; \
+              a->per_thread[thread_index].busy_##n##_ports++; \
               *addr = a->addr; \
               *port = clib_host_to_net_u16(portnum); \
               return 0; \
@@ -809,8 +815,8 @@ nat64_free_out_addr_and_port (struct nat64_db_s *db, ip4_address_t * addr,
         case NAT_PROTOCOL_##N: \
           ASSERT (a->busy_##n##_port_refcounts[port_host_byte_order] >= 1); \
           --a->busy_##n##_port_refcounts[port_host_byte_order]; \
-          a->busy_##n##_ports--; \
-          a->busy_##n##_ports_per_thread[thread_index]--; \
+          if (port_host_byte_order >= 1024) \
+            a->per_thread[thread_index].busy_##n##_ports--; \
           break;
 	  foreach_nat_protocol
 #undef _
@@ -928,7 +934,7 @@ nat64_add_del_static_bib_entry (ip6_address_t * in_addr,
 	return VNET_API_ERROR_VALUE_EXIST;
 
       /* outside port must be assigned to same thread as internall address */
-      if ((out_port > 1024) && (nm->num_workers > 1))
+      if ((out_port >= 1024) && (nm->num_workers > 1))
 	{
 	  if (thread_index != get_thread_idx_by_port (out_port))
 	    return VNET_API_ERROR_INVALID_VALUE_2;
@@ -946,11 +952,8 @@ nat64_add_del_static_bib_entry (ip6_address_t * in_addr,
               if (a->busy_##n##_port_refcounts[out_port]) \
                 return VNET_API_ERROR_INVALID_VALUE; \
 	      ++a->busy_##n##_port_refcounts[out_port]; \
-              if (out_port > 1024) \
-                { \
-                  a->busy_##n##_ports++; \
-                  a->busy_##n##_ports_per_thread[thread_index]++; \
-                } \
+              if (out_port >= 1024) \
+                a->per_thread[thread_index].busy_##n##_ports++; \
               break;
 	      foreach_nat_protocol
 #undef _
@@ -1617,6 +1620,7 @@ nat64_plugin_disable ()
       {
 	if (a->fib_index != ~0)
 	  fib_table_unlock (a->fib_index, FIB_PROTOCOL_IP6, nm->fib_src_hi);
+	vec_free (a->per_thread);
       }
       vec_free (nm->addr_pool);
     }
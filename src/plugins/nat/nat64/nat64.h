@@ -89,18 +89,34 @@ typedef struct
   u8 done;
 } nat64_static_bib_to_update_t;
 
+/* Port accounting of a pool address for one thread, kept in its own cache
+ * line so that workers allocating ports don't write to shared lines */
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+/* *INDENT-OFF* */
+#define _(N, i, n, s) \
+  u16 busy_##n##_ports;
+  foreach_nat_protocol
+#undef _
+/* *INDENT-ON* */
+} nat64_address_per_thread_t;
+
 typedef struct
 {
   ip4_address_t addr;
   u32 fib_index;
+  /* Dynamic ports >= 1024 are owned by the thread whose port range they are
+   * in (see nat64_get_worker_out2in), so a refcount is only ever written by
+   * that thread, or by the main thread under the barrier */
 /* *INDENT-OFF* */
 #define _(N, i, n, s) \
-  u16 busy_##n##_ports; \
-  u16 * busy_##n##_ports_per_thread; \
   u32 busy_##n##_port_refcounts[65535];
   foreach_nat_protocol
 #undef _
 /* *INDENT-ON* */
+  /* per thread busy port counters, indexed by thread index */
+  nat64_address_per_thread_t *per_thread;
 } nat64_address_t;
 
 typedef struct
@@ -109,6 +125,14 @@ typedef struct
   u8 flags;
 } nat64_interface_t;
 
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+
+  /* Randomize port allocation order */
+  u32 random_seed;
+} nat64_main_per_thread_data_t;
+
 typedef struct
 {
   u32 enabled;
@@ -136,6 +160,9 @@ typedef struct
   /** BIB and session DB per thread */
   nat64_db_t *db;
 
+  /** Per thread data, written by the owning thread only */
+  nat64_main_per_thread_data_t *per_thread_data;
+
   /** Worker handoff */
   u32 fq_in2out_index;
   u32 fq_out2in_index;
@@ -197,9 +224,6 @@ typedef struct
   /* required */
   vnet_main_t *vnet_main;
 
-  /* Randomize port allocation order */
-  u32 random_seed;
-
   /* TCP MSS clamping */
   u16 mss_clamping;
 
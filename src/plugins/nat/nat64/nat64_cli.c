@@ -148,6 +148,8 @@ static int
 nat64_cli_pool_walk (nat64_address_t * ap, void *ctx)
 {
   vlib_main_t *vm = ctx;
+  nat64_address_per_thread_t *ptd;
+  u32 busy;
 
   if (ap->fib_index != ~0)
     {
@@ -162,7 +164,10 @@ nat64_cli_pool_walk (nat64_address_t * ap, void *ctx)
     vlib_cli_output (vm, " %U", format_ip4_address, &ap->addr);
 
 #define _(N, i, n, s) \
-  vlib_cli_output (vm, "  %d busy %s ports", ap->busy_##n##_ports, s);
+  busy = 0; \
+  vec_foreach (ptd, ap->per_thread) \
+    busy += ptd->busy_##n##_ports; \
+  vlib_cli_output (vm, "  %d busy %s ports", busy, s);
   foreach_nat_protocol
 #undef _
     return 0;
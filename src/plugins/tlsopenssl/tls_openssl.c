@@ -16,6 +16,10 @@
 #include <openssl/ssl.h>
 #include <openssl/conf.h>
 #include <openssl/err.h>
+#include <openssl/rand.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#endif
 
 #ifdef HAVE_OPENSSL_ASYNC
 #include <openssl/async.h>
@@ -67,11 +71,15 @@ openssl_ctx_free (tls_ctx_t * ctx)
   /* Cleanup ssl ctx unless migrated */
   if (!ctx->is_migrated)
     {
-      if (SSL_is_init_finished (oc->ssl) && !ctx->is_passive_close)
+      /* Close notify already sent if records are not protected by openssl */
+      if (SSL_is_init_finished (oc->ssl) && !ctx->is_passive_close &&
+	  !openssl_rec_is_active (oc))
 	SSL_shutdown (oc->ssl);
 
+      openssl_rec_free (oc);
       SSL_free (oc->ssl);
       vec_free (ctx->srv_hostname);
+      vec_free (oc->session_key);
 
 #ifdef HAVE_OPENSSL_ASYNC
   openssl_evt_free (ctx->evt_index, ctx->c_thread_index);
@@ -369,6 +377,10 @@ openssl_ctx_handshake_rx (tls_ctx_t * ctx, session_t * tls_session)
 	  return -1;
 	}
 
+      /* App may start writing as soon as it is notified */
+      if (oc->rec)
+	openssl_rec_enable (oc);
+
       /* Accept failed, cleanup */
       if (tls_notify_app_accept (ctx))
 	{
@@ -402,6 +414,9 @@ openssl_ctx_write_tls (tls_ctx_t *ctx, session_t *app_session,
   int wrote = 0;
   svm_fifo_t *f;
 
+  if (openssl_rec_is_active (oc))
+    return openssl_rec_write (oc, app_session, sp);
+
   ts = session_get_from_handle (ctx->tls_session_handle);
   space = svm_fifo_max_enqueue_prod (ts->tx_fifo);
   /* Leave a bit of extra space for tls ctrl data, if any needed */
@@ -546,6 +561,9 @@ openssl_ctx_read_tls (tls_ctx_t *ctx, session_t *tls_session)
       tls_session = session_get_from_handle (ctx->tls_session_handle);
     }
 
+  if (openssl_rec_is_active (oc))
+    return openssl_rec_read (oc, tls_session);
+
   app_session = session_get_from_handle (ctx->app_session_handle);
   f = app_session->rx_fifo;
 
@@ -639,6 +657,226 @@ openssl_ctx_read (tls_ctx_t *ctx, session_t *ts)
     return openssl_ctx_read_dtls (ctx, ts);
 }
 
+static void
+openssl_session_cache_add (u8 *key, SSL_SESSION *session)
+{
+  openssl_session_cache_t *sc = &openssl_main.session_cache;
+  tls_main_t *tm = vnet_tls_get_main ();
+  openssl_cached_session_t *e;
+  uword *p;
+
+  clib_spinlock_lock (&sc->lock);
+
+  if (!sc->entries)
+    vec_validate (sc->entries, tm->session_cache_size - 1);
+
+  p = hash_get_mem (sc->entry_by_key, key);
+  if (p)
+    {
+      e = vec_elt_at_index (sc->entries, p[0]);
+      SSL_SESSION_free (e->session);
+      e->session = session;
+      goto done;
+    }
+
+  /* Overwrite oldest entry */
+  e = vec_elt_at_index (sc->entries, sc->next_entry);
+  if (e->session)
+    {
+      hash_unset_mem (sc->entry_by_key, e->key);
+      vec_free (e->key);
+      SSL_SESSION_free (e->session);
+    }
+  e->key = vec_dup (key);
+  e->session = session;
+  hash_set_mem (sc->entry_by_key, e->key, sc->next_entry);
+  sc->next_entry = (sc->next_entry + 1) % vec_len (sc->entries);
+
+done:
+  clib_spinlock_unlock (&sc->lock);
+}
+
+/**
+ * Find session to resume, caller must free the returned copy. OpenSSL marks
+ * the session of a connection freed without close_notify as not resumable,
+ * so the cached one is never handed out.
+ */
+static SSL_SESSION *
+openssl_session_cache_get (u8 *key)
+{
+  openssl_session_cache_t *sc = &openssl_main.session_cache;
+  SSL_SESSION *session = 0;
+  uword *p;
+
+  clib_spinlock_lock (&sc->lock);
+
+  p = hash_get_mem (sc->entry_by_key, key);
+  if (p)
+    session = SSL_SESSION_dup (vec_elt (sc->entries, p[0]).session);
+
+  clib_spinlock_unlock (&sc->lock);
+  return session;
+}
+
+/**
+ * Called once a session that can be resumed is established. With TLS 1.3
+ * that is when the server's new session ticket is received.
+ */
+static int
+openssl_cln_session_new_cb (SSL *ssl, SSL_SESSION *session)
+{
+  u8 *key = SSL_get_app_data (ssl);
+
+  if (!key || !SSL_SESSION_is_resumable (session))
+    return 0;
+
+  /* Cache takes over the reference */
+  openssl_session_cache_add (key, session);
+  return 1;
+}
+
+static void
+openssl_cln_init_resumption (openssl_ctx_t *oc)
+{
+  tls_main_t *tm = vnet_tls_get_main ();
+  tls_ctx_t *ctx = &oc->ctx;
+  transport_connection_t *tc;
+  SSL_SESSION *session;
+  app_worker_t *app_wrk;
+  session_t *ts;
+
+  if (ctx->crypto_flags & TRANSPORT_ENDPT_CRYPTO_CFG_F_NO_TICKETS)
+    SSL_set_options (oc->ssl, SSL_OP_NO_TICKET);
+
+  app_wrk = app_worker_get_if_valid (ctx->parent_app_wrk_index);
+  if (!app_wrk || !tm->session_cache_size)
+    return;
+
+  /* Sessions are only resumed for same app, peer and identity */
+  ts = session_get_from_handle (ctx->tls_session_handle);
+  tc = session_get_transport (ts);
+  oc->session_key =
+    format (0, "%u %u %U %u %s", app_wrk->app_index, ctx->ckpair_index,
+	    format_ip46_address, &tc->rmt_ip, IP46_TYPE_ANY,
+	    clib_net_to_host_u16 (tc->rmt_port),
+	    ctx->srv_hostname ? (char *) ctx->srv_hostname : "");
+  SSL_set_app_data (oc->ssl, oc->session_key);
+
+  session = openssl_session_cache_get (oc->session_key);
+  if (session)
+    {
+      SSL_set_session (oc->ssl, session);
+      SSL_SESSION_free (session);
+    }
+}
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+static int
+openssl_ticket_key_cb (SSL *ssl, u8 *key_name, u8 *iv, EVP_CIPHER_CTX *ectx,
+		       EVP_MAC_CTX *hctx, int enc)
+#else
+static int
+openssl_ticket_key_cb (SSL *ssl, u8 *key_name, u8 *iv, EVP_CIPHER_CTX *ectx,
+		       HMAC_CTX *hctx, int enc)
+#endif
+{
+  tls_ticket_key_t key;
+  int rv;
+
+  if (enc)
+    {
+      if (tls_ticket_key_current (&key))
+	return -1;
+      if (RAND_bytes (iv, EVP_CIPHER_iv_length (EVP_aes_256_cbc ())) <= 0)
+	{
+	  rv = -1;
+	  goto done;
+	}
+      clib_memcpy_fast (key_name, key.name, TLS_TICKET_KEY_NAME_LEN);
+      rv = EVP_EncryptInit_ex (ectx, EVP_aes_256_cbc (), 0, key.aes_key, iv);
+      if (rv != 1)
+	{
+	  rv = -1;
+	  goto done;
+	}
+      rv = 1;
+    }
+  else
+    {
+      /* Unknown key, fall back to full handshake */
+      rv = tls_ticket_key_find (key_name, &key);
+      if (rv < 0)
+	return 0;
+      if (EVP_DecryptInit_ex (ectx, EVP_aes_256_cbc (), 0, key.aes_key, iv) !=
+	  1)
+	{
+	  rv = -1;
+	  goto done;
+	}
+      /* Ticket encrypted with retired key, issue a new one */
+      rv = rv ? 2 : 1;
+    }
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  OSSL_PARAM params[3];
+  params[0] = OSSL_PARAM_construct_octet_string (
+    OSSL_MAC_PARAM_KEY, key.hmac_key, sizeof (key.hmac_key));
+  params[1] = OSSL_PARAM_construct_utf8_string (OSSL_MAC_PARAM_DIGEST,
+						(char *) "sha256", 0);
+  params[2] = OSSL_PARAM_construct_end ();
+  if (!EVP_MAC_CTX_set_params (hctx, params))
+    rv = -1;
+#else
+  if (!HMAC_Init_ex (hctx, key.hmac_key, sizeof (key.hmac_key), EVP_sha256 (),
+		     0))
+    rv = -1;
+#endif
+
+done:
+  OPENSSL_cleanse (&key, sizeof (key));
+  return rv;
+}
+
+static void
+openssl_srv_init_resumption (SSL_CTX *ssl_ctx, tls_ctx_t *lctx)
+{
+  tls_main_t *tm = vnet_tls_get_main ();
+  app_worker_t *app_wrk;
+  u32 sid_ctx[2];
+
+  if (lctx->crypto_flags & TRANSPORT_ENDPT_CRYPTO_CFG_F_NO_RESUME)
+    {
+      SSL_CTX_set_session_cache_mode (ssl_ctx, SSL_SESS_CACHE_OFF);
+      SSL_CTX_set_options (ssl_ctx, SSL_OP_NO_TICKET);
+      SSL_CTX_set_num_tickets (ssl_ctx, 0);
+      return;
+    }
+
+  /* Ticket keys are shared by all listeners, make sure sessions can only
+   * be resumed by the app and certificate that established them */
+  app_wrk = app_worker_get (lctx->parent_app_wrk_index);
+  sid_ctx[0] = app_wrk->app_index;
+  sid_ctx[1] = lctx->ckpair_index;
+  SSL_CTX_set_session_id_context (ssl_ctx, (u8 *) sid_ctx, sizeof (sid_ctx));
+
+  /* Stateful cache is per listener, OpenSSL locks it for the workers */
+  SSL_CTX_set_session_cache_mode (ssl_ctx, SSL_SESS_CACHE_SERVER);
+  SSL_CTX_sess_set_cache_size (ssl_ctx, tm->session_cache_size);
+  SSL_CTX_set_timeout (ssl_ctx, tm->session_timeout);
+
+  if (lctx->crypto_flags & TRANSPORT_ENDPT_CRYPTO_CFG_F_NO_TICKETS)
+    {
+      SSL_CTX_set_options (ssl_ctx, SSL_OP_NO_TICKET);
+      return;
+    }
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  SSL_CTX_set_tlsext_ticket_key_evp_cb (ssl_ctx, openssl_ticket_key_cb);
+#else
+  SSL_CTX_set_tlsext_ticket_key_cb (ssl_ctx, openssl_ticket_key_cb);
+#endif
+}
+
 static int
 openssl_set_ckpair (SSL *ssl, u32 ckpair_index)
 {
@@ -760,6 +998,13 @@ openssl_ctx_init_client (tls_ctx_t * ctx)
 
   SSL_CTX_set_options (oc->ssl_ctx, flags);
   SSL_CTX_set_cert_store (oc->ssl_ctx, om->cert_store);
+  if (!(ctx->crypto_flags & TRANSPORT_ENDPT_CRYPTO_CFG_F_NO_RESUME))
+    {
+      SSL_CTX_set_session_cache_mode (oc->ssl_ctx,
+				      SSL_SESS_CACHE_CLIENT |
+					SSL_SESS_CACHE_NO_INTERNAL_STORE);
+      SSL_CTX_sess_set_new_cb (oc->ssl_ctx, openssl_cln_session_new_cb);
+    }
 
   oc->ssl = SSL_new (oc->ssl_ctx);
   if (oc->ssl == NULL)
@@ -782,6 +1027,9 @@ openssl_ctx_init_client (tls_ctx_t * ctx)
   SSL_set_bio (oc->ssl, oc->wbio, oc->rbio);
   SSL_set_connect_state (oc->ssl);
 
+  if (!(ctx->crypto_flags & TRANSPORT_ENDPT_CRYPTO_CFG_F_NO_RESUME))
+    openssl_cln_init_resumption (oc);
+
   /* Hostname validation and strict check by name are disabled by default */
   rv = openssl_client_init_verify (oc->ssl, (const char *) ctx->srv_hostname,
 				   0, 0);
@@ -841,6 +1089,7 @@ openssl_start_listen (tls_ctx_t * lctx)
 
   long flags = SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3 | SSL_OP_NO_COMPRESSION;
   openssl_main_t *om = &openssl_main;
+  tls_main_t *tm = vnet_tls_get_main ();
 
   ckpair = app_cert_key_pair_get_if_valid (lctx->ckpair_index);
   if (!ckpair)
@@ -872,6 +1121,9 @@ openssl_start_listen (tls_ctx_t * lctx)
 #endif
   SSL_CTX_set_options (ssl_ctx, flags);
   SSL_CTX_set_ecdh_auto (ssl_ctx, 1);
+  openssl_srv_init_resumption (ssl_ctx, lctx);
+  if (tm->record_offload && lctx->tls_type == TRANSPORT_PROTO_TLS)
+    openssl_rec_listen_init (ssl_ctx);
 
   rv = SSL_CTX_set_cipher_list (ssl_ctx, (const char *) om->ciphers);
   if (rv != 1)
@@ -974,6 +1226,8 @@ static int
 openssl_ctx_init_server (tls_ctx_t * ctx)
 {
   openssl_ctx_t *oc = (openssl_ctx_t *) ctx;
+  tls_main_t *tm = vnet_tls_get_main ();
+  openssl_main_t *om = &openssl_main;
   u32 olc_index = ctx->tls_ssl_ctx;
   openssl_listen_ctx_t *olc;
   int rv, err;
@@ -1002,6 +1256,11 @@ openssl_ctx_init_server (tls_ctx_t * ctx)
   SSL_set_bio (oc->ssl, oc->wbio, oc->rbio);
   SSL_set_accept_state (oc->ssl);
 
+  /* Records are protected with vnet crypto once handshake is done */
+  if (tm->record_offload && ctx->tls_type == TRANSPORT_PROTO_TLS &&
+      !om->async)
+    openssl_rec_srv_init (oc);
+
   TLS_DBG (1, "Initiating handshake for [%u]%u", ctx->c_thread_index,
 	   oc->openssl_ctx_index);
 
@@ -1039,6 +1298,13 @@ openssl_handshake_is_over (tls_ctx_t * ctx)
   return SSL_is_init_finished (mc->ssl);
 }
 
+static u8
+openssl_handshake_is_resumed (tls_ctx_t *ctx)
+{
+  openssl_ctx_t *oc = (openssl_ctx_t *) ctx;
+  return oc->ssl && SSL_session_reused (oc->ssl);
+}
+
 static int
 openssl_transport_close (tls_ctx_t * ctx)
 {
@@ -1062,6 +1328,12 @@ openssl_app_close (tls_ctx_t * ctx)
   openssl_ctx_t *oc = (openssl_ctx_t *) ctx;
   session_t *app_session;
 
+  if (openssl_rec_is_active (oc))
+    {
+      openssl_rec_app_close (oc);
+      return 0;
+    }
+
   /* Wait for all data to be written to tcp */
   app_session = session_get_from_handle (ctx->app_session_handle);
   if (BIO_ctrl_pending (oc->rbio) <= 0
@@ -1151,6 +1423,7 @@ const static tls_engine_vft_t openssl_engine = {
   .ctx_transport_close = openssl_transport_close,
   .ctx_app_close = openssl_app_close,
   .ctx_reinit_cachain = openssl_reinit_ca_chain,
+  .ctx_handshake_is_resumed = openssl_handshake_is_resumed,
 };
 
 int
@@ -1189,6 +1462,10 @@ tls_openssl_init (vlib_main_t * vm)
   SSL_load_error_strings ();
 
   vec_validate (om->ctx_pool, num_threads - 1);
+  openssl_rec_init ();
+  clib_spinlock_init (&om->session_cache.lock);
+  om->session_cache.entry_by_key =
+    hash_create_vec (0, sizeof (u8), sizeof (uword));
   vec_validate (om->rx_bufs, num_threads - 1);
   vec_validate (om->tx_bufs, num_threads - 1);
   for (i = 0; i < num_threads; i++)
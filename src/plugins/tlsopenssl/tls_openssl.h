@@ -23,12 +23,102 @@
 #include <vnet/plugin/plugin.h>
 #include <vpp/app/version.h>
 #include <vnet/tls/tls.h>
+#include <vnet/crypto/crypto.h>
 
 #define TLSO_CTRL_BYTES 1000
 #define TLSO_MIN_ENQ_SPACE (1 << 16)
 
+#define TLSO_REC_HDR_LEN     5
+#define TLSO_REC_TAG_LEN     16
+#define TLSO_REC_IV_LEN	     12
+#define TLSO_REC_MAX_PLAIN   (1 << 14)
+#define TLSO_REC_MAX_CIPHER  (TLSO_REC_MAX_PLAIN + 256)
+#define TLSO_REC_OVERHEAD    (TLSO_REC_HDR_LEN + 1 + TLSO_REC_TAG_LEN)
+#define TLSO_REC_MAX_OPS     256
+#define TLSO_REC_BUF_SIZE    (64 * (TLSO_REC_HDR_LEN + TLSO_REC_MAX_CIPHER))
+
 #define DTLSO_MAX_DGRAM 2000
 
+typedef struct openssl_rec_key_
+{
+  u8 secret[EVP_MAX_MD_SIZE];
+  u8 iv[TLSO_REC_IV_LEN];
+  u32 key_index;	/**< vnet crypto key */
+  u32 key_req;		/**< last key install request to main thread */
+  u64 seq;
+} openssl_rec_key_t;
+
+typedef enum openssl_rec_flags_
+{
+  OPENSSL_REC_F_TX_SECRET = 1 << 0,
+  OPENSSL_REC_F_RX_SECRET = 1 << 1,
+  OPENSSL_REC_F_ACTIVE = 1 << 2,
+  OPENSSL_REC_F_IN_FLUSH = 1 << 3,
+  OPENSSL_REC_F_TX_EVT = 1 << 4,
+  OPENSSL_REC_F_RX_NTF = 1 << 5,
+  OPENSSL_REC_F_RX_ABORT = 1 << 6,
+  OPENSSL_REC_F_SEND_KEY_UPDATE = 1 << 7,
+  OPENSSL_REC_F_PEER_CLOSED = 1 << 8,
+  OPENSSL_REC_F_ERROR = 1 << 9,
+  OPENSSL_REC_F_ERROR_NTF = 1 << 10,
+  OPENSSL_REC_F_SRV_FINISHED = 1 << 11,
+  /* Shifted by openssl_rec_dir_t, so rx must follow tx */
+  OPENSSL_REC_F_TX_KEY_PENDING = 1 << 12,
+  OPENSSL_REC_F_RX_KEY_PENDING = 1 << 13,
+  OPENSSL_REC_F_REQUEST_KEY_UPDATE = 1 << 14,
+} openssl_rec_flags_t;
+
+/** TLS 1.3 record protection done with vnet crypto, after handshake */
+typedef struct openssl_rec_
+{
+  openssl_rec_key_t tx;
+  openssl_rec_key_t rx;
+  const EVP_MD *md;
+  vnet_crypto_alg_t alg;
+  vnet_crypto_op_id_t enc_op;
+  vnet_crypto_op_id_t dec_op;
+  u32 n_tx_after_finished; /**< records sent by openssl with app keys */
+  u32 n_staged;		   /**< records in the worker's batch */
+  u32 tx_pending;	   /**< bytes to be enqueued to tcp */
+  u32 rx_pending;	   /**< bytes reserved in app rx fifo */
+  u32 rx_staged;	   /**< tcp rx fifo bytes peeked */
+  u32 rx_consumed;
+  u16 flags;
+  u8 key_len;
+} openssl_rec_t;
+
+/** Record queued for encryption or decryption */
+typedef struct openssl_rec_op_
+{
+  u32 ctx_index;
+  u32 offset;
+  u32 len;
+  u8 nonce[TLSO_REC_IV_LEN];
+} openssl_rec_op_t;
+
+typedef enum openssl_rec_dir_
+{
+  OPENSSL_REC_TX,
+  OPENSSL_REC_RX,
+  OPENSSL_REC_N_DIR,
+} openssl_rec_dir_t;
+
+typedef struct openssl_rec_batch_
+{
+  vnet_crypto_op_t *ops;
+  openssl_rec_op_t *rec_ops;
+  u32 n_ops;
+} openssl_rec_batch_t;
+
+/** Records of all sessions on a worker, protected in one go per dispatch */
+typedef struct openssl_rec_wrk_
+{
+  openssl_rec_batch_t batch[OPENSSL_REC_N_DIR];
+  u8 *buf;
+  u32 buf_len;
+  u32 key_req; /**< key install requests sent to main thread */
+} openssl_rec_wrk_t;
+
 typedef struct tls_ctx_openssl_
 {
   tls_ctx_t ctx;			/**< First */
@@ -37,6 +127,8 @@ typedef struct tls_ctx_openssl_
   SSL *ssl;
   BIO *rbio;
   BIO *wbio;
+  u8 *session_key;			/**< client session cache key */
+  openssl_rec_t *rec;			/**< record offload state */
 } openssl_ctx_t;
 
 typedef struct tls_listen_ctx_opensl_
@@ -48,6 +140,21 @@ typedef struct tls_listen_ctx_opensl_
   EVP_PKEY *pkey;
 } openssl_listen_ctx_t;
 
+typedef struct openssl_cached_session_
+{
+  u8 *key;
+  SSL_SESSION *session;
+} openssl_cached_session_t;
+
+/** Client sessions for resumption, shared by all workers */
+typedef struct openssl_session_cache_
+{
+  clib_spinlock_t lock;
+  uword *entry_by_key;
+  openssl_cached_session_t *entries; /**< ring, oldest entry evicted */
+  u32 next_entry;
+} openssl_session_cache_t;
+
 typedef struct openssl_main_
 {
   openssl_ctx_t ***ctx_pool;
@@ -60,6 +167,8 @@ typedef struct openssl_main_
   u16 msg_id_base;
 
   X509_STORE *cert_store;
+  openssl_session_cache_t session_cache;
+  openssl_rec_wrk_t *rec_wrk;
   u8 *ciphers;
   int engine_init;
   int async;
@@ -80,6 +189,21 @@ void openssl_async_node_enable_disable (u8 is_en);
 clib_error_t *tls_openssl_api_init (vlib_main_t * vm);
 int tls_openssl_set_ciphers (char *ciphers);
 int vpp_openssl_is_inflight (tls_ctx_t * ctx);
+void openssl_rec_init (void);
+void openssl_rec_listen_init (SSL_CTX *ssl_ctx);
+void openssl_rec_srv_init (openssl_ctx_t *oc);
+int openssl_rec_enable (openssl_ctx_t *oc);
+int openssl_rec_write (openssl_ctx_t *oc, session_t *app_session,
+		       transport_send_params_t *sp);
+int openssl_rec_read (openssl_ctx_t *oc, session_t *ts);
+void openssl_rec_app_close (openssl_ctx_t *oc);
+void openssl_rec_free (openssl_ctx_t *oc);
+
+static inline int
+openssl_rec_is_active (openssl_ctx_t *oc)
+{
+  return oc->rec && (oc->rec->flags & OPENSSL_REC_F_ACTIVE);
+}
 
 #endif /* SRC_PLUGINS_TLSOPENSSL_TLS_OPENSSL_H_ */
 
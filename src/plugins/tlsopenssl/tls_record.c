@@ -0,0 +1,1158 @@
+/*
+ * Copyright (c) 2022 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * TLS 1.3 record layer on top of vnet crypto
+ *
+ * OpenSSL does the handshake and the traffic secrets are captured from its
+ * key log. Once the server handshake completes, application data records
+ * are no longer handed to OpenSSL. They are staged in a per worker batch and
+ * encrypted or decrypted with one vnet_crypto_process_ops call, for all
+ * sessions on the worker, either when the batch fills up or from an
+ * interrupt node, on the next dispatch.
+ *
+ * Vnet crypto keys can only be added or deleted by the main thread, under
+ * barrier. Workers derive the keys and send them to main, which replies with
+ * the key index. Records in the direction being rekeyed are held meanwhile.
+ */
+
+#include <openssl/kdf.h>
+#include <vnet/session/session.h>
+#include <tlsopenssl/tls_openssl.h>
+
+extern openssl_main_t openssl_main;
+
+static vlib_node_registration_t openssl_rec_flush_node;
+
+#define foreach_openssl_rec_error                                             \
+  _ (TX_KEY_UPDATE, tx_key_update, INFO, "tx key updates")                    \
+  _ (RX_KEY_UPDATE, rx_key_update, INFO, "rx key updates")
+
+typedef enum
+{
+#define _(f, n, s, d) OPENSSL_REC_ERROR_##f,
+  foreach_openssl_rec_error
+#undef _
+    OPENSSL_REC_N_ERROR,
+} openssl_rec_error_t;
+
+static vlib_error_desc_t openssl_rec_error_counters[] = {
+#define _(f, n, s, d) { #n, d, VL_COUNTER_SEVERITY_##s },
+  foreach_openssl_rec_error
+#undef _
+};
+
+static inline openssl_rec_wrk_t *
+openssl_rec_wrk_get (u32 thread_index)
+{
+  return vec_elt_at_index (openssl_main.rec_wrk, thread_index);
+}
+
+static int
+openssl_rec_hkdf_expand_label (const EVP_MD *md, u8 *secret, char *label,
+			       u8 *out, u32 out_len)
+{
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+  u32 label_len = strlen (label);
+  u8 info[2 + 1 + 6 + 32 + 1], *p = info;
+  size_t len = out_len;
+  EVP_PKEY_CTX *pctx;
+  int rv = -1;
+
+  if (label_len > 32)
+    return -1;
+
+  /* HkdfLabel with empty context, RFC 8446 section 7.1 */
+  *p++ = out_len >> 8;
+  *p++ = out_len & 0xff;
+  *p++ = 6 + label_len;
+  clib_memcpy_fast (p, "tls13 ", 6);
+  p += 6;
+  clib_memcpy_fast (p, label, label_len);
+  p += label_len;
+  *p++ = 0;
+
+  pctx = EVP_PKEY_CTX_new_id (EVP_PKEY_HKDF, 0);
+  if (!pctx)
+    return -1;
+
+  if (EVP_PKEY_derive_init (pctx) <= 0 ||
+      EVP_PKEY_CTX_hkdf_mode (pctx, EVP_PKEY_HKDEF_MODE_EXPAND_ONLY) <= 0 ||
+      EVP_PKEY_CTX_set_hkdf_md (pctx, md) <= 0 ||
+      EVP_PKEY_CTX_set1_hkdf_key (pctx, secret, EVP_MD_size (md)) <= 0 ||
+      EVP_PKEY_CTX_add1_hkdf_info (pctx, info, p - info) <= 0 ||
+      EVP_PKEY_derive (pctx, out, &len) <= 0)
+    goto done;
+
+  rv = 0;
+
+done:
+  EVP_PKEY_CTX_free (pctx);
+  return rv;
+#else
+  return -1;
+#endif
+}
+
+/** Key change done by main thread on behalf of a worker */
+typedef struct openssl_rec_key_rpc_args_
+{
+  u32 thread_index;
+  u32 ctx_index;
+  u32 key_req;
+  u32 old_key_index;
+  vnet_crypto_alg_t alg;
+  u8 dir;
+  u8 key_len; /**< zero if old key is only deleted */
+  u8 key[32];
+} openssl_rec_key_rpc_args_t;
+
+typedef struct openssl_rec_key_reply_
+{
+  u32 ctx_index;
+  u32 key_req;
+  u32 key_index;
+  u8 dir;
+} openssl_rec_key_reply_t;
+
+static void openssl_rec_key_installed (void *arg);
+
+/**
+ * Add and delete vnet crypto keys on main thread
+ *
+ * Adding a key may grow the key pool and the engines' key data, which must
+ * not happen while workers use them.
+ */
+static void
+openssl_rec_key_rpc (void *arg)
+{
+  openssl_rec_key_rpc_args_t *a = arg;
+  vlib_main_t *vm = vlib_get_main ();
+  openssl_rec_key_reply_t *r;
+
+  if (a->old_key_index != ~0)
+    vnet_crypto_key_del (vm, a->old_key_index);
+
+  if (!a->key_len)
+    return;
+
+  r = clib_mem_alloc (sizeof (*r));
+  r->ctx_index = a->ctx_index;
+  r->key_req = a->key_req;
+  r->dir = a->dir;
+  r->key_index = vnet_crypto_key_add (vm, a->alg, a->key, a->key_len);
+  OPENSSL_cleanse (a->key, sizeof (a->key));
+
+  session_send_rpc_evt_to_thread_force (a->thread_index,
+					openssl_rec_key_installed, r);
+}
+
+static void
+openssl_rec_key_del (u32 key_index)
+{
+  openssl_rec_key_rpc_args_t a = { .old_key_index = key_index };
+
+  if (key_index != ~0)
+    vlib_rpc_call_main_thread (openssl_rec_key_rpc, (u8 *) &a, sizeof (a));
+}
+
+/**
+ * Derive write key and iv from traffic secret and ask main thread to
+ * replace the vnet crypto key
+ */
+static int
+openssl_rec_key_set (openssl_ctx_t *oc, openssl_rec_dir_t dir)
+{
+  openssl_rec_wrk_t *wrk = openssl_rec_wrk_get (oc->ctx.c_thread_index);
+  openssl_rec_key_rpc_args_t a = {};
+  openssl_rec_t *rec = oc->rec;
+  openssl_rec_key_t *k;
+
+  k = dir == OPENSSL_REC_TX ? &rec->tx : &rec->rx;
+  if (openssl_rec_hkdf_expand_label (rec->md, k->secret, "key", a.key,
+				     rec->key_len) ||
+      openssl_rec_hkdf_expand_label (rec->md, k->secret, "iv", k->iv,
+				     TLSO_REC_IV_LEN))
+    {
+      OPENSSL_cleanse (a.key, sizeof (a.key));
+      return -1;
+    }
+
+  /* Replies to older requests, if any, are ignored */
+  k->key_req = ++wrk->key_req;
+
+  a.thread_index = oc->ctx.c_thread_index;
+  a.ctx_index = oc->openssl_ctx_index;
+  a.key_req = k->key_req;
+  a.old_key_index = k->key_index;
+  a.alg = rec->alg;
+  a.dir = dir;
+  a.key_len = rec->key_len;
+  vlib_rpc_call_main_thread (openssl_rec_key_rpc, (u8 *) &a, sizeof (a));
+  OPENSSL_cleanse (a.key, sizeof (a.key));
+
+  k->key_index = ~0;
+  k->seq = 0;
+  rec->flags |= OPENSSL_REC_F_TX_KEY_PENDING << dir;
+
+  return 0;
+}
+
+/**
+ * Move to next generation of traffic secret after key update
+ */
+static int
+openssl_rec_key_update (openssl_ctx_t *oc, openssl_rec_dir_t dir)
+{
+  openssl_rec_t *rec = oc->rec;
+  u8 secret[EVP_MAX_MD_SIZE];
+  openssl_rec_key_t *k;
+  int rv;
+
+  vlib_node_increment_counter (vlib_get_main (), openssl_rec_flush_node.index,
+			       OPENSSL_REC_ERROR_TX_KEY_UPDATE + dir, 1);
+
+  k = dir == OPENSSL_REC_TX ? &rec->tx : &rec->rx;
+  rv = openssl_rec_hkdf_expand_label (rec->md, k->secret, "traffic upd",
+				      secret, EVP_MD_size (rec->md));
+  if (!rv)
+    {
+      clib_memcpy_fast (k->secret, secret, EVP_MD_size (rec->md));
+      rv = openssl_rec_key_set (oc, dir);
+    }
+  OPENSSL_cleanse (secret, sizeof (secret));
+  return rv;
+}
+
+static inline void
+openssl_rec_nonce (openssl_rec_key_t *k, u8 *nonce)
+{
+  u64 seq = clib_host_to_net_u64 (k->seq++);
+  u8 *s = (u8 *) &seq;
+  int i;
+
+  clib_memcpy_fast (nonce, k->iv, TLSO_REC_IV_LEN);
+  for (i = 0; i < sizeof (seq); i++)
+    nonce[TLSO_REC_IV_LEN - sizeof (seq) + i] ^= s[i];
+}
+
+static inline int
+openssl_rec_wrk_has_space (openssl_rec_wrk_t *wrk, openssl_rec_dir_t dir,
+			   u32 len)
+{
+  return wrk->batch[dir].n_ops < TLSO_REC_MAX_OPS &&
+	 wrk->buf_len + len <= TLSO_REC_BUF_SIZE;
+}
+
+static inline openssl_rec_op_t *
+openssl_rec_op_alloc (openssl_ctx_t *oc, openssl_rec_wrk_t *wrk,
+		      openssl_rec_dir_t dir, u32 len, vnet_crypto_op_t **op)
+{
+  openssl_rec_batch_t *b = &wrk->batch[dir];
+  openssl_rec_op_t *rop;
+
+  if (!wrk->batch[OPENSSL_REC_TX].n_ops && !wrk->batch[OPENSSL_REC_RX].n_ops)
+    vlib_node_set_interrupt_pending (vlib_get_main (),
+				     openssl_rec_flush_node.index);
+
+  *op = &b->ops[b->n_ops];
+  rop = &b->rec_ops[b->n_ops];
+  rop->ctx_index = oc->openssl_ctx_index;
+  rop->offset = wrk->buf_len;
+  rop->len = len;
+
+  b->n_ops += 1;
+  wrk->buf_len += len;
+  oc->rec->n_staged += 1;
+
+  return rop;
+}
+
+/**
+ * Add record to tx batch
+ *
+ * @return pointer to where plaintext of length len should be written
+ */
+static u8 *
+openssl_rec_stage_tx (openssl_ctx_t *oc, openssl_rec_wrk_t *wrk, u32 len,
+		      u8 type)
+{
+  openssl_rec_t *rec = oc->rec;
+  u32 clen = len + 1 + TLSO_REC_TAG_LEN;
+  openssl_rec_op_t *rop;
+  vnet_crypto_op_t *op;
+  u8 *hdr;
+
+  ASSERT (!(rec->flags & OPENSSL_REC_F_TX_KEY_PENDING));
+  rop = openssl_rec_op_alloc (oc, wrk, OPENSSL_REC_TX,
+			      TLSO_REC_HDR_LEN + clen, &op);
+  rec->tx_pending += rop->len;
+
+  hdr = wrk->buf + rop->offset;
+  hdr[0] = SSL3_RT_APPLICATION_DATA;
+  hdr[1] = 3;
+  hdr[2] = 3;
+  hdr[3] = clen >> 8;
+  hdr[4] = clen & 0xff;
+  /* Inner content type, no padding */
+  hdr[TLSO_REC_HDR_LEN + len] = type;
+
+  openssl_rec_nonce (&rec->tx, rop->nonce);
+
+  vnet_crypto_op_init (op, rec->enc_op);
+  op->key_index = rec->tx.key_index;
+  op->iv = rop->nonce;
+  op->aad = hdr;
+  op->aad_len = TLSO_REC_HDR_LEN;
+  op->src = op->dst = hdr + TLSO_REC_HDR_LEN;
+  op->len = len + 1;
+  op->tag = op->src + op->len;
+  op->tag_len = TLSO_REC_TAG_LEN;
+
+  return hdr + TLSO_REC_HDR_LEN;
+}
+
+/**
+ * Add record at rx_staged offset in tcp's rx fifo to rx batch
+ */
+static void
+openssl_rec_stage_rx (openssl_ctx_t *oc, openssl_rec_wrk_t *wrk,
+		      session_t *ts, u32 len)
+{
+  openssl_rec_t *rec = oc->rec;
+  openssl_rec_op_t *rop;
+  vnet_crypto_op_t *op;
+  u8 *hdr;
+  int rv;
+
+  ASSERT (!(rec->flags & OPENSSL_REC_F_RX_KEY_PENDING));
+  rop = openssl_rec_op_alloc (oc, wrk, OPENSSL_REC_RX, len, &op);
+  hdr = wrk->buf + rop->offset;
+  rv = svm_fifo_peek (ts->rx_fifo, rec->rx_staged, len, hdr);
+  ASSERT (rv == len);
+  rec->rx_staged += len;
+  /* Upper bound on plaintext enqueued to app */
+  rec->rx_pending += len - TLSO_REC_OVERHEAD;
+
+  openssl_rec_nonce (&rec->rx, rop->nonce);
+
+  vnet_crypto_op_init (op, rec->dec_op);
+  op->key_index = rec->rx.key_index;
+  op->iv = rop->nonce;
+  op->aad = hdr;
+  op->aad_len = TLSO_REC_HDR_LEN;
+  op->src = op->dst = hdr + TLSO_REC_HDR_LEN;
+  op->len = len - TLSO_REC_HDR_LEN - TLSO_REC_TAG_LEN;
+  op->tag = op->src + op->len;
+  op->tag_len = TLSO_REC_TAG_LEN;
+}
+
+static void
+openssl_rec_tx_done (openssl_ctx_t *oc, vnet_crypto_op_t *op, u8 *data,
+		     u32 len)
+{
+  openssl_rec_t *rec = oc->rec;
+  session_t *ts;
+
+  rec->tx_pending -= len;
+  if (rec->flags & OPENSSL_REC_F_ERROR)
+    return;
+
+  if (op->status != VNET_CRYPTO_OP_STATUS_COMPLETED)
+    {
+      rec->flags |= OPENSSL_REC_F_ERROR;
+      return;
+    }
+
+  /* Space reserved when record was staged */
+  ts = session_get_from_handle (oc->ctx.tls_session_handle);
+  if (svm_fifo_enqueue (ts->tx_fifo, len, data) != len)
+    {
+      rec->flags |= OPENSSL_REC_F_ERROR;
+      return;
+    }
+  rec->flags |= OPENSSL_REC_F_TX_EVT;
+}
+
+static void
+openssl_rec_handshake_rx (openssl_ctx_t *oc, u8 *data, u32 len)
+{
+  openssl_rec_t *rec = oc->rec;
+  u32 msg_len;
+
+  while (len)
+    {
+      if (len < 4)
+	goto error;
+      msg_len = (data[1] << 16) | (data[2] << 8) | data[3];
+      if (msg_len > len - 4)
+	goto error;
+
+      /* Only post-handshake message a client can send without being asked */
+      if (data[0] != SSL3_MT_KEY_UPDATE || msg_len != 1 || data[4] > 1)
+	goto error;
+
+      if (openssl_rec_key_update (oc, OPENSSL_REC_RX))
+	goto error;
+
+      /* Records staged after this one need the new key */
+      rec->flags |= OPENSSL_REC_F_RX_ABORT;
+      if (data[4])
+	rec->flags |= OPENSSL_REC_F_SEND_KEY_UPDATE;
+
+      data += 4 + msg_len;
+      len -= 4 + msg_len;
+    }
+  return;
+
+error:
+  rec->flags |= OPENSSL_REC_F_ERROR;
+}
+
+static void
+openssl_rec_rx_done (openssl_ctx_t *oc, vnet_crypto_op_t *op, u8 *hdr,
+		     u32 len)
+{
+  openssl_rec_t *rec = oc->rec;
+  session_t *ts, *app_session;
+  u8 *data, type;
+  u32 n;
+
+  rec->rx_pending -= len - TLSO_REC_OVERHEAD;
+  rec->rx_staged -= len;
+
+  /* Left in tcp's fifo, to be read again or dropped with the session */
+  if (rec->flags & (OPENSSL_REC_F_ERROR | OPENSSL_REC_F_RX_ABORT))
+    return;
+
+  if (op->status != VNET_CRYPTO_OP_STATUS_COMPLETED)
+    {
+      rec->flags |= OPENSSL_REC_F_ERROR;
+      return;
+    }
+
+  ts = session_get_from_handle (oc->ctx.tls_session_handle);
+  svm_fifo_dequeue_drop (ts->rx_fifo, len);
+  rec->rx_consumed += len;
+
+  /* Strip padding to find inner content type */
+  data = hdr + TLSO_REC_HDR_LEN;
+  n = op->len;
+  while (n && !data[n - 1])
+    n--;
+  if (!n)
+    {
+      rec->flags |= OPENSSL_REC_F_ERROR;
+      return;
+    }
+  type = data[--n];
+
+  switch (type)
+    {
+    case SSL3_RT_APPLICATION_DATA:
+      if (!n || (rec->flags & OPENSSL_REC_F_PEER_CLOSED))
+	break;
+      app_session = session_get_from_handle (oc->ctx.app_session_handle);
+      if (svm_fifo_enqueue (app_session->rx_fifo, n, data) != n)
+	{
+	  rec->flags |= OPENSSL_REC_F_ERROR;
+	  break;
+	}
+      rec->flags |= OPENSSL_REC_F_RX_NTF;
+      break;
+    case SSL3_RT_ALERT:
+      if (n != 2 || data[0] == SSL3_AL_FATAL)
+	rec->flags |= OPENSSL_REC_F_ERROR;
+      /* Like with openssl, wait for transport close */
+      else if (data[1] == SSL3_AD_CLOSE_NOTIFY)
+	rec->flags |= OPENSSL_REC_F_PEER_CLOSED;
+      break;
+    case SSL3_RT_HANDSHAKE:
+      openssl_rec_handshake_rx (oc, data, n);
+      break;
+    default:
+      rec->flags |= OPENSSL_REC_F_ERROR;
+      break;
+    }
+}
+
+static void openssl_rec_flush (vlib_main_t *vm, openssl_rec_wrk_t *wrk);
+
+static void
+openssl_rec_send_key_update (openssl_ctx_t *oc)
+{
+  openssl_rec_wrk_t *wrk = openssl_rec_wrk_get (oc->ctx.c_thread_index);
+  vlib_main_t *vm = vlib_get_main ();
+  openssl_rec_t *rec = oc->rec;
+  u8 *data;
+
+  rec->flags &= ~OPENSSL_REC_F_SEND_KEY_UPDATE;
+
+  if (!openssl_rec_wrk_has_space (wrk, OPENSSL_REC_TX,
+				  TLSO_REC_OVERHEAD + 5))
+    openssl_rec_flush (vm, wrk);
+
+  data = openssl_rec_stage_tx (oc, wrk, 5, SSL3_RT_HANDSHAKE);
+  data[0] = SSL3_MT_KEY_UPDATE;
+  data[1] = data[2] = 0;
+  data[3] = 1;
+  /* update_requested only when rekeying on our own */
+  data[4] = (rec->flags & OPENSSL_REC_F_REQUEST_KEY_UPDATE) ? 1 : 0;
+  rec->flags &= ~OPENSSL_REC_F_REQUEST_KEY_UPDATE;
+
+  /* Everything staged so far must go out with the current key */
+  openssl_rec_flush (vm, wrk);
+
+  if (!(rec->flags & OPENSSL_REC_F_ERROR) &&
+      openssl_rec_key_update (oc, OPENSSL_REC_TX))
+    rec->flags |= OPENSSL_REC_F_ERROR;
+}
+
+static void
+openssl_rec_flush_notify (openssl_ctx_t *oc)
+{
+  openssl_rec_t *rec = oc->rec;
+  tls_ctx_t *ctx = &oc->ctx;
+  session_t *ts, *app_session;
+
+  rec->flags &= ~OPENSSL_REC_F_IN_FLUSH;
+  ts = session_get_from_handle (ctx->tls_session_handle);
+
+  if (rec->flags & OPENSSL_REC_F_TX_EVT)
+    {
+      rec->flags &= ~OPENSSL_REC_F_TX_EVT;
+      tls_add_vpp_q_tx_evt (ts);
+    }
+
+  if (rec->rx_consumed)
+    {
+      if (svm_fifo_needs_deq_ntf (ts->rx_fifo, rec->rx_consumed))
+	{
+	  svm_fifo_clear_deq_ntf (ts->rx_fifo);
+	  session_send_io_evt_to_thread (ts->rx_fifo, SESSION_IO_EVT_RX);
+	}
+      rec->rx_consumed = 0;
+    }
+
+  if (PREDICT_FALSE (rec->flags & OPENSSL_REC_F_ERROR))
+    {
+      if (!(rec->flags & OPENSSL_REC_F_ERROR_NTF))
+	{
+	  rec->flags |= OPENSSL_REC_F_ERROR_NTF;
+	  tls_notify_app_io_error (ctx);
+	}
+      return;
+    }
+
+  if (rec->flags & OPENSSL_REC_F_RX_ABORT)
+    {
+      rec->flags &= ~OPENSSL_REC_F_RX_ABORT;
+      tls_add_vpp_q_builtin_rx_evt (ts);
+    }
+
+  /* Otherwise sent once the current key is installed */
+  if ((rec->flags &
+       (OPENSSL_REC_F_SEND_KEY_UPDATE | OPENSSL_REC_F_TX_KEY_PENDING)) ==
+      OPENSSL_REC_F_SEND_KEY_UPDATE)
+    openssl_rec_send_key_update (oc);
+
+  if (rec->flags & OPENSSL_REC_F_RX_NTF)
+    {
+      rec->flags &= ~OPENSSL_REC_F_RX_NTF;
+      app_session = session_get_from_handle (ctx->app_session_handle);
+      /* If handshake just completed, session may still be in accepting
+       * state */
+      if (app_session->session_state >= SESSION_STATE_READY)
+	tls_notify_app_enqueue (ctx, app_session);
+    }
+}
+
+/**
+ * Encrypt and decrypt all staged records and pass them on
+ *
+ * Notifications are only sent once the batch is reset, so callbacks can
+ * safely stage, or flush, new records.
+ */
+static void
+openssl_rec_flush (vlib_main_t *vm, openssl_rec_wrk_t *wrk)
+{
+  u32 ctx_indices[OPENSSL_REC_N_DIR * TLSO_REC_MAX_OPS];
+  openssl_main_t *om = &openssl_main;
+  u32 thread_index = vm->thread_index;
+  u32 i, n_ctx = 0, dir;
+  openssl_rec_batch_t *b;
+  openssl_rec_op_t *rop;
+  openssl_ctx_t **ocp;
+  openssl_ctx_t *oc;
+
+  if (!wrk->batch[OPENSSL_REC_TX].n_ops && !wrk->batch[OPENSSL_REC_RX].n_ops)
+    return;
+
+  for (dir = 0; dir < OPENSSL_REC_N_DIR; dir++)
+    {
+      b = &wrk->batch[dir];
+      if (b->n_ops)
+	vnet_crypto_process_ops (vm, b->ops, b->n_ops);
+    }
+
+  for (dir = 0; dir < OPENSSL_REC_N_DIR; dir++)
+    {
+      b = &wrk->batch[dir];
+      for (i = 0; i < b->n_ops; i++)
+	{
+	  rop = &b->rec_ops[i];
+	  /* Session freed after record was staged */
+	  if (rop->ctx_index == ~0)
+	    continue;
+
+	  oc = *pool_elt_at_index (om->ctx_pool[thread_index], rop->ctx_index);
+	  oc->rec->n_staged -= 1;
+	  if (!(oc->rec->flags & OPENSSL_REC_F_IN_FLUSH))
+	    {
+	      oc->rec->flags |= OPENSSL_REC_F_IN_FLUSH;
+	      ctx_indices[n_ctx++] = rop->ctx_index;
+	    }
+
+	  if (dir == OPENSSL_REC_TX)
+	    openssl_rec_tx_done (oc, &b->ops[i], wrk->buf + rop->offset,
+				 rop->len);
+	  else
+	    openssl_rec_rx_done (oc, &b->ops[i], wrk->buf + rop->offset,
+				 rop->len);
+	}
+      b->n_ops = 0;
+    }
+  wrk->buf_len = 0;
+
+  for (i = 0; i < n_ctx; i++)
+    {
+      /* Callbacks may have cleaned up sessions already notified */
+      if (pool_is_free_index (om->ctx_pool[thread_index], ctx_indices[i]))
+	continue;
+      ocp = pool_elt_at_index (om->ctx_pool[thread_index], ctx_indices[i]);
+      oc = *ocp;
+      if (!oc->rec || !(oc->rec->flags & OPENSSL_REC_F_IN_FLUSH))
+	continue;
+      openssl_rec_flush_notify (oc);
+    }
+}
+
+static void
+openssl_rec_confirm_app_close (openssl_ctx_t *oc)
+{
+  openssl_rec_wrk_t *wrk = openssl_rec_wrk_get (oc->ctx.c_thread_index);
+  vlib_main_t *vm = vlib_get_main ();
+  tls_ctx_t *ctx = &oc->ctx;
+  u8 *data;
+
+  if (!(oc->rec->flags & OPENSSL_REC_F_ERROR))
+    {
+      if (!openssl_rec_wrk_has_space (wrk, OPENSSL_REC_TX,
+				      TLSO_REC_OVERHEAD + 2))
+	openssl_rec_flush (vm, wrk);
+      data = openssl_rec_stage_tx (oc, wrk, 2, SSL3_RT_ALERT);
+      data[0] = SSL3_AL_WARNING;
+      data[1] = SSL3_AD_CLOSE_NOTIFY;
+      openssl_rec_flush (vm, wrk);
+    }
+
+  tls_disconnect_transport (ctx);
+  session_transport_closed_notify (&ctx->connection);
+}
+
+/**
+ * Main thread added a key, resume records held meanwhile
+ */
+static void
+openssl_rec_key_installed (void *arg)
+{
+  u32 thread_index = vlib_get_thread_index ();
+  openssl_rec_key_reply_t *r = arg;
+  openssl_main_t *om = &openssl_main;
+  session_t *ts, *app_session;
+  openssl_rec_key_t *k = 0;
+  openssl_ctx_t *oc = 0;
+  openssl_rec_t *rec;
+
+  if (!pool_is_free_index (om->ctx_pool[thread_index], r->ctx_index))
+    oc = *pool_elt_at_index (om->ctx_pool[thread_index], r->ctx_index);
+  if (oc && (rec = oc->rec))
+    k = r->dir == OPENSSL_REC_TX ? &rec->tx : &rec->rx;
+
+  /* Session freed or key updated again meanwhile */
+  if (!k || k->key_req != r->key_req)
+    {
+      openssl_rec_key_del (r->key_index);
+      goto done;
+    }
+
+  rec->flags &= ~(OPENSSL_REC_F_TX_KEY_PENDING << r->dir);
+  if (r->key_index == ~0)
+    {
+      rec->flags |= OPENSSL_REC_F_ERROR | OPENSSL_REC_F_ERROR_NTF;
+      tls_notify_app_io_error (&oc->ctx);
+      goto done;
+    }
+  k->key_index = r->key_index;
+
+  if (r->dir == OPENSSL_REC_RX)
+    {
+      ts = session_get_from_handle (oc->ctx.tls_session_handle);
+      tls_add_vpp_q_builtin_rx_evt (ts);
+      goto done;
+    }
+
+  if (rec->flags & OPENSSL_REC_F_SEND_KEY_UPDATE)
+    {
+      openssl_rec_send_key_update (oc);
+      goto done;
+    }
+
+  app_session = session_get_from_handle (oc->ctx.app_session_handle);
+  if (oc->ctx.app_closed && !svm_fifo_max_dequeue_cons (app_session->tx_fifo))
+    openssl_rec_confirm_app_close (oc);
+  else
+    transport_connection_reschedule (&oc->ctx.connection);
+
+done:
+  clib_mem_free (r);
+}
+
+int
+openssl_rec_write (openssl_ctx_t *oc, session_t *app_session,
+		   transport_send_params_t *sp)
+{
+  openssl_rec_wrk_t *wrk = openssl_rec_wrk_get (oc->ctx.c_thread_index);
+  u32 deq_max, space, enq_buf, n_recs, len;
+  tls_main_t *tm = vnet_tls_get_main ();
+  openssl_rec_t *rec = oc->rec;
+  tls_ctx_t *ctx = &oc->ctx;
+  session_t *ts;
+  int wrote = 0;
+  svm_fifo_t *f;
+  u8 *data;
+
+  if (PREDICT_FALSE (rec->flags & OPENSSL_REC_F_ERROR))
+    return 0;
+
+  /* Rekey both directions after configured number of records */
+  if (PREDICT_FALSE (tm->record_key_update &&
+		     rec->tx.seq >= tm->record_key_update &&
+		     !(rec->flags & OPENSSL_REC_F_TX_KEY_PENDING)))
+    {
+      rec->flags |= OPENSSL_REC_F_REQUEST_KEY_UPDATE;
+      openssl_rec_send_key_update (oc);
+      if (PREDICT_FALSE (rec->flags & OPENSSL_REC_F_ERROR))
+	return 0;
+    }
+
+  /* Rescheduled once main thread installs the key */
+  if (PREDICT_FALSE (rec->flags & OPENSSL_REC_F_TX_KEY_PENDING))
+    {
+      transport_connection_deschedule (&ctx->connection);
+      sp->flags |= TRANSPORT_SND_F_DESCHED;
+      return 0;
+    }
+
+  ts = session_get_from_handle (ctx->tls_session_handle);
+  space = svm_fifo_max_enqueue_prod (ts->tx_fifo);
+  /* Leave room for records not yet enqueued and for tls ctrl data */
+  space = clib_max ((int) space - (int) rec->tx_pending - TLSO_CTRL_BYTES, 0);
+
+  f = app_session->tx_fifo;
+
+  n_recs = space / (TLSO_REC_MAX_PLAIN + TLSO_REC_OVERHEAD) + 1;
+  deq_max = svm_fifo_max_dequeue_cons (f);
+  deq_max = clib_min (deq_max,
+		      clib_max ((int) (space - n_recs * TLSO_REC_OVERHEAD), 0));
+  if (!deq_max)
+    goto check_tls_fifo;
+
+  deq_max = clib_min (deq_max, sp->max_burst_size);
+  n_recs = deq_max / TLSO_REC_MAX_PLAIN + 1;
+
+  /* Make sure tcp's tx fifo can buffer all records once encrypted */
+  if (svm_fifo_provision_chunks (ts->tx_fifo, 0, 0,
+				 rec->tx_pending + deq_max +
+				   n_recs * TLSO_REC_OVERHEAD + TLSO_CTRL_BYTES))
+    goto check_tls_fifo;
+
+  if (!openssl_rec_wrk_has_space (wrk, OPENSSL_REC_TX,
+				  TLSO_REC_MAX_PLAIN + TLSO_REC_OVERHEAD))
+    {
+      openssl_rec_flush (vlib_get_main (), wrk);
+      if (PREDICT_FALSE (rec->flags & OPENSSL_REC_F_ERROR))
+	return 0;
+    }
+
+  while (deq_max)
+    {
+      len = clib_min (deq_max, TLSO_REC_MAX_PLAIN);
+      /* Batch full, ask for tx reschedule */
+      if (!openssl_rec_wrk_has_space (wrk, OPENSSL_REC_TX,
+				      len + TLSO_REC_OVERHEAD))
+	break;
+      data = openssl_rec_stage_tx (oc, wrk, len, SSL3_RT_APPLICATION_DATA);
+      svm_fifo_dequeue (f, len, data);
+      wrote += len;
+      deq_max -= len;
+    }
+
+  if (svm_fifo_needs_deq_ntf (f, wrote))
+    session_dequeue_notify (app_session);
+
+check_tls_fifo:
+
+  if (PREDICT_FALSE (ctx->app_closed && !svm_fifo_max_dequeue_cons (f)))
+    openssl_rec_confirm_app_close (oc);
+
+  /* Deschedule and wait for deq notification if fifo is almost full */
+  enq_buf = clib_min (svm_fifo_size (ts->tx_fifo) / 2, TLSO_MIN_ENQ_SPACE);
+  if (space < wrote + enq_buf)
+    {
+      svm_fifo_add_want_deq_ntf (ts->tx_fifo, SVM_FIFO_WANT_DEQ_NOTIF);
+      transport_connection_deschedule (&ctx->connection);
+      sp->flags |= TRANSPORT_SND_F_DESCHED;
+    }
+  else
+    /* Request tx reschedule of the app session */
+    app_session->flags |= SESSION_F_CUSTOM_TX;
+
+  return wrote;
+}
+
+int
+openssl_rec_read (openssl_ctx_t *oc, session_t *ts)
+{
+  openssl_rec_wrk_t *wrk = openssl_rec_wrk_get (oc->ctx.c_thread_index);
+  u32 avail, space, len, read = 0;
+  openssl_rec_t *rec = oc->rec;
+  u8 hdr[TLSO_REC_HDR_LEN];
+  session_t *app_session;
+  int rv, stalled = 0;
+
+  if (PREDICT_FALSE (rec->flags &
+		     (OPENSSL_REC_F_ERROR | OPENSSL_REC_F_PEER_CLOSED |
+		      OPENSSL_REC_F_RX_KEY_PENDING)))
+    return 0;
+
+  if (!openssl_rec_wrk_has_space (wrk, OPENSSL_REC_RX,
+				  TLSO_REC_HDR_LEN + TLSO_REC_MAX_CIPHER))
+    {
+      openssl_rec_flush (vlib_get_main (), wrk);
+      if (PREDICT_FALSE (rec->flags & OPENSSL_REC_F_ERROR))
+	return 0;
+      /* Session pool might grow when apps are notified */
+      ts = session_get_from_handle (oc->ctx.tls_session_handle);
+    }
+
+  app_session = session_get_from_handle (oc->ctx.app_session_handle);
+  avail = svm_fifo_max_dequeue_cons (ts->rx_fifo);
+  space = svm_fifo_max_enqueue_prod (app_session->rx_fifo);
+
+  while (rec->rx_staged + TLSO_REC_HDR_LEN <= avail)
+    {
+      rv = svm_fifo_peek (ts->rx_fifo, rec->rx_staged, TLSO_REC_HDR_LEN, hdr);
+      ASSERT (rv == TLSO_REC_HDR_LEN);
+      len = (hdr[3] << 8) | hdr[4];
+
+      /* All protected records look like application data */
+      if (hdr[0] != SSL3_RT_APPLICATION_DATA || len > TLSO_REC_MAX_CIPHER ||
+	  len <= TLSO_REC_TAG_LEN)
+	{
+	  rec->flags |= OPENSSL_REC_F_ERROR | OPENSSL_REC_F_ERROR_NTF;
+	  tls_notify_app_io_error (&oc->ctx);
+	  return 0;
+	}
+
+      len += TLSO_REC_HDR_LEN;
+      if (rec->rx_staged + len > avail)
+	break;
+
+      if (rec->rx_pending + len - TLSO_REC_OVERHEAD > space ||
+	  !openssl_rec_wrk_has_space (wrk, OPENSSL_REC_RX, len))
+	{
+	  stalled = 1;
+	  break;
+	}
+
+      openssl_rec_stage_rx (oc, wrk, ts, len);
+      read += len;
+    }
+
+  /* Retry once app dequeues or batch is flushed */
+  if (stalled)
+    tls_add_vpp_q_builtin_rx_evt (ts);
+
+  return read;
+}
+
+void
+openssl_rec_app_close (openssl_ctx_t *oc)
+{
+  session_t *app_session;
+
+  /* Wait for all data to be written to tcp and for the tx key */
+  app_session = session_get_from_handle (oc->ctx.app_session_handle);
+  if (!svm_fifo_max_dequeue_cons (app_session->tx_fifo) &&
+      !(oc->rec->flags & OPENSSL_REC_F_TX_KEY_PENDING))
+    openssl_rec_confirm_app_close (oc);
+  else
+    oc->ctx.app_closed = 1;
+}
+
+/**
+ * Switch to vnet crypto record layer once server handshake is done
+ *
+ * Falls back to openssl if the session or cipher are not supported.
+ */
+int
+openssl_rec_enable (openssl_ctx_t *oc)
+{
+  openssl_rec_t *rec = oc->rec;
+  const SSL_CIPHER *cipher;
+  openssl_rec_wrk_t *wrk;
+  u32 i;
+
+  if (!rec)
+    return -1;
+
+  SSL_set_msg_callback (oc->ssl, 0);
+
+  if (SSL_version (oc->ssl) != TLS1_3_VERSION ||
+      (rec->flags & (OPENSSL_REC_F_TX_SECRET | OPENSSL_REC_F_RX_SECRET)) !=
+	(OPENSSL_REC_F_TX_SECRET | OPENSSL_REC_F_RX_SECRET) ||
+      SSL_has_pending (oc->ssl))
+    goto disable;
+
+  cipher = SSL_get_current_cipher (oc->ssl);
+  switch (SSL_CIPHER_get_id (cipher))
+    {
+    case TLS1_3_CK_AES_128_GCM_SHA256:
+      rec->alg = VNET_CRYPTO_ALG_AES_128_GCM;
+      rec->enc_op = VNET_CRYPTO_OP_AES_128_GCM_ENC;
+      rec->dec_op = VNET_CRYPTO_OP_AES_128_GCM_DEC;
+      rec->key_len = 16;
+      break;
+    case TLS1_3_CK_AES_256_GCM_SHA384:
+      rec->alg = VNET_CRYPTO_ALG_AES_256_GCM;
+      rec->enc_op = VNET_CRYPTO_OP_AES_256_GCM_ENC;
+      rec->dec_op = VNET_CRYPTO_OP_AES_256_GCM_DEC;
+      rec->key_len = 32;
+      break;
+    case TLS1_3_CK_CHACHA20_POLY1305_SHA256:
+      rec->alg = VNET_CRYPTO_ALG_CHACHA20_POLY1305;
+      rec->enc_op = VNET_CRYPTO_OP_CHACHA20_POLY1305_ENC;
+      rec->dec_op = VNET_CRYPTO_OP_CHACHA20_POLY1305_DEC;
+      rec->key_len = 32;
+      break;
+    default:
+      goto disable;
+    }
+
+  if (!vnet_crypto_is_set_handler (rec->alg))
+    goto disable;
+
+  rec->md = SSL_CIPHER_get_handshake_digest (cipher);
+  if (!rec->md)
+    goto disable;
+
+  /* Records are held until main thread installs the keys */
+  rec->flags = OPENSSL_REC_F_ACTIVE;
+  if (openssl_rec_key_set (oc, OPENSSL_REC_TX) ||
+      openssl_rec_key_set (oc, OPENSSL_REC_RX))
+    goto disable;
+
+  /* Openssl already sent session tickets with the application keys */
+  rec->tx.seq = rec->n_tx_after_finished;
+
+  wrk = openssl_rec_wrk_get (oc->ctx.c_thread_index);
+  if (!wrk->buf)
+    {
+      vec_validate (wrk->buf, TLSO_REC_BUF_SIZE - 1);
+      for (i = 0; i < OPENSSL_REC_N_DIR; i++)
+	{
+	  vec_validate_aligned (wrk->batch[i].ops, TLSO_REC_MAX_OPS - 1,
+				CLIB_CACHE_LINE_BYTES);
+	  vec_validate (wrk->batch[i].rec_ops, TLSO_REC_MAX_OPS - 1);
+	}
+    }
+
+  return 0;
+
+disable:
+  TLS_DBG (1, "record offload not possible for %u", oc->openssl_ctx_index);
+  openssl_rec_free (oc);
+  return -1;
+}
+
+void
+openssl_rec_free (openssl_ctx_t *oc)
+{
+  openssl_rec_t *rec = oc->rec;
+  openssl_rec_wrk_t *wrk;
+  openssl_rec_batch_t *b;
+  u32 i, dir;
+
+  if (!rec)
+    return;
+
+  /* Drop records still in the batch */
+  if (rec->n_staged)
+    {
+      wrk = openssl_rec_wrk_get (oc->ctx.c_thread_index);
+      for (dir = 0; dir < OPENSSL_REC_N_DIR; dir++)
+	{
+	  b = &wrk->batch[dir];
+	  for (i = 0; i < b->n_ops; i++)
+	    if (b->rec_ops[i].ctx_index == oc->openssl_ctx_index)
+	      b->rec_ops[i].ctx_index = ~0;
+	}
+    }
+
+  /* Keys still being added are deleted when main thread replies */
+  openssl_rec_key_del (rec->tx.key_index);
+  openssl_rec_key_del (rec->rx.key_index);
+
+  OPENSSL_cleanse (rec, sizeof (*rec));
+  clib_mem_free (rec);
+  oc->rec = 0;
+}
+
+static void
+openssl_rec_keylog_cb (const SSL *ssl, const char *line)
+{
+  openssl_ctx_t *oc = SSL_get_app_data (ssl);
+  unformat_input_t input;
+  openssl_rec_key_t *k;
+  u8 *secret = 0;
+  char *hex;
+  u16 flag;
+
+  if (!oc || !oc->rec)
+    return;
+
+  /* Format is label, client random and secret, all hex encoded */
+  if (!strncmp (line, "SERVER_TRAFFIC_SECRET_0 ", 24))
+    {
+      k = &oc->rec->tx;
+      flag = OPENSSL_REC_F_TX_SECRET;
+    }
+  else if (!strncmp (line, "CLIENT_TRAFFIC_SECRET_0 ", 24))
+    {
+      k = &oc->rec->rx;
+      flag = OPENSSL_REC_F_RX_SECRET;
+    }
+  else
+    return;
+
+  hex = strrchr (line, ' ') + 1;
+  unformat_init_string (&input, hex, strlen (hex));
+  if (unformat (&input, "%U", unformat_hex_string, &secret) &&
+      vec_len (secret) <= sizeof (k->secret))
+    {
+      clib_memcpy_fast (k->secret, secret, vec_len (secret));
+      oc->rec->flags |= flag;
+    }
+  unformat_free (&input);
+
+  if (secret)
+    OPENSSL_cleanse (secret, vec_len (secret));
+  vec_free (secret);
+}
+
+/**
+ * Count records openssl protects with the application keys, i.e., the ones
+ * after server's finished message, to find the first tx sequence number.
+ */
+static void
+openssl_rec_msg_cb (int write_p, int version, int content_type,
+		    const void *buf, size_t len, SSL *ssl, void *arg)
+{
+  openssl_ctx_t *oc = SSL_get_app_data (ssl);
+  openssl_rec_t *rec;
+
+  if (!write_p || !oc || !oc->rec)
+    return;
+
+  rec = oc->rec;
+  if (content_type == SSL3_RT_HANDSHAKE && len &&
+      ((u8 *) buf)[0] == SSL3_MT_FINISHED)
+    rec->flags |= OPENSSL_REC_F_SRV_FINISHED;
+  else if (content_type == SSL3_RT_HEADER &&
+	   (rec->flags & OPENSSL_REC_F_SRV_FINISHED))
+    rec->n_tx_after_finished += 1;
+}
+
+void
+openssl_rec_listen_init (SSL_CTX *ssl_ctx)
+{
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+  SSL_CTX_set_keylog_callback (ssl_ctx, openssl_rec_keylog_cb);
+#endif
+}
+
+void
+openssl_rec_srv_init (openssl_ctx_t *oc)
+{
+  openssl_rec_t *rec;
+
+  rec = clib_mem_alloc (sizeof (*rec));
+  clib_memset (rec, 0, sizeof (*rec));
+  rec->tx.key_index = rec->rx.key_index = ~0;
+  oc->rec = rec;
+
+  SSL_set_app_data (oc->ssl, oc);
+  SSL_set_msg_callback (oc->ssl, openssl_rec_msg_cb);
+}
+
+static uword
+openssl_rec_flush_node_fn (vlib_main_t *vm, vlib_node_runtime_t *node,
+			   vlib_frame_t *frame)
+{
+  openssl_rec_wrk_t *wrk = openssl_rec_wrk_get (vm->thread_index);
+  u32 n_ops;
+
+  n_ops = wrk->batch[OPENSSL_REC_TX].n_ops + wrk->batch[OPENSSL_REC_RX].n_ops;
+  openssl_rec_flush (vm, wrk);
+
+  return n_ops;
+}
+
+VLIB_REGISTER_NODE (openssl_rec_flush_node, static) = {
+  .function = openssl_rec_flush_node_fn,
+  .name = "tls-openssl-rec-flush",
+  .type = VLIB_NODE_TYPE_INPUT,
+  .state = VLIB_NODE_STATE_INTERRUPT,
+  .n_errors = OPENSSL_REC_N_ERROR,
+  .error_counters = openssl_rec_error_counters,
+};
+
+void
+openssl_rec_init (void)
+{
+  vlib_thread_main_t *vtm = vlib_get_thread_main ();
+  openssl_main_t *om = &openssl_main;
+
+  vec_validate (om->rec_wrk, vtm->n_threads);
+}
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
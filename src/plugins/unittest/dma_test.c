@@ -0,0 +1,195 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright (c) 2024 Cisco Systems, Inc.
+ */
+
+#include <vlib/vlib.h>
+#include <vlib/dma/dma.h>
+
+/*
+ * Software dma backend for tests. Copies are only done, and batches
+ * completed, once they have been in flight for the configured delay, so
+ * that users see their batches overlap as they would with a device.
+ */
+
+typedef struct
+{
+  void *src;
+  void *dst;
+  u32 size;
+} dma_test_transfer_t;
+
+typedef struct
+{
+  vlib_dma_batch_t batch;
+  f64 submit_time;
+  u32 config_index;
+  dma_test_transfer_t transfers[0];
+} dma_test_batch_t;
+
+typedef struct
+{
+  /* free batches, per config index */
+  dma_test_batch_t ***freelists;
+  dma_test_batch_t **pending;
+  u64 n_submitted;
+  u64 n_completed;
+} dma_test_thread_t;
+
+typedef struct
+{
+  dma_test_thread_t *threads;
+  f64 delay;
+  u32 max_batches;
+  u8 registered;
+} dma_test_main_t;
+
+static dma_test_main_t dma_test_main;
+
+extern vlib_node_registration_t dma_test_node;
+
+static int
+dma_test_batch_submit (vlib_main_t *vm, vlib_dma_batch_t *vb)
+{
+  dma_test_main_t *dtm = &dma_test_main;
+  dma_test_thread_t *t = vec_elt_at_index (dtm->threads, vm->thread_index);
+  dma_test_batch_t *b = (dma_test_batch_t *) vb;
+
+  if (vb->n_enq == 0)
+    {
+      vec_add1 (t->freelists[b->config_index], b);
+      return 0;
+    }
+
+  b->submit_time = vlib_time_now (vm);
+  vec_add1 (t->pending, b);
+  t->n_submitted++;
+  return 1;
+}
+
+static vlib_dma_batch_t *
+dma_test_batch_new (vlib_main_t *vm, vlib_dma_config_data_t *cd)
+{
+  dma_test_main_t *dtm = &dma_test_main;
+  dma_test_thread_t *t = vec_elt_at_index (dtm->threads, vm->thread_index);
+  u32 max_batches = dtm->max_batches ? dtm->max_batches : cd->cfg.max_batches;
+  dma_test_batch_t *b;
+
+  /* like a device ring, there is no batch while it is full */
+  if (vec_len (t->pending) >= max_batches)
+    return 0;
+
+  vec_validate (t->freelists, cd->config_index);
+  if (vec_len (t->freelists[cd->config_index]))
+    return &vec_pop (t->freelists[cd->config_index])->batch;
+
+  b = clib_mem_alloc_aligned (sizeof (dma_test_batch_t) +
+				sizeof (dma_test_transfer_t) *
+				  cd->cfg.max_transfers,
+			      CLIB_CACHE_LINE_BYTES);
+  clib_memset (b, 0, sizeof (dma_test_batch_t));
+  b->config_index = cd->config_index;
+  b->batch.callback_fn = cd->cfg.callback_fn;
+  b->batch.submit_fn = dma_test_batch_submit;
+  b->batch.stride = sizeof (dma_test_transfer_t);
+  b->batch.src_ptr_off = STRUCT_OFFSET_OF (dma_test_batch_t, transfers[0].src);
+  b->batch.dst_ptr_off = STRUCT_OFFSET_OF (dma_test_batch_t, transfers[0].dst);
+  b->batch.size_off = STRUCT_OFFSET_OF (dma_test_batch_t, transfers[0].size);
+  return &b->batch;
+}
+
+static int
+dma_test_config_add_fn (vlib_main_t *vm, vlib_dma_config_data_t *cd)
+{
+  cd->batch_new_fn = dma_test_batch_new;
+  return 1;
+}
+
+static uword
+dma_test_node_fn (vlib_main_t *vm, vlib_node_runtime_t *node,
+		  vlib_frame_t *frame)
+{
+  dma_test_main_t *dtm = &dma_test_main;
+  dma_test_thread_t *t = vec_elt_at_index (dtm->threads, vm->thread_index);
+  f64 now = vlib_time_now (vm);
+  dma_test_batch_t *b;
+  u32 i, n = 0;
+
+  /* batches complete in order */
+  vec_foreach_index (i, t->pending)
+    {
+      b = t->pending[i];
+      if (now - b->submit_time < dtm->delay)
+	break;
+
+      for (u16 j = 0; j < b->batch.n_enq; j++)
+	clib_memcpy_fast (b->transfers[j].dst, b->transfers[j].src,
+			  b->transfers[j].size);
+      if (b->batch.callback_fn)
+	b->batch.callback_fn (vm, &b->batch);
+
+      b->batch.n_enq = 0;
+      vec_add1 (t->freelists[b->config_index], b);
+      t->n_completed++;
+      n++;
+    }
+
+  vec_delete (t->pending, n, 0);
+  return n;
+}
+
+VLIB_REGISTER_NODE (dma_test_node) = {
+  .function = dma_test_node_fn,
+  .name = "dma-test-input",
+  .type = VLIB_NODE_TYPE_INPUT,
+  .state = VLIB_NODE_STATE_DISABLED,
+};
+
+static clib_error_t *
+test_dma_backend_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			     vlib_cli_command_t *cmd)
+{
+  dma_test_main_t *dtm = &dma_test_main;
+  vlib_dma_backend_t backend = {
+    .name = "test",
+    .config_add_fn = dma_test_config_add_fn,
+  };
+  dma_test_thread_t *t;
+  u64 n_submitted = 0, n_completed = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "delay %f", &dtm->delay))
+	;
+      else if (unformat (input, "max-batches %u", &dtm->max_batches))
+	;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  /* configs are never deleted, so neither is the backend */
+  if (!dtm->registered)
+    {
+      vec_validate (dtm->threads, vlib_get_n_threads () - 1);
+      vlib_dma_register_backend (vm, &backend);
+      foreach_vlib_main ()
+	vlib_node_set_state (this_vlib_main, dma_test_node.index,
+			     VLIB_NODE_STATE_POLLING);
+      dtm->registered = 1;
+    }
+
+  vec_foreach (t, dtm->threads)
+    {
+      n_submitted += t->n_submitted;
+      n_completed += t->n_completed;
+    }
+  vlib_cli_output (vm, "delay %.3f max-batches %u submitted %lu completed %lu",
+		   dtm->delay, dtm->max_batches, n_submitted, n_completed);
+  return 0;
+}
+
+VLIB_CLI_COMMAND (test_dma_backend_command, static) = {
+  .path = "test dma backend",
+  .short_help = "test dma backend [delay <seconds>] [max-batches <n>]",
+  .function = test_dma_backend_command_fn,
+};
@@ -2005,6 +2005,218 @@ session_test_mq_basic (vlib_main_t * vm, unformat_input_t * input)
   return 0;
 }
 
+static int
+session_test_lookup_batch (vlib_main_t *vm, unformat_input_t *input)
+{
+  session_endpoint_cfg_t server_sep = SESSION_ENDPOINT_CFG_NULL;
+  u64 options[APP_OPTIONS_N_OPTIONS], bind4_handle, bind6_handle;
+  transport_connection_t *tcs[40], *tc, est4 = {}, est6 = {};
+  session_lookup_key_t keys[40], *key;
+  u16 lcl_ports[4], rmt_port = clib_host_to_net_u16 (4321);
+  u32 server_index, i, n_keys = ARRAY_LEN (keys);
+  session_t *sessions[40], *listener, *s;
+  ip4_address_t lcl_ip4, rmt_ip4;
+  ip6_address_t lcl_ip6, rmt_ip6;
+  u8 results[40], result;
+  int verbose = 0, error = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "verbose"))
+	verbose = 1;
+      else
+	{
+	  vlib_cli_output (vm, "parse error: '%U'", format_unformat_error,
+			   input);
+	  return -1;
+	}
+    }
+
+  /* Listener port, established session port, no match, invalid fib */
+  lcl_ports[0] = clib_host_to_net_u16 (5111);
+  lcl_ports[1] = clib_host_to_net_u16 (5222);
+  lcl_ports[2] = clib_host_to_net_u16 (5333);
+  lcl_ports[3] = lcl_ports[0];
+
+  lcl_ip4.as_u32 = clib_host_to_net_u32 (0x0a000001);
+  rmt_ip4.as_u32 = clib_host_to_net_u32 (0x0a000002);
+  clib_memset (&lcl_ip6, 0, sizeof (lcl_ip6));
+  lcl_ip6.as_u16[0] = clib_host_to_net_u16 (0xfd00);
+  rmt_ip6 = lcl_ip6;
+  lcl_ip6.as_u8[15] = 1;
+  rmt_ip6.as_u8[15] = 2;
+
+  clib_memset (options, 0, sizeof (options));
+  options[APP_OPTIONS_FLAGS] = APP_OPTIONS_FLAGS_IS_BUILTIN;
+  options[APP_OPTIONS_FLAGS] |= APP_OPTIONS_FLAGS_USE_GLOBAL_SCOPE;
+  vnet_app_attach_args_t attach_args = {
+    .api_client_index = ~0,
+    .options = options,
+    .namespace_id = 0,
+    .session_cb_vft = &placeholder_session_cbs,
+    .name = format (0, "session_test"),
+  };
+
+  error = vnet_application_attach (&attach_args);
+  SESSION_TEST ((error == 0), "app attached");
+  server_index = attach_args.app_index;
+  vec_free (attach_args.name);
+
+  server_sep.is_ip4 = 1;
+  server_sep.port = lcl_ports[0];
+  server_sep.transport_proto = TRANSPORT_PROTO_TCP;
+  vnet_listen_args_t bind_args = {
+    .sep_ext = server_sep,
+    .app_index = server_index,
+    .wrk_map_index = 0,
+  };
+  error = vnet_listen (&bind_args);
+  SESSION_TEST ((error == 0), "server bind4 should work");
+  bind4_handle = bind_args.handle;
+
+  bind_args.sep.is_ip4 = 0;
+  error = vnet_listen (&bind_args);
+  SESSION_TEST ((error == 0), "server bind6 should work");
+  bind6_handle = bind_args.handle;
+
+  /*
+   * Add established sessions that point to the listeners. Only the safe
+   * lookups dereference them, connection lookups are done from a thread
+   * that does not own them and must report the wrong thread.
+   */
+  listener = listen_session_get_from_handle (bind4_handle);
+  est4.lcl_ip.ip4 = lcl_ip4;
+  est4.rmt_ip.ip4 = rmt_ip4;
+  est4.lcl_port = lcl_ports[1];
+  est4.rmt_port = rmt_port;
+  est4.proto = TRANSPORT_PROTO_TCP;
+  est4.is_ip4 = 1;
+  error = session_lookup_add_connection (&est4, session_handle (listener));
+  SESSION_TEST ((error == 0), "add established ip4 session should work");
+
+  listener = listen_session_get_from_handle (bind6_handle);
+  est6.lcl_ip.ip6 = lcl_ip6;
+  est6.rmt_ip.ip6 = rmt_ip6;
+  est6.lcl_port = lcl_ports[1];
+  est6.rmt_port = rmt_port;
+  est6.proto = TRANSPORT_PROTO_TCP;
+  error = session_lookup_add_connection (&est6, session_handle (listener));
+  SESSION_TEST ((error == 0), "add established ip6 session should work");
+
+  /*
+   * More keys than fit in one batch, with each type of lookup outcome
+   * interleaved. Results must match those of the per key lookups.
+   */
+  for (i = 0; i < n_keys; i++)
+    {
+      key = &keys[i];
+      key->lcl_ip4 = &lcl_ip4;
+      key->rmt_ip4 = &rmt_ip4;
+      key->lcl_port = lcl_ports[i % 4];
+      key->rmt_port = rmt_port;
+      key->fib_index = i % 4 == 3 ? ~0 : 0;
+    }
+
+  session_lookup_safe4_batch (keys, n_keys, TRANSPORT_PROTO_TCP, sessions);
+  for (i = 0; i < n_keys; i++)
+    {
+      key = &keys[i];
+      s = session_lookup_safe4 (key->fib_index, key->lcl_ip4, key->rmt_ip4,
+				key->lcl_port, key->rmt_port,
+				TRANSPORT_PROTO_TCP);
+      SESSION_TEST ((sessions[i] == s), "safe4 batch key %u should match "
+		    "per key lookup", i);
+      SESSION_TEST ((i % 4 > 1 || s != 0), "safe4 key %u should match", i);
+    }
+
+  session_lookup_connection_wt4_batch (keys, n_keys, TRANSPORT_PROTO_TCP, 1,
+				       tcs, results);
+  for (i = 0; i < n_keys; i++)
+    {
+      key = &keys[i];
+      if (i % 4 == 1)
+	{
+	  SESSION_TEST ((tcs[i] == 0 &&
+			 results[i] == SESSION_LOOKUP_RESULT_WRONG_THREAD),
+			"wt4 batch key %u should report wrong thread", i);
+	  continue;
+	}
+      result = SESSION_LOOKUP_RESULT_NONE;
+      tc = session_lookup_connection_wt4 (key->fib_index, key->lcl_ip4,
+					  key->rmt_ip4, key->lcl_port,
+					  key->rmt_port, TRANSPORT_PROTO_TCP,
+					  1, &result);
+      SESSION_TEST ((tcs[i] == tc && results[i] == result),
+		    "wt4 batch key %u should match per key lookup", i);
+      SESSION_TEST ((i % 4 != 0 || tc != 0), "wt4 key %u should match", i);
+    }
+
+  for (i = 0; i < n_keys; i++)
+    {
+      key = &keys[i];
+      key->lcl_ip6 = &lcl_ip6;
+      key->rmt_ip6 = &rmt_ip6;
+    }
+
+  session_lookup_safe6_batch (keys, n_keys, TRANSPORT_PROTO_TCP, sessions);
+  for (i = 0; i < n_keys; i++)
+    {
+      key = &keys[i];
+      s = session_lookup_safe6 (key->fib_index, key->lcl_ip6, key->rmt_ip6,
+				key->lcl_port, key->rmt_port,
+				TRANSPORT_PROTO_TCP);
+      SESSION_TEST ((sessions[i] == s), "safe6 batch key %u should match "
+		    "per key lookup", i);
+      SESSION_TEST ((i % 4 > 1 || s != 0), "safe6 key %u should match", i);
+    }
+
+  session_lookup_connection_wt6_batch (keys, n_keys, TRANSPORT_PROTO_TCP, 1,
+				       tcs, results);
+  for (i = 0; i < n_keys; i++)
+    {
+      key = &keys[i];
+      if (i % 4 == 1)
+	{
+	  SESSION_TEST ((tcs[i] == 0 &&
+			 results[i] == SESSION_LOOKUP_RESULT_WRONG_THREAD),
+			"wt6 batch key %u should report wrong thread", i);
+	  continue;
+	}
+      result = SESSION_LOOKUP_RESULT_NONE;
+      tc = session_lookup_connection_wt6 (key->fib_index, key->lcl_ip6,
+					  key->rmt_ip6, key->lcl_port,
+					  key->rmt_port, TRANSPORT_PROTO_TCP,
+					  1, &result);
+      SESSION_TEST ((tcs[i] == tc && results[i] == result),
+		    "wt6 batch key %u should match per key lookup", i);
+      SESSION_TEST ((i % 4 != 0 || tc != 0), "wt6 key %u should match", i);
+    }
+
+  if (verbose)
+    vlib_cli_output (vm, "batch lookups of %u keys match", n_keys);
+
+  session_lookup_del_connection (&est4);
+  session_lookup_del_connection (&est6);
+
+  vnet_unlisten_args_t unbind_args = {
+    .handle = bind4_handle,
+    .app_index = server_index,
+  };
+  error = vnet_unlisten (&unbind_args);
+  SESSION_TEST ((error == 0), "unbind4 should work");
+
+  unbind_args.handle = bind6_handle;
+  error = vnet_unlisten (&unbind_args);
+  SESSION_TEST ((error == 0), "unbind6 should work");
+
+  vnet_app_detach_args_t detach_args = {
+    .app_index = server_index,
+    .api_client_index = ~0,
+  };
+  vnet_application_detach (&detach_args);
+  return 0;
+}
+
 static clib_error_t *
 session_test (vlib_main_t * vm,
 	      unformat_input_t * input, vlib_cli_command_t * cmd_arg)
@@ -2031,10 +2243,14 @@ session_test (vlib_main_t * vm,
 	res = session_test_mq_speed (vm, input);
       else if (unformat (input, "mq-basic"))
 	res = session_test_mq_basic (vm, input);
+      else if (unformat (input, "lookup-batch"))
+	res = session_test_lookup_batch (vm, input);
       else if (unformat (input, "all"))
 	{
 	  if ((res = session_test_basic (vm, input)))
 	    goto done;
+	  if ((res = session_test_lookup_batch (vm, input)))
+	    goto done;
 	  if ((res = session_test_namespace (vm, input)))
 	    goto done;
 	  if ((res = session_test_rule_table (vm, input)))
@@ -320,6 +320,58 @@ vhost_user_vring_init (vhost_user_intf_t * vui, u32 qid)
     vring->enabled = 1;
 }
 
+/*
+ * Detach the dma batches in flight for a vring (or for all of them with
+ * ~0) from it. They complete on their own thread later, and then only
+ * free their buffers, without touching the vring or the interface.
+ */
+static void
+vhost_user_dma_cancel (vhost_user_intf_t *vui, u32 vring_idx)
+{
+  vhost_user_main_t *vum = &vhost_user_main;
+  vhost_user_dma_batch_t *db;
+  vhost_cpu_t *cpu;
+
+  if (!vui->use_dma)
+    return;
+
+  vec_foreach (cpu, vum->cpus)
+    pool_foreach (db, cpu->dma_batches)
+      {
+	if (db->if_index == vui->if_index &&
+	    (vring_idx == ~0 || db->vring_idx == vring_idx))
+	  db->stale = 1;
+      }
+}
+
+void
+vhost_user_dma_completion_cb (vlib_main_t *vm, vlib_dma_batch_t *b)
+{
+  vhost_user_main_t *vum = &vhost_user_main;
+  vhost_cpu_t *cpu = vec_elt_at_index (vum->cpus, vm->thread_index);
+  vhost_user_dma_batch_t *db = pool_elt_at_index (cpu->dma_batches, b->cookie);
+  vhost_user_intf_t *vui;
+  vhost_user_vring_t *vq;
+
+  if (PREDICT_FALSE (db->stale))
+    vlib_buffer_free (vm, db->buffers, vec_len (db->buffers));
+  else
+    {
+      vui = pool_elt_at_index (vum->vhost_user_interfaces, db->if_index);
+      vq = vec_elt_at_index (vui->vrings, db->vring_idx);
+      vq->dma_n_inflight--;
+
+      /* odd vrings are the guest tx ones, i.e. our rx */
+      if (db->vring_idx & 1)
+	vhost_user_rx_dma_complete (vm, vui, vq, db);
+      else
+	vhost_user_tx_dma_complete (vm, vui, vq, db);
+    }
+
+  vec_reset_length (db->buffers);
+  pool_put (cpu->dma_batches, db);
+}
+
 static_always_inline void
 vhost_user_vring_close (vhost_user_intf_t * vui, u32 qid)
 {
@@ -357,6 +409,8 @@ vhost_user_vring_close (vhost_user_intf_t * vui, u32 qid)
   vui->vrings[qid].queue_index = queue_index;
   vui->vrings[qid].mode = mode;
   vui->vrings[qid].thread_index = thread_index;
+
+  vhost_user_dma_cancel (vui, qid);
 }
 
 static_always_inline void
@@ -1187,6 +1241,7 @@ vhost_user_init (vlib_main_t * vm)
   }
 
   vum->random = random_default_seed ();
+  vum->dma_config = -1;
 
   mhash_init_c_string (&vum->if_index_by_sock_name, sizeof (uword));
 
@@ -1490,6 +1545,9 @@ vhost_user_delete_if (vnet_main_t * vnm, vlib_main_t * vm, u32 sw_if_index)
   // Delete ethernet interface
   ethernet_delete_interface (vnm, vui->hw_if_index);
 
+  // Batches still in flight must not find the interface on completion
+  vhost_user_dma_cancel (vui, ~0);
+
   // free vrings
   vec_free (vui->vrings);
 
@@ -1644,6 +1702,32 @@ vhost_user_vui_init (vnet_main_t * vnm, vhost_user_intf_t * vui,
        == (FEATURE_VIRTIO_NET_F_HOST_GUEST_TSO_FEATURE_BITS)))
     vui->enable_gso = 1;
   vhost_user_update_gso_interface_count (vui, 1 /* add */ );
+
+  /*
+   * One dma config serves all interfaces and is never deleted, so batches
+   * still in flight when an interface goes away can always complete.
+   */
+  if (args->use_dma && vum->dma_config < 0)
+    {
+      vlib_dma_config_t dma_config = {
+	.max_batches = 256,
+	.max_transfers = VHOST_USER_DMA_MAX_TRANSFERS,
+	.max_transfer_size = VLIB_BUFFER_DEFAULT_DATA_SIZE,
+	.barrier_before_last = 1,
+	.sw_fallback = 1,
+	.callback_fn = vhost_user_dma_completion_cb,
+      };
+      vum->dma_config = vlib_dma_config_add (vlib_get_main (), &dma_config);
+    }
+  vui->use_dma = args->use_dma && vum->dma_config >= 0;
+  if (args->use_dma && !vui->use_dma)
+    vu_log_warn (vui, "no dma backend available, using cpu copies");
+  /* virtio headers are built in scratch space, never offload them */
+  vui->dma_threshold = args->dma_threshold ? args->dma_threshold :
+					     VHOST_USER_DMA_DEFAULT_THRESHOLD;
+  vui->dma_threshold =
+    clib_max (vui->dma_threshold, sizeof (vnet_virtio_net_hdr_mrg_rxbuf_t) + 1);
+
   mhash_set_mem (&vum->if_index_by_sock_name, vui->sock_filename,
 		 &vui->if_index, 0);
 
@@ -1801,6 +1885,10 @@ vhost_user_connect_command_fn (vlib_main_t * vm,
 	args.enable_packed = 1;
       else if (unformat (line_input, "event-idx"))
 	args.enable_event_idx = 1;
+      else if (unformat (line_input, "use-dma"))
+	args.use_dma = 1;
+      else if (unformat (line_input, "dma-threshold %u", &args.dma_threshold))
+	;
       else if (unformat (line_input, "feature-mask 0x%llx",
 			 &args.feature_mask))
 	;
@@ -2215,6 +2303,9 @@ show_vhost_user_command_fn (vlib_main_t * vm,
 	vlib_cli_output (vm, "  Packed ring enable");
       if (vui->enable_event_idx)
 	vlib_cli_output (vm, "  Event index enable");
+      if (vui->use_dma)
+	vlib_cli_output (vm, "  DMA enable, config %d threshold %u",
+			 vum->dma_config, vui->dma_threshold);
 
       vlib_cli_output (vm, "virtio_net_hdr_sz %d\n"
 		       " features mask (0x%llx): \n"
@@ -2378,6 +2469,11 @@ done:
  * will be used anyway and multiple instances will have the same name. Use
  * with caution.
  *
+ * - <b>use-dma</b> - Optional flag to offload the copies to and from guest
+ * buffers to a dma engine, on split rings. Copies shorter than
+ * <b>dma-threshold</b> bytes (default 256) are still done by the cpu. Falls
+ * back to cpu copies if no dma backend is available.
+ *
  * @cliexpar
  * Example of how to create a vhost interface with VPP as the client and all
  * features enabled:
@@ -2398,7 +2494,7 @@ VLIB_CLI_COMMAND (vhost_user_connect_command, static) = {
     .path = "create vhost-user",
     .short_help = "create vhost-user socket <socket-filename> [server] "
     "[feature-mask <hex>] [hwaddr <mac-addr>] [renumber <dev_instance>] [gso] "
-    "[packed] [event-idx]",
+    "[packed] [event-idx] [use-dma [dma-threshold <n>]]",
     .function = vhost_user_connect_command_fn,
     .is_mp_safe = 1,
 };
@@ -17,6 +17,7 @@
 
 #include <vhost/virtio_std.h>
 #include <vhost/vhost_std.h>
+#include <vlib/dma/dma.h>
 
 /* vhost-user data structures */
 
@@ -110,6 +111,8 @@ typedef struct
   u8 enable_packed;
   u8 enable_event_idx;
   u8 use_custom_mac;
+  u8 use_dma;
+  u32 dma_threshold;
 
   /* return */
   u32 sw_if_index;
@@ -177,6 +180,34 @@ typedef struct vhost_user_msg {
 } __attribute ((packed)) vhost_user_msg_t;
 /* *INDENT-ON* */
 
+/* Copies shorter than this are done by the cpu when dma is in use */
+#define VHOST_USER_DMA_DEFAULT_THRESHOLD 256
+
+/* Max number of dma batches in flight per queue */
+#define VHOST_USER_DMA_MAX_INFLIGHT 16
+
+/* Max number of copies per dma batch */
+#define VHOST_USER_DMA_MAX_TRANSFERS (4 * VLIB_FRAME_SIZE)
+
+/*
+ * A dma batch in flight. Batches complete in order on the thread which
+ * submitted them, they are kept in a per-thread pool so that deleting
+ * the interface or resetting the vring only has to mark them stale.
+ */
+typedef struct
+{
+  /* tx: buffers to free, rx: buffers to hand over to the graph */
+  u32 *buffers;
+  u32 if_index;
+  u16 vring_idx;
+  /* used ring index to publish once the batch has completed */
+  u16 used_idx;
+  /* rx: next node of the buffers */
+  u32 next_index;
+  /* the vring was reset or the interface deleted while in flight */
+  u8 stale;
+} vhost_user_dma_batch_t;
+
 typedef struct
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
@@ -232,6 +263,11 @@ typedef struct
   u8 first_kick;
   u32 queue_index;
   u32 thread_index;
+
+  /* dma batches in flight and the newest of them, in the pool of the
+     thread which submitted them */
+  u16 dma_n_inflight;
+  u32 dma_last;
 } vhost_user_vring_t;
 
 #define VHOST_USER_EVENT_START_TIMER 1
@@ -285,6 +321,10 @@ typedef struct
   u8 enable_packed;
 
   u8 enable_event_idx;
+
+  /* offload guest memory copies of at least dma_threshold bytes */
+  u8 use_dma;
+  u32 dma_threshold;
 } vhost_user_intf_t;
 
 #define FOR_ALL_VHOST_TXQ(qid, vui) for (qid = 1; qid < vui->num_qid; qid += 2)
@@ -327,6 +367,9 @@ typedef struct
   u32 *to_next_list;
   vlib_buffer_t **rx_buffers_pdesc;
   u32 polling_q_count;
+
+  /* dma batches submitted by this thread */
+  vhost_user_dma_batch_t *dma_batches;
 } vhost_cpu_t;
 
 typedef struct
@@ -353,6 +396,9 @@ typedef struct
 
   /* gso interface count */
   u32 gso_count;
+
+  /* dma config shared by the interfaces using dma, -1 if none */
+  int dma_config;
 } vhost_user_main_t;
 
 typedef struct
@@ -371,6 +417,13 @@ int vhost_user_dump_ifs (vnet_main_t * vnm, vlib_main_t * vm,
 			 vhost_user_intf_details_t ** out_vuids);
 void vhost_user_set_operation_mode (vhost_user_intf_t *vui,
 				    vhost_user_vring_t *txvq);
+void vhost_user_dma_completion_cb (vlib_main_t *vm, vlib_dma_batch_t *b);
+void vhost_user_rx_dma_complete (vlib_main_t *vm, vhost_user_intf_t *vui,
+				 vhost_user_vring_t *txvq,
+				 vhost_user_dma_batch_t *db);
+void vhost_user_tx_dma_complete (vlib_main_t *vm, vhost_user_intf_t *vui,
+				 vhost_user_vring_t *rxvq,
+				 vhost_user_dma_batch_t *db);
 
 extern vlib_node_registration_t vhost_user_send_interrupt_node;
 extern vnet_device_class_t vhost_user_device_class;
@@ -485,6 +485,55 @@ vhost_user_advance_last_used_idx (vhost_user_vring_t * vring)
     }
 }
 
+/*
+ * Submit the dma batch of a vring, to publish used_idx once its copies are
+ * done. If nothing was offloaded (or there is no batch, when the cpu did
+ * the copies) but older batches of the vring are still in flight, used_idx
+ * is published with the newest of them instead, as it must not overtake
+ * them. Returns the batch which publishes used_idx, or 0 if the caller can
+ * publish it right away.
+ */
+static_always_inline vhost_user_dma_batch_t *
+vhost_user_dma_submit (vlib_main_t *vm, vhost_user_intf_t *vui,
+		       vhost_user_vring_t *vq, vlib_dma_batch_t *b,
+		       u16 used_idx)
+{
+  vhost_user_main_t *vum = &vhost_user_main;
+  vhost_cpu_t *cpu = &vum->cpus[vm->thread_index];
+  vhost_user_dma_batch_t *db;
+
+  if (!b || !b->n_enq)
+    {
+      /* gives the empty batch back */
+      if (b)
+	vlib_dma_batch_submit (vm, b);
+      if (!vq->dma_n_inflight)
+	return 0;
+      db = pool_elt_at_index (cpu->dma_batches, vq->dma_last);
+      db->used_idx = used_idx;
+      return db;
+    }
+
+  /* a reused element keeps its buffers vector */
+  if (pool_free_elts (cpu->dma_batches))
+    pool_get (cpu->dma_batches, db);
+  else
+    pool_get_zero (cpu->dma_batches, db);
+
+  db->if_index = vui->if_index;
+  db->vring_idx = vq - vui->vrings;
+  db->used_idx = used_idx;
+  db->next_index = ~0;
+  db->stale = 0;
+
+  vq->dma_n_inflight++;
+  vq->dma_last = db - cpu->dma_batches;
+
+  vlib_dma_batch_set_cookie (vm, b, vq->dma_last);
+  vlib_dma_batch_submit (vm, b);
+  return db;
+}
+
 #endif
 
 /*
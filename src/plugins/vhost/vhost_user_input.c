@@ -184,6 +184,58 @@ vhost_user_input_copy (vhost_user_intf_t * vui, vhost_copy_t * cpy,
   return 0;
 }
 
+/*
+ * DMA variant of vhost_user_input_copy. Copies of at least dma_threshold
+ * bytes are added to the batch, shorter ones are done right away by the cpu.
+ */
+static_always_inline u32
+vhost_user_input_copy_dma (vlib_main_t *vm, vhost_user_intf_t *vui,
+			   vlib_dma_batch_t *b, vhost_copy_t *cpy,
+			   u16 copy_len, u32 *map_hint)
+{
+  void *src0;
+
+  while (copy_len)
+    {
+      if (PREDICT_FALSE (!(src0 = map_guest_mem (vui, cpy->src, map_hint))))
+	return 1;
+      if (cpy->len >= vui->dma_threshold &&
+	  b->n_enq < VHOST_USER_DMA_MAX_TRANSFERS)
+	vlib_dma_batch_add (vm, b, (void *) cpy->dst, src0, cpy->len);
+      else
+	clib_memcpy_fast ((void *) cpy->dst, src0, cpy->len);
+      copy_len -= 1;
+      cpy += 1;
+    }
+  return 0;
+}
+
+#ifndef CLIB_MARCH_VARIANT
+void
+vhost_user_rx_dma_complete (vlib_main_t *vm, vhost_user_intf_t *vui,
+			    vhost_user_vring_t *txvq,
+			    vhost_user_dma_batch_t *db)
+{
+  vhost_user_main_t *vum = &vhost_user_main;
+  vlib_node_runtime_t *node =
+    vlib_node_get_runtime (vm, vhost_user_input_node.index);
+
+  /* give buffers back to driver */
+  CLIB_MEMORY_STORE_BARRIER ();
+  txvq->used->idx = db->used_idx;
+  vhost_user_log_dirty_ring (vui, txvq, idx);
+
+  if (vec_len (db->buffers))
+    vlib_buffer_enqueue_to_single_next (vm, node, db->buffers, db->next_index,
+					vec_len (db->buffers));
+
+  if ((txvq->callfd_idx != ~0) &&
+      !(txvq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT) &&
+      txvq->n_since_last_int > vum->coalesce_frames)
+    vhost_user_send_call (vm, vui, txvq);
+}
+#endif
+
 /**
  * Try to discard packets from the tx ring (VPP RX path).
  * Returns the number of discarded packets.
@@ -203,6 +255,11 @@ vhost_user_rx_discard_packet (vlib_main_t * vm,
   u16 mask = txvq->qsz_mask;
   u16 last_avail_idx = txvq->last_avail_idx;
   u16 last_used_idx = txvq->last_used_idx;
+
+  /* the used index may not overtake descriptors still read by dma */
+  if (PREDICT_FALSE (txvq->dma_n_inflight))
+    return 0;
+
   while (discarded_packets != discard_max)
     {
       if (avail_idx == last_avail_idx)
@@ -401,6 +458,10 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
   u8 feature_arc_idx = fm->device_input_feature_arc_index;
   u32 current_config_index = ~(u32) 0;
   u16 mask = txvq->qsz_mask;
+  vlib_dma_batch_t *dma_batch = 0;
+  vhost_user_dma_batch_t *db;
+  u32 *to_next_start;
+  u16 copy_len_pkt;
 
   /* The descriptor table is not ready yet */
   if (PREDICT_FALSE (txvq->avail == 0))
@@ -505,8 +566,16 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
 	}
     }
 
+  /*
+   * Offload the copies to dma. The buffers are then handed over to the
+   * graph and the descriptors to the driver by the completion callback.
+   */
+  if (vui->use_dma && txvq->dma_n_inflight < VHOST_USER_DMA_MAX_INFLIGHT)
+    dma_batch = vlib_dma_batch_new (vm, vum->dma_config);
+
   vhost_user_input_setup_frame (vm, node, vui, &current_config_index,
 				&next_index, &to_next, &n_left_to_next);
+  to_next_start = to_next;
 
   u16 last_avail_idx = txvq->last_avail_idx;
   u16 last_used_idx = txvq->last_used_idx;
@@ -530,6 +599,7 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
 	}
 
       desc_current = txvq->avail->ring[last_avail_idx & mask];
+      copy_len_pkt = copy_len;
       cpu->rx_buffers_len--;
       bi_current = cpu->rx_buffers[cpu->rx_buffers_len];
       b_head = b_current = vlib_get_buffer (vm, bi_current);
@@ -643,11 +713,12 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
 		  /*
 		   * Checking if there are some left buffers.
 		   * If not, just rewind the used buffers and stop.
-		   * Note: Scheduled copies are not cancelled. This is
-		   * not an issue as they would still be valid. Useless,
-		   * but valid.
+		   * The copies scheduled for this packet are cancelled, as
+		   * the rewound buffers may be reused before a dma batch
+		   * completes.
 		   */
 		  vhost_user_input_rewind_buffers (vm, cpu, b_head);
+		  copy_len = copy_len_pkt;
 		  n_left = 0;
 		  goto stop;
 		}
@@ -709,46 +780,77 @@ vhost_user_if_input (vlib_main_t *vm, vhost_user_main_t *vum,
        */
       if (PREDICT_FALSE (copy_len >= VHOST_USER_RX_COPY_THRESHOLD))
 	{
-	  if (PREDICT_FALSE (vhost_user_input_copy (vui, cpu->copy,
-						    copy_len, &map_hint)))
+	  if (PREDICT_FALSE (
+		dma_batch ? vhost_user_input_copy_dma (vm, vui, dma_batch,
+						       cpu->copy, copy_len,
+						       &map_hint) :
+			    vhost_user_input_copy (vui, cpu->copy, copy_len,
+						   &map_hint)))
 	    {
 	      vlib_error_count (vm, node->node_index,
 				VHOST_USER_INPUT_FUNC_ERROR_MMAP_FAIL, 1);
 	    }
 	  copy_len = 0;
 
-	  /* give buffers back to driver */
-	  CLIB_MEMORY_STORE_BARRIER ();
-	  txvq->used->idx = last_used_idx;
-	  vhost_user_log_dirty_ring (vui, txvq, idx);
+	  /* give buffers back to driver, unless dma is still reading them */
+	  if (!dma_batch && !txvq->dma_n_inflight)
+	    {
+	      CLIB_MEMORY_STORE_BARRIER ();
+	      txvq->used->idx = last_used_idx;
+	      vhost_user_log_dirty_ring (vui, txvq, idx);
+	    }
 	}
     }
 stop:
-  vlib_put_next_frame (vm, node, next_index, n_left_to_next);
-
   txvq->last_used_idx = last_used_idx;
   txvq->last_avail_idx = last_avail_idx;
 
   /* Do the memory copies */
-  if (PREDICT_FALSE (vhost_user_input_copy (vui, cpu->copy, copy_len,
-					    &map_hint)))
+  if (PREDICT_FALSE (
+	dma_batch ? vhost_user_input_copy_dma (vm, vui, dma_batch, cpu->copy,
+					       copy_len, &map_hint) :
+		    vhost_user_input_copy (vui, cpu->copy, copy_len,
+					   &map_hint)))
     {
       vlib_error_count (vm, node->node_index,
 			VHOST_USER_INPUT_FUNC_ERROR_MMAP_FAIL, 1);
     }
 
-  /* give buffers back to driver */
-  CLIB_MEMORY_STORE_BARRIER ();
-  txvq->used->idx = txvq->last_used_idx;
-  vhost_user_log_dirty_ring (vui, txvq, idx);
+  /*
+   * With dma, the buffers follow the batch which publishes the used index,
+   * so that they do not overtake older packets, unless they go to another
+   * next node. This holds for cpu copies too while older batches are in
+   * flight.
+   */
+  if ((dma_batch || txvq->dma_n_inflight) &&
+      (db = vhost_user_dma_submit (vm, vui, txvq, dma_batch,
+				   txvq->last_used_idx)))
+    {
+      if (db->next_index == ~0 || db->next_index == next_index)
+	{
+	  db->next_index = next_index;
+	  vec_add (db->buffers, to_next_start, to_next - to_next_start);
+	  n_left_to_next += to_next - to_next_start;
+	}
+    }
+  else
+    {
+      /* give buffers back to driver */
+      CLIB_MEMORY_STORE_BARRIER ();
+      txvq->used->idx = txvq->last_used_idx;
+      vhost_user_log_dirty_ring (vui, txvq, idx);
+    }
 
-  /* interrupt (call) handling */
+  vlib_put_next_frame (vm, node, next_index, n_left_to_next);
+
+  /* interrupt (call) handling, deferred to dma completion if in flight */
   if ((txvq->callfd_idx != ~0) &&
       !(txvq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT))
     {
       txvq->n_since_last_int += n_rx_packets;
 
-      if (txvq->n_since_last_int > vum->coalesce_frames)
+      if (txvq->n_since_last_int > vum->coalesce_frames &&
+	  !txvq->dma_n_inflight)
 	vhost_user_send_call (vm, vui, txvq);
     }
 
@@ -201,6 +201,71 @@ vhost_user_tx_copy (vhost_user_intf_t * vui, vhost_copy_t * cpy,
   return 0;
 }
 
+/*
+ * DMA variant of vhost_user_tx_copy. Copies of at least dma_threshold bytes
+ * are added to the batch, shorter ones (e.g. virtio headers, which live in
+ * per-thread scratch space) are done right away by the cpu.
+ */
+static_always_inline u32
+vhost_user_tx_copy_dma (vlib_main_t *vm, vhost_user_intf_t *vui,
+			vlib_dma_batch_t *b, vhost_copy_t *cpy, u16 copy_len,
+			u32 *map_hint)
+{
+  void *dst0;
+
+  while (copy_len)
+    {
+      if (PREDICT_FALSE (!(dst0 = map_guest_mem (vui, cpy->dst, map_hint))))
+	return 1;
+      if (cpy->len >= vui->dma_threshold &&
+	  b->n_enq < VHOST_USER_DMA_MAX_TRANSFERS)
+	vlib_dma_batch_add (vm, b, dst0, (void *) cpy->src, cpy->len);
+      else
+	clib_memcpy_fast (dst0, (void *) cpy->src, cpy->len);
+      copy_len -= 1;
+      cpy += 1;
+    }
+  return 0;
+}
+
+/*
+ * Give the descriptors back to the driver, unless they may still be
+ * waiting on dma copies, or older batches are - then the completion
+ * callback does it.
+ */
+static_always_inline void
+vhost_user_tx_update_used (vhost_user_intf_t *vui, vhost_user_vring_t *rxvq,
+			   vlib_dma_batch_t *b)
+{
+  if ((b && b->n_enq) || rxvq->dma_n_inflight)
+    return;
+
+  CLIB_MEMORY_BARRIER ();
+  rxvq->used->idx = rxvq->last_used_idx;
+  vhost_user_log_dirty_ring (vui, rxvq, idx);
+}
+
+#ifndef CLIB_MARCH_VARIANT
+void
+vhost_user_tx_dma_complete (vlib_main_t *vm, vhost_user_intf_t *vui,
+			    vhost_user_vring_t *rxvq,
+			    vhost_user_dma_batch_t *db)
+{
+  vhost_user_main_t *vum = &vhost_user_main;
+
+  vlib_buffer_free (vm, db->buffers, vec_len (db->buffers));
+
+  CLIB_MEMORY_BARRIER ();
+  rxvq->used->idx = db->used_idx;
+  vhost_user_log_dirty_ring (vui, rxvq, idx);
+
+  if ((rxvq->callfd_idx != ~0) &&
+      !(rxvq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT) &&
+      rxvq->n_since_last_int > vum->coalesce_frames)
+    vhost_user_send_call (vm, vui, rxvq);
+}
+#endif
+
 static_always_inline void
 vhost_user_handle_tx_offload (vhost_user_intf_t *vui, vlib_buffer_t *b,
 			      vnet_virtio_net_hdr_t *hdr)
@@ -706,6 +771,9 @@ VNET_DEVICE_CLASS_TX_FN (vhost_user_device_class) (vlib_main_t * vm,
   u16 tx_headers_len;
   u32 or_flags;
   vnet_hw_if_tx_frame_t *tf = vlib_frame_scalar_args (frame);
+  vlib_dma_batch_t *dma_batch = 0;
+  vhost_user_dma_batch_t *db;
+  int buffers_in_dma = 0;
 
   if (PREDICT_FALSE (!vui->admin_up))
     {
@@ -734,6 +802,16 @@ VNET_DEVICE_CLASS_TX_FN (vhost_user_device_class) (vlib_main_t * vm,
   if (vhost_user_is_packed_ring_supported (vui))
     return (vhost_user_device_class_packed (vm, node, frame, vui, rxvq));
 
+  /*
+   * Offload the copies to dma, unless the queue is shared between threads
+   * (completions are handled on the submitting thread), dirty pages are
+   * being logged for migration, or too many batches are in flight.
+   */
+  if (vui->use_dma && !tf->shared_queue &&
+      !(vui->features & VIRTIO_FEATURE (VHOST_F_LOG_ALL)) &&
+      rxvq->dma_n_inflight < VHOST_USER_DMA_MAX_INFLIGHT)
+    dma_batch = vlib_dma_batch_new (vm, vum->dma_config);
+
 retry:
   error = VHOST_USER_TX_FUNC_ERROR_NONE;
   tx_headers_len = 0;
@@ -954,8 +1032,12 @@ retry:
        */
       if (PREDICT_FALSE (copy_len >= VHOST_USER_TX_COPY_THRESHOLD))
 	{
-	  if (PREDICT_FALSE (vhost_user_tx_copy (vui, cpu->copy, copy_len,
-						 &map_hint)))
+	  if (PREDICT_FALSE (
+		dma_batch ? vhost_user_tx_copy_dma (vm, vui, dma_batch,
+						    cpu->copy, copy_len,
+						    &map_hint) :
+			    vhost_user_tx_copy (vui, cpu->copy, copy_len,
+						&map_hint)))
 	    {
 	      vlib_error_count (vm, node->node_index,
 				VHOST_USER_TX_FUNC_ERROR_MMAP_FAIL, 1);
@@ -963,25 +1045,24 @@ retry:
 	  copy_len = 0;
 
 	  /* give buffers back to driver */
-	  CLIB_MEMORY_BARRIER ();
-	  rxvq->used->idx = rxvq->last_used_idx;
-	  vhost_user_log_dirty_ring (vui, rxvq, idx);
+	  vhost_user_tx_update_used (vui, rxvq, dma_batch);
 	}
       buffers++;
     }
 
 done:
   //Do the memory copies
-  if (PREDICT_FALSE (vhost_user_tx_copy (vui, cpu->copy, copy_len,
-					 &map_hint)))
+  if (PREDICT_FALSE (dma_batch ?
+		       vhost_user_tx_copy_dma (vm, vui, dma_batch, cpu->copy,
+					       copy_len, &map_hint) :
+		       vhost_user_tx_copy (vui, cpu->copy, copy_len,
+					   &map_hint)))
     {
       vlib_error_count (vm, node->node_index,
 			VHOST_USER_TX_FUNC_ERROR_MMAP_FAIL, 1);
     }
 
-  CLIB_MEMORY_BARRIER ();
-  rxvq->used->idx = rxvq->last_used_idx;
-  vhost_user_log_dirty_ring (vui, rxvq, idx);
+  vhost_user_tx_update_used (vui, rxvq, dma_batch);
 
   /*
    * When n_left is set, error is always set to something too.
@@ -1001,13 +1082,24 @@ done:
       goto retry;
     }
 
-  /* interrupt (call) handling */
+  /* the buffers are freed once all copies up to them are done */
+  if ((dma_batch || rxvq->dma_n_inflight) &&
+      (db = vhost_user_dma_submit (vm, vui, rxvq, dma_batch,
+				   rxvq->last_used_idx)))
+    {
+      vec_add (db->buffers, vlib_frame_vector_args (frame),
+	       frame->n_vectors);
+      buffers_in_dma = 1;
+    }
+
+  /* interrupt (call) handling, deferred to dma completion if in flight */
   if ((rxvq->callfd_idx != ~0) &&
       !(rxvq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT))
     {
       rxvq->n_since_last_int += frame->n_vectors - n_left;
 
-      if (rxvq->n_since_last_int > vum->coalesce_frames)
+      if (rxvq->n_since_last_int > vum->coalesce_frames &&
+	  !rxvq->dma_n_inflight)
 	vhost_user_send_call (vm, vui, rxvq);
     }
 
@@ -1023,7 +1115,8 @@ done3:
 	 thread_index, vui->sw_if_index, n_left);
     }
 
-  vlib_buffer_free (vm, vlib_frame_vector_args (frame), frame->n_vectors);
+  if (!buffers_in_dma)
+    vlib_buffer_free (vm, vlib_frame_vector_args (frame), frame->n_vectors);
   return frame->n_vectors;
 }
 
@@ -1543,6 +1543,8 @@ format_fifo_segment (u8 * s, va_list * args)
   uword allocated, in_use, virt;
   f64 usage;
   fifo_segment_mem_status_t mem_st;
+  clib_mem_page_stats_t page_stats;
+  clib_mem_page_sz_t log2_page_size;
 
   indent = format_get_indent (s);
 
@@ -1618,6 +1620,17 @@ format_fifo_segment (u8 * s, va_list * args)
 	      format_white_space, indent + 2, usage, format_memory_size,
 	      in_use, format_memory_size, allocated, format_memory_size, virt,
 	      fifo_segment_mem_status_strings[mem_st]);
+
+  /* page size and numa placement of the segment's memory. Segment
+   * headers do not track their va, so use the mapping's. Shm segments
+   * do not record the page size they were mapped with */
+  log2_page_size = fs->ssvm.log2_page_size;
+  if (log2_page_size <= CLIB_MEM_PAGE_SZ_DEFAULT_HUGE)
+    log2_page_size = clib_mem_get_log2_page_size ();
+  clib_mem_get_page_stats (fs->ssvm.sh, log2_page_size,
+			   ((size - 1) >> log2_page_size) + 1, &page_stats);
+  s = format (s, "%U%U\n", format_white_space, indent + 2,
+	      format_clib_mem_page_stats, &page_stats);
   s = format (s, "\n");
 
   return s;
@@ -120,6 +120,7 @@ typedef struct _svm_fifo
   void *cache_buffer;  /** cache buffer*/
   u32 cache_pos;       /** cache buffer pos*/
   u32 cache_length;    /** cache buffer length in chain*/
+  struct svm_fifo_buffer_seg_ *ooo_buffers; /** ooo segments, by start */
 #if SVM_FIFO_TRACE
   svm_fifo_trace_elem_t *trace;
 #endif
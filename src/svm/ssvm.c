@@ -25,6 +25,28 @@ static init_fn client_init_fns[SSVM_N_SEGMENT_TYPES] =
 static delete_fn delete_fns[SSVM_N_SEGMENT_TYPES] =
   { ssvm_delete_shm, ssvm_delete_memfd, ssvm_delete_private };
 
+/**
+ * Bind pages of a newly mapped segment to the requested numa node
+ *
+ * Only the memory policy of the mapping is set, pages are not touched.
+ * They are placed on the segment's numa, if it has memory left, when
+ * first faulted in. Segments may be added by workers, which must not
+ * stall on faulting in the whole segment.
+ */
+static int
+ssvm_numa_bind (ssvm_private_t *ssvm, void *va, uword size)
+{
+  if (clib_mem_vm_set_numa_affinity (va, size, ssvm->numa, 0 /* force */) ==
+	CLIB_MEM_ERROR &&
+      ssvm->numa != 0)
+    {
+      clib_warning ("failed to set mempolicy for numa node %u", ssvm->numa);
+      return -1;
+    }
+
+  return 0;
+}
+
 int
 ssvm_server_init_shm (ssvm_private_t * ssvm)
 {
@@ -227,12 +249,12 @@ ssvm_server_init_memfd (ssvm_private_t * memfd)
 
   ASSERT (vec_c_string_is_terminated (memfd->name));
 
-  if (memfd->huge_page)
-    memfd->fd = clib_mem_vm_create_fd (CLIB_MEM_PAGE_SZ_DEFAULT_HUGE,
-				       (char *) memfd->name);
-  else
-    memfd->fd =
-      clib_mem_vm_create_fd (CLIB_MEM_PAGE_SZ_DEFAULT, (char *) memfd->name);
+  log2_page_size = memfd->log2_page_size;
+  if (log2_page_size == CLIB_MEM_PAGE_SZ_UNKNOWN)
+    log2_page_size = memfd->huge_page ? CLIB_MEM_PAGE_SZ_DEFAULT_HUGE :
+					CLIB_MEM_PAGE_SZ_DEFAULT;
+
+  memfd->fd = clib_mem_vm_create_fd (log2_page_size, (char *) memfd->name);
 
   if (memfd->fd == CLIB_MEM_ERROR)
     {
@@ -265,7 +287,16 @@ ssvm_server_init_memfd (ssvm_private_t * memfd)
       return SSVM_API_ERROR_CREATE_FAILURE;
     }
 
+  if (memfd->numa_bind &&
+      ssvm_numa_bind (memfd, sh, memfd->ssvm_size))
+    {
+      clib_mem_vm_unmap (sh);
+      close (memfd->fd);
+      return SSVM_API_ERROR_CREATE_FAILURE;
+    }
+
   memfd->sh = sh;
+  memfd->log2_page_size = log2_page_size;
   memfd->my_pid = getpid ();
   memfd->is_server = 1;
 
@@ -415,26 +446,36 @@ ssvm_server_init_private (ssvm_private_t * ssvm)
   ssvm_shared_header_t *sh;
   clib_mem_heap_t *heap, *oldheap;
 
-  log2_page_size = clib_mem_get_log2_page_size ();
+  log2_page_size = ssvm->log2_page_size;
+  if (log2_page_size == CLIB_MEM_PAGE_SZ_UNKNOWN)
+    log2_page_size = ssvm->huge_page ? CLIB_MEM_PAGE_SZ_DEFAULT_HUGE :
+				       CLIB_MEM_PAGE_SZ_DEFAULT;
+  log2_page_size = clib_mem_log2_page_size_validate (log2_page_size);
   if (log2_page_size == 0)
     {
       clib_unix_warning ("cannot determine page size");
       return SSVM_API_ERROR_CREATE_FAILURE;
     }
 
-  page_size = 1ULL << log2_page_size;
-  rnd_size = clib_max (ssvm->ssvm_size + (page_size - 1), ssvm->ssvm_size);
-  rnd_size &= ~(page_size - 1);
+  /* first (default size) page is set aside for the shared header */
+  page_size = clib_mem_get_page_size ();
+  rnd_size = round_pow2 (ssvm->ssvm_size + page_size, 1ULL << log2_page_size);
 
-  sh = clib_mem_vm_map (0, rnd_size + page_size, log2_page_size,
-			(char *) ssvm->name);
+  sh = clib_mem_vm_map (0, rnd_size, log2_page_size, (char *) ssvm->name);
   if (sh == CLIB_MEM_VM_MAP_FAILED)
     {
       clib_unix_warning ("private map failed");
       return SSVM_API_ERROR_CREATE_FAILURE;
     }
 
-  heap = clib_mem_create_heap ((u8 *) sh + page_size, rnd_size,
+  if (ssvm->numa_bind &&
+      ssvm_numa_bind (ssvm, sh, rnd_size))
+    {
+      clib_mem_vm_unmap (sh);
+      return SSVM_API_ERROR_CREATE_FAILURE;
+    }
+
+  heap = clib_mem_create_heap ((u8 *) sh + page_size, rnd_size - page_size,
 			       1 /* locked */ , "ssvm server private");
   if (heap == 0)
     {
@@ -445,6 +486,7 @@ ssvm_server_init_private (ssvm_private_t * ssvm)
   rnd_size = clib_mem_get_heap_free_space (heap);
 
   ssvm->ssvm_size = rnd_size;
+  ssvm->log2_page_size = log2_page_size;
   ssvm->is_server = 1;
   ssvm->my_pid = getpid ();
   ssvm->requested_va = ~0;
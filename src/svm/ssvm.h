@@ -85,10 +85,11 @@ typedef struct
   uword requested_va;
   u32 my_pid;
   u8 *name;
-  u8 numa;			/**< UNUSED: numa requested at alloc time */
+  u8 numa;			/**< numa requested at alloc time */
   int is_server;
   int huge_page;
-  int log2_page_size;
+  int numa_bind;		/**< prefer numa for pages faulted in later */
+  int log2_page_size;		/**< requested and then actual page size */
   union
   {
     int fd;			/**< memfd segments */
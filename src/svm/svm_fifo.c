@@ -311,7 +311,6 @@ ooo_segment_try_collect (svm_fifo_t * f, u32 n_bytes_enqueued, u32 * tail)
 {
   u32 s_index, bytes = 0;
   ooo_segment_t *s;
-  svm_fifo_buffer_seg_t b_seg_, *b_seg = &b_seg_;
   i32 diff;
 
   s = pool_elt_at_index (f->ooo_segments, f->ooos_list_head);
@@ -326,16 +325,6 @@ ooo_segment_try_collect (svm_fifo_t * f, u32 n_bytes_enqueued, u32 * tail)
   while (0 <= diff && diff < n_bytes_enqueued)
     {
       s_index = s - f->ooo_segments;
-    
-      if (f->flags & SVM_FIFO_F_LL_BUFFER) {
-          clib_memset(b_seg, 0, sizeof (*b_seg));
-          b_seg->bi = s->bi;
-          b_seg->start = s->start;
-          b_seg->length = s->length;
-          clib_warning("xxxxxxxxxxxxxxxbuffer_index:%d b_seg->length:%u", b_seg->bi, b_seg->length);
-
-          svm_fifo_enqueue(f, sizeof( * b_seg), (u8* ) b_seg);
-      }
 
       /* Segment end is beyond the tail. Advance tail and remove segment */
       if (s->length > diff)
@@ -2,6 +2,9 @@
 #include <svm/svm_fifo.h>
 #include <vlib/vlib.h>
 
+/* Out-of-order segments a buffer mode fifo holds on to */
+#define SVM_FIFO_OOO_BUFFERS_MAX 512
+
 static u8 *
 format_b_seg(u8 *s, va_list *va) {
     svm_fifo_buffer_seg_t *b_seg;
@@ -79,6 +82,112 @@ svm_fifo_is_empty_cons_maybe_buffer (svm_fifo_t * f)
   return (svm_fifo_max_dequeue_cons_maybe_buffer (f) == 0);
 }
 
+/**
+ * Free space for the producer. In buffer mode bytes are accounted with
+ * head2/tail2 while the data area only holds segment descriptors, so the
+ * fifo is also full when no descriptor fits anymore.
+ */
+u32
+svm_fifo_max_enqueue_prod_maybe_buffer (svm_fifo_t *f)
+{
+  u32 head, tail;
+
+  if (!(f->flags & SVM_FIFO_F_LL_BUFFER))
+    return svm_fifo_max_enqueue_prod (f);
+
+  if (svm_fifo_max_enqueue_prod (f) < sizeof (svm_fifo_buffer_seg_t))
+    return 0;
+
+  f_load_head2_tail2_prod (f, &head, &tail);
+  return f_free_count (f, head, tail);
+}
+
+/* The fifo keeps its own reference to every buffer in the chain */
+static inline void
+svm_fifo_buffer_chain_ref (vlib_main_t *vm, vlib_buffer_t *b)
+{
+  while (1)
+    {
+      clib_atomic_add_fetch (&b->ref_count, 1);
+      if (!(b->flags & VLIB_BUFFER_NEXT_PRESENT))
+	break;
+      b = vlib_get_buffer (vm, b->next_buffer);
+    }
+}
+
+/* Drop n_bytes from the front of a chain that then holds len bytes */
+static inline void
+svm_fifo_buffer_chain_advance (vlib_main_t *vm, vlib_buffer_t *b, u32 n_bytes,
+			       u32 len)
+{
+  vlib_buffer_t *cb = b;
+  u32 n;
+
+  while (n_bytes)
+    {
+      n = clib_min (n_bytes, cb->current_length);
+      cb->current_data += n;
+      cb->current_length -= n;
+      n_bytes -= n;
+      if (n_bytes)
+	cb = vlib_get_buffer (vm, cb->next_buffer);
+    }
+  if (b->flags & VLIB_BUFFER_NEXT_PRESENT)
+    {
+      b->total_length_not_including_first_buffer = len - b->current_length;
+      b->flags |= VLIB_BUFFER_TOTAL_LENGTH_VALID;
+    }
+}
+
+/**
+ * Move the out-of-order segments the tail has reached to the descriptor
+ * ring. Data already in the fifo is trimmed from the front of a segment, or
+ * the whole segment is freed if nothing new is left in it. Stops early if
+ * the descriptor ring is full, the sender then retransmits the rest.
+ *
+ * @return number of bytes the tail advanced
+ */
+static u32
+svm_fifo_collect_ooo_buffers (svm_fifo_t *f, u32 *tail)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  svm_fifo_buffer_seg_t *b_seg;
+  u32 n_segs = 0, bytes = 0, trim;
+
+  vec_foreach (b_seg, f->ooo_buffers)
+    {
+      if ((i32) (b_seg->start - *tail) > 0)
+	break;
+
+      trim = *tail - b_seg->start;
+      if (trim >= b_seg->length)
+	{
+	  vlib_buffer_free_one (vm, b_seg->bi);
+	  n_segs++;
+	  continue;
+	}
+
+      if (svm_fifo_max_enqueue_prod (f) < sizeof (*b_seg))
+	break;
+
+      b_seg->start = *tail;
+      b_seg->length -= trim;
+      if (trim)
+	svm_fifo_buffer_chain_advance (vm, vlib_get_buffer (vm, b_seg->bi),
+				       trim, b_seg->length);
+
+      svm_fifo_enqueue (f, sizeof (*b_seg), (u8 *) b_seg);
+      *tail += b_seg->length;
+      bytes += b_seg->length;
+      n_segs++;
+    }
+
+  if (n_segs)
+    vec_delete (f->ooo_buffers, n_segs, 0);
+
+  return bytes;
+}
+
 int
 svm_fifo_enqueue_w_buffer (svm_fifo_t * f, vlib_buffer_t *b)
 {
@@ -96,26 +205,24 @@ svm_fifo_enqueue_w_buffer (svm_fifo_t * f, vlib_buffer_t *b)
   if (PREDICT_FALSE (free_count < len))
     return SVM_FIFO_EFULL;
 
+  /* small segments can exhaust the descriptor ring before the byte space */
+  if (PREDICT_FALSE (svm_fifo_max_enqueue_prod (f) < sizeof (*b_seg)))
+    return SVM_FIFO_EFULL;
+
   b_seg->bi = vlib_get_buffer_index(vlib_get_main(), b);
   b_seg->start = tail;
   b_seg->length = len;
-  
-//  static u32 g_id = 0;
-//  b_seg->debug = g_id++;
-//  
-//  clib_warning("-----enqueue-------%U----[%U]", format_b_seg, b_seg, format_vlib_buffer_and_data_2, b);
+  b_seg->debug = 0;
 
   svm_fifo_enqueue(f, sizeof( * b_seg), (u8* ) b_seg);
+  svm_fifo_buffer_chain_ref (vlib_get_main (), b);
   
   tail = tail + len;
 
   svm_fifo_trace_add (f, head, len, 2);
 
-  /* collect out-of-order segments */
-  if (PREDICT_FALSE (f->ooos_list_head != OOO_SEGMENT_INVALID_INDEX))
-    {
-      len += ooo_segment_try_collect (f, len, &tail);
-    }
+  if (PREDICT_FALSE (vec_len (f->ooo_buffers)))
+    len += svm_fifo_collect_ooo_buffers (f, &tail);
 
   /* store-rel: producer owned index (paired with load-acq in consumer) */
   clib_atomic_store_rel_n (&f->shr->tail2, tail);
@@ -123,29 +230,53 @@ svm_fifo_enqueue_w_buffer (svm_fifo_t * f, vlib_buffer_t *b)
   return len;
 }
 
+/**
+ * Out-of-order enqueue in buffer mode. The ooo tracker merges and trims
+ * overlapping segments, which cannot be mirrored on the buffers that back
+ * them, so the segments are instead kept as they arrived, sorted by start,
+ * and only trimmed once the tail reaches them. Segments fully covered by one
+ * already held are dropped.
+ */
 int
 svm_fifo_enqueue_w_buffer_with_offset (svm_fifo_t * f, u32 offset, vlib_buffer_t *b)
 {
+  svm_fifo_buffer_seg_t b_seg_, *b_seg = &b_seg_, *it;
+  vlib_main_t *vm = vlib_get_main ();
   u32 tail, head, free_count, len;
-  ooo_segment_t *s;  
+  int i;
 
   f_load_head2_tail2_prod (f, &head, &tail);
 
   /* free space in fifo can only increase during enqueue: SPSC */
   free_count = f_free_count (f, head, tail);
-  f->ooos_newest = OOO_SEGMENT_INVALID_INDEX;
 
-  len = vlib_buffer_length_in_chain(vlib_get_main(), b);
+  len = vlib_buffer_length_in_chain (vm, b);
 
   /* will this request fit? */
   if ((len + offset) > free_count)
     return SVM_FIFO_EFULL;
 
+  if (PREDICT_FALSE (vec_len (f->ooo_buffers) >= SVM_FIFO_OOO_BUFFERS_MAX))
+    return SVM_FIFO_EFULL;
+
+  b_seg->bi = vlib_get_buffer_index (vm, b);
+  b_seg->start = tail + offset;
+  b_seg->length = len;
+  b_seg->debug = 0;
+
+  vec_foreach_index (i, f->ooo_buffers)
+    {
+      it = vec_elt_at_index (f->ooo_buffers, i);
+      if ((i32) (it->start - b_seg->start) > 0)
+	break;
+      if ((i32) (it->start + it->length - (b_seg->start + len)) >= 0)
+	return 0;
+    }
+
+  vec_insert_elts (f->ooo_buffers, b_seg, 1, i);
+  svm_fifo_buffer_chain_ref (vm, b);
+
   svm_fifo_trace_add (f, offset, len, 1);
-  ooo_segment_add (f, offset, head, tail, len);
-  
-  s = pool_elt_at_index (f->ooo_segments, f->ooos_newest);
-  s->bi = vlib_get_buffer_index(vlib_get_main(), b);
 
   return 0;
 }
@@ -356,4 +487,103 @@ svm_fifo_dequeue_drop_w_buffer (svm_fifo_t * f, u32 len)
   return total_drop_bytes;
 }
 
+/**
+ * Zero-copy dequeue for builtin apps. Hands the next in-order segment to the
+ * caller as a buffer chain, together with the reference the fifo held on it.
+ * Byte accounting is released so the transport can reopen its window.
+ *
+ * @return bytes in the chain, 0 if the segment is larger than max_len or
+ *         SVM_FIFO_EEMPTY if the fifo is empty
+ */
+int
+svm_fifo_dequeue_buffer (svm_fifo_t *f, u32 max_len, u32 *bi)
+{
+  svm_fifo_buffer_seg_t b_seg_, *b_seg = &b_seg_;
+  vlib_main_t *vm = vlib_get_main ();
+  vlib_buffer_t *b;
+  u32 len;
+
+  /* remainder of a segment partially consumed by the copying readers */
+  if (f->cache_buffer && f->cache_pos < f->cache_length)
+    {
+      b = f->cache_buffer;
+      len = f->cache_length - f->cache_pos;
+      if (len > max_len)
+	return 0;
+
+      svm_fifo_buffer_chain_advance (vm, b, f->cache_pos, len);
+
+      f->cache_buffer = 0;
+      f->cache_pos = f->cache_length = 0;
+      *bi = vlib_get_buffer_index (vm, b);
+      return len;
+    }
+
+  if (f->cache_buffer)
+    {
+      vec_add1 (f->free_buffers, vlib_get_buffer_index (vm, f->cache_buffer));
+      f->cache_buffer = 0;
+      f->cache_pos = f->cache_length = 0;
+    }
 
+  if (svm_fifo_max_dequeue_cons (f) < sizeof (*b_seg))
+    return SVM_FIFO_EEMPTY;
+
+  svm_fifo_peek (f, 0, sizeof (*b_seg), (u8 *) b_seg);
+  if (b_seg->length > max_len)
+    return 0;
+
+  svm_fifo_dequeue_drop (f, sizeof (*b_seg));
+
+  /* store-rel: consumer owned index (paired with load-acq in producer) */
+  clib_atomic_store_rel_n (&f->shr->head2, b_seg->start + b_seg->length);
+
+  *bi = b_seg->bi;
+  return b_seg->length;
+}
+
+/**
+ * Free buffers already consumed by copying readers. External apps return
+ * them with recycle messages, builtin apps free them after their rx callback.
+ */
+void
+svm_fifo_free_buffers (svm_fifo_t *f)
+{
+  if (!vec_len (f->free_buffers))
+    return;
+
+  vlib_buffer_free (vlib_get_main (), f->free_buffers,
+		    vec_len (f->free_buffers));
+  vec_reset_length (f->free_buffers);
+}
+
+/**
+ * Collect all buffers still held by the fifo: queued segments, the segment
+ * being read and consumed ones not yet freed. Used on fifo cleanup.
+ */
+void
+svm_fifo_collect_buffers (svm_fifo_t *f, u32 **bis)
+{
+  svm_fifo_buffer_seg_t b_seg_, *b_seg = &b_seg_;
+  vlib_main_t *vm = vlib_get_main ();
+  u32 i, n_segs;
+
+  n_segs = svm_fifo_max_dequeue (f) / sizeof (*b_seg);
+  for (i = 0; i < n_segs; i++)
+    {
+      svm_fifo_peek (f, i * sizeof (*b_seg), sizeof (*b_seg), (u8 *) b_seg);
+      vec_add1 (*bis, b_seg->bi);
+    }
+
+  if (f->cache_buffer)
+    vec_add1 (*bis, vlib_get_buffer_index (vm, f->cache_buffer));
+  f->cache_buffer = 0;
+  f->cache_pos = f->cache_length = 0;
+
+  vec_append (*bis, f->free_buffers);
+  vec_free (f->free_buffers);
+
+  vec_foreach (b_seg, f->ooo_buffers)
+    vec_add1 (*bis, b_seg->bi);
+  vec_free (f->ooo_buffers);
+}
@@ -7,6 +7,7 @@
 
 u32 svm_fifo_max_dequeue_cons_maybe_buffer (svm_fifo_t * f);
 int svm_fifo_is_empty_cons_maybe_buffer (svm_fifo_t * f);
+u32 svm_fifo_max_enqueue_prod_maybe_buffer (svm_fifo_t *f);
 
 int svm_fifo_enqueue_w_buffer (svm_fifo_t * f, vlib_buffer_t *b);
 int svm_fifo_enqueue_w_buffer_with_offset (svm_fifo_t * f, u32 offset, vlib_buffer_t *b);
@@ -15,5 +16,9 @@ int svm_fifo_peek_w_buffer (svm_fifo_t *f, u32 offset, u32 len, u8 *dst);
 int svm_fifo_dequeue_w_buffer (svm_fifo_t * f, u32 len, u8 * dst);
 int svm_fifo_dequeue_drop_w_buffer (svm_fifo_t * f, u32 len);
 
+int svm_fifo_dequeue_buffer (svm_fifo_t *f, u32 max_len, u32 *bi);
+void svm_fifo_free_buffers (svm_fifo_t *f);
+void svm_fifo_collect_buffers (svm_fifo_t *f, u32 **bis);
+
 
 #endif
@@ -353,6 +353,22 @@ typedef struct api_main_t
   /** vpp/vlib input queue length */
   u32 vlib_input_queue_length;
 
+  /** Barrier batching: max non-mp-safe msgs per barrier, 0 = default */
+  u32 barrier_batch_max_msgs;
+
+  /** Barrier batching: max barrier hold time in seconds, 0 = default */
+  f64 barrier_batch_max_time;
+
+  /** Barrier batching: msgs handled under the open batch, 0 = closed */
+  u32 barrier_batch_n_msgs;
+  f64 barrier_batch_start;
+
+  /** Barrier batching statistics */
+  u64 barrier_batch_count;
+  u64 barrier_batch_msgs;
+  f64 barrier_batch_hold_total;
+  f64 barrier_batch_hold_max;
+
   /** client message index hash table */
   uword *msg_index_by_name_and_crc;
 
@@ -364,8 +364,12 @@ vl_api_clnt_process (vlib_main_t *vm, vlib_node_runtime_t *node,
 	      break;
 	    }
 
-	  /* Allow no more than 10us without a pause */
-	  if (vlib_time_now (vm) > start_time + 10e-6)
+	  /*
+	   * Allow no more than 10us without a pause, unless a barrier
+	   * batch is open: it closes on its own message / time budget.
+	   */
+	  if (!am->barrier_batch_n_msgs &&
+	      vlib_time_now (vm) > start_time + 10e-6)
 	    {
 	      int index = SLEEP_400_US;
 	      if (vector_rate > 40.0)
@@ -390,6 +394,9 @@ vl_api_clnt_process (vlib_main_t *vm, vlib_node_runtime_t *node,
 	    }
 	}
 
+      /* Never suspend with the barrier held */
+      vl_mem_api_barrier_batch_close (am, vm);
+
       /*
        * see if we have any private api shared-memory segments
        * If so, push required context variables, and process
@@ -423,13 +430,19 @@ vl_api_clnt_process (vlib_main_t *vm, vlib_node_runtime_t *node,
 	      regp = vl_socket_get_registration (a->reg_index);
 	      if (regp)
 		{
+		  msgbuf_t *mbp = (msgbuf_t *) a->data;
+
+		  if (ntohl (mbp->data_len) >= sizeof (u16))
+		    vl_mem_api_barrier_batch_msg (am, vm, mbp->data);
 		  vl_socket_process_api_msg (regp, (i8 *) a->data);
+		  vl_mem_api_barrier_batch_check (am, vm);
 		  a = pool_elt_at_index (socket_main.process_args,
 					 event_data[i]);
 		}
 	      vec_free (a->data);
 	      pool_put (socket_main.process_args, a);
 	    }
+	  vl_mem_api_barrier_batch_close (am, vm);
 	  break;
 
 	  /* Timeout... */
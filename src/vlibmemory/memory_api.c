@@ -894,6 +894,76 @@ vl_mem_api_handler_with_vm_node (api_main_t *am, svm_region_t *vlib_rp,
     }
 }
 
+#define VL_API_BARRIER_BATCH_DEFAULT_MSGS 64
+#define VL_API_BARRIER_BATCH_DEFAULT_TIME 100e-6
+
+/*
+ * Consecutive non-mp-safe messages are dispatched under a single
+ * worker barrier, bounded by a message count and a hold time budget,
+ * instead of syncing and releasing the barrier around each message.
+ * The handler path still calls vl_msg_api_barrier_sync/release, which
+ * simply nest since the barrier is recursive.
+ */
+void
+vl_mem_api_barrier_batch_msg (api_main_t *am, vlib_main_t *vm, void *the_msg)
+{
+  u16 id = clib_net_to_host_u16 (*((u16 *) the_msg));
+  vl_api_msg_data_t *m = vl_api_get_msg_data (am, id);
+
+  if (am->barrier_batch_max_msgs == 1 || !m || !m->handler || m->is_mp_safe)
+    {
+      /* Don't hold workers off while running mp-safe handlers */
+      vl_mem_api_barrier_batch_close (am, vm);
+      return;
+    }
+
+  if (am->barrier_batch_n_msgs == 0)
+    {
+      vl_msg_api_barrier_trace_context (m->name);
+      vl_msg_api_barrier_sync ();
+      am->barrier_batch_start = vlib_time_now (vm);
+    }
+  am->barrier_batch_n_msgs++;
+}
+
+void
+vl_mem_api_barrier_batch_check (api_main_t *am, vlib_main_t *vm)
+{
+  u32 max_msgs = am->barrier_batch_max_msgs;
+  f64 max_time = am->barrier_batch_max_time;
+
+  if (am->barrier_batch_n_msgs == 0)
+    return;
+
+  if (max_msgs == 0)
+    max_msgs = VL_API_BARRIER_BATCH_DEFAULT_MSGS;
+  if (max_time == 0.0)
+    max_time = VL_API_BARRIER_BATCH_DEFAULT_TIME;
+
+  if (am->barrier_batch_n_msgs >= max_msgs ||
+      vlib_time_now (vm) - am->barrier_batch_start >= max_time)
+    vl_mem_api_barrier_batch_close (am, vm);
+}
+
+void
+vl_mem_api_barrier_batch_close (api_main_t *am, vlib_main_t *vm)
+{
+  f64 hold;
+
+  if (am->barrier_batch_n_msgs == 0)
+    return;
+
+  hold = vlib_time_now (vm) - am->barrier_batch_start;
+  vl_msg_api_barrier_release ();
+
+  am->barrier_batch_count++;
+  am->barrier_batch_msgs += am->barrier_batch_n_msgs;
+  am->barrier_batch_hold_total += hold;
+  if (hold > am->barrier_batch_hold_max)
+    am->barrier_batch_hold_max = hold;
+  am->barrier_batch_n_msgs = 0;
+}
+
 static inline int
 void_mem_api_handle_msg_i (api_main_t * am, svm_region_t * vlib_rp,
 			   vlib_main_t * vm, vlib_node_runtime_t * node,
@@ -907,10 +977,17 @@ void_mem_api_handle_msg_i (api_main_t * am, svm_region_t * vlib_rp,
   if (!svm_queue_sub2 (q, (u8 *) & mp))
     {
       VL_MSG_API_UNPOISON ((void *) mp);
+      /* Private segments are serviced one message at a time, no batching */
+      if (!is_private)
+	vl_mem_api_barrier_batch_msg (am, vm, (void *) mp);
       vl_mem_api_handler_with_vm_node (am, vlib_rp, (void *) mp, vm, node,
 				       is_private);
+      if (!is_private)
+	vl_mem_api_barrier_batch_check (am, vm);
       return 0;
     }
+  if (!is_private)
+    vl_mem_api_barrier_batch_close (am, vm);
   return -1;
 }
 
@@ -33,6 +33,10 @@ int vl_mem_api_handle_msg_main (vlib_main_t * vm, vlib_node_runtime_t * node);
 int vl_mem_api_handle_msg_private (vlib_main_t * vm,
 				   vlib_node_runtime_t * node, u32 reg_index);
 int vl_mem_api_handle_rpc (vlib_main_t * vm, vlib_node_runtime_t * node);
+void vl_mem_api_barrier_batch_msg (api_main_t *am, vlib_main_t *vm,
+				   void *the_msg);
+void vl_mem_api_barrier_batch_check (api_main_t *am, vlib_main_t *vm);
+void vl_mem_api_barrier_batch_close (api_main_t *am, vlib_main_t *vm);
 
 vl_api_registration_t *vl_mem_api_client_index_to_registration (u32 handle);
 void vl_mem_api_enable_disable (vlib_main_t * vm, int yesno);
@@ -94,6 +94,69 @@ VLIB_CLI_COMMAND (cli_clear_api_histogram_command, static) =
 };
 /* *INDENT-ON* */
 
+static clib_error_t *
+vl_api_show_barrier_batch_command (vlib_main_t *vm, unformat_input_t *input,
+				   vlib_cli_command_t *cli_cmd)
+{
+  api_main_t *am = vlibapi_get_main ();
+
+  /* Messages then take the barrier one at a time, which is not counted */
+  if (am->barrier_batch_max_msgs == 1)
+    {
+      vlib_cli_output (vm, "Barrier batching disabled.");
+      return 0;
+    }
+
+  if (am->barrier_batch_count == 0)
+    {
+      vlib_cli_output (vm, "No barrier batches.");
+      return 0;
+    }
+
+  vlib_cli_output (vm, "Batches: %llu, messages: %llu, %.2f msgs/batch",
+		   am->barrier_batch_count, am->barrier_batch_msgs,
+		   (f64) am->barrier_batch_msgs / (f64) am->barrier_batch_count);
+  vlib_cli_output (vm, "Barrier hold: avg %.2f us, max %.2f us",
+		   am->barrier_batch_hold_total * 1e6 /
+		     (f64) am->barrier_batch_count,
+		   am->barrier_batch_hold_max * 1e6);
+  return 0;
+}
+
+/*?
+ * Display binary api barrier batching statistics: number of batches,
+ * non-mp-safe messages handled under them and barrier hold time. With
+ * batching disabled (api-queue barrier-batch-msgs 1) there are none,
+ * messages take the barrier one at a time as without batching.
+?*/
+VLIB_CLI_COMMAND (cli_show_api_barrier_batch_command, static) = {
+  .path = "show api barrier-batch",
+  .short_help = "show api barrier-batch",
+  .function = vl_api_show_barrier_batch_command,
+};
+
+static clib_error_t *
+vl_api_clear_barrier_batch_command (vlib_main_t *vm, unformat_input_t *input,
+				    vlib_cli_command_t *cli_cmd)
+{
+  api_main_t *am = vlibapi_get_main ();
+
+  am->barrier_batch_count = 0;
+  am->barrier_batch_msgs = 0;
+  am->barrier_batch_hold_total = 0.0;
+  am->barrier_batch_hold_max = 0.0;
+  return 0;
+}
+
+/*?
+ * Clear the binary api barrier batching statistics
+?*/
+VLIB_CLI_COMMAND (cli_clear_api_barrier_batch_command, static) = {
+  .path = "clear api barrier-batch",
+  .short_help = "clear api barrier-batch",
+  .function = vl_api_clear_barrier_batch_command,
+};
+
 static clib_error_t *
 vl_api_client_command (vlib_main_t * vm,
 		       unformat_input_t * input, vlib_cli_command_t * cli_cmd)
@@ -1200,7 +1263,7 @@ static clib_error_t *
 api_queue_config_fn (vlib_main_t * vm, unformat_input_t * input)
 {
   api_main_t *am = vlibapi_get_main ();
-  u32 nitems;
+  u32 nitems, usecs;
 
   while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
     {
@@ -1213,6 +1276,20 @@ api_queue_config_fn (vlib_main_t * vm, unformat_input_t * input)
 	    clib_warning ("vlib input queue length %d too small, ignored",
 			  nitems);
 	}
+      else if (unformat (input, "barrier-batch-msgs %u", &nitems))
+	{
+	  if (nitems >= 1)
+	    am->barrier_batch_max_msgs = nitems;
+	  else
+	    return clib_error_return (0, "barrier-batch-msgs must be >= 1");
+	}
+      else if (unformat (input, "barrier-batch-time %u", &usecs))
+	{
+	  if (usecs >= 1)
+	    am->barrier_batch_max_time = (f64) usecs * 1e-6;
+	  else
+	    return clib_error_return (0, "barrier-batch-time must be >= 1");
+	}
       else
 	return clib_error_return (0, "unknown input `%U'",
 				  format_unformat_error, input);
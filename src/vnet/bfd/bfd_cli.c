@@ -62,6 +62,7 @@ format_bfd_session_cli (u8 * s, va_list * args)
   s =
     format (s, "%10s %-32s %20u\n", "", "Transmit interval",
 	    bfd_nsec_to_usec (bs->transmit_interval_nsec));
+  s = format (s, "%10s %-32s %20u\n", "", "Home thread", bs->thread_index);
   u64 now = clib_cpu_time_now ();
   u8 *tmp = NULL;
   if (bs->last_tx_nsec > 0)
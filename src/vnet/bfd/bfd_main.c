@@ -338,21 +338,24 @@ bfd_set_timer (bfd_main_t * bm, bfd_session_t * bs, u64 now,
 	       (bs->event_time_nsec - now) * SEC_PER_NSEC, wheel_time_ticks);
       wheel_time_ticks = wheel_time_ticks ? wheel_time_ticks : 1;
       bfd_lock (bm);
+      bfd_per_thread_data_t *ptd =
+	vec_elt_at_index (bm->per_thread_data, bs->thread_index);
       if (bs->tw_id)
 	{
-	  TW (tw_timer_update) (&bm->wheel, bs->tw_id, wheel_time_ticks);
-	  BFD_DBG ("tw_timer_update(%p, %u, %lu);", &bm->wheel, bs->tw_id,
+	  TW (tw_timer_update) (&ptd->wheel, bs->tw_id, wheel_time_ticks);
+	  BFD_DBG ("tw_timer_update(%p, %u, %lu);", &ptd->wheel, bs->tw_id,
 		   wheel_time_ticks);
 	}
       else
 	{
 	  bs->tw_id =
-	    TW (tw_timer_start) (&bm->wheel, bs->bs_idx, 0, wheel_time_ticks);
-	  BFD_DBG ("tw_timer_start(%p, %u, 0, %lu) == %u;", &bm->wheel,
+	    TW (tw_timer_start) (&ptd->wheel, bs->bs_idx, 0, wheel_time_ticks);
+	  BFD_DBG ("tw_timer_start(%p, %u, 0, %lu) == %u;", &ptd->wheel,
 		   bs->bs_idx, wheel_time_ticks);
 	}
 
-      if (!handling_wakeup)
+      /* workers poll their wheels, only the process needs waking up */
+      if (!handling_wakeup && 0 == bs->thread_index)
 	{
 
 	  /* Send only if it is earlier than current awaited wakeup time */
@@ -1193,7 +1196,7 @@ bfd_process (vlib_main_t *vm, vlib_node_runtime_t *rt,
 	     CLIB_UNUSED (vlib_frame_t *f))
 {
   bfd_main_t *bm = &bfd_main;
-  u32 *expired = 0;
+  bfd_per_thread_data_t *ptd = vec_elt_at_index (bm->per_thread_data, 0);
   uword event_type, *event_data = 0;
 
   /* So we can send events to the bfd process */
@@ -1207,18 +1210,18 @@ bfd_process (vlib_main_t *vm, vlib_node_runtime_t *rt,
 	       vm_time);
       bfd_lock (bm);
       f64 timeout;
-      if (pool_elts (bm->sessions))
+      if (ptd->n_sessions)
 	{
 	  u32 first_expires_in_ticks =
-	    TW (tw_timer_first_expires_in_ticks) (&bm->wheel);
+	    TW (tw_timer_first_expires_in_ticks) (&ptd->wheel);
 	  if (!first_expires_in_ticks)
 	    {
 	      BFD_DBG
 		("tw_timer_first_expires_in_ticks(%p) returns 0ticks",
-		 &bm->wheel);
-	      timeout = bm->wheel.next_run_time - vm_time;
+		 &ptd->wheel);
+	      timeout = ptd->wheel.next_run_time - vm_time;
 	      BFD_DBG ("wheel.next_run_time is %.9f",
-		       bm->wheel.next_run_time);
+		       ptd->wheel.next_run_time);
 	      u64 next_expire_nsec = now + timeout * SEC_PER_NSEC;
 	      bm->bfd_process_next_wakeup_nsec = next_expire_nsec;
 	      bfd_unlock (bm);
@@ -1226,7 +1229,7 @@ bfd_process (vlib_main_t *vm, vlib_node_runtime_t *rt,
 	  else
 	    {
 	      BFD_DBG ("tw_timer_first_expires_in_ticks(%p) returns %luticks",
-		       &bm->wheel, first_expires_in_ticks);
+		       &ptd->wheel, first_expires_in_ticks);
 	      u64 next_expire_nsec =
 		now + first_expires_in_ticks * bm->nsec_per_tw_tick;
 	      bm->bfd_process_next_wakeup_nsec = next_expire_nsec;
@@ -1303,13 +1306,14 @@ bfd_process (vlib_main_t *vm, vlib_node_runtime_t *rt,
 	  vlib_log_err (bm->log_class, "BUG: event type 0x%wx", event_type);
 	  break;
 	}
-      BFD_DBG ("tw_timer_expire_timers_vec(%p, %.04f);", &bm->wheel, vm_time);
+      BFD_DBG ("tw_timer_expire_timers_vec(%p, %.04f);", &ptd->wheel,
+	       vm_time);
       bfd_lock (bm);
-      expired =
-	TW (tw_timer_expire_timers_vec) (&bm->wheel, vm_time, expired);
-      BFD_DBG ("Expired %d elements", vec_len (expired));
+      ptd->expired =
+	TW (tw_timer_expire_timers_vec) (&ptd->wheel, vm_time, ptd->expired);
+      BFD_DBG ("Expired %d elements", vec_len (ptd->expired));
       u32 *p = NULL;
-      vec_foreach (p, expired)
+      vec_foreach (p, ptd->expired)
       {
 	const u32 bs_idx = *p;
 	if (!pool_is_free_index (bm->sessions, bs_idx))
@@ -1321,9 +1325,9 @@ bfd_process (vlib_main_t *vm, vlib_node_runtime_t *rt,
 	  }
       }
       bfd_unlock (bm);
-      if (expired)
+      if (ptd->expired)
 	{
-	  vec_set_len (expired, 0);
+	  vec_set_len (ptd->expired, 0);
 	}
       if (event_data)
 	{
@@ -1357,6 +1361,57 @@ VLIB_REGISTER_NODE (bfd_process_node, static) =
 };
 // clang-format on
 
+/*
+ * bfd worker node function - drives the timing wheel of sessions homed on a
+ * worker thread, so their tx and timeouts never go through the main thread
+ */
+static uword
+bfd_worker_input (vlib_main_t *vm, vlib_node_runtime_t *rt,
+		  CLIB_UNUSED (vlib_frame_t *f))
+{
+  bfd_main_t *bm = &bfd_main;
+  bfd_per_thread_data_t *ptd =
+    vec_elt_at_index (bm->per_thread_data, vm->thread_index);
+  u32 *p, n_expired;
+  f64 vm_time;
+  u64 now;
+
+  now = bfd_time_now_nsec (vm, &vm_time);
+
+  /* wheel ticks once per BFD_TW_TPS, skip the lock until then */
+  if (vm_time < ptd->wheel.next_run_time)
+    return 0;
+
+  bfd_lock (bm);
+  ptd->expired =
+    TW (tw_timer_expire_timers_vec) (&ptd->wheel, vm_time, ptd->expired);
+  vec_foreach (p, ptd->expired)
+    {
+      if (!pool_is_free_index (bm->sessions, *p))
+	{
+	  bfd_session_t *bs = pool_elt_at_index (bm->sessions, *p);
+	  bs->tw_id = 0; /* timer is gone because it expired */
+	  bfd_on_timeout (vm, rt, bm, bs, now);
+	  bfd_set_timer (bm, bs, now, 1);
+	}
+    }
+  bfd_unlock (bm);
+
+  n_expired = vec_len (ptd->expired);
+  vec_set_len (ptd->expired, 0);
+  return n_expired;
+}
+
+VLIB_REGISTER_NODE (bfd_worker_node, static) = {
+  .function = bfd_worker_input,
+  .type = VLIB_NODE_TYPE_INPUT,
+  .name = "bfd-worker",
+  .state = VLIB_NODE_STATE_DISABLED,
+  .flags = VLIB_NODE_FLAG_TRACE_SUPPORTED,
+  .format_trace = format_bfd_process_trace,
+  .sibling_of = "bfd-process",
+};
+
 static clib_error_t *
 bfd_sw_interface_up_down (CLIB_UNUSED (vnet_main_t *vnm),
 			  CLIB_UNUSED (u32 sw_if_index), u32 flags)
@@ -1409,15 +1464,20 @@ bfd_main_init (vlib_main_t * vm)
   bm->random_seed = random_default_seed ();
   bm->vlib_main = vm;
   bm->vnet_main = vnet_get_main ();
-  clib_memset (&bm->wheel, 0, sizeof (bm->wheel));
+  vec_validate_aligned (bm->per_thread_data, n_vlib_mains - 1,
+			CLIB_CACHE_LINE_BYTES);
   bm->nsec_per_tw_tick = (f64) NSEC_PER_SEC / BFD_TW_TPS;
   bm->default_desired_min_tx_nsec =
     bfd_usec_to_nsec (BFD_DEFAULT_DESIRED_MIN_TX_USEC);
   bm->min_required_min_rx_while_echo_nsec =
     bfd_usec_to_nsec (BFD_REQUIRED_MIN_RX_USEC_WHILE_ECHO);
-  BFD_DBG ("tw_timer_wheel_init(%p, %p, %.04f, %u)", &bm->wheel, NULL,
-	   1.00 / BFD_TW_TPS, ~0);
-  TW (tw_timer_wheel_init) (&bm->wheel, NULL, 1.00 / BFD_TW_TPS, ~0);
+  bfd_per_thread_data_t *ptd;
+  vec_foreach (ptd, bm->per_thread_data)
+    {
+      BFD_DBG ("tw_timer_wheel_init(%p, %p, %.04f, %u)", &ptd->wheel, NULL,
+	       1.00 / BFD_TW_TPS, ~0);
+      TW (tw_timer_wheel_init) (&ptd->wheel, NULL, 1.00 / BFD_TW_TPS, ~0);
+    }
   bm->log_class = vlib_log_register_class ("bfd", 0);
   vlib_log_debug (bm->log_class, "initialized");
   bm->owner_thread_index = ~0;
@@ -1466,6 +1526,13 @@ bfd_get_session (bfd_main_t * bm, bfd_transport_e t)
   while (hash_get (bm->session_by_disc, result->local_discr));
   bfd_set_defaults (bm, result);
   hash_set (bm->session_by_disc, result->local_discr, result->bs_idx);
+  /* home the session on a worker picked by discriminator, so that peers'
+   * packets (which carry it as your-disc) can be steered there statelessly */
+  result->thread_index = bfd_thread_index_for_discr (result->local_discr);
+  if (1 == ++bm->per_thread_data[result->thread_index].n_sessions &&
+      result->thread_index)
+    vlib_node_set_state (vlib_get_main_by_index (result->thread_index),
+			 bfd_worker_node.index, VLIB_NODE_STATE_POLLING);
   bfd_validate_counters (bm);
   vlib_zero_combined_counter (&bm->rx_counter, result->bs_idx);
   vlib_zero_combined_counter (&bm->rx_echo_counter, result->bs_idx);
@@ -1491,6 +1558,16 @@ bfd_put_session (bfd_main_t * bm, bfd_session_t * bs)
       --bs->auth.next_key->use_count;
     }
   hash_unset (bm->session_by_disc, bs->local_discr);
+  bfd_per_thread_data_t *ptd =
+    vec_elt_at_index (bm->per_thread_data, bs->thread_index);
+  if (bs->tw_id)
+    {
+      TW (tw_timer_stop) (&ptd->wheel, bs->tw_id);
+      bs->tw_id = 0;
+    }
+  if (0 == --ptd->n_sessions && bs->thread_index)
+    vlib_node_set_state (vlib_get_main_by_index (bs->thread_index),
+			 bfd_worker_node.index, VLIB_NODE_STATE_DISABLED);
   vlib_zero_combined_counter (&bm->rx_counter, bs->bs_idx);
   vlib_zero_combined_counter (&bm->rx_echo_counter, bs->bs_idx);
   vlib_zero_combined_counter (&bm->tx_counter, bs->bs_idx);
@@ -2055,7 +2132,7 @@ format_bfd_session (u8 * s, va_list * args)
 	      "desired-min-tx=%u required-min-rx=%u\n"
 	      "required-min-echo-rx=%u detect-mult=%u\n"
 	      "remote-min-rx=%u remote-min-echo-rx=%u\n"
-	      "remote-demand=%s poll-state=%s\n"
+	      "remote-demand=%s poll-state=%s thread-index=%u\n"
 	      "auth: local-seq-num=%u remote-seq-num=%u\n"
 	      "      is-delayed=%s\n"
 	      "      curr-key=%U\n"
@@ -2067,7 +2144,7 @@ format_bfd_session (u8 * s, va_list * args)
 	      bs->config_required_min_rx_usec, 1, bs->local_detect_mult,
 	      bs->remote_min_rx_usec, bs->remote_min_echo_rx_usec,
 	      (bs->remote_demand ? "yes" : "no"),
-	      bfd_poll_state_string (bs->poll_state),
+	      bfd_poll_state_string (bs->poll_state), bs->thread_index,
 	      bs->auth.local_seq_number, bs->auth.remote_seq_number,
 	      (bs->auth.is_delayed ? "yes" : "no"),
 	      format_bfd_auth_key, bs->auth.curr_key, format_bfd_auth_key,
@@ -159,6 +159,9 @@ typedef struct bfd_session_s
   /** timing wheel internal id used to manipulate timer (if set) */
   u32 tw_id;
 
+  /** thread whose timing wheel drives this session */
+  u32 thread_index;
+
   /** transmit interval */
   u64 transmit_interval_nsec;
 
@@ -262,6 +265,24 @@ typedef enum
  */
 typedef void (*bfd_notify_fn_t) (bfd_listen_event_e, const bfd_session_t *);
 
+/**
+ * per-thread timer state - sessions are spread over workers by discriminator
+ * so that tx/rx timers run where the session's packets are handled
+ */
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+
+  /** timing wheel for scheduling timeouts of sessions homed here */
+  TWT (tw_timer_wheel) wheel;
+
+  /** expired timers, reused across dispatches */
+  u32 *expired;
+
+  /** number of sessions homed on this thread */
+  u32 n_sessions;
+} bfd_per_thread_data_t;
+
 typedef struct
 {
   /** lock to protect data structures */
@@ -284,8 +305,8 @@ typedef struct
   /** pool of bfd sessions context data */
   bfd_session_t *sessions;
 
-  /** timing wheel for scheduling timeouts */
-    TWT (tw_timer_wheel) wheel;
+  /** per-thread timing wheels, indexed by thread index */
+  bfd_per_thread_data_t *per_thread_data;
 
   /** hashmap - bfd session by discriminator */
   u32 *session_by_disc;
@@ -378,6 +399,20 @@ typedef CLIB_PACKED (struct {
 }) bfd_echo_pkt_t;
 /* *INDENT-ON* */
 
+/**
+ * thread owning the session with the given local discriminator - main thread
+ * if there are no workers, otherwise one of the workers
+ */
+static inline u32
+bfd_thread_index_for_discr (u32 local_discr)
+{
+  u32 n_workers = vlib_num_workers ();
+
+  if (!n_workers)
+    return 0;
+  return vlib_get_worker_thread_index (local_discr % n_workers);
+}
+
 static inline void
 bfd_lock (bfd_main_t * bm)
 {
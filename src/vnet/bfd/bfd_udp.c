@@ -70,6 +70,9 @@ typedef struct
   /* number of active udp6 sessions */
   u32 udp6_sessions_count;
   u32 udp6_sessions_count_stat_seg_entry;
+  /* frame queues for handing control packets off to the session's thread */
+  u32 fq4_index;
+  u32 fq6_index;
 } bfd_udp_main_t;
 
 static vlib_node_registration_t bfd_udp4_input_node;
@@ -1243,6 +1246,55 @@ bfd_udp6_scan (vlib_main_t *vm, vlib_buffer_t *b, bfd_session_t **bs_out)
   return err;
 }
 
+/*
+ * Steer control packets to the thread owning their session. The peer echoes
+ * our discriminator in your-disc, which is what the session was homed by, so
+ * no lookup is needed. Packets without it (session bring-up) are processed
+ * where they arrived. Returns the number of packets left in local.
+ */
+static_always_inline u32
+bfd_udp_input_handoff (vlib_main_t *vm, vlib_node_runtime_t *rt, u32 *from,
+		       u32 n_left_from, u32 *local, int is_ipv6)
+{
+  u32 to_thread[VLIB_FRAME_SIZE], n_to_thread = 0, n_local = 0;
+  u16 thread_indices[VLIB_FRAME_SIZE];
+  u32 fq_index, n_enq;
+
+  while (n_left_from > 0)
+    {
+      vlib_buffer_t *b0 = vlib_get_buffer (vm, from[0]);
+      const bfd_pkt_t *pkt = vlib_buffer_get_current (b0);
+      u32 thread_index = vm->thread_index;
+
+      if (b0->current_length >= sizeof (*pkt) && pkt->your_disc)
+	thread_index = bfd_thread_index_for_discr (pkt->your_disc);
+
+      if (thread_index == vm->thread_index)
+	local[n_local++] = from[0];
+      else
+	{
+	  to_thread[n_to_thread] = from[0];
+	  thread_indices[n_to_thread++] = thread_index;
+	}
+
+      from += 1;
+      n_left_from -= 1;
+    }
+
+  if (n_to_thread)
+    {
+      fq_index = is_ipv6 ? bfd_udp_main.fq6_index : bfd_udp_main.fq4_index;
+      n_enq = vlib_buffer_enqueue_to_thread (vm, rt, fq_index, to_thread,
+					     thread_indices, n_to_thread, 1);
+      if (n_enq < n_to_thread)
+	vlib_node_increment_counter (vm, rt->node_index,
+				     BFD_UDP_ERROR_CONGESTION_DROP,
+				     n_to_thread - n_enq);
+    }
+
+  return n_local;
+}
+
 /*
  * Process a frame of bfd packets
  * Expect 1 packet / frame
@@ -1252,12 +1304,20 @@ bfd_udp_input (vlib_main_t * vm, vlib_node_runtime_t * rt,
 	       vlib_frame_t * f, int is_ipv6)
 {
   u32 n_left_from, *from;
+  u32 local[VLIB_FRAME_SIZE];
   bfd_input_trace_t *t0;
   bfd_main_t *bm = &bfd_main;
 
   from = vlib_frame_vector_args (f);	/* array of buffer indices */
   n_left_from = f->n_vectors;	/* number of buffer indices */
 
+  if (vlib_num_workers ())
+    {
+      n_left_from =
+	bfd_udp_input_handoff (vm, rt, from, n_left_from, local, is_ipv6);
+      from = local;
+    }
+
   while (n_left_from > 0)
     {
       u32 bi0;
@@ -1643,6 +1703,10 @@ bfd_udp_init (vlib_main_t * vm)
   bfd_udp_main.bfd_main = &bfd_main;
   bfd_udp_main.vnet_main = vnet_get_main ();
   bfd_udp_stats_init (&bfd_udp_main);
+  bfd_udp_main.fq4_index =
+    vlib_frame_queue_main_init (bfd_udp4_input_node.index, 0);
+  bfd_udp_main.fq6_index =
+    vlib_frame_queue_main_init (bfd_udp6_input_node.index, 0);
 
   bfd_udp_main.log_class = vlib_log_register_class ("bfd", "udp");
   vlib_log_debug (bfd_udp_main.log_class, "initialized");
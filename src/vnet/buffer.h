@@ -126,6 +126,11 @@ typedef enum
 #define VNET_BUFFER_OFFLOAD_F_TNL_MASK                                        \
   (VNET_BUFFER_OFFLOAD_F_TNL_VXLAN | VNET_BUFFER_OFFLOAD_F_TNL_IPIP)
 
+#define VNET_BUFFER_OFFLOAD_F_ALL                                             \
+  (VNET_BUFFER_OFFLOAD_F_IP_CKSUM | VNET_BUFFER_OFFLOAD_F_TCP_CKSUM |         \
+   VNET_BUFFER_OFFLOAD_F_UDP_CKSUM | VNET_BUFFER_OFFLOAD_F_OUTER_IP_CKSUM |   \
+   VNET_BUFFER_OFFLOAD_F_OUTER_UDP_CKSUM | VNET_BUFFER_OFFLOAD_F_TNL_MASK)
+
 #define foreach_buffer_opaque_union_subtype     \
 _(ip)                                           \
 _(l2)                                           \
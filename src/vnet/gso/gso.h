@@ -33,6 +33,9 @@ int vnet_sw_interface_gso_enable_disable (u32 sw_if_index, u8 enable);
 u32 gso_segment_buffer (vlib_main_t *vm, vnet_interface_per_thread_data_t *ptd,
 			u32 bi, vlib_buffer_t *b, generic_header_offset_t *gho,
 			u32 n_bytes_b, u8 is_l2, u8 is_ip6);
+u32 vnet_gso_segment_buffer (vlib_main_t *vm,
+			     vnet_interface_per_thread_data_t *ptd,
+			     vlib_buffer_t *b, int is_l2, int is_ip6);
 
 static_always_inline void
 gso_init_bufs_from_template_base (vlib_buffer_t **bufs, vlib_buffer_t *b0,
@@ -101,6 +104,20 @@ gso_init_bufs_from_template_base (vlib_buffer_t **bufs, vlib_buffer_t *b0,
     }
 }
 
+/**
+ * UDP gso buffers are told apart from TCP ones by the l4 checksum offload
+ * they request. Tunnel gso always carries TCP.
+ */
+static_always_inline int
+vnet_buffer_is_udp_gso (vlib_buffer_t *b)
+{
+  return (b->flags & (VNET_BUFFER_F_GSO | VNET_BUFFER_F_OFFLOAD)) ==
+	   (VNET_BUFFER_F_GSO | VNET_BUFFER_F_OFFLOAD) &&
+	 (vnet_buffer (b)->oflags & (VNET_BUFFER_OFFLOAD_F_UDP_CKSUM |
+				     VNET_BUFFER_OFFLOAD_F_TNL_MASK)) ==
+	   VNET_BUFFER_OFFLOAD_F_UDP_CKSUM;
+}
+
 static_always_inline void
 gso_fixup_segmented_buf (vlib_main_t *vm, vlib_buffer_t *b0, u32 next_tcp_seq,
 			 int is_l2, int is_ip6, generic_header_offset_t *gho,
@@ -116,16 +133,25 @@ gso_fixup_segmented_buf (vlib_main_t *vm, vlib_buffer_t *b0, u32 next_tcp_seq,
   tcp_header_t *tcp =
     (tcp_header_t *) (vlib_buffer_get_current (b0) + gho->l4_hdr_offset +
 		      gho->outer_hdr_sz);
+  udp_header_t *udp = (udp_header_t *) tcp;
+  u8 is_udp = (gho->gho_flags & GHO_F_UDP) != 0;
+  u32 l4_cksum_flag = is_udp ? VNET_BUFFER_OFFLOAD_F_UDP_CKSUM :
+			       VNET_BUFFER_OFFLOAD_F_TCP_CKSUM;
 
-  tcp->flags = tcp_flags;
-  tcp->seq_number = clib_host_to_net_u32 (next_tcp_seq);
+  if (!is_udp)
+    {
+      tcp->flags = tcp_flags;
+      tcp->seq_number = clib_host_to_net_u32 (next_tcp_seq);
+    }
   c->odd = 0;
 
   if (is_ip6)
     {
       ip6->payload_length = clib_host_to_net_u16 (
 	b0->current_length - gho->l4_hdr_offset - gho->outer_hdr_sz);
-      vnet_buffer_offload_flags_clear (b0, VNET_BUFFER_OFFLOAD_F_TCP_CKSUM);
+      if (is_udp)
+	udp->length = ip6->payload_length;
+      vnet_buffer_offload_flags_clear (b0, l4_cksum_flag);
       ip6_psh_t psh = { 0 };
       u32 *p = (u32 *) &psh;
       psh.src = ip6->src_address;
@@ -141,8 +167,11 @@ gso_fixup_segmented_buf (vlib_main_t *vm, vlib_buffer_t *b0, u32 next_tcp_seq,
 	b0->current_length - gho->l3_hdr_offset - gho->outer_hdr_sz);
       if (gho->gho_flags & GHO_F_IP4)
 	ip4->checksum = ip4_header_checksum (ip4);
+      if (is_udp)
+	udp->length = clib_host_to_net_u16 (
+	  clib_net_to_host_u16 (ip4->length) - ip4_header_bytes (ip4));
       vnet_buffer_offload_flags_clear (b0, (VNET_BUFFER_OFFLOAD_F_IP_CKSUM |
-					    VNET_BUFFER_OFFLOAD_F_TCP_CKSUM));
+					    l4_cksum_flag));
       c->sum += clib_mem_unaligned (&ip4->src_address, u32);
       c->sum += clib_mem_unaligned (&ip4->dst_address, u32);
       c->sum += clib_host_to_net_u32 (
@@ -150,7 +179,15 @@ gso_fixup_segmented_buf (vlib_main_t *vm, vlib_buffer_t *b0, u32 next_tcp_seq,
 	(ip4->protocol << 16));
     }
   clib_ip_csum_chunk (c, (u8 *) tcp, gho->l4_hdr_sz);
-  tcp->checksum = clib_ip_csum_fold (c);
+  if (is_udp)
+    {
+      udp->checksum = clib_ip_csum_fold (c);
+      /* zero means no checksum for udp */
+      if (udp->checksum == 0)
+	udp->checksum = 0xffff;
+    }
+  else
+    tcp->checksum = clib_ip_csum_fold (c);
 
   if (!is_l2 && ((gho->gho_flags & GHO_F_TUNNEL) == 0))
     {
@@ -166,6 +203,20 @@ gso_fixup_segmented_buf (vlib_main_t *vm, vlib_buffer_t *b0, u32 next_tcp_seq,
     }
 }
 
+/**
+ * Udp segments are independent datagrams that must each fit in one
+ * buffer, they can not be split at the buffer size like tcp segments
+ */
+static_always_inline int
+gso_udp_segment_fits_buffer (vlib_main_t *vm, vlib_buffer_t *b,
+			     generic_header_offset_t *gho)
+{
+  if (!(gho->gho_flags & GHO_F_UDP))
+    return 1;
+  return vnet_buffer2 (b)->gso_size + gho->hdr_sz + gho->outer_hdr_sz <=
+	 vlib_buffer_get_default_data_size (vm);
+}
+
 static_always_inline u32
 gso_segment_buffer_inline (vlib_main_t *vm,
 			   vnet_interface_per_thread_data_t *ptd,
@@ -189,6 +240,8 @@ gso_segment_buffer_inline (vlib_main_t *vm,
   u16 src_left, dst_left, bytes_to_copy;
   u32 i = 0;
 
+  ASSERT (gso_udp_segment_fits_buffer (vm, b, gho));
+
   vec_validate (ptd->split_buffers, n_bufs - 1);
   n_alloc = vlib_buffer_alloc (vm, ptd->split_buffers, n_bufs);
   if (n_alloc < n_bufs)
@@ -203,11 +256,19 @@ gso_segment_buffer_inline (vlib_main_t *vm,
   tcp_header_t *tcp =
     (tcp_header_t *) (vlib_buffer_get_current (b) + gho->l4_hdr_offset +
 		      gho->outer_hdr_sz);
-  tcp_seq = next_tcp_seq = clib_net_to_host_u32 (tcp->seq_number);
-  /* store original flags for last packet and reset FIN and PSH */
-  tcp_flags = tcp->flags;
-  tcp_flags_no_fin_psh = tcp->flags & ~(TCP_FLAG_FIN | TCP_FLAG_PSH);
-  tcp->checksum = 0;
+  if (gho->gho_flags & GHO_F_UDP)
+    {
+      /* every segment is an independent udp datagram */
+      ((udp_header_t *) tcp)->checksum = 0;
+    }
+  else
+    {
+      tcp_seq = next_tcp_seq = clib_net_to_host_u32 (tcp->seq_number);
+      /* store original flags for last packet and reset FIN and PSH */
+      tcp_flags = tcp->flags;
+      tcp_flags_no_fin_psh = tcp->flags & ~(TCP_FLAG_FIN | TCP_FLAG_PSH);
+      tcp->checksum = 0;
+    }
 
   gso_init_bufs_from_template_base (bufs, b, default_bflags, n_bufs, hdr_sz);
 
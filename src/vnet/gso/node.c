@@ -27,7 +27,8 @@
 
 #define foreach_gso_error                                                     \
   _ (NO_BUFFERS, "no buffers to segment GSO")                                 \
-  _ (UNHANDLED_TYPE, "unhandled gso type")
+  _ (UNHANDLED_TYPE, "unhandled gso type")                                    \
+  _ (UDP_GSO_SIZE, "udp gso size exceeds buffer size")
 
 static char *gso_error_strings[] = {
 #define _(sym, string) string,
@@ -471,6 +472,54 @@ gso_segment_buffer (vlib_main_t *vm, vnet_interface_per_thread_data_t *ptd,
   return tso_segment_buffer (vm, ptd, bi, b, gho, n_bytes_b, is_l2, is_ip6);
 }
 
+/**
+ * Segment the gso buffer b on behalf of a node that is not on an output
+ * feature arc, e.g. esp-encrypt. The segments are left in
+ * ptd->split_buffers with their offloads resolved, the gso buffer itself
+ * is not freed.
+ *
+ * Return the number of segments, zero if there were not enough buffers
+ * to segment it, or ~0 if its encapsulation can not be segmented.
+ */
+u32
+vnet_gso_segment_buffer (vlib_main_t *vm,
+			 vnet_interface_per_thread_data_t *ptd,
+			 vlib_buffer_t *b, int is_l2, int is_ip6)
+{
+  generic_header_offset_t gho = { 0 };
+  u32 inner_is_ip6 = is_ip6;
+  u32 i;
+
+  vnet_generic_header_offset_parser (b, &gho, is_l2, !is_ip6, is_ip6);
+
+  if (PREDICT_FALSE (gho.gho_flags & GHO_F_TUNNEL))
+    {
+      if (gho.gho_flags & (GHO_F_GRE_TUNNEL | GHO_F_GENEVE_TUNNEL))
+	/* not supported yet */
+	return ~0;
+
+      inner_is_ip6 = (gho.gho_flags & GHO_F_IP6) != 0;
+    }
+
+  if (PREDICT_FALSE (!gso_udp_segment_fits_buffer (vm, b, &gho)))
+    return ~0;
+
+  if (0 == gso_segment_buffer_inline (vm, ptd, b, &gho, is_l2, inner_is_ip6))
+    return 0;
+
+  if (PREDICT_FALSE (gho.gho_flags & GHO_F_VXLAN_TUNNEL))
+    tso_segment_vxlan_tunnel_fixup (vm, ptd, b, &gho);
+  else if (PREDICT_FALSE (gho.gho_flags &
+			  (GHO_F_IPIP_TUNNEL | GHO_F_IPIP6_TUNNEL)))
+    tso_segment_ipip_tunnel_fixup (vm, ptd, b, &gho);
+
+  for (i = 0; i < vec_len (ptd->split_buffers); i++)
+    vnet_buffer_offload_flags_clear (
+      vlib_get_buffer (vm, ptd->split_buffers[i]), VNET_BUFFER_OFFLOAD_F_ALL);
+
+  return vec_len (ptd->split_buffers);
+}
+
 static_always_inline void
 drop_one_buffer_and_count (vlib_main_t * vm, vnet_main_t * vnm,
 			   vlib_node_runtime_t * node, u32 * pbi0,
@@ -546,6 +595,14 @@ vnet_gso_node_inline (vlib_main_t * vm,
 	    swif2 = vnet_buffer (b[2])->sw_if_index[VLIB_TX];
 	    swif3 = vnet_buffer (b[3])->sw_if_index[VLIB_TX];
 
+	    /* udp gso needs its own capability, take the slow path */
+	    if (PREDICT_FALSE (!(hi->caps & VNET_HW_IF_CAP_UDP_GSO) &&
+			       (vnet_buffer_is_udp_gso (b[0]) ||
+				vnet_buffer_is_udp_gso (b[1]) ||
+				vnet_buffer_is_udp_gso (b[2]) ||
+				vnet_buffer_is_udp_gso (b[3]))))
+	      break;
+
 	    if (PREDICT_FALSE (hi->sw_if_index != swif0))
 	      {
 		hi0 = vnet_get_sup_hw_interface (vnm, swif0);
@@ -637,7 +694,7 @@ vnet_gso_node_inline (vlib_main_t * vm,
 	{
 	  u32 bi0, swif0;
 	  gso_trace_t *t0;
-	  vnet_hw_interface_t *hi0;
+	  vnet_hw_interface_t *hi0 = hi;
 	  u32 next0 = 0;
 	  u32 do_segmentation0 = 0;
 
@@ -652,6 +709,9 @@ vnet_gso_node_inline (vlib_main_t * vm,
 	  else
 	    do_segmentation0 = do_segmentation;
 
+	  if (PREDICT_FALSE (vnet_buffer_is_udp_gso (b[0])))
+	    do_segmentation0 = (hi0->caps & VNET_HW_IF_CAP_UDP_GSO) == 0;
+
 	  /* speculatively enqueue b0 to the current next frame */
 	  to_next[0] = bi0 = from[0];
 	  to_next += 1;
@@ -706,6 +766,16 @@ vnet_gso_node_inline (vlib_main_t * vm,
 		      inner_is_ip6 = (gho.gho_flags & GHO_F_IP6) != 0;
 		    }
 
+		  if (PREDICT_FALSE (
+			!gso_udp_segment_fits_buffer (vm, b[0], &gho)))
+		    {
+		      drop_one_buffer_and_count (vm, vnm, node, from - 1,
+						 hi->sw_if_index,
+						 GSO_ERROR_UDP_GSO_SIZE);
+		      b += 1;
+		      continue;
+		    }
+
 		  n_tx_bytes = gso_segment_buffer_inline (vm, ptd, b[0], &gho,
 							  is_l2, inner_is_ip6);
 
@@ -744,7 +814,8 @@ vnet_gso_node_inline (vlib_main_t * vm,
 			{
 			  sbi0 = to_next[0] = from_seg[0];
 			  sb0 = vlib_get_buffer (vm, sbi0);
-			  vnet_buffer_offload_flags_clear (sb0, 0x7F);
+			  vnet_buffer_offload_flags_clear (
+			    sb0, VNET_BUFFER_OFFLOAD_F_ALL);
 			  ASSERT (sb0->current_length > 0);
 			  to_next += 1;
 			  from_seg += 1;
@@ -16,6 +16,7 @@
  */
 
 #include <vppinfra/llist.h>
+#include <vppinfra/tw_timer_1t_3w_1024sl_ov.h>
 
 #include <vnet/ip-neighbor/ip_neighbor.h>
 #include <vnet/ip-neighbor/ip4_neighbor.h>
@@ -125,10 +126,21 @@ typedef struct ip_neighbor_db_t_
   u32 ipndb_n_elts;
   /** per-protocol number of elements per-fib-index*/
   u32 *ipndb_n_elts_per_fib;
+  /** per-neighbour aging timers */
+  TWT (tw_timer_wheel) ipndb_wheel;
 } ip_neighbor_db_t;
 
 static vlib_log_class_t ipn_logger;
 
+/** aging timer wheel tick-rate */
+#define IP_NEIGHBOR_AGE_TPS (100)
+
+/** probes are spread over the last 1/N of the aging window */
+#define IP_NEIGHBOR_AGE_JITTER_DIV (4)
+
+/** seed for the per-neighbour aging jitter */
+static u32 ip_neighbor_age_seed;
+
 /* DBs of neighbours one per AF */
 /* *INDENT-OFF* */
 static ip_neighbor_db_t ip_neighbor_db[N_AF] = {
@@ -204,6 +216,48 @@ ip_neighbor_get_sw_if_index (const ip_neighbor_t * ipn)
   return (ipn->ipn_key->ipnk_sw_if_index);
 }
 
+/**
+ * The age at which a neighbour is first probed. Each neighbour has its own
+ * offset into the end of the aging window, so that neighbours learned
+ * together are not all probed together.
+ */
+static f64
+ip_neighbor_age_threshold (const ip_neighbor_t *ipn, u32 ipndb_age)
+{
+  return (ipndb_age - ((f64) ipndb_age * ipn->ipn_age_jitter /
+		       (IP_NEIGHBOR_AGE_JITTER_DIV * (1 << 16))));
+}
+
+static void
+ip_neighbor_age_schedule (ip_neighbor_t *ipn, f64 wait)
+{
+  ip_neighbor_db_t *ipndb;
+  u32 n_ticks;
+
+  ipndb = &ip_neighbor_db[ip_neighbor_get_af (ipn)];
+  /* round up, a neighbour is never checked before it is due */
+  n_ticks = wait > 0 ? (u32) (wait * IP_NEIGHBOR_AGE_TPS) + 1 : 1;
+
+  if (~0 == ipn->ipn_age_timer)
+    ipn->ipn_age_timer =
+      TW (tw_timer_start) (&ipndb->ipndb_wheel, ip_neighbor_get_index (ipn),
+			   0, n_ticks);
+  else
+    TW (tw_timer_update) (&ipndb->ipndb_wheel, ipn->ipn_age_timer, n_ticks);
+}
+
+static void
+ip_neighbor_age_unschedule (ip_neighbor_t *ipn)
+{
+  if (~0 != ipn->ipn_age_timer)
+    {
+      TW (tw_timer_stop)
+      (&ip_neighbor_db[ip_neighbor_get_af (ipn)].ipndb_wheel,
+       ipn->ipn_age_timer);
+      ipn->ipn_age_timer = ~0;
+    }
+}
+
 static void
 ip_neighbor_list_remove (ip_neighbor_t * ipn)
 {
@@ -219,6 +273,7 @@ ip_neighbor_list_remove (ip_neighbor_t * ipn)
 
       ipn->ipn_elt = ~0;
     }
+  ip_neighbor_age_unschedule (ipn);
 }
 
 static void
@@ -251,6 +306,13 @@ ip_neighbor_refresh (ip_neighbor_t * ipn)
       elt->ipne_index = ip_neighbor_get_index (ipn);
       clib_llist_add (ip_neighbor_elt_pool, ipne_anchor, elt, head);
       ipn->ipn_elt = elt - ip_neighbor_elt_pool;
+
+      /* a pending timer re-checks the age when it fires, so a refresh
+       * only needs to schedule one if there is none */
+      u32 ipndb_age = ip_neighbor_db[ip_neighbor_get_af (ipn)].ipndb_age;
+      if (ipndb_age && ~0 == ipn->ipn_age_timer)
+	ip_neighbor_age_schedule (ipn,
+				  ip_neighbor_age_threshold (ipn, ipndb_age));
     }
 }
 
@@ -527,6 +589,8 @@ ip_neighbor_alloc (const ip_neighbor_key_t * key,
   ipn->ipn_fib_entry_index = FIB_NODE_INDEX_INVALID;
   ipn->ipn_flags = flags;
   ipn->ipn_elt = ~0;
+  ipn->ipn_age_timer = ~0;
+  ipn->ipn_age_jitter = random_u32 (&ip_neighbor_age_seed);
 
   mac_address_copy (&ipn->ipn_mac, mac);
 
@@ -1568,27 +1632,27 @@ typedef enum ip_neighbor_age_state_t_
   IP_NEIGHBOR_AGE_DEAD,
 } ip_neighbor_age_state_t;
 
-#define IP_NEIGHBOR_PROCESS_SLEEP_LONG (0)
-
 static ip_neighbor_age_state_t
 ip_neighbour_age_out (index_t ipni, f64 now, f64 * wait)
 {
   ip_address_family_t af;
   ip_neighbor_t *ipn;
   u32 ipndb_age;
-  u32 ttl;
+  f64 threshold;
+  f64 ttl;
 
   ipn = ip_neighbor_get (ipni);
   af = ip_neighbor_get_af (ipn);
   ipndb_age = ip_neighbor_db[af].ipndb_age;
+  threshold = ip_neighbor_age_threshold (ipn, ipndb_age);
   ttl = now - ipn->ipn_time_last_updated;
   *wait = ipndb_age;
 
-  if (ttl > ipndb_age)
+  if (ttl > threshold)
     {
-      IP_NEIGHBOR_DBG ("aged: %U @%f - %f > %d",
+      IP_NEIGHBOR_DBG ("aged: %U @%f - %f > %f",
 		       format_ip_neighbor, ipni, now,
-		       ipn->ipn_time_last_updated, ipndb_age);
+		       ipn->ipn_time_last_updated, threshold);
       if (ipn->ipn_n_probes > 2)
 	{
 	  /* 3 strikes and yea-re out */
@@ -1608,110 +1672,151 @@ ip_neighbour_age_out (index_t ipni, f64 now, f64 * wait)
     }
   else
     {
-      /* here we are sure that ttl <= ipndb_age */
-      *wait = ipndb_age - ttl + 1;
+      /* here we are sure that ttl <= threshold */
+      *wait = threshold - ttl;
       return (IP_NEIGHBOR_AGE_ALIVE);
     }
 
   return (IP_NEIGHBOR_AGE_PROBE);
 }
 
+/**
+ * Aging configuration changed; drop all timers and, if aging is still
+ * enabled, schedule each dynamic neighbour against the new age.
+ */
+static void
+ip_neighbor_age_reschedule_all (ip_address_family_t af, f64 now)
+{
+  ip_neighbor_db_t *ipndb = &ip_neighbor_db[af];
+  ip_neighbor_elt_t *elt, *head;
+  ip_neighbor_t *ipn;
+  f64 wait;
+
+  head = pool_elt_at_index (ip_neighbor_elt_pool, ip_neighbor_list_head[af]);
+
+  /* *INDENT-OFF*/
+  clib_llist_foreach (ip_neighbor_elt_pool, ipne_anchor, head, elt,
+  ({
+    ipn = ip_neighbor_get (elt->ipne_index);
+    ip_neighbor_age_unschedule (ipn);
+  }));
+  /* *INDENT-ON* */
+
+  /* restart the wheel's clock, it may have been idle for a long time */
+  TW (tw_timer_wheel_free) (&ipndb->ipndb_wheel);
+  TW (tw_timer_wheel_init) (&ipndb->ipndb_wheel, NULL,
+			    1.0 / IP_NEIGHBOR_AGE_TPS, ~0);
+
+  if (!ipndb->ipndb_age)
+    return;
+
+  /* *INDENT-OFF*/
+  clib_llist_foreach (ip_neighbor_elt_pool, ipne_anchor, head, elt,
+  ({
+    ipn = ip_neighbor_get (elt->ipne_index);
+    wait = ip_neighbor_age_threshold (ipn, ipndb->ipndb_age) -
+	   (now - ipn->ipn_time_last_updated);
+    ip_neighbor_age_schedule (ipn, wait);
+  }));
+  /* *INDENT-ON* */
+}
+
 typedef enum ip_neighbor_process_event_t_
 {
   IP_NEIGHBOR_AGE_PROCESS_WAKEUP,
 } ip_neighbor_process_event_t;
 
+#define foreach_ip_neighbor_age_error                                         \
+  _ (PROBES, probes, "neighbour probes sent")                                 \
+  _ (AGED, aged, "neighbours aged out")
+
+typedef enum
+{
+#define _(sym, name, str) IP_NEIGHBOR_AGE_ERROR_##sym,
+  foreach_ip_neighbor_age_error
+#undef _
+    IP_NEIGHBOR_AGE_N_ERROR,
+} ip_neighbor_age_error_t;
+
+static vlib_error_desc_t ip_neighbor_age_error_counters[] = {
+#define _(sym, name, str) { #name, str, VL_COUNTER_SEVERITY_INFO },
+  foreach_ip_neighbor_age_error
+#undef _
+};
+
 static uword
 ip_neighbor_age_loop (vlib_main_t * vm,
 		      vlib_node_runtime_t * rt,
 		      vlib_frame_t * f, ip_address_family_t af)
 {
+  ip_neighbor_db_t *ipndb = &ip_neighbor_db[af];
   uword event_type, *event_data = NULL;
-  f64 timeout;
-
-  /* Set the timeout to an effectively infinite value when the process starts */
-  timeout = IP_NEIGHBOR_PROCESS_SLEEP_LONG;
+  u32 *expired = NULL, *ipni;
 
   while (1)
     {
-      f64 now;
+      u32 n_probes = 0, n_aged = 0;
+      f64 now, timeout, wait;
 
-      if (!timeout)
+      if (!ipndb->ipndb_age)
 	vlib_process_wait_for_event (vm);
       else
-	vlib_process_wait_for_event_or_clock (vm, timeout);
+	{
+	  /* sleep until the next timer is due, or the fast ring wraps.
+	   * Timers started when neighbours are learned do not signal the
+	   * process, they are due no sooner than the shortest threshold, so
+	   * never sleep past that */
+	  timeout = clib_max (1, TW (tw_timer_first_expires_in_ticks) (
+				   &ipndb->ipndb_wheel)) *
+		    ipndb->ipndb_wheel.timer_interval;
+	  timeout = clib_min (timeout, ipndb->ipndb_age *
+					 (1 - 1.0 / IP_NEIGHBOR_AGE_JITTER_DIV));
+	  vlib_process_wait_for_event_or_clock (vm, timeout);
+	}
 
       event_type = vlib_process_get_events (vm, &event_data);
       vec_reset_length (event_data);
 
       now = vlib_time_now (vm);
 
-      switch (event_type)
+      if (IP_NEIGHBOR_AGE_PROCESS_WAKEUP == event_type)
+	ip_neighbor_age_reschedule_all (af, now);
+
+      if (!ipndb->ipndb_age)
+	continue;
+
+      /* only the neighbours whose timers expired are visited, each one is
+       * then either rescheduled or removed */
+      expired =
+	TW (tw_timer_expire_timers_vec) (&ipndb->ipndb_wheel, now, expired);
+
+      vec_foreach (ipni, expired)
 	{
-	case ~0:
-	  {
-	    /* timer expired */
-	    ip_neighbor_elt_t *elt, *head;
-	    f64 wait;
-
-	    timeout = ip_neighbor_db[af].ipndb_age;
-	    head = pool_elt_at_index (ip_neighbor_elt_pool,
-				      ip_neighbor_list_head[af]);
-
-          /* *INDENT-OFF*/
-          /* the list is time sorted, newest first, so start from the back
-           * and work forwards. Stop when we get to one that is alive */
-          restart:
-          clib_llist_foreach_reverse(ip_neighbor_elt_pool,
-                                     ipne_anchor, head, elt,
-          ({
-            ip_neighbor_age_state_t res;
-
-            res = ip_neighbour_age_out(elt->ipne_index, now, &wait);
-
-            if (IP_NEIGHBOR_AGE_ALIVE == res) {
-              /* the oldest neighbor has not yet expired, go back to sleep */
-              timeout = clib_min (wait, timeout);
-              break;
-            }
-            else if (IP_NEIGHBOR_AGE_DEAD == res) {
-              /* the oldest neighbor is dead, pop it, then restart the walk
-               * again from the back */
-              ip_neighbor_destroy (ip_neighbor_get(elt->ipne_index));
-              goto restart;
-            }
-
-            timeout = clib_min (wait, timeout);
-          }));
-          /* *INDENT-ON* */
-	    break;
-	  }
-	case IP_NEIGHBOR_AGE_PROCESS_WAKEUP:
-	  {
-
-	    if (!ip_neighbor_db[af].ipndb_age)
-	      {
-		/* aging has been disabled */
-		timeout = 0;
-		break;
-	      }
-	    ip_neighbor_elt_t *elt, *head;
-
-	    head = pool_elt_at_index (ip_neighbor_elt_pool,
-				      ip_neighbor_list_head[af]);
-	    /* no neighbors yet */
-	    if (clib_llist_is_empty (ip_neighbor_elt_pool, ipne_anchor, head))
-	      {
-		timeout = ip_neighbor_db[af].ipndb_age;
-		break;
-	      }
-
-	    /* poke the oldset neighbour for aging, which returns how long we sleep for */
-	    elt = clib_llist_prev (ip_neighbor_elt_pool, ipne_anchor, head);
-	    ip_neighbour_age_out (elt->ipne_index, now, &timeout);
-	    break;
-	  }
+	  ip_neighbor_t *ipn = ip_neighbor_get (*ipni);
+
+	  /* timer is gone because it expired */
+	  ipn->ipn_age_timer = ~0;
+
+	  switch (ip_neighbour_age_out (*ipni, now, &wait))
+	    {
+	    case IP_NEIGHBOR_AGE_PROBE:
+	      n_probes++;
+	      /* fallthrough */
+	    case IP_NEIGHBOR_AGE_ALIVE:
+	      ip_neighbor_age_schedule (ipn, wait);
+	      break;
+	    case IP_NEIGHBOR_AGE_DEAD:
+	      ip_neighbor_destroy (ipn);
+	      n_aged++;
+	      break;
+	    }
 	}
+      vec_reset_length (expired);
+
+      vlib_node_increment_counter (vm, rt->node_index,
+				   IP_NEIGHBOR_AGE_ERROR_PROBES, n_probes);
+      vlib_node_increment_counter (vm, rt->node_index,
+				   IP_NEIGHBOR_AGE_ERROR_AGED, n_aged);
     }
   return 0;
 }
@@ -1735,11 +1840,15 @@ VLIB_REGISTER_NODE (ip4_neighbor_age_process_node,static) = {
   .function = ip4_neighbor_age_process,
   .type = VLIB_NODE_TYPE_PROCESS,
   .name = "ip4-neighbor-age-process",
+  .n_errors = IP_NEIGHBOR_AGE_N_ERROR,
+  .error_counters = ip_neighbor_age_error_counters,
 };
 VLIB_REGISTER_NODE (ip6_neighbor_age_process_node,static) = {
   .function = ip6_neighbor_age_process,
   .type = VLIB_NODE_TYPE_PROCESS,
   .name = "ip6-neighbor-age-process",
+  .n_errors = IP_NEIGHBOR_AGE_N_ERROR,
+  .error_counters = ip_neighbor_age_error_counters,
 };
 /* *INDENT-ON* */
 
@@ -1928,8 +2037,13 @@ ip_neighbor_init (vlib_main_t * vm)
   ip_address_family_t af;
 
   FOR_EACH_IP_ADDRESS_FAMILY (af)
+  {
     ip_neighbor_list_head[af] =
-    clib_llist_make_head (ip_neighbor_elt_pool, ipne_anchor);
+      clib_llist_make_head (ip_neighbor_elt_pool, ipne_anchor);
+    TW (tw_timer_wheel_init) (&ip_neighbor_db[af].ipndb_wheel, NULL,
+			      1.0 / IP_NEIGHBOR_AGE_TPS, ~0);
+  }
+  ip_neighbor_age_seed = random_default_seed ();
 
   return (NULL);
 }
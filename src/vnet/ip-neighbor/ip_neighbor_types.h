@@ -77,10 +77,14 @@ typedef struct ip_neighbor_t_
    * Aging related data
    *  - last time the neighbour was probed
    *  - number of probes - 3 and it's dead
+   *  - random offset spreading the first probe over the aging window
+   *  - handle of the aging timer (~0 when not scheduled)
    */
   f64 ipn_time_last_updated;
   u8 ipn_n_probes;
+  u16 ipn_age_jitter;
   index_t ipn_elt;
+  u32 ipn_age_timer;
 
   /**
    * The index of the adj fib created for this neighbour
@@ -115,6 +115,43 @@ esp_seq_advance (ipsec_sa_t * sa)
   return 0;
 }
 
+/*
+ * Multi-worker flavour of esp_seq_advance: the workers reserve disjoint
+ * blocks of sequence numbers from the SA and consume them locally, so no
+ * two workers ever send the same sequence number.
+ */
+always_inline int
+esp_seq_advance_mw (ipsec_sa_t *sa, u32 sa_index,
+		    ipsec_per_thread_data_t *ptd, u32 *seq, u32 *seq_hi)
+{
+  ipsec_sa_seq_block_t *sb;
+  u64 max;
+
+  /* validated for every thread when the SA is added */
+  sb = vec_elt_at_index (ptd->seq_blocks, sa_index);
+
+  if (PREDICT_FALSE (sb->next == sb->end))
+    {
+      u32 n = ipsec_main.seq_block_size;
+
+      sb->next = clib_atomic_fetch_add (&sa->seq64, n);
+      sb->end = sb->next + n;
+    }
+
+  if (ipsec_sa_is_set_USE_ANTI_REPLAY (sa))
+    {
+      max = ipsec_sa_is_set_USE_ESN (sa) ? ~0ULL : ESP_SEQ_MAX;
+      if (PREDICT_FALSE (sb->next >= max))
+	return 1;
+    }
+
+  sb->next++;
+  *seq = (u32) sb->next;
+  *seq_hi = ipsec_sa_is_set_USE_ESN (sa) ? (u32) (sb->next >> 32) : 0;
+
+  return 0;
+}
+
 always_inline u16
 esp_aad_fill (u8 *data, const esp_header_t *esp, const ipsec_sa_t *sa,
 	      u32 seq_hi)
@@ -756,9 +756,21 @@ esp_decrypt_post_crypto (vlib_main_t *vm, vlib_node_runtime_t *node,
    * a sequence s, s+1, s+2, s+3, ... s+n and nothing will prevent any
    * implementation, sequential or batching, from decrypting these.
    */
+  u8 is_mw = ipsec_sa_is_set_MULTI_WORKER (sa0);
+
+  /*
+   * A multi-worker SA shares its window between the workers, it may
+   * have moved since the pre-decrypt check so only this one is
+   * authoritative.
+   */
+  if (is_mw)
+    clib_spinlock_lock (&sa0->replay_lock);
+
   if (ipsec_sa_anti_replay_and_sn_advance (sa0, pd->seq, pd->seq_hi, true,
 					   NULL))
     {
+      if (is_mw)
+	clib_spinlock_unlock (&sa0->replay_lock);
       esp_decrypt_set_next_index (b, node, vm->thread_index,
 				  ESP_DECRYPT_ERROR_REPLAY, 0, next,
 				  ESP_DECRYPT_NEXT_DROP, pd->sa_index);
@@ -768,6 +780,9 @@ esp_decrypt_post_crypto (vlib_main_t *vm, vlib_node_runtime_t *node,
   u64 n_lost =
     ipsec_sa_anti_replay_advance (sa0, vm->thread_index, pd->seq, pd->seq_hi);
 
+  if (is_mw)
+    clib_spinlock_unlock (&sa0->replay_lock);
+
   vlib_prefetch_simple_counter (&ipsec_sa_err_counters[IPSEC_SA_ERROR_LOST],
 				vm->thread_index, pd->sa_index);
 
@@ -1100,23 +1115,28 @@ esp_decrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	  is_async = im->async_mode | ipsec_sa_is_set_IS_ASYNC (sa0);
 	}
 
-      if (PREDICT_FALSE ((u16) ~0 == sa0->thread_index))
+      /* multi-worker SAs are processed on the receiving worker */
+      if (!ipsec_sa_is_set_MULTI_WORKER (sa0))
 	{
-	  /* this is the first packet to use this SA, claim the SA
-	   * for this thread. this could happen simultaneously on
-	   * another thread */
-	  clib_atomic_cmp_and_swap (&sa0->thread_index, ~0,
-				    ipsec_sa_assign_thread (thread_index));
-	}
+	  if (PREDICT_FALSE ((u16) ~0 == sa0->thread_index))
+	    {
+	      /* this is the first packet to use this SA, claim the SA
+	       * for this thread. this could happen simultaneously on
+	       * another thread */
+	      clib_atomic_cmp_and_swap (&sa0->thread_index, ~0,
+					ipsec_sa_assign_thread (thread_index));
+	    }
 
-      if (PREDICT_FALSE (thread_index != sa0->thread_index))
-	{
-	  vnet_buffer (b[0])->ipsec.thread_index = sa0->thread_index;
-	  err = ESP_DECRYPT_ERROR_HANDOFF;
-	  esp_decrypt_set_next_index (b[0], node, thread_index, err, n_noop,
-				      noop_nexts, ESP_DECRYPT_NEXT_HANDOFF,
-				      current_sa_index);
-	  goto next;
+	  if (PREDICT_FALSE (thread_index != sa0->thread_index))
+	    {
+	      vnet_buffer (b[0])->ipsec.thread_index = sa0->thread_index;
+	      err = ESP_DECRYPT_ERROR_HANDOFF;
+	      esp_decrypt_set_next_index (b[0], node, thread_index, err,
+					  n_noop, noop_nexts,
+					  ESP_DECRYPT_NEXT_HANDOFF,
+					  current_sa_index);
+	      goto next;
+	    }
 	}
 
       /* store packet data for next round for easier prefetch */
@@ -1148,9 +1168,20 @@ esp_decrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 
       pd->current_length = b[0]->current_length;
 
-      /* anti-reply check */
-      if (ipsec_sa_anti_replay_and_sn_advance (sa0, pd->seq, ~0, false,
-					       &pd->seq_hi))
+      /* anti-reply check, the seq_hi inference needs a consistent
+       * view of a window the workers of a multi-worker SA share */
+      int is_replay;
+      if (ipsec_sa_is_set_MULTI_WORKER (sa0))
+	{
+	  clib_spinlock_lock (&sa0->replay_lock);
+	  is_replay = ipsec_sa_anti_replay_and_sn_advance (
+	    sa0, pd->seq, ~0, false, &pd->seq_hi);
+	  clib_spinlock_unlock (&sa0->replay_lock);
+	}
+      else
+	is_replay = ipsec_sa_anti_replay_and_sn_advance (sa0, pd->seq, ~0,
+							 false, &pd->seq_hi);
+      if (is_replay)
 	{
 	  err = ESP_DECRYPT_ERROR_REPLAY;
 	  esp_decrypt_set_next_index (b[0], node, thread_index, err, n_noop,
@@ -20,6 +20,7 @@
 #include <vnet/ip/ip.h>
 
 #include <vnet/crypto/crypto.h>
+#include <vnet/gso/gso.h>
 
 #include <vnet/ipsec/ipsec.h>
 #include <vnet/ipsec/ipsec_tun.h>
@@ -334,7 +335,7 @@ esp_encrypt_chain_crypto (vlib_main_t * vm, ipsec_per_thread_data_t * ptd,
 
 static_always_inline u32
 esp_encrypt_chain_integ (vlib_main_t * vm, ipsec_per_thread_data_t * ptd,
-			 ipsec_sa_t * sa0, vlib_buffer_t * b,
+			 ipsec_sa_t * sa0, u32 seq_hi, vlib_buffer_t * b,
 			 vlib_buffer_t * lb, u8 icv_sz, u8 * start,
 			 u32 start_len, u8 * digest, u16 * n_ch)
 {
@@ -356,8 +357,8 @@ esp_encrypt_chain_integ (vlib_main_t * vm, ipsec_per_thread_data_t * ptd,
 	  total_len += ch->len = cb->current_length - icv_sz;
 	  if (ipsec_sa_is_set_USE_ESN (sa0))
 	    {
-	      u32 seq_hi = clib_net_to_host_u32 (sa0->seq_hi);
-	      clib_memcpy_fast (digest, &seq_hi, sizeof (seq_hi));
+	      u32 tmp = clib_net_to_host_u32 (seq_hi);
+	      clib_memcpy_fast (digest, &tmp, sizeof (seq_hi));
 	      ch->len += sizeof (seq_hi);
 	      total_len += sizeof (seq_hi);
 	    }
@@ -472,7 +473,7 @@ esp_prepare_sync_op (vlib_main_t *vm, ipsec_per_thread_data_t *ptd,
 	  op->chunk_index = vec_len (ptd->chunks);
 	  op->digest = vlib_buffer_get_tail (lb) - icv_sz;
 
-	  esp_encrypt_chain_integ (vm, ptd, sa0, b[0], lb, icv_sz,
+	  esp_encrypt_chain_integ (vm, ptd, sa0, seq_hi, b[0], lb, icv_sz,
 				   payload - iv_sz - sizeof (esp_header_t),
 				   payload_len + iv_sz +
 				   sizeof (esp_header_t), op->digest,
@@ -490,8 +491,9 @@ esp_prepare_sync_op (vlib_main_t *vm, ipsec_per_thread_data_t *ptd,
 static_always_inline void
 esp_prepare_async_frame (vlib_main_t *vm, ipsec_per_thread_data_t *ptd,
 			 vnet_crypto_async_frame_t *async_frame,
-			 ipsec_sa_t *sa, vlib_buffer_t *b, esp_header_t *esp,
-			 u8 *payload, u32 payload_len, u8 iv_sz, u8 icv_sz,
+			 ipsec_sa_t *sa, u32 seq_hi, vlib_buffer_t *b,
+			 esp_header_t *esp, u8 *payload, u32 payload_len,
+			 u8 iv_sz, u8 icv_sz,
 			 u32 bi, u16 next, u32 hdr_len, u16 async_next,
 			 vlib_buffer_t *lb)
 {
@@ -521,7 +523,7 @@ esp_prepare_async_frame (vlib_main_t *vm, ipsec_per_thread_data_t *ptd,
 	{
 	  /* constuct aad in a scratch space in front of the nonce */
 	  aad = (u8 *) nonce - sizeof (esp_aead_t);
-	  esp_aad_fill (aad, esp, sa, sa->seq_hi);
+	  esp_aad_fill (aad, esp, sa, seq_hi);
 	}
       else
 	{
@@ -560,14 +562,14 @@ esp_prepare_async_frame (vlib_main_t *vm, ipsec_per_thread_data_t *ptd,
       if (b != lb)
 	{
 	  integ_total_len = esp_encrypt_chain_integ (
-	    vm, ptd, sa, b, lb, icv_sz,
+	    vm, ptd, sa, seq_hi, b, lb, icv_sz,
 	    payload - iv_sz - sizeof (esp_header_t),
 	    payload_len + iv_sz + sizeof (esp_header_t), tag, 0);
 	}
       else if (ipsec_sa_is_set_USE_ESN (sa))
 	{
-	  u32 seq_hi = clib_net_to_host_u32 (sa->seq_hi);
-	  clib_memcpy_fast (tag, &seq_hi, sizeof (seq_hi));
+	  u32 tmp = clib_net_to_host_u32 (seq_hi);
+	  clib_memcpy_fast (tag, &tmp, sizeof (seq_hi));
 	  integ_total_len += sizeof (seq_hi);
 	}
     }
@@ -580,14 +582,13 @@ esp_prepare_async_frame (vlib_main_t *vm, ipsec_per_thread_data_t *ptd,
 }
 
 always_inline uword
-esp_encrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
-		    vlib_frame_t *frame, vnet_link_t lt, int is_tun,
-		    u16 async_next_node)
+esp_encrypt_buffers_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
+			    u32 *from, u32 n_vectors, vnet_link_t lt,
+			    int is_tun, u16 async_next_node)
 {
   ipsec_main_t *im = &ipsec_main;
   ipsec_per_thread_data_t *ptd = vec_elt_at_index (im->ptd, vm->thread_index);
-  u32 *from = vlib_frame_vector_args (frame);
-  u32 n_left = frame->n_vectors;
+  u32 n_left = n_vectors;
   vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b = bufs;
   u32 thread_index = vm->thread_index;
   u16 buffer_data_size = vlib_buffer_get_default_data_size (vm);
@@ -634,7 +635,7 @@ esp_encrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
       esp_header_t *esp;
       u8 *payload, *next_hdr_ptr;
       u16 payload_len, payload_len_total, n_bufs;
-      u32 hdr_len;
+      u32 hdr_len, seq0 = 0, seq_hi0 = 0;
 
       err = ESP_ENCRYPT_ERROR_RX_PKTS;
 
@@ -703,23 +704,27 @@ esp_encrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	  is_async = im->async_mode | ipsec_sa_is_set_IS_ASYNC (sa0);
 	}
 
-      if (PREDICT_FALSE ((u16) ~0 == sa0->thread_index))
+      /* multi-worker SAs are processed on the receiving worker */
+      if (!ipsec_sa_is_set_MULTI_WORKER (sa0))
 	{
-	  /* this is the first packet to use this SA, claim the SA
-	   * for this thread. this could happen simultaneously on
-	   * another thread */
-	  clib_atomic_cmp_and_swap (&sa0->thread_index, ~0,
-				    ipsec_sa_assign_thread (thread_index));
-	}
+	  if (PREDICT_FALSE ((u16) ~0 == sa0->thread_index))
+	    {
+	      /* this is the first packet to use this SA, claim the SA
+	       * for this thread. this could happen simultaneously on
+	       * another thread */
+	      clib_atomic_cmp_and_swap (&sa0->thread_index, ~0,
+					ipsec_sa_assign_thread (thread_index));
+	    }
 
-      if (PREDICT_FALSE (thread_index != sa0->thread_index))
-	{
-	  vnet_buffer (b[0])->ipsec.thread_index = sa0->thread_index;
-	  err = ESP_ENCRYPT_ERROR_HANDOFF;
-	  esp_encrypt_set_next_index (b[0], node, thread_index, err, n_noop,
-				      noop_nexts, handoff_next,
-				      current_sa_index);
-	  goto trace;
+	  if (PREDICT_FALSE (thread_index != sa0->thread_index))
+	    {
+	      vnet_buffer (b[0])->ipsec.thread_index = sa0->thread_index;
+	      err = ESP_ENCRYPT_ERROR_HANDOFF;
+	      esp_encrypt_set_next_index (b[0], node, thread_index, err,
+					  n_noop, noop_nexts, handoff_next,
+					  current_sa_index);
+	      goto trace;
+	    }
 	}
 
       lb = b[0];
@@ -739,12 +744,30 @@ esp_encrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	    lb = vlib_get_buffer (vm, lb->next_buffer);
 	}
 
-      if (PREDICT_FALSE (esp_seq_advance (sa0)))
+      if (ipsec_sa_is_set_MULTI_WORKER (sa0))
 	{
-	  err = ESP_ENCRYPT_ERROR_SEQ_CYCLED;
-	  esp_encrypt_set_next_index (b[0], node, thread_index, err, n_noop,
-				      noop_nexts, drop_next, current_sa_index);
-	  goto trace;
+	  if (PREDICT_FALSE (esp_seq_advance_mw (sa0, current_sa_index, ptd,
+						 &seq0, &seq_hi0)))
+	    {
+	      err = ESP_ENCRYPT_ERROR_SEQ_CYCLED;
+	      esp_encrypt_set_next_index (b[0], node, thread_index, err,
+					  n_noop, noop_nexts, drop_next,
+					  current_sa_index);
+	      goto trace;
+	    }
+	}
+      else
+	{
+	  if (PREDICT_FALSE (esp_seq_advance (sa0)))
+	    {
+	      err = ESP_ENCRYPT_ERROR_SEQ_CYCLED;
+	      esp_encrypt_set_next_index (b[0], node, thread_index, err,
+					  n_noop, noop_nexts, drop_next,
+					  current_sa_index);
+	      goto trace;
+	    }
+	  seq0 = sa0->seq;
+	  seq_hi0 = sa0->seq_hi;
 	}
 
       /* space for IV */
@@ -986,7 +1009,7 @@ esp_encrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	}
 
       esp->spi = spi;
-      esp->seq = clib_net_to_host_u32 (sa0->seq);
+      esp->seq = clib_net_to_host_u32 (seq0);
 
       if (is_async)
 	{
@@ -1013,13 +1036,13 @@ esp_encrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	      vec_add1 (ptd->async_frames, async_frames[async_op]);
 	    }
 
-	  esp_prepare_async_frame (vm, ptd, async_frames[async_op], sa0, b[0],
-				   esp, payload, payload_len, iv_sz, icv_sz,
-				   from[b - bufs], sync_next[0], hdr_len,
-				   async_next_node, lb);
+	  esp_prepare_async_frame (vm, ptd, async_frames[async_op], sa0,
+				   seq_hi0, b[0], esp, payload, payload_len,
+				   iv_sz, icv_sz, from[b - bufs], sync_next[0],
+				   hdr_len, async_next_node, lb);
 	}
       else
-	esp_prepare_sync_op (vm, ptd, crypto_ops, integ_ops, sa0, sa0->seq_hi,
+	esp_prepare_sync_op (vm, ptd, crypto_ops, integ_ops, sa0, seq_hi0,
 			     payload, payload_len, iv_sz, icv_sz, n_sync, b,
 			     lb, hdr_len, esp);
 
@@ -1039,8 +1062,8 @@ esp_encrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	    {
 	      tr->sa_index = sa_index0;
 	      tr->spi = sa0->spi;
-	      tr->seq = sa0->seq;
-	      tr->sa_seq_hi = sa0->seq_hi;
+	      tr->seq = seq0;
+	      tr->sa_seq_hi = seq_hi0;
 	      tr->udp_encap = ipsec_sa_is_set_UDP_ENCAP (sa0);
 	      tr->crypto_alg = sa0->crypto_alg;
 	      tr->integ_alg = sa0->integ_alg;
@@ -1108,7 +1131,114 @@ esp_encrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
     vlib_buffer_enqueue_to_next (vm, node, noop_bi, noop_nexts, n_noop);
 
   vlib_node_increment_counter (vm, node->node_index, ESP_ENCRYPT_ERROR_RX_PKTS,
-			       frame->n_vectors);
+			       n_vectors);
+
+  return n_vectors;
+}
+
+/*
+ * Replace the gso buffers of the frame with their segments, so that the
+ * segments of a super-packet are encrypted back to back against the
+ * same SA and their crypto ops are submitted in the same batch instead
+ * of each going around the graph on its own.
+ */
+static u32 *
+esp_encrypt_gso_segment (vlib_main_t *vm, vlib_node_runtime_t *node,
+			 ipsec_per_thread_data_t *ptd, u32 *from,
+			 u32 n_vectors, vnet_link_t lt, int is_tun)
+{
+  vnet_interface_per_thread_data_t *iptd = vec_elt_at_index (
+    vnet_get_main ()->interface_main.per_thread_data, vm->thread_index);
+  u32 n_segmented = 0, n_dropped = 0, n_unsupported = 0;
+  u32 i, n_segs;
+
+  vec_reset_length (ptd->gso_buffers);
+
+  for (i = 0; i < n_vectors; i++)
+    {
+      vlib_buffer_t *b = vlib_get_buffer (vm, from[i]);
+      u16 l2_len, j;
+
+      if (!(b->flags & VNET_BUFFER_F_GSO))
+	{
+	  vec_add1 (ptd->gso_buffers, from[i]);
+	  continue;
+	}
+
+      /* on the tunnel the midchain rewrite has already been applied and
+       * current points at it, otherwise current points at the IP header
+       * and the segments need the saved L2 rewrite as well */
+      l2_len = is_tun ? 0 : vnet_buffer (b)->ip.save_rewrite_length;
+      vlib_buffer_advance (b, -l2_len);
+
+      n_segs = vnet_gso_segment_buffer (vm, iptd, b, /* is_l2 */ 0,
+					VNET_LINK_IP6 == lt);
+      if (PREDICT_FALSE (0 == n_segs || ~0 == n_segs))
+	{
+	  vlib_buffer_free_one (vm, from[i]);
+	  if (0 == n_segs)
+	    n_dropped++;
+	  else
+	    n_unsupported++;
+	  continue;
+	}
+
+      for (j = 0; j < n_segs; j++)
+	vlib_buffer_advance (vlib_get_buffer (vm, iptd->split_buffers[j]),
+			     l2_len);
+
+      vec_append (ptd->gso_buffers, iptd->split_buffers);
+      vec_reset_length (iptd->split_buffers);
+      vlib_buffer_free_one (vm, from[i]);
+      n_segmented++;
+    }
+
+  vlib_node_increment_counter (vm, node->node_index,
+			       ESP_ENCRYPT_ERROR_GSO_SEGMENTED, n_segmented);
+  if (n_dropped)
+    vlib_node_increment_counter (vm, node->node_index,
+				 ESP_ENCRYPT_ERROR_NO_BUFFERS, n_dropped);
+  if (n_unsupported)
+    vlib_node_increment_counter (vm, node->node_index,
+				 ESP_ENCRYPT_ERROR_GSO_UNSUPPORTED,
+				 n_unsupported);
+
+  return ptd->gso_buffers;
+}
+
+always_inline uword
+esp_encrypt_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
+		    vlib_frame_t *frame, vnet_link_t lt, int is_tun,
+		    u16 async_next_node)
+{
+  ipsec_main_t *im = &ipsec_main;
+  ipsec_per_thread_data_t *ptd;
+  u32 *from = vlib_frame_vector_args (frame);
+  u32 n_left = frame->n_vectors;
+  int has_gso = 0;
+  u32 i;
+
+  /* mpls payloads are not parsed for segmentation */
+  if (VNET_LINK_MPLS != lt)
+    for (i = 0; i < n_left; i++)
+      has_gso |= vlib_get_buffer (vm, from[i])->flags & VNET_BUFFER_F_GSO;
+
+  if (PREDICT_TRUE (!has_gso))
+    return esp_encrypt_buffers_inline (vm, node, from, n_left, lt, is_tun,
+				       async_next_node);
+
+  ptd = vec_elt_at_index (im->ptd, vm->thread_index);
+  from = esp_encrypt_gso_segment (vm, node, ptd, from, n_left, lt, is_tun);
+  n_left = vec_len (from);
+
+  while (n_left)
+    {
+      u32 n = clib_min (n_left, VLIB_FRAME_SIZE);
+      esp_encrypt_buffers_inline (vm, node, from, n, lt, is_tun,
+				  async_next_node);
+      from += n;
+      n_left -= n;
+    }
 
   return frame->n_vectors;
 }
@@ -598,6 +598,7 @@ ipsec_init (vlib_main_t * vm)
   vec_validate_aligned (im->ptd, vlib_num_workers (), CLIB_CACHE_LINE_BYTES);
 
   im->async_mode = 0;
+  im->seq_block_size = IPSEC_SA_SEQ_BLOCK_SIZE_DEFAULT;
   crypto_engine_backend_register_post_node (vm);
 
   im->ipsec4_out_spd_hash_tbl = NULL;
@@ -607,7 +608,6 @@ ipsec_init (vlib_main_t * vm)
   im->ipsec4_out_spd_hash_num_buckets =
     IPSEC4_OUT_SPD_DEFAULT_HASH_NUM_BUCKETS;
 
-  im->ipsec4_in_spd_hash_tbl = NULL;
   im->input_flow_cache_flag = 0;
   im->ipsec4_in_spd_flow_cache_entries = 0;
   im->input_epoch_count = 0;
@@ -700,6 +700,11 @@ ipsec_config (vlib_main_t *vm, unformat_input_t *input)
 	  im->ipsec4_in_spd_hash_num_buckets =
 	    1ULL << max_log2 (ipsec4_in_spd_hash_num_buckets);
 	}
+      else if (unformat (input, "seq-block-size %u", &im->seq_block_size))
+	{
+	  if (!im->seq_block_size)
+	    return clib_error_return (0, "seq-block-size must be non-zero");
+	}
       else if (unformat (input, "ip4 %U", unformat_vlib_cli_sub_input,
 			 &sub_input))
 	{
@@ -745,8 +750,20 @@ ipsec_config (vlib_main_t *vm, unformat_input_t *input)
     }
   if (im->input_flow_cache_flag)
     {
-      vec_add2 (im->ipsec4_in_spd_hash_tbl, im->ipsec4_in_spd_hash_tbl,
-		im->ipsec4_in_spd_hash_num_buckets);
+      ipsec_per_thread_data_t *ptd;
+      u32 n_workers = vlib_num_workers ();
+
+      /* the buckets are split between the workers, each of which only
+       * caches the flows it receives */
+      if (n_workers > 1)
+	im->ipsec4_in_spd_hash_num_buckets =
+	  1ULL << min_log2 (
+	    clib_max (im->ipsec4_in_spd_hash_num_buckets / n_workers, 1024));
+
+      vec_foreach (ptd, im->ptd)
+	vec_validate_aligned (ptd->ipsec4_in_spd_hash_tbl,
+			      im->ipsec4_in_spd_hash_num_buckets - 1,
+			      CLIB_CACHE_LINE_BYTES);
     }
 
   if (fp_spd_ip4_enabled)
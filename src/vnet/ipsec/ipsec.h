@@ -63,8 +63,8 @@ typedef union
   {
     ip4_address_t ip4_src_addr;
     ip4_address_t ip4_dest_addr;
-    ipsec_spd_policy_type_t policy_type;
-    u8 pad[4];
+    u32 spi;
+    u32 spd_index;
   }; // 16 bytes total
   ipsec4_hash_kv_16_8_t kv_16_8;
 } ipsec4_inbound_spd_tuple_t;
@@ -136,6 +136,12 @@ typedef struct
   vnet_crypto_op_t *chained_integ_ops;
   vnet_crypto_op_chunk_t *chunks;
   vnet_crypto_async_frame_t **async_frames;
+  /* frame expanded with the segments of gso buffers, see esp-encrypt */
+  u32 *gso_buffers;
+  /* sequence numbers reserved for multi-worker SAs, by SA index */
+  ipsec_sa_seq_block_t *seq_blocks;
+  /* inbound SPD flow cache, only used by this thread */
+  ipsec4_hash_kv_16_8_t *ipsec4_in_spd_hash_tbl;
 } ipsec_per_thread_data_t;
 
 typedef struct
@@ -179,7 +185,6 @@ typedef struct
   uword *ipsec_if_by_sw_if_index;
 
   ipsec4_hash_kv_16_8_t *ipsec4_out_spd_hash_tbl;
-  ipsec4_hash_kv_16_8_t *ipsec4_in_spd_hash_tbl;
   clib_bihash_8_16_t tun4_protect_by_key;
   clib_bihash_24_16_t tun6_protect_by_key;
 
@@ -261,6 +266,9 @@ typedef struct
 
   u8 async_mode;
   u16 msg_id_base;
+
+  /* sequence numbers a worker reserves at once for multi-worker SAs */
+  u32 seq_block_size;
 } ipsec_main_t;
 
 typedef enum ipsec_format_flags_t_
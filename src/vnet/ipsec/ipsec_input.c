@@ -18,6 +18,7 @@
 #include <vnet/vnet.h>
 #include <vnet/api_errno.h>
 #include <vnet/ip/ip.h>
+#include <vnet/udp/udp_local.h>
 #include <vnet/feature/feature.h>
 #include <vnet/ipsec/ipsec_spd_fp_lookup.h>
 
@@ -31,7 +32,9 @@ _(RX_PKTS, "IPSec pkts received")			\
 _(RX_POLICY_MATCH, "IPSec policy match")		\
 _(RX_POLICY_NO_MATCH, "IPSec policy not matched")	\
 _(RX_POLICY_BYPASS, "IPSec policy bypass")		\
-_(RX_POLICY_DISCARD, "IPSec policy discard")
+_(RX_POLICY_DISCARD, "IPSec policy discard")		\
+_(RX_FLOW_CACHE_HIT, "IPSec inbound flow cache hit")	\
+_(RX_FLOW_CACHE_MISS, "IPSec inbound flow cache miss")
 
 typedef enum
 {
@@ -76,16 +79,19 @@ format_ipsec_input_trace (u8 * s, va_list * args)
 
 always_inline void
 ipsec4_input_spd_add_flow_cache_entry (ipsec_main_t *im, u32 sa, u32 da,
-				       ipsec_spd_policy_type_t policy_type,
-				       u32 pol_id)
+				       u32 spi, u32 spd_index, u32 pol_id)
 {
+  ipsec_per_thread_data_t *ptd =
+    vec_elt_at_index (im->ptd, vlib_get_thread_index ());
+  ipsec4_hash_kv_16_8_t *kv;
   u64 hash;
   u8 is_overwrite = 0, is_stale_overwrite = 0;
   /* Store in network byte order to avoid conversion on lookup */
   ipsec4_inbound_spd_tuple_t ip4_tuple = {
     .ip4_src_addr = (ip4_address_t) clib_host_to_net_u32 (sa),
     .ip4_dest_addr = (ip4_address_t) clib_host_to_net_u32 (da),
-    .policy_type = policy_type
+    .spi = clib_host_to_net_u32 (spi),
+    .spd_index = spd_index,
   };
 
   ip4_tuple.kv_16_8.value =
@@ -93,24 +99,22 @@ ipsec4_input_spd_add_flow_cache_entry (ipsec_main_t *im, u32 sa, u32 da,
 
   hash = ipsec4_hash_16_8 (&ip4_tuple.kv_16_8);
   hash &= (im->ipsec4_in_spd_hash_num_buckets - 1);
+  kv = &ptd->ipsec4_in_spd_hash_tbl[hash];
 
-  ipsec_spinlock_lock (&im->ipsec4_in_spd_hash_tbl[hash].bucket_lock);
   /* Check if we are overwriting an existing entry so we know
     whether to increment the flow cache counter. Since flow
     cache counter is reset on any policy add/remove, but
     hash table values are not, we need to check if the entry
     we are overwriting is stale or not. If it's a stale entry
     overwrite, we still want to increment flow cache counter */
-  is_overwrite = (im->ipsec4_in_spd_hash_tbl[hash].value != 0);
+  is_overwrite = (kv->value != 0);
   /* Check if we are overwriting a stale entry by comparing
      with current epoch count */
   if (PREDICT_FALSE (is_overwrite))
     is_stale_overwrite =
-      (im->input_epoch_count !=
-       ((u32) (im->ipsec4_in_spd_hash_tbl[hash].value & 0xFFFFFFFF)));
-  clib_memcpy_fast (&im->ipsec4_in_spd_hash_tbl[hash], &ip4_tuple.kv_16_8,
-		    sizeof (ip4_tuple.kv_16_8));
-  ipsec_spinlock_unlock (&im->ipsec4_in_spd_hash_tbl[hash].bucket_lock);
+      (im->input_epoch_count != ((u32) (kv->value & 0xFFFFFFFF)));
+  /* the table is only used by this thread, no need for the bucket lock */
+  clib_memcpy_fast (kv, &ip4_tuple.kv_16_8, sizeof (ip4_tuple.kv_16_8));
 
   /* Increment the counter to track active flow cache entries
     when entering a fresh entry or overwriting a stale one */
@@ -120,32 +124,35 @@ ipsec4_input_spd_add_flow_cache_entry (ipsec_main_t *im, u32 sa, u32 da,
   return;
 }
 
+/*
+ * A single probe gives the PROTECT, BYPASS or DISCARD policy the flow
+ * matched last time, the caller acts according to the policy type.
+ */
 always_inline ipsec_policy_t *
-ipsec4_input_spd_find_flow_cache_entry (ipsec_main_t *im, u32 sa, u32 da,
-					ipsec_spd_policy_type_t policy_type)
+ipsec4_input_spd_find_flow_cache_entry (ipsec_main_t *im,
+					ipsec_per_thread_data_t *ptd, u32 sa,
+					u32 da, u32 spi, u32 spd_index)
 {
   ipsec_policy_t *p = NULL;
-  ipsec4_hash_kv_16_8_t kv_result;
+  ipsec4_hash_kv_16_8_t *kv_result;
   u64 hash;
   ipsec4_inbound_spd_tuple_t ip4_tuple = { .ip4_src_addr = (ip4_address_t) sa,
 					   .ip4_dest_addr = (ip4_address_t) da,
-					   .policy_type = policy_type };
+					   .spi = spi,
+					   .spd_index = spd_index };
 
   hash = ipsec4_hash_16_8 (&ip4_tuple.kv_16_8);
   hash &= (im->ipsec4_in_spd_hash_num_buckets - 1);
-
-  ipsec_spinlock_lock (&im->ipsec4_in_spd_hash_tbl[hash].bucket_lock);
-  kv_result = im->ipsec4_in_spd_hash_tbl[hash];
-  ipsec_spinlock_unlock (&im->ipsec4_in_spd_hash_tbl[hash].bucket_lock);
+  kv_result = &ptd->ipsec4_in_spd_hash_tbl[hash];
 
   if (ipsec4_hash_key_compare_16_8 ((u64 *) &ip4_tuple.kv_16_8,
-				    (u64 *) &kv_result))
+				    (u64 *) kv_result))
     {
-      if (im->input_epoch_count == ((u32) (kv_result.value & 0xFFFFFFFF)))
+      if (im->input_epoch_count == ((u32) (kv_result->value & 0xFFFFFFFF)))
 	{
 	  /* Get the policy based on the index */
 	  p =
-	    pool_elt_at_index (im->policies, ((u32) (kv_result.value >> 32)));
+	    pool_elt_at_index (im->policies, ((u32) (kv_result->value >> 32)));
 	}
     }
 
@@ -178,7 +185,7 @@ ipsec_fp_in_5tuple_from_ip6_range (ipsec_fp_5tuple_t *tuple, ip6_address_t *sa,
 }
 
 always_inline ipsec_policy_t *
-ipsec_input_policy_match (ipsec_spd_t *spd, u32 sa, u32 da,
+ipsec_input_policy_match (ipsec_spd_t *spd, u32 sa, u32 da, u32 spi,
 			  ipsec_spd_policy_type_t policy_type)
 {
   ipsec_main_t *im = &ipsec_main;
@@ -204,7 +211,8 @@ ipsec_input_policy_match (ipsec_spd_t *spd, u32 sa, u32 da,
     if (im->input_flow_cache_flag)
       {
 	/* Add an Entry in Flow cache */
-	ipsec4_input_spd_add_flow_cache_entry (im, sa, da, policy_type, *i);
+	ipsec4_input_spd_add_flow_cache_entry (im, sa, da, spi,
+					       spd - im->spds, *i);
       }
     return p;
   }
@@ -212,7 +220,8 @@ ipsec_input_policy_match (ipsec_spd_t *spd, u32 sa, u32 da,
 }
 
 always_inline ipsec_policy_t *
-ipsec_input_protect_policy_match (ipsec_spd_t *spd, u32 sa, u32 da, u32 spi)
+ipsec_input_protect_policy_match (ipsec_spd_t *spd, u32 sa, u32 da, u32 spi,
+				  u32 cache_spi)
 {
   ipsec_main_t *im = &ipsec_main;
   ipsec_policy_t *p;
@@ -254,8 +263,8 @@ ipsec_input_protect_policy_match (ipsec_spd_t *spd, u32 sa, u32 da, u32 spi)
     if (im->input_flow_cache_flag)
       {
 	/* Add an Entry in Flow cache */
-	ipsec4_input_spd_add_flow_cache_entry (
-	  im, sa, da, IPSEC_SPD_POLICY_IP4_INBOUND_PROTECT, *i);
+	ipsec4_input_spd_add_flow_cache_entry (im, sa, da, cache_spi,
+					       spd - im->spds, *i);
       }
 
     return p;
@@ -321,8 +330,10 @@ VLIB_NODE_FN (ipsec4_input_node) (vlib_main_t * vm,
 {
   u32 n_left_from, *from, thread_index;
   ipsec_main_t *im = &ipsec_main;
+  ipsec_per_thread_data_t *ptd;
   u64 ipsec_unprocessed = 0, ipsec_matched = 0;
   u64 ipsec_dropped = 0, ipsec_bypassed = 0;
+  u64 flow_cache_hits = 0, flow_cache_misses = 0;
   vlib_buffer_t *bufs[VLIB_FRAME_SIZE];
   vlib_buffer_t **b = bufs;
   u16 nexts[VLIB_FRAME_SIZE], *next;
@@ -332,6 +343,7 @@ VLIB_NODE_FN (ipsec4_input_node) (vlib_main_t * vm,
   next = nexts;
   vlib_get_buffers (vm, from, bufs, n_left_from);
   thread_index = vm->thread_index;
+  ptd = vec_elt_at_index (im->ptd, thread_index);
 
 
   while (n_left_from > 0)
@@ -344,10 +356,11 @@ VLIB_NODE_FN (ipsec4_input_node) (vlib_main_t * vm,
       ipsec_spd_t *spd0;
       ipsec_policy_t *p0 = NULL;
       u8 has_space0;
-      bool search_flow_cache = false;
       ipsec_policy_t *policies[1];
       ipsec_fp_5tuple_t tuples[1];
       bool ip_v6 = true;
+      bool use_fp;
+      u32 cache_spi;
 
       if (n_left_from > 2)
 	{
@@ -369,22 +382,54 @@ VLIB_NODE_FN (ipsec4_input_node) (vlib_main_t * vm,
 	{
 
 	  esp0 = (esp_header_t *) ((u8 *) ip0 + ip4_header_bytes (ip0));
+	  cache_spi = esp0->spi;
 	  if (PREDICT_FALSE (ip0->protocol == IP_PROTOCOL_UDP))
 	    {
+	      udp_header_t *udp0 = (udp_header_t *) esp0;
+
 	      /* FIXME Skip, if not a UDP encapsulated packet */
 	      esp0 = (esp_header_t *) ((u8 *) esp0 + sizeof (udp_header_t));
+
+	      /* only ESP carries an SPI, other UDP flows are cached on
+	       * the address pair rather than on their payload */
+	      cache_spi = udp0->dst_port ==
+			      clib_host_to_net_u16 (UDP_DST_PORT_ipsec) ?
+			    esp0->spi :
+			    0;
 	    }
 
+	  use_fp = im->fp_spd_ipv4_in_is_enabled &&
+		   PREDICT_TRUE (INDEX_INVALID !=
+				 spd0->fp_spd.ip4_in_lookup_hash_idx);
+
+	  has_space0 =
+	    vlib_buffer_has_space (b[0],
+				   (clib_address_t) (esp0 + 1) -
+				   (clib_address_t) ip0);
+
 	  // if flow cache is enabled, first search through flow cache for a
-	  // policy match for either protect, bypass or discard rules, in that
-	  // order. if no match is found search_flow_cache is set to false (1)
-	  // and we revert back to linear search
-	  search_flow_cache = im->input_flow_cache_flag;
-
-	esp_or_udp:
-	  if (im->fp_spd_ipv4_in_is_enabled &&
-	      PREDICT_TRUE (INDEX_INVALID !=
-			    spd0->fp_spd.ip4_in_lookup_hash_idx))
+	  // policy match of any type. On a miss revert back to linear search,
+	  // which adds the matched policy to the flow cache. The fast path
+	  // SPD lookup doesn't populate the cache, don't probe it then
+	  if (im->input_flow_cache_flag && !use_fp)
+	    {
+	      p0 = ipsec4_input_spd_find_flow_cache_entry (
+		im, ptd, ip0->src_address.as_u32, ip0->dst_address.as_u32,
+		cache_spi, c0->spd_index);
+
+	      if (p0)
+		{
+		  flow_cache_hits += 1;
+		  if (p0->type == IPSEC_SPD_POLICY_IP4_INBOUND_PROTECT)
+		    goto esp_protect;
+		  else if (p0->type == IPSEC_SPD_POLICY_IP4_INBOUND_BYPASS)
+		    goto esp_bypass;
+		  goto esp_discard;
+		}
+	      flow_cache_misses += 1;
+	    }
+
+	  if (use_fp)
 	    {
 	      ipsec_fp_in_5tuple_from_ip4_range (
 		&tuples[0], ip0->src_address.as_u32, ip0->dst_address.as_u32,
@@ -394,27 +439,16 @@ VLIB_NODE_FN (ipsec4_input_node) (vlib_main_t * vm,
 					  policies, 1);
 	      p0 = policies[0];
 	    }
-	  else if (search_flow_cache) // attempt to match policy in flow cache
-	    {
-	      p0 = ipsec4_input_spd_find_flow_cache_entry (
-		im, ip0->src_address.as_u32, ip0->dst_address.as_u32,
-		IPSEC_SPD_POLICY_IP4_INBOUND_PROTECT);
-	    }
-
-	  else // linear search if flow cache is not enabled,
-	       // or flow cache search just failed
+	  else
 	    {
 	      p0 = ipsec_input_protect_policy_match (
 		spd0, clib_net_to_host_u32 (ip0->src_address.as_u32),
 		clib_net_to_host_u32 (ip0->dst_address.as_u32),
-		clib_net_to_host_u32 (esp0->spi));
+		clib_net_to_host_u32 (esp0->spi),
+		clib_net_to_host_u32 (cache_spi));
 	    }
 
-	  has_space0 =
-	    vlib_buffer_has_space (b[0],
-				   (clib_address_t) (esp0 + 1) -
-				   (clib_address_t) ip0);
-
+	esp_protect:
 	  if (PREDICT_TRUE ((p0 != NULL) & (has_space0)))
 	    {
 	      ipsec_matched += 1;
@@ -435,30 +469,23 @@ VLIB_NODE_FN (ipsec4_input_node) (vlib_main_t * vm,
 	      pi0 = ~0;
 	    };
 
-	  if (im->fp_spd_ipv4_in_is_enabled &&
-	      PREDICT_TRUE (INDEX_INVALID !=
-			    spd0->fp_spd.ip4_in_lookup_hash_idx))
+	  if (use_fp)
 	    {
 	      tuples->action = IPSEC_SPD_POLICY_IP4_INBOUND_BYPASS;
 	      ipsec_fp_in_policy_match_n (&spd0->fp_spd, !ip_v6, tuples,
 					  policies, 1);
 	      p0 = policies[0];
 	    }
-	  else if (search_flow_cache)
-	    {
-	      p0 = ipsec4_input_spd_find_flow_cache_entry (
-		im, ip0->src_address.as_u32, ip0->dst_address.as_u32,
-		IPSEC_SPD_POLICY_IP4_INBOUND_BYPASS);
-	    }
-
 	  else
 	    {
 	      p0 = ipsec_input_policy_match (
 		spd0, clib_net_to_host_u32 (ip0->src_address.as_u32),
 		clib_net_to_host_u32 (ip0->dst_address.as_u32),
+		clib_net_to_host_u32 (cache_spi),
 		IPSEC_SPD_POLICY_IP4_INBOUND_BYPASS);
 	    }
 
+	esp_bypass:
 	  if (PREDICT_TRUE ((p0 != NULL)))
 	    {
 	      ipsec_bypassed += 1;
@@ -476,32 +503,23 @@ VLIB_NODE_FN (ipsec4_input_node) (vlib_main_t * vm,
 	      pi0 = ~0;
 	    };
 
-	  if (im->fp_spd_ipv4_in_is_enabled &&
-	      PREDICT_TRUE (INDEX_INVALID !=
-			    spd0->fp_spd.ip4_in_lookup_hash_idx))
+	  if (use_fp)
 	    {
 	      tuples->action = IPSEC_SPD_POLICY_IP4_INBOUND_DISCARD;
 	      ipsec_fp_in_policy_match_n (&spd0->fp_spd, !ip_v6, tuples,
 					  policies, 1);
 	      p0 = policies[0];
 	    }
-	  else
-
-	    if (search_flow_cache)
-	    {
-	      p0 = ipsec4_input_spd_find_flow_cache_entry (
-		im, ip0->src_address.as_u32, ip0->dst_address.as_u32,
-		IPSEC_SPD_POLICY_IP4_INBOUND_DISCARD);
-	    }
-
 	  else
 	    {
 	      p0 = ipsec_input_policy_match (
 		spd0, clib_net_to_host_u32 (ip0->src_address.as_u32),
 		clib_net_to_host_u32 (ip0->dst_address.as_u32),
+		clib_net_to_host_u32 (cache_spi),
 		IPSEC_SPD_POLICY_IP4_INBOUND_DISCARD);
 	    }
 
+	esp_discard:
 	  if (PREDICT_TRUE ((p0 != NULL)))
 	    {
 	      ipsec_dropped += 1;
@@ -520,13 +538,6 @@ VLIB_NODE_FN (ipsec4_input_node) (vlib_main_t * vm,
 	      pi0 = ~0;
 	    };
 
-	  // flow cache search failed, try again with linear search
-	  if (search_flow_cache && p0 == NULL)
-	    {
-	      search_flow_cache = false;
-	      goto esp_or_udp;
-	    }
-
 	  /* Drop by default if no match on PROTECT, BYPASS or DISCARD */
 	  ipsec_unprocessed += 1;
 	  next[0] = IPSEC_INPUT_NEXT_DROP;
@@ -550,31 +561,37 @@ VLIB_NODE_FN (ipsec4_input_node) (vlib_main_t * vm,
 	{
 	  ah0 = (ah_header_t *) ((u8 *) ip0 + ip4_header_bytes (ip0));
 
+	  has_space0 =
+	    vlib_buffer_has_space (b[0],
+				   (clib_address_t) (ah0 + 1) -
+				   (clib_address_t) ip0);
+
 	  // if flow cache is enabled, first search through flow cache for a
 	  // policy match and revert back to linear search on failure
-	  search_flow_cache = im->input_flow_cache_flag;
-
-	ah:
-	  if (search_flow_cache)
+	  if (im->input_flow_cache_flag)
 	    {
 	      p0 = ipsec4_input_spd_find_flow_cache_entry (
-		im, ip0->src_address.as_u32, ip0->dst_address.as_u32,
-		IPSEC_SPD_POLICY_IP4_INBOUND_PROTECT);
-	    }
+		im, ptd, ip0->src_address.as_u32, ip0->dst_address.as_u32,
+		ah0->spi, c0->spd_index);
 
-	  else
-	    {
-	      p0 = ipsec_input_protect_policy_match (
-		spd0, clib_net_to_host_u32 (ip0->src_address.as_u32),
-		clib_net_to_host_u32 (ip0->dst_address.as_u32),
-		clib_net_to_host_u32 (ah0->spi));
+	      if (p0)
+		{
+		  flow_cache_hits += 1;
+		  if (p0->type == IPSEC_SPD_POLICY_IP4_INBOUND_PROTECT)
+		    goto ah_protect;
+		  else if (p0->type == IPSEC_SPD_POLICY_IP4_INBOUND_BYPASS)
+		    goto ah_bypass;
+		  goto ah_discard;
+		}
+	      flow_cache_misses += 1;
 	    }
 
-	  has_space0 =
-	    vlib_buffer_has_space (b[0],
-				   (clib_address_t) (ah0 + 1) -
-				   (clib_address_t) ip0);
+	  p0 = ipsec_input_protect_policy_match (
+	    spd0, clib_net_to_host_u32 (ip0->src_address.as_u32),
+	    clib_net_to_host_u32 (ip0->dst_address.as_u32),
+	    clib_net_to_host_u32 (ah0->spi), clib_net_to_host_u32 (ah0->spi));
 
+	ah_protect:
 	  if (PREDICT_TRUE ((p0 != NULL) & (has_space0)))
 	    {
 	      ipsec_matched += 1;
@@ -594,21 +611,13 @@ VLIB_NODE_FN (ipsec4_input_node) (vlib_main_t * vm,
 	      pi0 = ~0;
 	    }
 
-	  if (search_flow_cache)
-	    {
-	      p0 = ipsec4_input_spd_find_flow_cache_entry (
-		im, ip0->src_address.as_u32, ip0->dst_address.as_u32,
-		IPSEC_SPD_POLICY_IP4_INBOUND_BYPASS);
-	    }
-
-	  else
-	    {
-	      p0 = ipsec_input_policy_match (
-		spd0, clib_net_to_host_u32 (ip0->src_address.as_u32),
-		clib_net_to_host_u32 (ip0->dst_address.as_u32),
-		IPSEC_SPD_POLICY_IP4_INBOUND_BYPASS);
-	    }
+	  p0 = ipsec_input_policy_match (
+	    spd0, clib_net_to_host_u32 (ip0->src_address.as_u32),
+	    clib_net_to_host_u32 (ip0->dst_address.as_u32),
+	    clib_net_to_host_u32 (ah0->spi),
+	    IPSEC_SPD_POLICY_IP4_INBOUND_BYPASS);
 
+	ah_bypass:
 	  if (PREDICT_TRUE ((p0 != NULL)))
 	    {
 	      ipsec_bypassed += 1;
@@ -626,21 +635,13 @@ VLIB_NODE_FN (ipsec4_input_node) (vlib_main_t * vm,
 	      pi0 = ~0;
 	    };
 
-	  if (search_flow_cache)
-	    {
-	      p0 = ipsec4_input_spd_find_flow_cache_entry (
-		im, ip0->src_address.as_u32, ip0->dst_address.as_u32,
-		IPSEC_SPD_POLICY_IP4_INBOUND_DISCARD);
-	    }
-
-	  else
-	    {
-	      p0 = ipsec_input_policy_match (
-		spd0, clib_net_to_host_u32 (ip0->src_address.as_u32),
-		clib_net_to_host_u32 (ip0->dst_address.as_u32),
-		IPSEC_SPD_POLICY_IP4_INBOUND_DISCARD);
-	    }
+	  p0 = ipsec_input_policy_match (
+	    spd0, clib_net_to_host_u32 (ip0->src_address.as_u32),
+	    clib_net_to_host_u32 (ip0->dst_address.as_u32),
+	    clib_net_to_host_u32 (ah0->spi),
+	    IPSEC_SPD_POLICY_IP4_INBOUND_DISCARD);
 
+	ah_discard:
 	  if (PREDICT_TRUE ((p0 != NULL)))
 	    {
 	      ipsec_dropped += 1;
@@ -659,13 +660,6 @@ VLIB_NODE_FN (ipsec4_input_node) (vlib_main_t * vm,
 	      pi0 = ~0;
 	    };
 
-	  // flow cache search failed, retry with linear search
-	  if (search_flow_cache && p0 == NULL)
-	    {
-	      search_flow_cache = false;
-	      goto ah;
-	    }
-
 	  /* Drop by default if no match on PROTECT, BYPASS or DISCARD */
 	  ipsec_unprocessed += 1;
 	  next[0] = IPSEC_INPUT_NEXT_DROP;
@@ -715,6 +709,14 @@ VLIB_NODE_FN (ipsec4_input_node) (vlib_main_t * vm,
 			       IPSEC_INPUT_ERROR_RX_POLICY_BYPASS,
 			       ipsec_bypassed);
 
+  vlib_node_increment_counter (vm, ipsec4_input_node.index,
+			       IPSEC_INPUT_ERROR_RX_FLOW_CACHE_HIT,
+			       flow_cache_hits);
+
+  vlib_node_increment_counter (vm, ipsec4_input_node.index,
+			       IPSEC_INPUT_ERROR_RX_FLOW_CACHE_MISS,
+			       flow_cache_misses);
+
   return frame->n_vectors;
 }
 
@@ -337,6 +337,10 @@ ipsec_sa_add_and_lock (u32 id, u32 spi, ipsec_protocol_t proto,
   if (p)
     return VNET_API_ERROR_ENTRY_ALREADY_EXISTS;
 
+  /* AH keeps the sequence number on the SA's thread */
+  if ((flags & IPSEC_SA_FLAG_MULTI_WORKER) && proto == IPSEC_PROTOCOL_AH)
+    return VNET_API_ERROR_UNSUPPORTED;
+
   if (getrandom (rand, sizeof (rand), 0) != sizeof (rand))
     return VNET_API_ERROR_INIT_FAILED;
 
@@ -481,6 +485,22 @@ ipsec_sa_add_and_lock (u32 id, u32 spi, ipsec_protocol_t proto,
 				 !ipsec_sa_is_set_IS_TUNNEL_V6 (sa));
     }
 
+  if (ipsec_sa_is_set_MULTI_WORKER (sa))
+    {
+      ipsec_per_thread_data_t *ptd;
+
+      clib_spinlock_init (&sa->replay_lock);
+
+      /* make room for the SA on every thread, and drop blocks the
+       * workers still hold from a previous user of this SA index */
+      vec_foreach (ptd, im->ptd)
+	{
+	  vec_validate (ptd->seq_blocks, sa_index);
+	  clib_memset (&ptd->seq_blocks[sa_index], 0,
+		       sizeof (ptd->seq_blocks[sa_index]));
+	}
+    }
+
   hash_set (im->sa_index_by_sa_id, sa->id, sa_index);
 
   if (sa_out_index)
@@ -518,6 +538,8 @@ ipsec_sa_del (ipsec_sa_t * sa)
   vnet_crypto_key_del (vm, sa->crypto_sync_key_index);
   if (sa->integ_alg != IPSEC_INTEG_ALG_NONE)
     vnet_crypto_key_del (vm, sa->integ_sync_key_index);
+  if (ipsec_sa_is_set_MULTI_WORKER (sa))
+    clib_spinlock_free (&sa->replay_lock);
   pool_put (ipsec_sa_pool, sa);
 }
 
@@ -99,6 +99,7 @@ typedef struct ipsec_key_t_
  * IPsec tunnel mode is IPv6 if non-zero,
  * else IPv4 tunnel only valid if is_tunnel is non-zero
  * enable UDP encapsulation for NAT traversal
+ * process the SA on all workers, without handoff to a single thread
  */
 #define foreach_ipsec_sa_flags                                                \
   _ (0, NONE, "none")                                                         \
@@ -112,7 +113,8 @@ typedef struct ipsec_key_t_
   _ (128, IS_AEAD, "aead")                                                    \
   _ (256, IS_CTR, "ctr")                                                      \
   _ (512, IS_ASYNC, "async")                                                  \
-  _ (1024, NO_ALGO_NO_DROP, "no-algo-no-drop")
+  _ (1024, NO_ALGO_NO_DROP, "no-algo-no-drop")                               \
+  _ (2048, MULTI_WORKER, "multi-worker")
 
 typedef enum ipsec_sad_flags_t_
 {
@@ -164,9 +166,17 @@ typedef struct
   vnet_crypto_key_index_t crypto_key_index;
   vnet_crypto_key_index_t integ_key_index;
 
+  union
+  {
+    struct
+    {
+      u32 seq;
+      u32 seq_hi;
+    };
+    /* multi-worker outbound: last reserved ESN, updated atomically */
+    u64 seq64;
+  };
   u32 spi;
-  u32 seq;
-  u32 seq_hi;
 
   u16 crypto_enc_op_id;
   u16 crypto_dec_op_id;
@@ -194,6 +204,10 @@ typedef struct
   tunnel_encap_decap_flags_t tunnel_flags;
   u8 __pad[2];
 
+  /* multi-worker inbound: serializes the anti-replay window access.
+   * Only a pointer, the lock itself lives on its own cacheline */
+  clib_spinlock_t replay_lock;
+
   /* data accessed by dataplane code should be above this comment */
     CLIB_CACHE_LINE_ALIGN_MARK (cacheline2);
 
@@ -232,6 +246,27 @@ STATIC_ASSERT (ESP_MAX_BLOCK_SIZE < (1 << 5), "esp alignment overflow");
 STATIC_ASSERT_OFFSET_OF (ipsec_sa_t, cacheline1, CLIB_CACHE_LINE_BYTES);
 STATIC_ASSERT_OFFSET_OF (ipsec_sa_t, cacheline2, 2 * CLIB_CACHE_LINE_BYTES);
 
+STATIC_ASSERT (CLIB_ARCH_IS_LITTLE_ENDIAN, "seq64 layout needs LE");
+STATIC_ASSERT ((STRUCT_OFFSET_OF (ipsec_sa_t, seq64) & 7) == 0,
+	       "seq64 is updated atomically, keep it 8 byte aligned");
+STATIC_ASSERT (STRUCT_OFFSET_OF (ipsec_sa_t, replay_lock) +
+		   sizeof (clib_spinlock_t) <=
+		 2 * CLIB_CACHE_LINE_BYTES,
+	       "replay_lock must fit in the second cacheline");
+
+/**
+ * A block of sequence numbers reserved by a worker for a multi-worker
+ * outbound SA. The numbers in (next, end] are owned by this worker only.
+ */
+typedef struct
+{
+  u64 next;
+  u64 end;
+} ipsec_sa_seq_block_t;
+
+/* Default number of sequence numbers a worker reserves at once */
+#define IPSEC_SA_SEQ_BLOCK_SIZE_DEFAULT 8
+
 /**
  * Pool of IPSec SAs
  */
@@ -159,10 +159,12 @@ ipsec_add_del_policy (vlib_main_t * vm,
        */
       if (im->input_epoch_count == 0xFFFFFFFF)
 	{
-	  /* Reset all the entries in flow cache */
-	  clib_memset_u8 (im->ipsec4_in_spd_hash_tbl, 0,
-			  im->ipsec4_in_spd_hash_num_buckets *
-			    (sizeof (*(im->ipsec4_in_spd_hash_tbl))));
+	  ipsec_per_thread_data_t *ptd;
+
+	  /* Reset all the entries in the per-thread flow caches */
+	  vec_foreach (ptd, im->ptd)
+	    clib_memset_u8 (ptd->ipsec4_in_spd_hash_tbl, 0,
+			    vec_bytes (ptd->ipsec4_in_spd_hash_tbl));
 	}
       /* Increment epoch counter by 1 */
       clib_atomic_fetch_add_relax (&im->input_epoch_count, 1);
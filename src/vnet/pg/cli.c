@@ -45,6 +45,8 @@
 #include <strings.h>
 #include <vppinfra/pcap.h>
 
+/* Minimum pacing of a looped pcap replay, in usec per packet. */
+#define PG_REPLAY_MIN_GAP_US 1
 
 /* Root of all packet generator cli commands. */
 /* *INDENT-OFF* */
@@ -207,6 +209,16 @@ format_pg_stream (u8 * s, va_list * va)
   s = format (s, "buffer-size %d, ", t->buffer_bytes);
   s = format (s, "worker %d, ", t->worker_index);
 
+  if (t->replay_speed > 0 && t->replay_loop_time)
+    s = format (s, "replay-speed %.2f, target %.2e pps, ", t->replay_speed,
+		vec_len (t->replay_pcap.timestamps) * 1e6 * t->replay_speed /
+		t->replay_loop_time);
+
+  if (t->time_last_packet > t->time_first_generate)
+    s = format (s, "achieved %.2e pps, ",
+		t->n_packets_generated /
+		(t->time_last_packet - t->time_first_generate));
+
   if (verbose)
     {
       pg_edit_group_t *g;
@@ -263,26 +275,80 @@ VLIB_CLI_COMMAND (show_streams_cli, static) = {
 /* *INDENT-ON* */
 
 static clib_error_t *
-pg_pcap_read (pg_stream_t * s, char *file_name)
+pg_pcap_read (pg_stream_t * s, char *file_name, u32 share, u32 n_shares)
 {
 #ifndef CLIB_UNIX
   return clib_error_return (0, "no pcap support");
 #else
-  pcap_main_t pm;
+  vlib_main_t *vm = vlib_get_main ();
+  pcap_main_t *pm = &s->replay_pcap;
+  u32 buf_sz = vlib_buffer_get_default_data_size (vm);
   clib_error_t *error;
-  clib_memset (&pm, 0, sizeof (pm));
-  pm.file_name = file_name;
-  error = pcap_read (&pm);
-  s->replay_packet_templates = pm.packets_read;
-  s->replay_packet_timestamps = pm.timestamps;
-  s->min_packet_bytes = pm.min_packet_bytes;
-  s->max_packet_bytes = pm.max_packet_bytes;
-  s->buffer_bytes = pm.max_packet_bytes;
+  u64 t0, duration;
+  u32 i, j, n;
+
+  clib_memset (pm, 0, sizeof (*pm));
+  pm->file_name = file_name;
+  error = pcap_map (pm);
+  pm->file_name = 0;
+  if (error)
+    return error;
+
+  n = vec_len (pm->packet_offsets);
+  if (n < n_shares)
+    {
+      pcap_unmap (pm);
+      return clib_error_return (0, "`%s' has %d packets, %d needed",
+				file_name, n, n_shares);
+    }
+
+  /* Replay clock starts at the first packet of the capture. One pass
+     lasts the capture duration plus an average inter-packet gap, and
+     at least PG_REPLAY_MIN_GAP_US per packet, so that single-packet or
+     zero-duration captures are still paced when looping. */
+  t0 = pm->timestamps[0];
+  duration = 0;
+  for (i = 0; i < n; i++)
+    {
+      pm->timestamps[i] = pm->timestamps[i] > t0 ? pm->timestamps[i] - t0 : 0;
+      duration = clib_max (duration, pm->timestamps[i]);
+    }
+  s->replay_loop_time = duration + (n > 1 ? duration / (n - 1) : 0);
+  s->replay_loop_time =
+    clib_max (s->replay_loop_time, (u64) n * PG_REPLAY_MIN_GAP_US);
+
+  /* Keep every n_shares-th packet, starting at share */
+  for (i = share, j = 0; i < n; i += n_shares, j++)
+    {
+      pm->packet_offsets[j] = pm->packet_offsets[i];
+      pm->packet_lengths[j] = pm->packet_lengths[i];
+      pm->timestamps[j] = pm->timestamps[i];
+    }
+  vec_set_len (pm->packet_offsets, j);
+  vec_set_len (pm->packet_lengths, j);
+  vec_set_len (pm->timestamps, j);
+
+  /* Pre-compute buffer chain sizes, so replay allocates in one go */
+  vec_validate (s->replay_n_buffers_before, j);
+  s->replay_n_buffers_before[0] = 0;
+  s->min_packet_bytes = s->max_packet_bytes = pm->packet_lengths[0];
+  for (i = 0; i < j; i++)
+    {
+      u32 len = pm->packet_lengths[i];
+      s->replay_n_buffers_before[i + 1] = s->replay_n_buffers_before[i] +
+	clib_max (1, (len + buf_sz - 1) / buf_sz);
+      s->min_packet_bytes = clib_min (s->min_packet_bytes, len);
+      s->max_packet_bytes = clib_max (s->max_packet_bytes, len);
+    }
+  s->buffer_bytes = s->max_packet_bytes;
 
   if (s->n_packets_limit == 0)
-    s->n_packets_limit = vec_len (pm.packets_read);
+    s->n_packets_limit = j;
+  else
+    s->n_packets_limit = s->n_packets_limit / n_shares +
+      (share < s->n_packets_limit % n_shares);
 
-  return error;
+  return 0;
 #endif /* CLIB_UNIX */
 }
 
@@ -309,6 +375,9 @@ unformat_pg_stream_parameter (unformat_input_t * input, va_list * args)
   else if (unformat (input, "buffer-size %d", &s->buffer_bytes))
     ;
 
+  else if (unformat (input, "replay-speed %f", &s->replay_speed))
+    ;
+
   else
     return 0;
 
@@ -330,9 +399,59 @@ validate_stream (pg_stream_t * s)
   if (s->rate_packets_per_second < 0)
     return clib_error_create ("negative rate");
 
+  if (s->replay_speed < 0)
+    return clib_error_create ("negative replay speed");
+
   return 0;
 }
 
+/*
+ * Spread a pcap replay over workers: one stream per worker, each
+ * replaying every n_workers-th packet of the capture on the capture's
+ * clock. Streams are named <name>-<n>.
+ */
+static clib_error_t *
+pg_pcap_add_streams (pg_main_t * pg, pg_stream_t * s_init,
+		     char *file_name, u32 n_workers)
+{
+  clib_error_t *error = 0;
+  pg_stream_t s;
+  u32 i;
+
+  for (i = 0; i < n_workers; i++)
+    {
+      /* Copy the settings only, each stream owns its own vectors */
+      s = s_init[0];
+      s.non_fixed_edits = 0;
+      s.edit_groups = 0;
+      s.fixed_packet_data = 0;
+      s.fixed_packet_data_mask = 0;
+      s.buffer_indices = 0;
+      s.replay_n_buffers_before = 0;
+      clib_memset (&s.replay_pcap, 0, sizeof (s.replay_pcap));
+      if (s_init->name)
+	s.name = format (0, "%v-%d", s_init->name, i);
+      else
+	s.name = format (0, "pcap-%d", i);
+      s.worker_index =
+	(s_init->worker_index + i) % clib_max (1, vlib_num_workers ());
+
+      error = pg_pcap_read (&s, file_name, i, n_workers);
+      if (!error)
+	error = validate_stream (&s);
+      if (error)
+	{
+	  pg_stream_free (&s);
+	  break;
+	}
+
+      pg_stream_add (pg, &s);
+      vec_free (s.name);
+    }
+
+  return error;
+}
+
 const char *
 pg_interface_get_input_node (pg_interface_t *pi)
 {
@@ -363,6 +482,7 @@ new_stream (vlib_main_t * vm,
   pg_main_t *pg = &pg_main;
   pg_stream_t s = { 0 };
   char *pcap_file_name;
+  u32 n_pcap_workers = 1;
 
   s.sw_if_index[VLIB_RX] = s.sw_if_index[VLIB_TX] = ~0;
   s.node_index = ~0;
@@ -418,6 +538,8 @@ new_stream (vlib_main_t * vm,
 
       else if (unformat (input, "pcap %s", &pcap_file_name))
 	;
+      else if (unformat (input, "workers %u", &n_pcap_workers))
+	;
 
       else if (!sub_input_given
 	       && unformat (input, "data %U", unformat_input, &sub_input))
@@ -473,7 +595,13 @@ new_stream (vlib_main_t * vm,
 
     if (pcap_file_name != 0)
       {
-	error = pg_pcap_read (&s, pcap_file_name);
+	if (n_pcap_workers > 1)
+	  {
+	    error = pg_pcap_add_streams (pg, &s, pcap_file_name,
+					 n_pcap_workers);
+	    goto done;
+	  }
+	error = pg_pcap_read (&s, pcap_file_name, 0, 1);
 	if (error)
 	  goto done;
 	vec_free (pcap_file_name);
@@ -494,7 +622,7 @@ new_stream (vlib_main_t * vm,
 
   error = validate_stream (&s);
   if (error)
-    return error;
+    goto done;
 
   pg_stream_add (pg, &s);
   return 0;
@@ -502,6 +630,7 @@ new_stream (vlib_main_t * vm,
 done:
   pg_stream_free (&s);
   unformat_free (&sub_input);
+  vec_free (pcap_file_name);
   return error;
 }
 
@@ -520,6 +649,8 @@ VLIB_CLI_COMMAND (new_stream_cli, static) = {
   "node NODE-NAME       node for stream output\n"
   "data STRING          specifies packet data\n"
   "pcap FILENAME        read packet data from pcap file\n"
+  "workers N            spread pcap replay over N worker streams\n"
+  "replay-speed X       replay pcap with its timing, scaled by X\n"
   "rate PPS             rate to transfer packet data\n"
   "maxframe NPKTS       maximum number of packets per frame\n",
 };
@@ -1075,7 +1075,7 @@ init_buffers_inline (vlib_main_t * vm,
   u32 n_left, *b;
   u8 *data, *mask;
 
-  ASSERT (s->replay_packet_templates == 0);
+  ASSERT (!pg_stream_is_replay (s));
 
   data = s->fixed_packet_data + data_offset;
   mask = s->fixed_packet_data_mask + data_offset;
@@ -1159,7 +1159,7 @@ pg_stream_fill_helper (pg_main_t * pg,
   uword is_start_of_packet = bi == s->buffer_indices;
   u32 n_allocated;
 
-  ASSERT (vec_len (s->replay_packet_templates) == 0);
+  ASSERT (!pg_stream_is_replay (s));
 
   n_allocated = vlib_buffer_alloc (vm, buffers, n_alloc);
   if (n_allocated == 0)
@@ -1198,8 +1198,9 @@ static u32
 pg_stream_fill_replay (pg_main_t * pg, pg_stream_t * s, u32 n_alloc)
 {
   pg_buffer_index_t *bi;
-  u32 n_left, i, l;
-  u32 buffer_alloc_request = 0;
+  pcap_main_t *pm = &s->replay_pcap;
+  u32 n_left, i, l, n_wraps;
+  u32 buffer_alloc_request;
   u32 buffer_alloc_result;
   u32 current_buffer_index;
   u32 *buffers;
@@ -1208,26 +1209,19 @@ pg_stream_fill_replay (pg_main_t * pg, pg_stream_t * s, u32 n_alloc)
   u32 buf_sz = vlib_buffer_get_default_data_size (vm);
   vnet_interface_main_t *im = &vnm->interface_main;
   vnet_sw_interface_t *si;
+  u32 *nbb = s->replay_n_buffers_before;
+  u64 n_bytes = 0;
 
   buffers = pg->replay_buffers_by_thread[vm->thread_index];
   vec_reset_length (buffers);
   bi = s->buffer_indices;
 
-  n_left = n_alloc;
   i = s->current_replay_packet_index;
-  l = vec_len (s->replay_packet_templates);
-
-  /* Figure out how many buffers we need */
-  while (n_left > 0)
-    {
-      u8 *d0;
+  l = vec_len (pm->packet_offsets);
 
-      d0 = vec_elt (s->replay_packet_templates, i);
-      buffer_alloc_request += (vec_len (d0) + (buf_sz - 1)) / buf_sz;
-
-      i = ((i + 1) == l) ? 0 : i + 1;
-      n_left--;
-    }
+  /* Buffers needed, from the per-packet counts computed at load time */
+  n_wraps = (i + n_alloc) / l;
+  buffer_alloc_request = nbb[(i + n_alloc) % l] - nbb[i] + n_wraps * nbb[l];
 
   ASSERT (buffer_alloc_request > 0);
   vec_validate (buffers, buffer_alloc_request - 1);
@@ -1247,8 +1241,6 @@ pg_stream_fill_replay (pg_main_t * pg, pg_stream_t * s, u32 n_alloc)
   n_left = n_alloc;
 
   current_buffer_index = 0;
-  i = s->current_replay_packet_index;
-  l = vec_len (s->replay_packet_templates);
   while (n_left > 0)
     {
       u8 *d0;
@@ -1257,15 +1249,16 @@ pg_stream_fill_replay (pg_main_t * pg, pg_stream_t * s, u32 n_alloc)
       u32 bytes_to_copy, bytes_this_chunk;
       vlib_buffer_t *b;
 
-      d0 = vec_elt (s->replay_packet_templates, i);
+      d0 = pm->file_map + pm->packet_offsets[i];
       data_offset = 0;
-      bytes_to_copy = vec_len (d0);
+      bytes_to_copy = pm->packet_lengths[i];
+      n_bytes += bytes_to_copy;
 
       /* Add head chunk to pg fifo */
       clib_fifo_add1 (bi->buffer_fifo, buffers[current_buffer_index]);
 
       /* Copy the data */
-      while (bytes_to_copy)
+      do
 	{
 	  bytes_this_chunk = clib_min (bytes_to_copy, buf_sz);
 	  ASSERT (current_buffer_index < vec_len (buffers));
@@ -1289,6 +1282,7 @@ pg_stream_fill_replay (pg_main_t * pg, pg_stream_t * s, u32 n_alloc)
 	  data_offset += bytes_this_chunk;
 	  current_buffer_index++;
 	}
+      while (bytes_to_copy);
 
       i = ((i + 1) == l) ? 0 : i + 1;
       n_left--;
@@ -1296,22 +1290,17 @@ pg_stream_fill_replay (pg_main_t * pg, pg_stream_t * s, u32 n_alloc)
 
   /* Update the interface counters */
   si = vnet_get_sw_interface (vnm, s->sw_if_index[VLIB_RX]);
-  l = 0;
-  for (i = 0; i < n_alloc; i++)
-    l += vlib_buffer_index_length_in_chain (vm, buffers[i]);
   vlib_increment_combined_counter (im->combined_sw_if_counters
 				   + VNET_INTERFACE_COUNTER_RX,
 				   vlib_get_thread_index (),
-				   si->sw_if_index, n_alloc, l);
+				   si->sw_if_index, n_alloc, n_bytes);
 
-  s->current_replay_packet_index += n_alloc;
-  s->current_replay_packet_index %= vec_len (s->replay_packet_templates);
+  s->current_replay_packet_index = i;
 
   pg->replay_buffers_by_thread[vm->thread_index] = buffers;
   return n_alloc;
 }
 
-
 static u32
 pg_stream_fill (pg_main_t * pg, pg_stream_t * s, u32 n_buffers)
 {
@@ -1341,7 +1330,7 @@ pg_stream_fill (pg_main_t * pg, pg_stream_t * s, u32 n_buffers)
   /*
    * Handle pcap replay directly
    */
-  if (s->replay_packet_templates)
+  if (pg_stream_is_replay (s))
     return pg_stream_fill_replay (pg, s, n_alloc);
 
   /* All buffer fifos should have the same size. */
@@ -1614,6 +1603,15 @@ fill_buffer_offload_flags (vlib_main_t *vm, u32 *buffers, u32 n_buffers,
 	{
 	  if (buffer_oflags & VNET_BUFFER_OFFLOAD_F_UDP_CKSUM)
 	    oflags |= VNET_BUFFER_OFFLOAD_F_UDP_CKSUM;
+
+	  /* udp gso is identified by its checksum offload */
+	  if (gso_enabled && (b0->flags & VLIB_BUFFER_NEXT_PRESENT))
+	    {
+	      b0->flags |= VNET_BUFFER_F_GSO;
+	      oflags |= VNET_BUFFER_OFFLOAD_F_UDP_CKSUM;
+	      vnet_buffer2 (b0)->gso_l4_hdr_sz = sizeof (udp_header_t);
+	      vnet_buffer2 (b0)->gso_size = gso_size;
+	    }
 	}
 
       if (oflags)
@@ -1702,7 +1700,7 @@ pg_generate_packets (vlib_node_runtime_t * node,
 	  vlib_buffer_copy_indices (to_next + n, start, n_this_frame - n);
 	}
 
-      if (s->replay_packet_templates == 0)
+      if (!pg_stream_is_replay (s))
 	{
 	  vec_foreach (bi, s->buffer_indices)
 	    clib_fifo_advance_head (bi->buffer_fifo, n_this_frame);
@@ -1757,6 +1755,43 @@ pg_generate_packets (vlib_node_runtime_t * node,
   return n_packets_generated;
 }
 
+/* Number of packets due by the capture timestamps, scaled by speed. */
+static_always_inline uword
+pg_stream_replay_n_due (pg_stream_t * s, f64 time_now)
+{
+  u64 *ts = s->replay_pcap.timestamps;
+  u32 i = s->replay_send_packet_index;
+  u32 l = vec_len (ts);
+  u64 offset = s->replay_send_time_offset;
+  u64 now_us;
+  uword n = 0;
+
+  now_us = (time_now - s->time_first_generate) * 1e6 * s->replay_speed;
+
+  while (n < s->n_max_frame && ts[i] + offset <= now_us)
+    {
+      n++;
+      if (++i == l)
+	{
+	  i = 0;
+	  offset += s->replay_loop_time;
+	}
+    }
+
+  return n;
+}
+
+/* Move the send cursor past the packets actually sent. */
+static_always_inline void
+pg_stream_replay_advance (pg_stream_t * s, uword n_packets)
+{
+  u32 l = vec_len (s->replay_pcap.timestamps);
+  u64 i = (u64) s->replay_send_packet_index + n_packets;
+
+  s->replay_send_time_offset += (i / l) * s->replay_loop_time;
+  s->replay_send_packet_index = i % l;
+}
+
 static uword
 pg_input_stream (vlib_node_runtime_t * node, pg_main_t * pg, pg_stream_t * s)
 {
@@ -1774,12 +1809,16 @@ pg_input_stream (vlib_node_runtime_t * node, pg_main_t * pg, pg_stream_t * s)
   time_now = vlib_time_now (vm);
   if (s->time_last_generate == 0)
     s->time_last_generate = time_now;
+  if (s->time_first_generate == 0)
+    s->time_first_generate = time_now;
 
   dt = time_now - s->time_last_generate;
   s->time_last_generate = time_now;
 
   n_packets = VLIB_FRAME_SIZE;
-  if (s->rate_packets_per_second > 0)
+  if (s->replay_speed > 0 && pg_stream_is_replay (s))
+    n_packets = pg_stream_replay_n_due (s, time_now);
+  else if (s->rate_packets_per_second > 0)
     {
       s->packet_accumulator += dt * s->rate_packets_per_second;
       n_packets = s->packet_accumulator;
@@ -1801,6 +1840,12 @@ pg_input_stream (vlib_node_runtime_t * node, pg_main_t * pg, pg_stream_t * s)
     n_packets = pg_generate_packets (node, pg, s, n_packets);
 
   s->n_packets_generated += n_packets;
+  if (n_packets > 0)
+    {
+      s->time_last_packet = time_now;
+      if (pg_stream_is_replay (s))
+	pg_stream_replay_advance (s, n_packets);
+    }
 
   return n_packets;
 }
@@ -44,6 +44,7 @@
 #include <vnet/pg/edit.h>
 #include <vppinfra/fifo.h>	/* for buffer_fifo */
 #include <vppinfra/pcap.h>
+#include <vppinfra/pcap_funcs.h>
 #include <vnet/interface.h>
 #include <vnet/ethernet/mac_address.h>
 #include <vnet/gso/gro.h>
@@ -176,11 +177,38 @@ typedef struct pg_stream_t
 
   pg_buffer_index_t *buffer_indices;
 
-  u8 **replay_packet_templates;
-  u64 *replay_packet_timestamps;
+  /* pcap replay: packet data stays in the mapped capture file,
+     timestamps are relative to the start of the capture, in usec. */
+  pcap_main_t replay_pcap;
+
+  /* Number of buffers needed to replay the packets before index i. */
+  u32 *replay_n_buffers_before;
+
   u32 current_replay_packet_index;
+
+  /* Replay with the capture timing scaled by this factor.
+     Zero means use the stream rate instead. */
+  f64 replay_speed;
+
+  /* Capture time of one replay pass, in usec. */
+  u64 replay_loop_time;
+
+  /* Next packet to send and capture time of the passes sent, in usec.
+     current_replay_packet_index runs ahead by the buffers queued. */
+  u32 replay_send_packet_index;
+  u64 replay_send_time_offset;
+
+  /* Time the first and the last packets were generated. */
+  f64 time_first_generate;
+  f64 time_last_packet;
 } pg_stream_t;
 
+always_inline int
+pg_stream_is_replay (pg_stream_t * s)
+{
+  return s->replay_pcap.file_map != 0;
+}
+
 always_inline void
 pg_buffer_index_free (pg_buffer_index_t * bi)
 {
@@ -201,7 +229,6 @@ pg_edit_group_free (pg_edit_group_t * g)
 always_inline void
 pg_stream_free (pg_stream_t * s)
 {
-  int i;
   pg_edit_group_t *g;
   pg_edit_t *e;
   vec_foreach (e, s->non_fixed_edits) pg_edit_free (e);
@@ -211,10 +238,8 @@ pg_stream_free (pg_stream_t * s)
   vec_free (s->fixed_packet_data);
   vec_free (s->fixed_packet_data_mask);
   vec_free (s->name);
-  for (i = 0; i < vec_len (s->replay_packet_templates); i++)
-    vec_free (s->replay_packet_templates[i]);
-  vec_free (s->replay_packet_templates);
-  vec_free (s->replay_packet_timestamps);
+  pcap_unmap (&s->replay_pcap);
+  vec_free (s->replay_n_buffers_before);
 
   {
     pg_buffer_index_t *bi;
@@ -59,7 +59,13 @@ pg_stream_enable_disable (pg_main_t * pg, pg_stream_t * s, int want_enabled)
     return;
 
   if (want_enabled)
-    s->n_packets_generated = 0;
+    {
+      s->n_packets_generated = 0;
+      s->time_first_generate = 0;
+      s->current_replay_packet_index = 0;
+      s->replay_send_packet_index = 0;
+      s->replay_send_time_offset = 0;
+    }
 
   /* Toggle enabled flag. */
   s->flags ^= PG_STREAM_FLAGS_IS_ENABLED;
@@ -527,7 +533,7 @@ pg_stream_add (pg_main_t * pg, pg_stream_t * s_init)
     default:
       /* Get packet size from fixed edits. */
       s->packet_size_edit_type = PG_EDIT_FIXED;
-      if (!s->replay_packet_templates)
+      if (!pg_stream_is_replay (s))
 	s->min_packet_bytes = s->max_packet_bytes =
 	  vec_len (s->fixed_packet_data);
       break;
@@ -602,7 +608,7 @@ pg_stream_change (pg_main_t * pg, pg_stream_t * s)
     default:
       /* Get packet size from fixed edits. */
       s->packet_size_edit_type = PG_EDIT_FIXED;
-      if (!s->replay_packet_templates)
+      if (!pg_stream_is_replay (s))
 	s->min_packet_bytes = s->max_packet_bytes =
 	  vec_len (s->fixed_packet_data);
       break;
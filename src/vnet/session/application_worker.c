@@ -169,7 +169,9 @@ app_worker_alloc_session_fifos (segment_manager_t * sm, session_t * s)
 						 &rx_fifo, &tx_fifo)))
     return rv;
 
-  if (rv == 0 && props->use_fifo_buffer) {
+  /* only tcp enqueues rx data as vlib buffers */
+  if (rv == 0 && props->use_fifo_buffer &&
+      session_get_transport_proto (s) == TRANSPORT_PROTO_TCP) {
     rx_fifo->flags |= SVM_FIFO_F_LL_BUFFER;
 //    tx_fifo->flags |= SVM_FIFO_F_LL_BUFFER;
 
@@ -462,6 +464,9 @@ app_worker_builtin_rx (app_worker_t * app_wrk, session_t * s)
 {
   application_t *app = application_get (app_wrk->app_index);
   app->cb_fns.builtin_app_rx_callback (s);
+  /* buffers consumed by copying reads in buffer mode */
+  if (s->rx_fifo && (s->rx_fifo->flags & SVM_FIFO_F_LL_BUFFER))
+    svm_fifo_free_buffers (s->rx_fifo);
   return 0;
 }
 
@@ -31,6 +31,8 @@ typedef struct segment_manager_main_
   u32 default_max_fifo_size;	/**< default max fifo size */
   u8 default_high_watermark;	/**< default high watermark % */
   u8 default_low_watermark;	/**< default low watermark % */
+  u8 default_numa_local;	/**< default bind segments to local numa */
+  clib_mem_page_sz_t default_log2_page_size; /**< default segment page size */
 } segment_manager_main_t;
 
 static segment_manager_main_t sm_main;
@@ -59,6 +61,8 @@ segment_manager_props_init (segment_manager_props_t * props)
   props->max_fifo_size = sm_main.default_max_fifo_size;
   props->high_watermark = sm_main.default_high_watermark;
   props->low_watermark = sm_main.default_low_watermark;
+  props->log2_page_size = sm_main.default_log2_page_size;
+  props->numa_local = sm_main.default_numa_local;
   props->n_slices = vlib_num_workers () + 1;
   return props;
 }
@@ -94,6 +98,7 @@ segment_manager_add_segment_inline (segment_manager_t *sm, uword segment_size,
   segment_manager_main_t *smm = &sm_main;
   segment_manager_props_t *props;
   app_worker_t *app_wrk;
+  clib_mem_page_sz_t log2_page_size;
   fifo_segment_t *fs;
   u32 fs_index = ~0;
   u8 *seg_name;
@@ -128,14 +133,19 @@ segment_manager_add_segment_inline (segment_manager_t *sm, uword segment_size,
     vlib_thread_main.n_vlib_mains * sizeof (fifo_segment_slice_t) +
     FIFO_SEGMENT_ALLOC_OVERHEAD;
 
-  if (props->huge_page)
+  log2_page_size = props->log2_page_size;
+  if (props->huge_page && log2_page_size == CLIB_MEM_PAGE_SZ_DEFAULT)
+    log2_page_size = CLIB_MEM_PAGE_SZ_DEFAULT_HUGE;
+  segment_size = round_pow2 (segment_size, clib_mem_page_bytes (log2_page_size));
+  fs->ssvm.log2_page_size = log2_page_size;
+
+  /* bind segment memory to the numa of the thread that allocates it, i.e.,
+   * main thread at attach time or the worker that runs out of fifos */
+  if (props->numa_local)
     {
-      uword hugepage_size = clib_mem_get_default_hugepage_size ();
-      segment_size = round_pow2 (segment_size, hugepage_size);
-      fs->ssvm.huge_page = 1;
+      fs->ssvm.numa_bind = 1;
+      fs->ssvm.numa = vlib_get_main ()->numa_node;
     }
-  else
-    segment_size = round_pow2 (segment_size, clib_mem_get_page_size ());
 
   seg_name = format (0, "seg-%u-%u-%u%c", app_wrk->app_index,
 		     app_wrk->wrk_index, smm->seg_name_counter++, 0);
@@ -1023,6 +1033,10 @@ segment_manager_main_init (void)
   sm->default_max_fifo_size = 4 << 20;
   sm->default_high_watermark = 80;
   sm->default_low_watermark = 50;
+  sm->default_numa_local = session_main.segment_numa_local;
+  sm->default_log2_page_size = session_main.segment_log2_page_size;
+  if (sm->default_log2_page_size == CLIB_MEM_PAGE_SZ_UNKNOWN)
+    sm->default_log2_page_size = CLIB_MEM_PAGE_SZ_DEFAULT;
 }
 
 static u8 *
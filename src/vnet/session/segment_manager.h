@@ -33,7 +33,8 @@ typedef struct _segment_manager_props
   u8 add_segment:1;			/**< can add new segments flag */
   u8 use_mq_eventfd:1;			/**< use eventfds for mqs flag */
   u8 use_fifo_buffer:1;			/**< use eventfds for mqs flag */
-  u8 reserved:5;			/**< reserved flags */
+  u8 numa_local:1;			/**< bind segments to local numa */
+  u8 reserved:4;			/**< reserved flags */
   u8 n_slices;				/**< number of fs slices/threads */
   ssvm_segment_type_t segment_type;	/**< seg type: if set to SSVM_N_TYPES,
 					     private segments are used */
@@ -42,6 +43,7 @@ typedef struct _segment_manager_props
   u8 low_watermark;			/**< memory usage low watermark % */
   u8 pct_first_alloc;			/**< pct of fifo size to alloc */
   u8 huge_page;				/**< use hugepage */
+  clib_mem_page_sz_t log2_page_size;	/**< segments page size */
 } segment_manager_props_t;
 
 typedef enum seg_manager_flag_
@@ -263,65 +263,28 @@ session_cleanup_notify (session_t * s, session_cleanup_ntf_t ntf)
   app_worker_cleanup_notify (app_wrk, s, ntf);
 }
 
-void
-session_free_w_fifos_try_ooo_recycle_buffer (session_t * s)
+/**
+ * Free the buffers an rx fifo in buffer mode still references
+ */
+static void
+session_free_fifo_buffers (session_t *s)
 {
-    svm_fifo_t *f;
-    u32 len, nb;
-    u32 nb_max;
-    u32 *free_buffers = 0;
-    ooo_segment_t *os = NULL;
-
-    u8 buf[sizeof(session_event_t) + sizeof(session_recycle_buffer_msg_t)];
-    session_event_t *evt = (session_event_t *)&buf;
-    session_recycle_buffer_msg_t *mp = (session_recycle_buffer_msg_t *)&evt->data[0]; 
-
-    evt->event_type = SESSION_CTRL_EVT_RECYCLE_BUFFER;
-
-    nb_max = SESSION_CTRL_MSG_MAX_SIZE/sizeof(u32) - 5;
-    nb_max = clib_max(nb_max-1, 1);
-    
-    f = s->rx_fifo;
-    if (f && (f->flags & SVM_FIFO_F_LL_BUFFER))
-    {
-      if (f->ooos_list_head != OOO_SEGMENT_INVALID_INDEX)
-	os = svm_fifo_first_ooo_segment (f);
-
-      while (os)
-	{
-	  vec_add1 (free_buffers, os->bi);
-
-	  if (os->next == OOO_SEGMENT_INVALID_INDEX)
-	    break;
-
-	  os = pool_elt_at_index (f->ooo_segments, os->next);
-	}
-
-      while ((len = vec_len (free_buffers)))
-	{
-	  clib_memset (mp, 0, sizeof (*mp));
-
-	  nb = clib_min (nb_max, len);
-	  vlib_buffer_copy_indices (mp->buffers, free_buffers, nb);
-	  mp->n_buffers = nb;
-	  mp->handle = session_handle (s);
+  u32 *bis = 0;
 
-	  vec_delete (free_buffers, nb, 0);
-	  len -= nb;
-
-	  session_evt_add_to_list (session_main_get_worker (s->thread_index),
-				   evt);
-	}
+  if (!s->rx_fifo || !(s->rx_fifo->flags & SVM_FIFO_F_LL_BUFFER))
+    return;
 
-      vec_free (free_buffers);
-    }
+  svm_fifo_collect_buffers (s->rx_fifo, &bis);
+  if (vec_len (bis))
+    vlib_buffer_free (vlib_get_main (), bis, vec_len (bis));
+  vec_free (bis);
 }
 
 void
 session_free_w_fifos (session_t * s)
 {
   session_cleanup_notify (s, SESSION_CLEANUP_SESSION);
-  session_free_w_fifos_try_ooo_recycle_buffer(s);
+  session_free_fifo_buffers (s);
   segment_manager_dealloc_fifos (s->rx_fifo, s->tx_fifo);
   session_free (s);
 }
@@ -2314,6 +2277,12 @@ session_config_fn (vlib_main_t * vm, unformat_input_t * input)
       else if (unformat (input, "wrk-mqs-segment-size %U",
 			 unformat_memory_size, &smm->wrk_mqs_segment_size))
 	;
+      else if (unformat (input, "segment-page-size %U",
+			 unformat_log2_page_size,
+			 &smm->segment_log2_page_size))
+	;
+      else if (unformat (input, "segment-numa-local"))
+	smm->segment_numa_local = 1;
       else if (unformat (input, "preallocated-sessions %d",
 			 &smm->preallocated_sessions))
 	;
@@ -45,6 +45,9 @@ typedef struct session_wrk_stats_
   u32 errors[SESSION_N_ERRORS];
 } session_wrk_stats_t;
 
+/* Max number of dgrams carried by one gso segment */
+#define SESSION_DGRAM_GSO_MAX_SEGS 64
+
 typedef struct session_tx_context_
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
@@ -60,6 +63,7 @@ typedef struct session_tx_context_
   u16 n_segs_per_evt;
   u16 n_bufs_needed;
   u8 n_bufs_per_seg;
+  u16 gso_size;
     CLIB_CACHE_LINE_ALIGN_MARK (cacheline1);
   session_dgram_hdr_t hdr;
 
@@ -264,6 +268,10 @@ typedef struct session_main_
   /** Session ssvm segment configs*/
   uword wrk_mqs_segment_size;
 
+  /** App fifo segments page size and numa placement */
+  clib_mem_page_sz_t segment_log2_page_size;
+  u8 segment_numa_local;
+
   /** Session enable dma*/
   u8 dma_enabled;
 
@@ -554,7 +562,7 @@ always_inline u32
 transport_max_rx_enqueue (transport_connection_t * tc)
 {
   session_t *s = session_get (tc->s_index, tc->thread_index);
-  return svm_fifo_max_enqueue_prod (s->rx_fifo);
+  return svm_fifo_max_enqueue_prod_maybe_buffer (s->rx_fifo);
 }
 
 always_inline u32
@@ -35,6 +35,11 @@
  */
 static u32 *fib_index_to_table_index[2];
 
+/**
+ * Number of keys batched lookups prefetch ahead of searching
+ */
+#define SESSION_LOOKUP_BATCH_SIZE 16
+
 /* *INDENT-OFF* */
 /* 16 octets */
 typedef CLIB_PACKED (struct {
@@ -875,6 +880,70 @@ session_lookup_half_open_connection (u64 handle, u8 proto, u8 is_ip4)
   return 0;
 }
 
+static inline transport_connection_t *
+session_lookup_connection_wt_found (u64 value, u8 proto, u32 thread_index,
+				    u8 *result)
+{
+  session_t *s;
+
+  if (PREDICT_FALSE ((u32) (value >> 32) != thread_index))
+    {
+      *result = SESSION_LOOKUP_RESULT_WRONG_THREAD;
+      return 0;
+    }
+  s = session_get (value & 0xFFFFFFFFULL, thread_index);
+  return transport_get_connection (proto, s->connection_index, thread_index);
+}
+
+/**
+ * Remaining steps of @ref session_lookup_connection_wt4 once the
+ * established sessions table lookup missed
+ */
+static inline transport_connection_t *
+session_lookup_connection_wt4_miss (session_table_t *st, session_kv4_t *kv4,
+				    ip4_address_t *lcl, ip4_address_t *rmt,
+				    u16 lcl_port, u16 rmt_port, u8 proto,
+				    u8 *result)
+{
+  session_t *s;
+  u32 action_index;
+  int rv;
+
+  /*
+   * Try half-open connections
+   */
+  rv = clib_bihash_search_inline_16_8 (&st->v4_half_open_hash, kv4);
+  if (rv == 0)
+    return transport_get_half_open (proto, kv4->value & 0xFFFFFFFF);
+
+  /*
+   * Check the session rules table
+   */
+  action_index = session_rules_table_lookup4 (&st->session_rules[proto], lcl,
+					      rmt, lcl_port, rmt_port);
+  if (session_lookup_action_index_is_valid (action_index))
+    {
+      if (action_index == SESSION_RULES_TABLE_ACTION_DROP)
+	{
+	  *result = SESSION_LOOKUP_RESULT_FILTERED;
+	  return 0;
+	}
+      if ((s = session_lookup_action_to_session (action_index,
+						 FIB_PROTOCOL_IP4, proto)))
+	return transport_get_listener (proto, s->connection_index);
+      return 0;
+    }
+
+  /*
+   * If nothing is found, check if any listener is available
+   */
+  s = session_lookup_listener4_i (st, lcl, lcl_port, proto, 1);
+  if (s)
+    return transport_get_listener (proto, s->connection_index);
+
+  return 0;
+}
+
 /**
  * Lookup connection with ip4 and transport layer information
  *
@@ -909,8 +978,6 @@ session_lookup_connection_wt4 (u32 fib_index, ip4_address_t * lcl,
 {
   session_table_t *st;
   session_kv4_t kv4;
-  session_t *s;
-  u32 action_index;
   int rv;
 
   st = session_table_get_for_fib_index (FIB_PROTOCOL_IP4, fib_index);
@@ -923,50 +990,11 @@ session_lookup_connection_wt4 (u32 fib_index, ip4_address_t * lcl,
   make_v4_ss_kv (&kv4, lcl, rmt, lcl_port, rmt_port, proto);
   rv = clib_bihash_search_inline_16_8 (&st->v4_session_hash, &kv4);
   if (rv == 0)
-    {
-      if (PREDICT_FALSE ((u32) (kv4.value >> 32) != thread_index))
-	{
-	  *result = SESSION_LOOKUP_RESULT_WRONG_THREAD;
-	  return 0;
-	}
-      s = session_get (kv4.value & 0xFFFFFFFFULL, thread_index);
-      return transport_get_connection (proto, s->connection_index,
-				       thread_index);
-    }
-
-  /*
-   * Try half-open connections
-   */
-  rv = clib_bihash_search_inline_16_8 (&st->v4_half_open_hash, &kv4);
-  if (rv == 0)
-    return transport_get_half_open (proto, kv4.value & 0xFFFFFFFF);
-
-  /*
-   * Check the session rules table
-   */
-  action_index = session_rules_table_lookup4 (&st->session_rules[proto], lcl,
-					      rmt, lcl_port, rmt_port);
-  if (session_lookup_action_index_is_valid (action_index))
-    {
-      if (action_index == SESSION_RULES_TABLE_ACTION_DROP)
-	{
-	  *result = SESSION_LOOKUP_RESULT_FILTERED;
-	  return 0;
-	}
-      if ((s = session_lookup_action_to_session (action_index,
-						 FIB_PROTOCOL_IP4, proto)))
-	return transport_get_listener (proto, s->connection_index);
-      return 0;
-    }
-
-  /*
-   * If nothing is found, check if any listener is available
-   */
-  s = session_lookup_listener4_i (st, lcl, lcl_port, proto, 1);
-  if (s)
-    return transport_get_listener (proto, s->connection_index);
+    return session_lookup_connection_wt_found (kv4.value, proto,
+					       thread_index, result);
 
-  return 0;
+  return session_lookup_connection_wt4_miss (st, &kv4, lcl, rmt, lcl_port,
+					     rmt_port, proto, result);
 }
 
 /**
@@ -1043,6 +1071,40 @@ session_lookup_connection4 (u32 fib_index, ip4_address_t * lcl,
   return 0;
 }
 
+/**
+ * Remaining steps of @ref session_lookup_safe4 once the established
+ * sessions table lookup missed
+ */
+static inline session_t *
+session_lookup_safe4_miss (session_table_t *st, ip4_address_t *lcl,
+			   ip4_address_t *rmt, u16 lcl_port, u16 rmt_port,
+			   u8 proto)
+{
+  session_t *s;
+  u32 action_index;
+
+  /*
+   * Check the session rules table
+   */
+  action_index = session_rules_table_lookup4 (&st->session_rules[proto], lcl,
+					      rmt, lcl_port, rmt_port);
+  if (session_lookup_action_index_is_valid (action_index))
+    {
+      if (action_index == SESSION_RULES_TABLE_ACTION_DROP)
+	return 0;
+      return session_lookup_action_to_session (action_index, FIB_PROTOCOL_IP4,
+					       proto);
+    }
+
+  /*
+   *  If nothing is found, check if any listener is available
+   */
+  if ((s = session_lookup_listener4_i (st, lcl, lcl_port, proto, 1)))
+    return s;
+
+  return 0;
+}
+
 /**
  * Lookup session with ip4 and transport layer information
  *
@@ -1060,8 +1122,6 @@ session_lookup_safe4 (u32 fib_index, ip4_address_t * lcl, ip4_address_t * rmt,
 {
   session_table_t *st;
   session_kv4_t kv4;
-  session_t *s;
-  u32 action_index;
   int rv;
 
   st = session_table_get_for_fib_index (FIB_PROTOCOL_IP4, fib_index);
@@ -1076,24 +1136,48 @@ session_lookup_safe4 (u32 fib_index, ip4_address_t * lcl, ip4_address_t * rmt,
   if (rv == 0)
     return session_get_from_handle_safe (kv4.value);
 
-  /*
-   * Check the session rules table
-   */
-  action_index = session_rules_table_lookup4 (&st->session_rules[proto], lcl,
+  return session_lookup_safe4_miss (st, lcl, rmt, lcl_port, rmt_port, proto);
+}
+
+/**
+ * Remaining steps of @ref session_lookup_connection_wt6 once the
+ * established sessions table lookup missed
+ */
+static inline transport_connection_t *
+session_lookup_connection_wt6_miss (session_table_t *st, session_kv6_t *kv6,
+				    ip6_address_t *lcl, ip6_address_t *rmt,
+				    u16 lcl_port, u16 rmt_port, u8 proto,
+				    u8 *result)
+{
+  session_t *s;
+  u32 action_index;
+  int rv;
+
+  /* Try half-open connections */
+  rv = clib_bihash_search_inline_48_8 (&st->v6_half_open_hash, kv6);
+  if (rv == 0)
+    return transport_get_half_open (proto, kv6->value & 0xFFFFFFFF);
+
+  /* Check the session rules table */
+  action_index = session_rules_table_lookup6 (&st->session_rules[proto], lcl,
 					      rmt, lcl_port, rmt_port);
   if (session_lookup_action_index_is_valid (action_index))
     {
       if (action_index == SESSION_RULES_TABLE_ACTION_DROP)
-	return 0;
-      return session_lookup_action_to_session (action_index, FIB_PROTOCOL_IP4,
-					       proto);
+	{
+	  *result = SESSION_LOOKUP_RESULT_FILTERED;
+	  return 0;
+	}
+      if ((s = session_lookup_action_to_session (action_index,
+						 FIB_PROTOCOL_IP6, proto)))
+	return transport_get_listener (proto, s->connection_index);
+      return 0;
     }
 
-  /*
-   *  If nothing is found, check if any listener is available
-   */
-  if ((s = session_lookup_listener4_i (st, lcl, lcl_port, proto, 1)))
-    return s;
+  /* If nothing is found, check if any listener is available */
+  s = session_lookup_listener6_i (st, lcl, lcl_port, proto, 1);
+  if (s)
+    return transport_get_listener (proto, s->connection_index);
 
   return 0;
 }
@@ -1130,9 +1214,7 @@ session_lookup_connection_wt6 (u32 fib_index, ip6_address_t * lcl,
 			       u8 * result)
 {
   session_table_t *st;
-  session_t *s;
   session_kv6_t kv6;
-  u32 action_index;
   int rv;
 
   st = session_table_get_for_fib_index (FIB_PROTOCOL_IP6, fib_index);
@@ -1144,43 +1226,12 @@ session_lookup_connection_wt6 (u32 fib_index, ip6_address_t * lcl,
   if (rv == 0)
     {
       ASSERT ((u32) (kv6.value >> 32) == thread_index);
-      if (PREDICT_FALSE ((u32) (kv6.value >> 32) != thread_index))
-	{
-	  *result = SESSION_LOOKUP_RESULT_WRONG_THREAD;
-	  return 0;
-	}
-      s = session_get (kv6.value & 0xFFFFFFFFULL, thread_index);
-      return transport_get_connection (proto, s->connection_index,
-				       thread_index);
+      return session_lookup_connection_wt_found (kv6.value, proto,
+						 thread_index, result);
     }
 
-  /* Try half-open connections */
-  rv = clib_bihash_search_inline_48_8 (&st->v6_half_open_hash, &kv6);
-  if (rv == 0)
-    return transport_get_half_open (proto, kv6.value & 0xFFFFFFFF);
-
-  /* Check the session rules table */
-  action_index = session_rules_table_lookup6 (&st->session_rules[proto], lcl,
-					      rmt, lcl_port, rmt_port);
-  if (session_lookup_action_index_is_valid (action_index))
-    {
-      if (action_index == SESSION_RULES_TABLE_ACTION_DROP)
-	{
-	  *result = SESSION_LOOKUP_RESULT_FILTERED;
-	  return 0;
-	}
-      if ((s = session_lookup_action_to_session (action_index,
-						 FIB_PROTOCOL_IP6, proto)))
-	return transport_get_listener (proto, s->connection_index);
-      return 0;
-    }
-
-  /* If nothing is found, check if any listener is available */
-  s = session_lookup_listener6_i (st, lcl, lcl_port, proto, 1);
-  if (s)
-    return transport_get_listener (proto, s->connection_index);
-
-  return 0;
+  return session_lookup_connection_wt6_miss (st, &kv6, lcl, rmt, lcl_port,
+					     rmt_port, proto, result);
 }
 
 /**
@@ -1249,6 +1300,35 @@ session_lookup_connection6 (u32 fib_index, ip6_address_t * lcl,
   return 0;
 }
 
+/**
+ * Remaining steps of @ref session_lookup_safe6 once the established
+ * sessions table lookup missed
+ */
+static inline session_t *
+session_lookup_safe6_miss (session_table_t *st, ip6_address_t *lcl,
+			   ip6_address_t *rmt, u16 lcl_port, u16 rmt_port,
+			   u8 proto)
+{
+  session_t *s;
+  u32 action_index;
+
+  /* Check the session rules table */
+  action_index = session_rules_table_lookup6 (&st->session_rules[proto], lcl,
+					      rmt, lcl_port, rmt_port);
+  if (session_lookup_action_index_is_valid (action_index))
+    {
+      if (action_index == SESSION_RULES_TABLE_ACTION_DROP)
+	return 0;
+      return session_lookup_action_to_session (action_index, FIB_PROTOCOL_IP6,
+					       proto);
+    }
+
+  /* If nothing is found, check if any listener is available */
+  if ((s = session_lookup_listener6_i (st, lcl, lcl_port, proto, 1)))
+    return s;
+  return 0;
+}
+
 /**
  * Lookup session with ip6 and transport layer information
  *
@@ -1268,8 +1348,6 @@ session_lookup_safe6 (u32 fib_index, ip6_address_t * lcl, ip6_address_t * rmt,
 {
   session_table_t *st;
   session_kv6_t kv6;
-  session_t *s;
-  u32 action_index;
   int rv;
 
   st = session_table_get_for_fib_index (FIB_PROTOCOL_IP6, fib_index);
@@ -1281,21 +1359,221 @@ session_lookup_safe6 (u32 fib_index, ip6_address_t * lcl, ip6_address_t * rmt,
   if (rv == 0)
     return session_get_from_handle_safe (kv6.value);
 
-  /* Check the session rules table */
-  action_index = session_rules_table_lookup6 (&st->session_rules[proto], lcl,
-					      rmt, lcl_port, rmt_port);
-  if (session_lookup_action_index_is_valid (action_index))
+  return session_lookup_safe6_miss (st, lcl, rmt, lcl_port, rmt_port, proto);
+}
+
+/**
+ * Batched established sessions table lookup
+ *
+ * Keys are processed in groups of SESSION_LOOKUP_BATCH_SIZE. For each group
+ * the established sessions table buckets are first prefetched, then the
+ * bucket data, and only then are the lookups done, so the cache misses of
+ * the group overlap instead of being serialized. Misses fall back to the
+ * per key lookups of @ref session_lookup_connection_wt4 or
+ * @ref session_lookup_safe4, and their ip6 counterparts.
+ *
+ * @param keys		lookup keys, one per packet
+ * @param n_keys	number of keys
+ * @param proto		transport protocol (e.g., tcp, udp)
+ * @param thread_index	thread index for request, unused if is_safe
+ * @param out		returned transport connections, or sessions if
+ *			is_safe, 0 if no match
+ * @param results	returned lookup results, unused if is_safe
+ * @param is_ip4	lookup in the ip4 or the ip6 tables
+ * @param is_safe	return sessions, as opposed to transport connections
+ */
+static_always_inline void
+session_lookup_batch_inline (session_lookup_key_t *keys, u32 n_keys, u8 proto,
+			     u32 thread_index, void **out, u8 *results,
+			     u8 is_ip4, u8 is_safe)
+{
+  session_table_t *sts[SESSION_LOOKUP_BATCH_SIZE], *st = 0;
+  session_kv4_t kv4s[SESSION_LOOKUP_BATCH_SIZE];
+  session_kv6_t kv6s[SESSION_LOOKUP_BATCH_SIZE];
+  u64 hashes[SESSION_LOOKUP_BATCH_SIZE];
+  u8 fib_proto = is_ip4 ? FIB_PROTOCOL_IP4 : FIB_PROTOCOL_IP6;
+  u32 i, n, fib_index = ~0;
+  session_lookup_key_t *key;
+  u64 value;
+  int rv;
+
+  while (n_keys)
     {
-      if (action_index == SESSION_RULES_TABLE_ACTION_DROP)
-	return 0;
-      return session_lookup_action_to_session (action_index, FIB_PROTOCOL_IP6,
-					       proto);
+      n = clib_min (n_keys, SESSION_LOOKUP_BATCH_SIZE);
+
+      /* Stage 1: hash keys and prefetch buckets */
+      for (i = 0; i < n; i++)
+	{
+	  key = &keys[i];
+	  if (key->fib_index != fib_index)
+	    {
+	      fib_index = key->fib_index;
+	      st = session_table_get_for_fib_index (fib_proto, fib_index);
+	    }
+	  sts[i] = st;
+	  if (PREDICT_FALSE (!st))
+	    continue;
+	  if (is_ip4)
+	    {
+	      make_v4_ss_kv (&kv4s[i], key->lcl_ip4, key->rmt_ip4,
+			     key->lcl_port, key->rmt_port, proto);
+	      hashes[i] = clib_bihash_hash_16_8 (&kv4s[i]);
+	      clib_bihash_prefetch_bucket_16_8 (&st->v4_session_hash,
+						hashes[i]);
+	    }
+	  else
+	    {
+	      make_v6_ss_kv (&kv6s[i], key->lcl_ip6, key->rmt_ip6,
+			     key->lcl_port, key->rmt_port, proto);
+	      hashes[i] = clib_bihash_hash_48_8 (&kv6s[i]);
+	      clib_bihash_prefetch_bucket_48_8 (&st->v6_session_hash,
+						hashes[i]);
+	    }
+	}
+
+      /* Stage 2: prefetch bucket data */
+      for (i = 0; i < n; i++)
+	{
+	  if (PREDICT_FALSE (!sts[i]))
+	    continue;
+	  if (is_ip4)
+	    clib_bihash_prefetch_data_16_8 (&sts[i]->v4_session_hash,
+					    hashes[i]);
+	  else
+	    clib_bihash_prefetch_data_48_8 (&sts[i]->v6_session_hash,
+					    hashes[i]);
+	}
+
+      /* Stage 3: lookup */
+      for (i = 0; i < n; i++)
+	{
+	  key = &keys[i];
+	  if (!is_safe)
+	    results[i] = SESSION_LOOKUP_RESULT_NONE;
+	  if (PREDICT_FALSE (!sts[i]))
+	    {
+	      out[i] = 0;
+	      continue;
+	    }
+	  if (is_ip4)
+	    {
+	      rv = clib_bihash_search_inline_with_hash_16_8 (
+		&sts[i]->v4_session_hash, hashes[i], &kv4s[i]);
+	      value = kv4s[i].value;
+	    }
+	  else
+	    {
+	      rv = clib_bihash_search_inline_with_hash_48_8 (
+		&sts[i]->v6_session_hash, hashes[i], &kv6s[i]);
+	      value = kv6s[i].value;
+	    }
+
+	  if (PREDICT_TRUE (rv == 0))
+	    {
+	      if (is_safe)
+		out[i] = session_get_from_handle_safe (value);
+	      else
+		out[i] = session_lookup_connection_wt_found (
+		  value, proto, thread_index, &results[i]);
+	    }
+	  else if (is_safe)
+	    {
+	      if (is_ip4)
+		out[i] = session_lookup_safe4_miss (
+		  sts[i], key->lcl_ip4, key->rmt_ip4, key->lcl_port,
+		  key->rmt_port, proto);
+	      else
+		out[i] = session_lookup_safe6_miss (
+		  sts[i], key->lcl_ip6, key->rmt_ip6, key->lcl_port,
+		  key->rmt_port, proto);
+	    }
+	  else
+	    {
+	      if (is_ip4)
+		out[i] = session_lookup_connection_wt4_miss (
+		  sts[i], &kv4s[i], key->lcl_ip4, key->rmt_ip4, key->lcl_port,
+		  key->rmt_port, proto, &results[i]);
+	      else
+		out[i] = session_lookup_connection_wt6_miss (
+		  sts[i], &kv6s[i], key->lcl_ip6, key->rmt_ip6, key->lcl_port,
+		  key->rmt_port, proto, &results[i]);
+	    }
+	}
+
+      keys += n;
+      out += n;
+      if (!is_safe)
+	results += n;
+      n_keys -= n;
     }
+}
 
-  /* If nothing is found, check if any listener is available */
-  if ((s = session_lookup_listener6_i (st, lcl, lcl_port, proto, 1)))
-    return s;
-  return 0;
+/**
+ * Batched variant of @ref session_lookup_connection_wt4
+ *
+ * See @ref session_lookup_batch_inline
+ *
+ * @param keys		lookup keys, one per packet
+ * @param n_keys	number of keys
+ * @param proto		transport protocol (e.g., tcp, udp)
+ * @param thread_index	thread index for request
+ * @param tcs		returned transport connections, 0 if no match
+ * @param results	returned lookup results, see session_lookup_result_t
+ */
+void
+session_lookup_connection_wt4_batch (session_lookup_key_t *keys, u32 n_keys,
+				     u8 proto, u32 thread_index,
+				     transport_connection_t **tcs, u8 *results)
+{
+  session_lookup_batch_inline (keys, n_keys, proto, thread_index,
+			       (void **) tcs, results, 1 /* is_ip4 */,
+			       0 /* is_safe */);
+}
+
+/**
+ * Batched variant of @ref session_lookup_connection_wt6
+ *
+ * See @ref session_lookup_connection_wt4_batch
+ */
+void
+session_lookup_connection_wt6_batch (session_lookup_key_t *keys, u32 n_keys,
+				     u8 proto, u32 thread_index,
+				     transport_connection_t **tcs, u8 *results)
+{
+  session_lookup_batch_inline (keys, n_keys, proto, thread_index,
+			       (void **) tcs, results, 0 /* is_ip4 */,
+			       0 /* is_safe */);
+}
+
+/**
+ * Batched variant of @ref session_lookup_safe4
+ *
+ * See @ref session_lookup_batch_inline
+ *
+ * @param keys		lookup keys, one per packet
+ * @param n_keys	number of keys
+ * @param proto		transport protocol (e.g., tcp, udp)
+ * @param sessions	returned sessions, 0 if no match
+ */
+void
+session_lookup_safe4_batch (session_lookup_key_t *keys, u32 n_keys, u8 proto,
+			    session_t **sessions)
+{
+  session_lookup_batch_inline (keys, n_keys, proto, 0, (void **) sessions, 0,
+			       1 /* is_ip4 */, 1 /* is_safe */);
+}
+
+/**
+ * Batched variant of @ref session_lookup_safe6
+ *
+ * See @ref session_lookup_safe4_batch
+ */
+void
+session_lookup_safe6_batch (session_lookup_key_t *keys, u32 n_keys, u8 proto,
+			    session_t **sessions)
+{
+  session_lookup_batch_inline (keys, n_keys, proto, 0, (void **) sessions, 0,
+			       0 /* is_ip4 */, 1 /* is_safe */);
 }
 
 transport_connection_t *
@@ -29,6 +29,28 @@ typedef enum session_lookup_result_
   SESSION_LOOKUP_RESULT_FILTERED
 } session_lookup_result_t;
 
+/**
+ * Key for batched lookups. Addresses point into the packet headers and
+ * must stay valid for the duration of the lookup. Keys with an invalid
+ * fib_index (~0) are skipped and return no match.
+ */
+typedef struct session_lookup_key_
+{
+  union
+  {
+    ip4_address_t *lcl_ip4;
+    ip6_address_t *lcl_ip6;
+  };
+  union
+  {
+    ip4_address_t *rmt_ip4;
+    ip6_address_t *rmt_ip6;
+  };
+  u32 fib_index;
+  u16 lcl_port;
+  u16 rmt_port;
+} session_lookup_key_t;
+
 session_t *session_lookup_safe4 (u32 fib_index, ip4_address_t * lcl,
 				 ip4_address_t * rmt, u16 lcl_port,
 				 u16 rmt_port, u8 proto);
@@ -42,6 +64,20 @@ transport_connection_t *session_lookup_connection_wt4 (u32 fib_index,
 						       u16 rmt_port, u8 proto,
 						       u32 thread_index,
 						       u8 * is_filtered);
+void session_lookup_connection_wt4_batch (session_lookup_key_t *keys,
+					  u32 n_keys, u8 proto,
+					  u32 thread_index,
+					  transport_connection_t **tcs,
+					  u8 *results);
+void session_lookup_connection_wt6_batch (session_lookup_key_t *keys,
+					  u32 n_keys, u8 proto,
+					  u32 thread_index,
+					  transport_connection_t **tcs,
+					  u8 *results);
+void session_lookup_safe4_batch (session_lookup_key_t *keys, u32 n_keys,
+				 u8 proto, session_t **sessions);
+void session_lookup_safe6_batch (session_lookup_key_t *keys, u32 n_keys,
+				 u8 proto, session_t **sessions);
 transport_connection_t *session_lookup_connection4 (u32 fib_index,
 						    ip4_address_t * lcl,
 						    ip4_address_t * rmt,
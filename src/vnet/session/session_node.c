@@ -1071,7 +1071,9 @@ session_tx_fifo_chain_tail (session_worker_t *wrk, session_tx_context_t *ctx,
 		    svm_fifo_peek (ctx->s->tx_fifo, 0, sizeof (ctx->hdr),
 				   (u8 *) & ctx->hdr);
 		}
-	      else if (ctx->left_to_snd == n_bytes_read)
+	      /* Last read of this burst, save progress within the dgram */
+	      else if (ctx->left_to_snd == left_from_seg &&
+		       to_deq == n_bytes_read)
 		svm_fifo_overwrite_head (ctx->s->tx_fifo, (u8 *) & ctx->hdr,
 					 sizeof (session_dgram_pre_hdr_t));
 	    }
@@ -1173,7 +1175,15 @@ session_tx_fill_buffer (session_worker_t *wrk, session_tx_context_t *ctx,
    * Fill in the remaining buffers in the chain, if any
    */
   if (PREDICT_FALSE (ctx->n_bufs_per_seg > 1 && ctx->left_to_snd))
-    session_tx_fifo_chain_tail (wrk, ctx, b, n_bufs, peek_data);
+    {
+      session_tx_fifo_chain_tail (wrk, ctx, b, n_bufs, peek_data);
+      /* Chain carries gso_size long dgrams, one per buffer */
+      if (ctx->gso_size)
+	{
+	  b->flags |= VNET_BUFFER_F_GSO;
+	  vnet_buffer2 (b)->gso_size = ctx->gso_size;
+	}
+    }
 }
 
 always_inline u8
@@ -1241,6 +1251,7 @@ session_tx_set_dequeue_params (vlib_main_t * vm, session_tx_context_t * ctx,
 
   n_bytes_per_buf = vlib_buffer_get_default_data_size (vm);
   ctx->max_dequeue = svm_fifo_max_dequeue_cons (ctx->s->tx_fifo);
+  ctx->gso_size = 0;
 
   if (peek_data)
     {
@@ -1257,6 +1268,7 @@ session_tx_set_dequeue_params (vlib_main_t * vm, session_tx_context_t * ctx,
       if (ctx->transport_vft->transport_options.tx_type == TRANSPORT_TX_DGRAM)
 	{
 	  u32 len, chain_limit;
+	  u8 can_gso = 1;
 
 	  if (ctx->max_dequeue <= sizeof (ctx->hdr))
 	    {
@@ -1301,7 +1313,13 @@ session_tx_set_dequeue_params (vlib_main_t * vm, session_tx_context_t * ctx,
 	      ctx->sp.snd_mss = clib_min (ctx->sp.snd_mss, len);
 	      offset = ctx->hdr.data_length + sizeof (session_dgram_hdr_t);
 	      first_dgram_len = len;
-	      max_offset = clib_min (ctx->max_dequeue, 16 << 10);
+	      can_gso = first_dgram_len == ctx->sp.snd_mss;
+	      max_offset = 16 << 10;
+	      /* With gso, look for as many dgrams as can be sent now */
+	      if (ctx->sp.max_gso_size && can_gso)
+		max_offset =
+		  clib_max (max_offset, max_segs * ctx->sp.max_gso_size);
+	      max_offset = clib_min (ctx->max_dequeue, max_offset);
 
 	      while (offset < max_offset)
 		{
@@ -1320,6 +1338,22 @@ session_tx_set_dequeue_params (vlib_main_t * vm, session_tx_context_t * ctx,
 	    }
 
 	  ctx->max_dequeue = len;
+
+	  /* If transport accepts gso segments, build them out of dgrams, or
+	   * mss sized chunks of one dgram, that fit in one buffer each */
+	  if (ctx->sp.max_gso_size && can_gso &&
+	      len > ctx->sp.snd_mss && ctx->sp.snd_mss <= chain_limit)
+	    {
+	      u32 n_dgrams;
+
+	      n_dgrams = clib_min (ctx->sp.max_gso_size / ctx->sp.snd_mss,
+				   SESSION_DGRAM_GSO_MAX_SEGS);
+	      if (n_dgrams > 1)
+		{
+		  ctx->gso_size = ctx->sp.snd_mss;
+		  ctx->sp.snd_mss = n_dgrams * ctx->gso_size;
+		}
+	    }
 	}
     }
   ASSERT (ctx->max_dequeue > 0);
@@ -1348,6 +1382,21 @@ session_tx_set_dequeue_params (vlib_main_t * vm, session_tx_context_t * ctx,
     }
 
   ASSERT (n_bytes_per_buf > TRANSPORT_MAX_HDRS_LEN);
+  if (PREDICT_FALSE (ctx->gso_size))
+    {
+      u32 n_bytes_last_seg;
+
+      /* One buffer per dgram, headers are pushed only to the first */
+      n_bytes_last_seg = ctx->max_len_to_snd
+	- ((ctx->n_segs_per_evt - 1) * ctx->sp.snd_mss);
+      ctx->n_bufs_per_seg = ctx->sp.snd_mss / ctx->gso_size;
+      ctx->n_bufs_needed = ((ctx->n_segs_per_evt - 1) * ctx->n_bufs_per_seg)
+	+ ceil ((f64) n_bytes_last_seg / ctx->gso_size);
+      ctx->deq_per_buf = ctx->gso_size;
+      ctx->deq_per_first_buf = ctx->gso_size;
+      return;
+    }
+
   if (ctx->n_segs_per_evt > 1)
     {
       u32 n_bytes_last_seg, n_bufs_last_seg;
@@ -52,6 +52,9 @@ typedef struct transport_send_params_
       u32 snd_space;
       u32 tx_offset;
       u16 snd_mss;
+      /* Dgram transports only. Max bytes of equal sized dgrams that may
+       * be sent as one gso segment, 0 if gso is not supported */
+      u16 max_gso_size;
     };
     /* Used by custom tx functions */
     struct
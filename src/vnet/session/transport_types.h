@@ -284,10 +284,17 @@ typedef enum transport_endpt_ext_cfg_type_
   TRANSPORT_ENDPT_EXT_CFG_CRYPTO,
 } transport_endpt_ext_cfg_type_t;
 
+typedef enum transport_endpt_crypto_cfg_flags_
+{
+  TRANSPORT_ENDPT_CRYPTO_CFG_F_NO_RESUME = 1 << 0,  /**< always full hs */
+  TRANSPORT_ENDPT_CRYPTO_CFG_F_NO_TICKETS = 1 << 1, /**< session ids only */
+} __clib_packed transport_endpt_crypto_cfg_flags_t;
+
 typedef struct transport_endpt_crypto_cfg_
 {
   u32 ckpair_index;
   u8 crypto_engine;
+  u8 flags;	    /**< transport_endpt_crypto_cfg_flags_t */
   u8 hostname[256]; /**< full domain len is 255 as per rfc 3986 */
 } transport_endpt_crypto_cfg_t;
 
@@ -42,7 +42,8 @@ format_span_trace (u8 * s, va_list * args)
 }
 
 #define foreach_span_error                      \
-_(HITS, "SPAN incoming packets processed")
+_(HITS, "SPAN incoming packets processed")             \
+_(NO_BUFFER, "SPAN mirrored packets dropped, no buffers")
 
 typedef enum
 {
@@ -58,35 +59,87 @@ static char *span_error_strings[] = {
 #undef _
 };
 
-static_always_inline void
+static_always_inline u32
 span_mirror (vlib_main_t * vm, vlib_node_runtime_t * node, u32 sw_if_index0,
-	     vlib_buffer_t * b0, vlib_frame_t ** mirror_frames,
+	     u32 bi0, vlib_frame_t ** mirror_frames, u32 ** clones,
 	     vlib_rx_or_tx_t rxtx, span_feat_t sf)
 {
-  vlib_buffer_t *c0;
+  vlib_buffer_t *b0, *c0;
   span_main_t *sm = &span_main;
   vnet_main_t *vnm = vnet_get_main ();
+  u32 thread_index = vm->thread_index;
   u32 *to_mirror_next = 0;
-  u32 i;
+  u32 i, n_clones, n_cloned, n_bytes, ci;
   span_interface_t *si0;
   span_mirror_t *sm0;
+  i16 current_data;
+  u32 *cl;
 
   if (sw_if_index0 >= vec_len (sm->interfaces))
-    return;
+    return bi0;
 
   si0 = vec_elt_at_index (sm->interfaces, sw_if_index0);
   sm0 = &si0->mirror_rxtx[sf][rxtx];
 
   if (sm0->num_mirror_ports == 0)
-    return;
+    return bi0;
+
+  b0 = vlib_get_buffer (vm, bi0);
 
   /* Don't do it again */
   if (PREDICT_FALSE (b0->flags & VNET_BUFFER_F_SPAN_CLONE))
-    return;
+    return bi0;
+
+  /*
+   * Clone the packet once per mirror port plus once for the original
+   * path. Each clone gets a private copy of the packet head, in which
+   * the output path may rewrite headers, and shares the reference
+   * counted tail with the others.
+   */
+  n_clones = sm0->num_mirror_ports + 1;
+  n_bytes = vlib_buffer_length_in_chain (vm, b0);
+  current_data = b0->current_data;
+  vec_validate (*clones, n_clones - 1);
+  cl = *clones;
+
+  if (PREDICT_TRUE (b0->ref_count == 1))
+    n_cloned = vlib_buffer_clone (vm, bi0, cl, n_clones,
+				  VLIB_BUFFER_CLONE_HEAD_SIZE);
+  else
+    {
+      /* the buffer is itself shared, fall back to full copies */
+      cl[0] = bi0;
+      for (n_cloned = 1; n_cloned < n_clones; n_cloned++)
+	{
+	  c0 = vlib_buffer_copy (vm, b0);
+	  if (c0 == 0)
+	    break;
+	  cl[n_cloned] = vlib_get_buffer_index (vm, c0);
+	}
+    }
+
+  if (PREDICT_FALSE (n_cloned == 0))
+    {
+      /* no buffers at all, restore the original and forward it as-is */
+      vlib_buffer_advance (b0, current_data - b0->current_data);
+      cl[n_cloned++] = bi0;
+    }
+  b0 = vlib_get_buffer (vm, cl[0]);
 
   /* *INDENT-OFF* */
+  ci = 1;
   clib_bitmap_foreach (i, sm0->mirror_ports)
     {
+      u32 ssi = si0->session_index_by_dst[i];
+
+      if (PREDICT_FALSE (ci >= n_cloned))
+	{
+	  /* out of buffers, the mirror port does not keep up */
+	  vlib_increment_combined_counter (&sm->dropped_counters,
+					   thread_index, ssi, 1, n_bytes);
+	  continue;
+	}
+
       if (mirror_frames[i] == 0)
         {
           if (sf == SPAN_FEAT_L2)
@@ -96,33 +149,39 @@ span_mirror (vlib_main_t * vm, vlib_node_runtime_t * node, u32 sw_if_index0,
 	}
       to_mirror_next = vlib_frame_vector_args (mirror_frames[i]);
       to_mirror_next += mirror_frames[i]->n_vectors;
-      /* This can fail */
-      c0 = vlib_buffer_copy (vm, b0);
-      if (PREDICT_TRUE(c0 != 0))
-        {
-          vnet_buffer (c0)->sw_if_index[VLIB_TX] = i;
-          c0->flags |= VNET_BUFFER_F_SPAN_CLONE;
-          if (sf == SPAN_FEAT_L2)
-	    vnet_buffer (c0)->l2.feature_bitmap = L2OUTPUT_FEAT_OUTPUT;
-          to_mirror_next[0] = vlib_get_buffer_index (vm, c0);
-          mirror_frames[i]->n_vectors++;
-          if (PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
-            {
-              span_trace_t *t = vlib_add_trace (vm, node, b0, sizeof (*t));
-              t->src_sw_if_index = sw_if_index0;
-              t->mirror_sw_if_index = i;
+
+      c0 = vlib_get_buffer (vm, cl[ci]);
+      vnet_buffer (c0)->sw_if_index[VLIB_TX] = i;
+      c0->flags |= VNET_BUFFER_F_SPAN_CLONE;
+      if (sf == SPAN_FEAT_L2)
+	vnet_buffer (c0)->l2.feature_bitmap = L2OUTPUT_FEAT_OUTPUT;
+      to_mirror_next[0] = cl[ci++];
+      mirror_frames[i]->n_vectors++;
+      vlib_increment_combined_counter (&sm->mirrored_counters,
+				       thread_index, ssi, 1, n_bytes);
+      if (PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
+	{
+	  span_trace_t *t = vlib_add_trace (vm, node, b0, sizeof (*t));
+	  t->src_sw_if_index = sw_if_index0;
+	  t->mirror_sw_if_index = i;
 #if 0
-	      /* Enable this path to allow packet trace of SPAN packets.
-	         Note that all SPAN packets will show up on the trace output
-	         with the first SPAN packet (since they are in the same frame)
-	         thus making trace output of the original packet confusing */
-	      mirror_frames[i]->flags |= VLIB_FRAME_TRACE;
-	      c0->flags |= VLIB_BUFFER_IS_TRACED;
+	  /* Enable this path to allow packet trace of SPAN packets.
+	     Note that all SPAN packets will show up on the trace output
+	     with the first SPAN packet (since they are in the same frame)
+	     thus making trace output of the original packet confusing */
+	  mirror_frames[i]->flags |= VLIB_FRAME_TRACE;
+	  c0->flags |= VLIB_BUFFER_IS_TRACED;
 #endif
-	    }
 	}
     }
   /* *INDENT-ON* */
+
+  if (PREDICT_FALSE (n_cloned < n_clones))
+    vlib_node_increment_counter (vm, node->node_index, SPAN_ERROR_NO_BUFFER,
+				 n_clones - n_cloned);
+
+  /* the first clone replaces the original on its way */
+  return cl[0];
 }
 
 static_always_inline uword
@@ -136,6 +195,7 @@ span_node_inline_fn (vlib_main_t * vm, vlib_node_runtime_t * node,
   u32 next_index;
   u32 sw_if_index;
   static __thread vlib_frame_t **mirror_frames = 0;
+  static __thread u32 *clones = 0;
 
   from = vlib_frame_vector_args (frame);
   n_left_from = frame->n_vectors;
@@ -161,11 +221,8 @@ span_node_inline_fn (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  u32 sw_if_index1;
 	  u32 next1 = 0;
 
-	  /* speculatively enqueue b0, b1 to the current next frame */
-	  to_next[0] = bi0 = from[0];
-	  to_next[1] = bi1 = from[1];
-	  to_next += 2;
-	  n_left_to_next -= 2;
+	  bi0 = from[0];
+	  bi1 = from[1];
 	  from += 2;
 	  n_left_from -= 2;
 
@@ -174,8 +231,19 @@ span_node_inline_fn (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  sw_if_index0 = vnet_buffer (b0)->sw_if_index[rxtx];
 	  sw_if_index1 = vnet_buffer (b1)->sw_if_index[rxtx];
 
-	  span_mirror (vm, node, sw_if_index0, b0, mirror_frames, rxtx, sf);
-	  span_mirror (vm, node, sw_if_index1, b1, mirror_frames, rxtx, sf);
+	  /* the original may be replaced by its clone */
+	  bi0 = span_mirror (vm, node, sw_if_index0, bi0, mirror_frames,
+			     &clones, rxtx, sf);
+	  bi1 = span_mirror (vm, node, sw_if_index1, bi1, mirror_frames,
+			     &clones, rxtx, sf);
+	  b0 = vlib_get_buffer (vm, bi0);
+	  b1 = vlib_get_buffer (vm, bi1);
+
+	  /* speculatively enqueue b0, b1 to the current next frame */
+	  to_next[0] = bi0;
+	  to_next[1] = bi1;
+	  to_next += 2;
+	  n_left_to_next -= 2;
 
 	  switch (sf)
 	    {
@@ -214,17 +282,21 @@ span_node_inline_fn (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  u32 sw_if_index0;
 	  u32 next0 = 0;
 
-	  /* speculatively enqueue b0 to the current next frame */
-	  to_next[0] = bi0 = from[0];
-	  to_next += 1;
-	  n_left_to_next -= 1;
+	  bi0 = from[0];
 	  from += 1;
 	  n_left_from -= 1;
 
 	  b0 = vlib_get_buffer (vm, bi0);
 	  sw_if_index0 = vnet_buffer (b0)->sw_if_index[rxtx];
 
-	  span_mirror (vm, node, sw_if_index0, b0, mirror_frames, rxtx, sf);
+	  bi0 = span_mirror (vm, node, sw_if_index0, bi0, mirror_frames,
+			     &clones, rxtx, sf);
+	  b0 = vlib_get_buffer (vm, bi0);
+
+	  /* speculatively enqueue b0 to the current next frame */
+	  to_next[0] = bi0;
+	  to_next += 1;
+	  n_left_to_next -= 1;
 
 	  switch (sf)
 	    {
@@ -21,7 +21,16 @@
 
 #include <vnet/span/span.h>
 
-span_main_t span_main;
+span_main_t span_main = {
+  .mirrored_counters = {
+    .name = "span-mirrored",
+    .stat_segment_name = "/span/mirrored",
+  },
+  .dropped_counters = {
+    .name = "span-dropped",
+    .stat_segment_name = "/span/dropped",
+  },
+};
 
 typedef enum
 {
@@ -48,6 +57,42 @@ span_dst_set (span_mirror_t * sm, u32 dst_sw_if_index, int enable)
   return last;
 }
 
+static void
+span_session_update (span_main_t * sm, span_interface_t * si,
+		     u32 src_sw_if_index, u32 dst_sw_if_index)
+{
+  span_session_t *ss;
+  u32 *ssi;
+  int mirrored = 0;
+  int sf, rxtx;
+
+  for (sf = 0; sf < SPAN_FEAT_N; sf++)
+    for (rxtx = 0; rxtx < VLIB_N_RX_TX; rxtx++)
+      mirrored |= clib_bitmap_get (si->mirror_rxtx[sf][rxtx].mirror_ports,
+				   dst_sw_if_index);
+
+  vec_validate_init_empty (si->session_index_by_dst, dst_sw_if_index, ~0);
+  ssi = vec_elt_at_index (si->session_index_by_dst, dst_sw_if_index);
+
+  if (mirrored && *ssi == ~0)
+    {
+      pool_get_zero (sm->sessions, ss);
+      ss->src_sw_if_index = src_sw_if_index;
+      ss->dst_sw_if_index = dst_sw_if_index;
+      *ssi = ss - sm->sessions;
+
+      vlib_validate_combined_counter (&sm->mirrored_counters, *ssi);
+      vlib_validate_combined_counter (&sm->dropped_counters, *ssi);
+      vlib_zero_combined_counter (&sm->mirrored_counters, *ssi);
+      vlib_zero_combined_counter (&sm->dropped_counters, *ssi);
+    }
+  else if (!mirrored && *ssi != ~0)
+    {
+      pool_put_index (sm->sessions, *ssi);
+      *ssi = ~0;
+    }
+}
+
 int
 span_add_delete_entry (vlib_main_t * vm,
 		       u32 src_sw_if_index, u32 dst_sw_if_index, u8 state,
@@ -101,6 +146,17 @@ span_add_delete_entry (vlib_main_t * vm,
       return VNET_API_ERROR_UNIMPLEMENTED;
     }
 
+  if (dst_sw_if_index != ~0)
+    span_session_update (sm, si, src_sw_if_index, dst_sw_if_index);
+  else
+    {
+      u32 i;
+
+      vec_foreach_index (i, si->session_index_by_dst)
+	if (si->session_index_by_dst[i] != ~0)
+	  span_session_update (sm, si, src_sw_if_index, i);
+    }
+
   if (dst_sw_if_index != ~0 && dst_sw_if_index > sm->max_sw_if_index)
     sm->max_sw_if_index = dst_sw_if_index;
 
@@ -206,8 +262,9 @@ show_interfaces_span_command_fn (vlib_main_t * vm,
 	clib_bitmap_t *b = clib_bitmap_dup_or (d, l);
 	if (header)
 	  {
-	    vlib_cli_output (vm, "%-32s %-32s  %6s   %6s", "Source", "Destination",
-			     "Device", "L2");
+	    vlib_cli_output (vm, "%-32s %-32s  %6s   %6s  %12s %12s", "Source",
+			     "Destination", "Device", "L2", "Mirrored",
+			     "Dropped");
 	    header = 0;
 	  }
 	s = format (s, "%U", format_vnet_sw_if_index_name, vnm,
@@ -219,9 +276,23 @@ show_interfaces_span_command_fn (vlib_main_t * vm,
 	    int l2 = (clib_bitmap_get (lrxm->mirror_ports, i) +
 		      clib_bitmap_get (ltxm->mirror_ports, i) * 2);
 
-	    vlib_cli_output (vm, "%-32v %-32U (%6s) (%6s)", s,
+	    vlib_counter_t mirrored = { 0 }, dropped = { 0 };
+	    u32 ssi = ~0;
+
+	    if (i < vec_len (si->session_index_by_dst))
+	      ssi = si->session_index_by_dst[i];
+	    if (ssi != ~0)
+	      {
+		vlib_get_combined_counter (&sm->mirrored_counters, ssi,
+					   &mirrored);
+		vlib_get_combined_counter (&sm->dropped_counters, ssi,
+					   &dropped);
+	      }
+
+	    vlib_cli_output (vm, "%-32v %-32U (%6s) (%6s)  %12Ld %12Ld", s,
 			     format_vnet_sw_if_index_name, vnm, i,
-			     states[device], states[l2]);
+			     states[device], states[l2], mirrored.packets,
+			     dropped.packets);
 	    vec_reset_length (s);
 	  }
 	clib_bitmap_free (b);
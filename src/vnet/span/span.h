@@ -36,8 +36,17 @@ typedef struct
 typedef struct
 {
   span_mirror_t mirror_rxtx[SPAN_FEAT_N][VLIB_N_RX_TX];
+
+  /* per-destination session index, ~0 if not mirrored there */
+  u32 *session_index_by_dst;
 } span_interface_t;
 
+typedef struct
+{
+  u32 src_sw_if_index;
+  u32 dst_sw_if_index;
+} span_session_t;
+
 typedef struct
 {
   /* l2 feature Next nodes */
@@ -50,6 +59,13 @@ typedef struct
   /* biggest sw_if_index used so far */
   u32 max_sw_if_index;
 
+  /* pool of src -> dst mirror sessions */
+  span_session_t *sessions;
+
+  /* per-session counters of mirrored and dropped packets */
+  vlib_combined_counter_main_t mirrored_counters;
+  vlib_combined_counter_main_t dropped_counters;
+
   /* convenience */
   vlib_main_t *vlib_main;
   vnet_main_t *vnet_main;
@@ -256,25 +256,36 @@ tcp_update_time_now (tcp_worker_ctx_t *wrk)
   tcp_set_time_now (wrk, now);
 }
 
-always_inline tcp_connection_t *
-tcp_input_lookup_buffer (vlib_buffer_t * b, u8 thread_index, u32 * error,
-			 u8 is_ip4, u8 is_nolookup)
+/**
+ * Parse tcp header and initialize the buffer's tcp metadata
+ *
+ * Lookups are not done here but the session lookup key is filled in, if
+ * requested, such that lookups can be batched.
+ *
+ * @param b		buffer whose current data is pointing at ip
+ * @param error		set to TCP_ERROR_LENGTH if buffer is malformed
+ * @param is_ip4	flag set to 1 if using ip4
+ * @param key		session lookup key to fill in, or 0. If buffer is
+ *			malformed, key fib_index is set to ~0
+ *
+ * @return 1 if buffer is well formed, 0 otherwise
+ */
+always_inline int
+tcp_input_parse_buffer (vlib_buffer_t *b, u32 *error, u8 is_ip4,
+			session_lookup_key_t *key)
 {
+  /* Read ip metadata before it's overwritten by tcp's */
   u32 fib_index = vnet_buffer (b)->ip.fib_index;
+  u32 rx_sw_if_index = vnet_buffer (b)->ip.rx_sw_if_index;
   int n_advance_bytes, n_data_bytes;
-  transport_connection_t *tc;
   tcp_header_t *tcp;
-  u8 result = 0;
 
   if (is_ip4)
     {
       ip4_header_t *ip4 = vlib_buffer_get_current (b);
       int ip_hdr_bytes = ip4_header_bytes (ip4);
       if (PREDICT_FALSE (b->current_length < ip_hdr_bytes + sizeof (*tcp)))
-	{
-	  *error = TCP_ERROR_LENGTH;
-	  return 0;
-	}
+	goto error;
       tcp = ip4_next_header (ip4);
       vnet_buffer (b)->tcp.hdr_offset = (u8 *) tcp - (u8 *) ip4;
       n_advance_bytes = (ip_hdr_bytes + tcp_header_bytes (tcp));
@@ -282,26 +293,19 @@ tcp_input_lookup_buffer (vlib_buffer_t * b, u8 thread_index, u32 * error,
 
       /* Length check. Checksum computed by ipx_local no need to compute again */
       if (PREDICT_FALSE (n_data_bytes < 0))
+	goto error;
+
+      if (key)
 	{
-	  *error = TCP_ERROR_LENGTH;
-	  return 0;
+	  key->lcl_ip4 = &ip4->dst_address;
+	  key->rmt_ip4 = &ip4->src_address;
 	}
-
-      if (!is_nolookup)
-	tc = session_lookup_connection_wt4 (fib_index, &ip4->dst_address,
-					    &ip4->src_address, tcp->dst_port,
-					    tcp->src_port,
-					    TRANSPORT_PROTO_TCP, thread_index,
-					    &result);
     }
   else
     {
       ip6_header_t *ip6 = vlib_buffer_get_current (b);
       if (PREDICT_FALSE (b->current_length < sizeof (*ip6) + sizeof (*tcp)))
-	{
-	  *error = TCP_ERROR_LENGTH;
-	  return 0;
-	}
+	goto error;
       tcp = ip6_next_header (ip6);
       vnet_buffer (b)->tcp.hdr_offset = (u8 *) tcp - (u8 *) ip6;
       n_advance_bytes = tcp_header_bytes (tcp);
@@ -310,38 +314,32 @@ tcp_input_lookup_buffer (vlib_buffer_t * b, u8 thread_index, u32 * error,
       n_advance_bytes += sizeof (ip6[0]);
 
       if (PREDICT_FALSE (n_data_bytes < 0))
-	{
-	  *error = TCP_ERROR_LENGTH;
-	  return 0;
-	}
+	goto error;
 
-      if (!is_nolookup)
+      if (key)
 	{
 	  if (PREDICT_FALSE
 	      (ip6_address_is_link_local_unicast (&ip6->dst_address)))
 	    {
 	      ip6_main_t *im = &ip6_main;
 	      fib_index = vec_elt (im->fib_index_by_sw_if_index,
-				   vnet_buffer (b)->ip.rx_sw_if_index);
+				   rx_sw_if_index);
 	    }
-
-	  tc = session_lookup_connection_wt6 (fib_index, &ip6->dst_address,
-					      &ip6->src_address,
-					      tcp->dst_port, tcp->src_port,
-					      TRANSPORT_PROTO_TCP,
-					      thread_index, &result);
+	  key->lcl_ip6 = &ip6->dst_address;
+	  key->rmt_ip6 = &ip6->src_address;
 	}
     }
 
+  if (key)
+    {
+      key->fib_index = fib_index;
+      key->lcl_port = tcp->dst_port;
+      key->rmt_port = tcp->src_port;
+    }
+
   /* Set the sw_if_index[VLIB_RX] to the interface we received
    * the connection on (the local interface) */
-  vnet_buffer (b)->sw_if_index[VLIB_RX] = vnet_buffer (b)->ip.rx_sw_if_index;
-
-  if (is_nolookup)
-    tc =
-      (transport_connection_t *) tcp_connection_get (vnet_buffer (b)->
-						     tcp.connection_index,
-						     thread_index);
+  vnet_buffer (b)->sw_if_index[VLIB_RX] = rx_sw_if_index;
 
   vnet_buffer (b)->tcp.seq_number = clib_net_to_host_u32 (tcp->seq_number);
   vnet_buffer (b)->tcp.ack_number = clib_net_to_host_u32 (tcp->ack_number);
@@ -350,9 +348,13 @@ tcp_input_lookup_buffer (vlib_buffer_t * b, u8 thread_index, u32 * error,
   vnet_buffer (b)->tcp.seq_end = vnet_buffer (b)->tcp.seq_number
     + n_data_bytes;
 
-  *error = result ? TCP_ERROR_NONE + result : *error;
+  return 1;
 
-  return tcp_get_connection_from_transport (tc);
+error:
+  *error = TCP_ERROR_LENGTH;
+  if (key)
+    key->fib_index = ~0;
+  return 0;
 }
 
 /**
@@ -1196,6 +1196,13 @@ tcp_session_enqueue_ooo (tcp_connection_t * tc, vlib_buffer_t * b,
 	  svm_fifo_newest_ooo_segment_reset (s0->rx_fifo);
 	  TCP_EVT (TCP_EVT_CC_SACKS, tc);
 	}
+      /* Buffer mode fifos keep segments unmerged, report them as is */
+      else if (s0->rx_fifo->flags & SVM_FIFO_F_LL_BUFFER)
+	{
+	  start = vnet_buffer (b)->tcp.seq_number;
+	  tcp_update_sack_list (tc, start, start + data_len);
+	  TCP_EVT (TCP_EVT_CC_SACKS, tc);
+	}
     }
 
   return TCP_ERROR_ENQUEUED_OOO;
@@ -1398,16 +1405,13 @@ tcp46_established_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
   tcp_worker_ctx_t *wrk = tcp_get_worker (thread_index);
   vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
   u16 err_counters[TCP_N_ERROR] = { 0 };
-  u32 n_left_from, *from, *to_free=0;
+  u32 n_left_from, *from;
 
   if (node->flags & VLIB_NODE_FLAG_TRACE)
     tcp_established_trace_frame (vm, node, frame, is_ip4);
 
   from = vlib_frame_vector_args (frame);
   n_left_from = frame->n_vectors;
-  
-  to_free = vec_new (u32, frame->n_vectors);
-  vec_copy (to_free, from);
 
   vlib_get_buffers (vm, from, bufs, n_left_from);
   b = bufs;
@@ -1451,12 +1455,8 @@ tcp46_established_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
       /* 6: check the URG bit TODO */
 
       /* 7: process the segment text */
-      if (vnet_buffer (b[0])->tcp.data_len) { 
+      if (vnet_buffer (b[0])->tcp.data_len)
 	error = tcp_segment_rcv (wrk, tc, b[0]);
-        if (tc->connection.flags & TRANSPORT_CONNECTION_F_USE_BUFFER) {
-            vec_del1 (to_free, vec_search (to_free, from[frame->n_vectors - n_left_from]));
-        }
-      } 
 
       /* 8: check the FIN bit */
       if (PREDICT_FALSE (tcp_is_fin (th)))
@@ -1475,11 +1475,8 @@ tcp46_established_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
   tcp_store_err_counters (established, err_counters);
   tcp_handle_postponed_dequeues (wrk);
   tcp_handle_disconnects (wrk);
+  vlib_buffer_free (vm, from, frame->n_vectors);
 
-  //vlib_buffer_free (vm, from, frame->n_vectors);
-  vlib_buffer_free (vm, to_free, vec_len (to_free));
-  vec_free (to_free);
-  
   return frame->n_vectors;
 }
 
@@ -1759,13 +1756,9 @@ tcp46_syn_sent_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   u32 n_left_from, *from, thread_index = vm->thread_index, errors = 0;
   tcp_worker_ctx_t *wrk = tcp_get_worker (thread_index);
   vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
-  u32 *to_free=0;
 
   from = vlib_frame_vector_args (frame);
   n_left_from = frame->n_vectors;
-  
-  to_free = vec_new(u32, frame->n_vectors);
-  vec_copy(to_free, from);
 
   if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE))
     tcp46_syn_sent_trace_frame (vm, node, from, n_left_from);
@@ -1971,10 +1964,7 @@ tcp46_syn_sent_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	{
 	  clib_warning ("rcvd data in syn-sent");
 	  error = tcp_segment_rcv (wrk, new_tc, b[0]);
-          if (tc->connection.flags & TRANSPORT_CONNECTION_F_USE_BUFFER)
-            vec_del1(to_free, vec_search (to_free, from[frame->n_vectors - n_left_from]));
-	  
-          if (error == TCP_ERROR_ACK_OK)
+	  if (error == TCP_ERROR_ACK_OK)
 	    error = TCP_ERROR_SYN_ACKS_RCVD;
 	}
       else
@@ -2001,11 +1991,7 @@ tcp46_syn_sent_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   errors =
     session_main_flush_enqueue_events (TRANSPORT_PROTO_TCP, thread_index);
   tcp_inc_counter (syn_sent, TCP_ERROR_MSG_QUEUE_FULL, errors);
-  
-  //vlib_buffer_free (vm, from, frame->n_vectors);
-  vlib_buffer_free (vm, to_free, vec_len (to_free));
-  vec_free(to_free);
-  
+  vlib_buffer_free (vm, from, frame->n_vectors);
   tcp_handle_disconnects (wrk);
 
   return frame->n_vectors;
@@ -2082,14 +2068,10 @@ tcp46_rcv_process_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   u32 thread_index = vm->thread_index, errors, n_left_from, *from, max_deq;
   tcp_worker_ctx_t *wrk = tcp_get_worker (thread_index);
   vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
-  u32 *to_free=0;
 
   from = vlib_frame_vector_args (frame);
   n_left_from = frame->n_vectors;
 
-  to_free = vec_new(u32, frame->n_vectors);
-  vec_copy(to_free, from);
-
   if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE))
     tcp46_rcv_process_trace_frame (vm, node, from, n_left_from);
 
@@ -2360,11 +2342,8 @@ tcp46_rcv_process_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
 	case TCP_STATE_ESTABLISHED:
 	case TCP_STATE_FIN_WAIT_1:
 	case TCP_STATE_FIN_WAIT_2:
-	  if (vnet_buffer (b[0])->tcp.data_len){
+	  if (vnet_buffer (b[0])->tcp.data_len)
 	    error = tcp_segment_rcv (wrk, tc, b[0]);
-            if (tc->connection.flags & TRANSPORT_CONNECTION_F_USE_BUFFER)
-                vec_del1(to_free, vec_search (to_free, from[frame->n_vectors - n_left_from]));
-          }
 	  /* Don't accept out of order fins lower */
 	  if (vnet_buffer (b[0])->tcp.seq_end != tc->rcv_nxt)
 	    goto drop;
@@ -2464,10 +2443,7 @@ tcp46_rcv_process_inline (vlib_main_t *vm, vlib_node_runtime_t *node,
   tcp_inc_counter (rcv_process, TCP_ERROR_MSG_QUEUE_FULL, errors);
   tcp_handle_postponed_dequeues (wrk);
   tcp_handle_disconnects (wrk);
-  
-  //vlib_buffer_free (vm, from, frame->n_vectors);
-  vlib_buffer_free (vm, to_free, vec_len (to_free));
-  vec_free (to_free);  
+  vlib_buffer_free (vm, from, frame->n_vectors);
 
   return frame->n_vectors;
 }
@@ -2867,8 +2843,13 @@ tcp46_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
   u32 n_left_from, *from, thread_index = vm->thread_index;
   tcp_main_t *tm = vnet_get_tcp_main ();
   vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
+  transport_connection_t *tcs[VLIB_FRAME_SIZE];
+  session_lookup_key_t keys[VLIB_FRAME_SIZE];
+  u8 results[VLIB_FRAME_SIZE];
+  u32 errors[VLIB_FRAME_SIZE];
   u16 nexts[VLIB_FRAME_SIZE], *next;
   u16 err_counters[TCP_N_ERROR] = { 0 };
+  u32 i;
 
   tcp_update_time_now (tcp_get_worker (thread_index));
 
@@ -2876,87 +2857,57 @@ tcp46_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
   n_left_from = frame->n_vectors;
   vlib_get_buffers (vm, from, bufs, n_left_from);
 
+  /*
+   * Parse all headers first and only then lookup the connections in one
+   * batch, so that session table cache misses overlap
+   */
   b = bufs;
-  next = nexts;
-
-  while (n_left_from >= 4)
+  for (i = 0; i < n_left_from; i++)
     {
-      u32 error0 = TCP_ERROR_NO_LISTENER, error1 = TCP_ERROR_NO_LISTENER;
-      tcp_connection_t *tc0, *tc1;
-
-      {
-	vlib_prefetch_buffer_header (b[2], STORE);
-	CLIB_PREFETCH (b[2]->data, 2 * CLIB_CACHE_LINE_BYTES, LOAD);
-
-	vlib_prefetch_buffer_header (b[3], STORE);
-	CLIB_PREFETCH (b[3]->data, 2 * CLIB_CACHE_LINE_BYTES, LOAD);
-      }
-
-      next[0] = next[1] = TCP_INPUT_NEXT_DROP;
-
-      tc0 = tcp_input_lookup_buffer (b[0], thread_index, &error0, is_ip4,
-				     is_nolookup);
-      tc1 = tcp_input_lookup_buffer (b[1], thread_index, &error1, is_ip4,
-				     is_nolookup);
-
-      if (PREDICT_TRUE (!tc0 + !tc1 == 0))
+      if (i + 2 < n_left_from)
 	{
-	  ASSERT (tcp_lookup_is_valid (tc0, b[0], tcp_buffer_hdr (b[0])));
-	  ASSERT (tcp_lookup_is_valid (tc1, b[1], tcp_buffer_hdr (b[1])));
-
-	  vnet_buffer (b[0])->tcp.connection_index = tc0->c_c_index;
-	  vnet_buffer (b[1])->tcp.connection_index = tc1->c_c_index;
+	  vlib_prefetch_buffer_header (b[2], STORE);
+	  CLIB_PREFETCH (b[2]->data, 2 * CLIB_CACHE_LINE_BYTES, LOAD);
+	}
 
-	  tcp_input_dispatch_buffer (tm, tc0, b[0], &next[0], err_counters);
-	  tcp_input_dispatch_buffer (tm, tc1, b[1], &next[1], err_counters);
+      errors[i] = TCP_ERROR_NO_LISTENER;
+      if (is_nolookup)
+	{
+	  tcs[i] = 0;
+	  if (tcp_input_parse_buffer (b[0], &errors[i], is_ip4, 0))
+	    tcs[i] = (transport_connection_t *) tcp_connection_get (
+	      vnet_buffer (b[0])->tcp.connection_index, thread_index);
 	}
       else
-	{
-	  if (PREDICT_TRUE (tc0 != 0))
-	    {
-	      ASSERT (tcp_lookup_is_valid (tc0, b[0], tcp_buffer_hdr (b[0])));
-	      vnet_buffer (b[0])->tcp.connection_index = tc0->c_c_index;
-	      tcp_input_dispatch_buffer (tm, tc0, b[0], &next[0],
-					 err_counters);
-	    }
-	  else
-	    {
-	      tcp_input_set_error_next (tm, &next[0], &error0, is_ip4);
-	      tcp_inc_err_counter (err_counters, error0, 1);
-	    }
+	tcp_input_parse_buffer (b[0], &errors[i], is_ip4, &keys[i]);
 
-	  if (PREDICT_TRUE (tc1 != 0))
-	    {
-	      ASSERT (tcp_lookup_is_valid (tc1, b[1], tcp_buffer_hdr (b[1])));
-	      vnet_buffer (b[1])->tcp.connection_index = tc1->c_c_index;
-	      tcp_input_dispatch_buffer (tm, tc1, b[1], &next[1],
-					 err_counters);
-	    }
-	  else
-	    {
-	      tcp_input_set_error_next (tm, &next[1], &error1, is_ip4);
-	      tcp_inc_err_counter (err_counters, error1, 1);
-	    }
-	}
+      b += 1;
+    }
 
-      b += 2;
-      next += 2;
-      n_left_from -= 2;
+  if (!is_nolookup)
+    {
+      if (is_ip4)
+	session_lookup_connection_wt4_batch (keys, n_left_from,
+					     TRANSPORT_PROTO_TCP, thread_index,
+					     tcs, results);
+      else
+	session_lookup_connection_wt6_batch (keys, n_left_from,
+					     TRANSPORT_PROTO_TCP, thread_index,
+					     tcs, results);
     }
-  while (n_left_from > 0)
+
+  b = bufs;
+  next = nexts;
+
+  for (i = 0; i < n_left_from; i++)
     {
-      tcp_connection_t *tc0;
-      u32 error0 = TCP_ERROR_NO_LISTENER;
+      tcp_connection_t *tc0 = tcp_get_connection_from_transport (tcs[i]);
+      u32 error0 = errors[i];
 
-      if (n_left_from > 1)
-	{
-	  vlib_prefetch_buffer_header (b[1], STORE);
-	  CLIB_PREFETCH (b[1]->data, 2 * CLIB_CACHE_LINE_BYTES, LOAD);
-	}
+      if (!is_nolookup && results[i])
+	error0 = TCP_ERROR_NONE + results[i];
 
       next[0] = TCP_INPUT_NEXT_DROP;
-      tc0 = tcp_input_lookup_buffer (b[0], thread_index, &error0, is_ip4,
-				     is_nolookup);
       if (PREDICT_TRUE (tc0 != 0))
 	{
 	  ASSERT (tcp_lookup_is_valid (tc0, b[0], tcp_buffer_hdr (b[0])));
@@ -2971,7 +2922,6 @@ tcp46_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 
       b += 1;
       next += 1;
-      n_left_from -= 1;
     }
 
   if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_TRACE))
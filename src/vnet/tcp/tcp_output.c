@@ -561,7 +561,7 @@ tcp_buffer_make_reset (vlib_main_t *vm, vlib_buffer_t *b, u8 is_ip4)
 
   /*
    * Find IP and TCP headers and glean information from them. Assumes
-   * buffer was parsed by something like @ref tcp_input_lookup_buffer
+   * buffer was parsed by something like @ref tcp_input_parse_buffer
    */
   th = tcp_buffer_hdr (b);
 
@@ -16,6 +16,7 @@
 #include <vnet/session/application_interface.h>
 #include <vppinfra/lock.h>
 #include <vnet/tls/tls.h>
+#include <sys/random.h>
 
 static tls_main_t tls_main;
 static tls_engine_vft_t *tls_vfts;
@@ -148,6 +149,23 @@ tls_notify_app_enqueue (tls_ctx_t * ctx, session_t * app_session)
     tls_add_app_q_evt (app_wrk, app_session);
 }
 
+static void
+tls_handshake_stats_update (tls_ctx_t *ctx, u8 is_server)
+{
+  tls_worker_t *wrk = &tls_main.wrk[ctx->c_thread_index];
+  u8 is_resumed = 0;
+
+  if (tls_vfts[ctx->tls_ctx_engine].ctx_handshake_is_resumed)
+    is_resumed = tls_vfts[ctx->tls_ctx_engine].ctx_handshake_is_resumed (ctx);
+
+  if (is_server)
+    wrk->hs_stats[is_resumed ? TLS_HS_STAT_SRV_RESUMED :
+				     TLS_HS_STAT_SRV_FULL] += 1;
+  else
+    wrk->hs_stats[is_resumed ? TLS_HS_STAT_CLN_RESUMED :
+				     TLS_HS_STAT_CLN_FULL] += 1;
+}
+
 int
 tls_notify_app_accept (tls_ctx_t * ctx)
 {
@@ -156,6 +174,8 @@ tls_notify_app_accept (tls_ctx_t * ctx)
   tls_ctx_t *lctx;
   int rv;
 
+  tls_handshake_stats_update (ctx, 1 /* is_server */);
+
   lctx = tls_listener_ctx_get (ctx->listener_ctx_index);
   app_listener = listen_session_get_from_handle (lctx->app_session_handle);
 
@@ -185,6 +205,9 @@ tls_notify_app_connected (tls_ctx_t * ctx, session_error_t err)
   session_t *app_session;
   app_worker_t *app_wrk;
 
+  if (!err)
+    tls_handshake_stats_update (ctx, 0 /* is_server */);
+
   app_wrk = app_worker_get_if_valid (ctx->parent_app_wrk_index);
   if (!app_wrk)
     {
@@ -379,6 +402,84 @@ tls_reinit_ca_chain (crypto_engine_type_t tls_engine_id)
   return tls_vfts[tls_engine_id].ctx_reinit_cachain ();
 }
 
+static int
+tls_ticket_key_generate (tls_ticket_key_t *key, f64 now)
+{
+  if (getrandom (key->name, sizeof (key->name), 0) != sizeof (key->name) ||
+      getrandom (key->aes_key, sizeof (key->aes_key), 0) !=
+	sizeof (key->aes_key) ||
+      getrandom (key->hmac_key, sizeof (key->hmac_key), 0) !=
+	sizeof (key->hmac_key))
+    return -1;
+  key->created = now;
+  return 0;
+}
+
+/**
+ * Get key used to encrypt new session tickets
+ *
+ * Keys are rotated once they exceed the configured lifetime. Retired keys
+ * are kept long enough to decrypt tickets issued with them.
+ */
+int
+tls_ticket_key_current (tls_ticket_key_t *key)
+{
+  tls_main_t *tm = &tls_main;
+  f64 now = vlib_time_now (vlib_get_main ());
+  tls_ticket_key_t *keys = tm->ticket_keys;
+  int rv = 0;
+
+  clib_spinlock_lock (&tm->ticket_keys_lock);
+
+  if (!keys[0].created || now - keys[0].created > tm->ticket_key_lifetime)
+    {
+      memmove (&keys[1], &keys[0], (TLS_TICKET_N_KEYS - 1) * sizeof (*keys));
+      if (tls_ticket_key_generate (&keys[0], now))
+	{
+	  clib_memset (&keys[0], 0, sizeof (keys[0]));
+	  rv = -1;
+	  goto done;
+	}
+    }
+  clib_memcpy_fast (key, &keys[0], sizeof (*key));
+
+done:
+  clib_spinlock_unlock (&tm->ticket_keys_lock);
+  return rv;
+}
+
+/**
+ * Find key a session ticket was encrypted with
+ *
+ * @return 0 if ticket key is current, 1 if key is retired and ticket should
+ *         be renewed, -1 if key is unknown or expired
+ */
+int
+tls_ticket_key_find (u8 *name, tls_ticket_key_t *key)
+{
+  tls_main_t *tm = &tls_main;
+  f64 now = vlib_time_now (vlib_get_main ());
+  tls_ticket_key_t *keys = tm->ticket_keys;
+  int i, rv = -1;
+
+  clib_spinlock_lock (&tm->ticket_keys_lock);
+
+  for (i = 0; i < TLS_TICKET_N_KEYS; i++)
+    {
+      if (!keys[i].created ||
+	  memcmp (keys[i].name, name, TLS_TICKET_KEY_NAME_LEN))
+	continue;
+      if (now - keys[i].created > TLS_TICKET_N_KEYS * tm->ticket_key_lifetime)
+	break;
+      clib_memcpy_fast (key, &keys[i], sizeof (*key));
+      rv = i == 0 && now - keys[i].created <= tm->ticket_key_lifetime ? 0 : 1;
+      break;
+    }
+
+  clib_spinlock_unlock (&tm->ticket_keys_lock);
+  return rv;
+}
+
 void
 tls_notify_app_io_error (tls_ctx_t *ctx)
 {
@@ -743,6 +844,7 @@ tls_connect (transport_endpoint_cfg_t * tep)
   ctx->tcp_is_ip4 = sep->is_ip4;
   ctx->tls_type = sep->transport_proto;
   ctx->ckpair_index = ccfg->ckpair_index;
+  ctx->crypto_flags = ccfg->flags;
   ctx->c_proto = TRANSPORT_PROTO_TLS;
   ctx->c_flags |= TRANSPORT_CONNECTION_F_NO_LOOKUP;
   if (ccfg->hostname[0])
@@ -841,6 +943,7 @@ tls_start_listen (u32 app_listener_index, transport_endpoint_cfg_t *tep)
   lctx->tls_ctx_engine = engine_type;
   lctx->tls_type = sep->transport_proto;
   lctx->ckpair_index = ccfg->ckpair_index;
+  lctx->crypto_flags = ccfg->flags;
   lctx->c_s_index = app_listener_index;
   lctx->c_flags |= TRANSPORT_CONNECTION_F_NO_LOOKUP;
 
@@ -1199,6 +1302,7 @@ dtls_connect (transport_endpoint_cfg_t *tep)
   ctx->parent_app_api_context = sep->opaque;
   ctx->tcp_is_ip4 = sep->is_ip4;
   ctx->ckpair_index = ccfg->ckpair_index;
+  ctx->crypto_flags = ccfg->flags;
   ctx->tls_type = sep->transport_proto;
   ctx->tls_ctx_handle = ctx_handle;
   ctx->c_proto = TRANSPORT_PROTO_DTLS;
@@ -1312,9 +1416,14 @@ tls_init (vlib_main_t * vm)
 
   vec_validate (tm->rx_bufs, num_threads - 1);
   vec_validate (tm->tx_bufs, num_threads - 1);
+  vec_validate_aligned (tm->wrk, num_threads - 1, CLIB_CACHE_LINE_BYTES);
 
   tm->first_seg_size = 32 << 20;
   tm->add_seg_size = 256 << 20;
+  tm->session_cache_size = TLS_SESSION_CACHE_SIZE;
+  tm->session_timeout = TLS_SESSION_TIMEOUT;
+  tm->ticket_key_lifetime = TLS_TICKET_KEY_LIFETIME;
+  clib_spinlock_init (&tm->ticket_keys_lock);
 
   transport_register_protocol (TRANSPORT_PROTO_TLS, &tls_proto,
 			       FIB_PROTOCOL_IP4, ~0);
@@ -1356,15 +1465,79 @@ tls_config_fn (vlib_main_t * vm, unformat_input_t * input)
 	    }
 	  tm->fifo_size = tmp;
 	}
+      else if (unformat (input, "session-cache-size %u",
+			 &tm->session_cache_size))
+	;
+      else if (unformat (input, "session-timeout %u", &tm->session_timeout))
+	;
+      else if (unformat (input, "ticket-key-lifetime %u",
+			 &tm->ticket_key_lifetime))
+	{
+	  if (!tm->ticket_key_lifetime)
+	    return clib_error_return (0, "ticket-key-lifetime must be > 0");
+	}
+      else if (unformat (input, "record-offload"))
+	tm->record_offload = 1;
+      else if (unformat (input, "record-key-update %u",
+			 &tm->record_key_update))
+	;
       else
 	return clib_error_return (0, "unknown input `%U'",
 				  format_unformat_error, input);
     }
+
+  /* key updates are only sent by the record offload data path */
+  if (tm->record_key_update && !tm->record_offload)
+    return clib_error_return (0, "record-key-update requires record-offload");
+
   return 0;
 }
 
 VLIB_CONFIG_FUNCTION (tls_config_fn, "tls");
 
+static clib_error_t *
+show_tls_stats_command_fn (vlib_main_t *vm, unformat_input_t *input,
+			   vlib_cli_command_t *cmd)
+{
+  u64 hs_stats[TLS_N_HS_STATS] = { 0 };
+  tls_main_t *tm = &tls_main;
+  tls_ticket_key_t *key;
+  f64 now;
+  int i, j;
+
+  if (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    return clib_error_return (0, "unknown input `%U'", format_unformat_error,
+			      input);
+
+  vec_foreach_index (i, tm->wrk)
+    for (j = 0; j < TLS_N_HS_STATS; j++)
+      hs_stats[j] += tm->wrk[i].hs_stats[j];
+
+#define _(sym, str)                                                           \
+  vlib_cli_output (vm, "%-30s %lu", str, hs_stats[TLS_HS_STAT_##sym]);
+  foreach_tls_hs_stat
+#undef _
+
+  now = vlib_time_now (vm);
+  clib_spinlock_lock (&tm->ticket_keys_lock);
+  for (i = 0; i < TLS_TICKET_N_KEYS; i++)
+    {
+      key = &tm->ticket_keys[i];
+      if (key->created)
+	vlib_cli_output (vm, "ticket key %d age %.0fs lifetime %us", i,
+			 now - key->created, tm->ticket_key_lifetime);
+    }
+  clib_spinlock_unlock (&tm->ticket_keys_lock);
+
+  return 0;
+}
+
+VLIB_CLI_COMMAND (show_tls_stats_command, static) = {
+  .path = "show tls stats",
+  .short_help = "show tls stats",
+  .function = show_tls_stats_command_fn,
+};
+
 tls_main_t *
 vnet_tls_get_main (void)
 {
@@ -28,6 +28,12 @@
 #define TLS_CHUNK_SIZE 		(1 << 14)
 #define TLS_CA_CERT_PATH	"/etc/ssl/certs/ca-certificates.crt"
 
+#define TLS_SESSION_CACHE_SIZE	 (20 << 10)
+#define TLS_SESSION_TIMEOUT	 7200
+#define TLS_TICKET_KEY_LIFETIME	 3600
+#define TLS_TICKET_KEY_NAME_LEN	 16
+#define TLS_TICKET_N_KEYS	 2
+
 #if TLS_DEBUG
 #define TLS_DBG(_lvl, _fmt, _args...) 			\
   if (_lvl <= TLS_DEBUG) 				\
@@ -82,11 +88,41 @@ typedef struct tls_ctx_
   u8 no_app_session;
   u8 is_migrated;
   u8 *srv_hostname;
+  u8 crypto_flags;
   u32 evt_index;
   u32 ckpair_index;
   transport_proto_t tls_type;
 } tls_ctx_t;
 
+/** Session ticket encryption key, shared by all workers and engines */
+typedef struct tls_ticket_key_
+{
+  u8 name[TLS_TICKET_KEY_NAME_LEN];
+  u8 aes_key[32];
+  u8 hmac_key[32];
+  f64 created;
+} tls_ticket_key_t;
+
+#define foreach_tls_hs_stat                                                   \
+  _ (SRV_FULL, "server full handshakes")                                      \
+  _ (SRV_RESUMED, "server resumed handshakes")                                \
+  _ (CLN_FULL, "client full handshakes")                                      \
+  _ (CLN_RESUMED, "client resumed handshakes")
+
+typedef enum tls_hs_stat_
+{
+#define _(sym, str) TLS_HS_STAT_##sym,
+  foreach_tls_hs_stat
+#undef _
+    TLS_N_HS_STATS,
+} tls_hs_stat_t;
+
+typedef struct tls_worker_
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  u64 hs_stats[TLS_N_HS_STATS];
+} tls_worker_t;
+
 typedef struct tls_main_
 {
   u32 app_index;
@@ -94,6 +130,11 @@ typedef struct tls_main_
   tls_ctx_t *half_open_ctx_pool;
   u8 **rx_bufs;
   u8 **tx_bufs;
+  tls_worker_t *wrk;
+
+  /** Current key first, older keys only decrypt and renew tickets */
+  tls_ticket_key_t ticket_keys[TLS_TICKET_N_KEYS];
+  clib_spinlock_t ticket_keys_lock;
 
   /*
    * Config
@@ -103,6 +144,11 @@ typedef struct tls_main_
   u64 first_seg_size;
   u64 add_seg_size;
   u32 fifo_size;
+  u32 session_cache_size;
+  u32 session_timeout;
+  u32 ticket_key_lifetime;
+  u32 record_key_update;
+  u8 record_offload;
 } tls_main_t;
 
 typedef struct tls_engine_vft_
@@ -125,6 +171,7 @@ typedef struct tls_engine_vft_
   int (*ctx_transport_close) (tls_ctx_t * ctx);
   int (*ctx_app_close) (tls_ctx_t * ctx);
   int (*ctx_reinit_cachain) (void);
+  u8 (*ctx_handshake_is_resumed) (tls_ctx_t *ctx);
 } tls_engine_vft_t;
 
 tls_main_t *vnet_tls_get_main (void);
@@ -140,6 +187,8 @@ void tls_notify_app_enqueue (tls_ctx_t * ctx, session_t * app_session);
 void tls_notify_app_io_error (tls_ctx_t *ctx);
 void tls_disconnect_transport (tls_ctx_t * ctx);
 int tls_reinit_ca_chain (crypto_engine_type_t tls_engine_id);
+int tls_ticket_key_current (tls_ticket_key_t *key);
+int tls_ticket_key_find (u8 *name, tls_ticket_key_t *key);
 #endif /* SRC_VNET_TLS_TLS_H_ */
 
 /*
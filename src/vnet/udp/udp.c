@@ -16,6 +16,9 @@
 #include <vnet/udp/udp.h>
 #include <vnet/session/session.h>
 #include <vnet/dpo/load_balance.h>
+#include <vnet/feature/feature.h>
+#include <vnet/fib/ip4_fib.h>
+#include <vnet/fib/ip6_fib.h>
 #include <vnet/ip/ip4_inlines.h>
 #include <vnet/ip/ip6_inlines.h>
 #include <vppinfra/sparse_vec.h>
@@ -88,6 +91,53 @@ udp_connection_free (udp_connection_t * uc)
   pool_put (wrk->connections, uc);
 }
 
+/**
+ * Enable gso for a connected session if its egress interface can either
+ * segment udp in hardware or has the gso feature enabled
+ */
+void
+udp_connection_check_gso (udp_connection_t *uc)
+{
+  udp_main_t *um = &udp_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  const load_balance_t *lb;
+  vnet_hw_interface_t *hw_if;
+  const dpo_id_t *dpo;
+  u32 sw_if_index, lb_idx;
+  u8 gso_feature;
+
+  uc->cfg_flags &= ~UDP_CFG_F_GSO;
+  if (!um->max_gso_size || !(uc->flags & UDP_CONN_F_CONNECTED))
+    return;
+
+  if (uc->c_is_ip4)
+    lb_idx = ip4_fib_forwarding_lookup (uc->c_fib_index, &uc->c_rmt_ip4);
+  else
+    lb_idx = ip6_fib_table_fwding_lookup (uc->c_fib_index, &uc->c_rmt_ip6);
+
+  lb = load_balance_get (lb_idx);
+  if (PREDICT_FALSE (lb->lb_n_buckets > 1))
+    return;
+  dpo = load_balance_get_bucket_i (lb, 0);
+
+  sw_if_index = dpo_get_urpf (dpo);
+  if (PREDICT_FALSE (sw_if_index == ~0))
+    return;
+
+  /* returns negative api errors, e.g., if no feature was ever configured
+   * on the interface */
+  hw_if = vnet_get_sup_hw_interface (vnm, sw_if_index);
+  if (uc->c_is_ip4)
+    gso_feature =
+      vnet_feature_is_enabled ("ip4-output", "gso-ip4", sw_if_index) == 1;
+  else
+    gso_feature =
+      vnet_feature_is_enabled ("ip6-output", "gso-ip6", sw_if_index) == 1;
+
+  if ((hw_if->caps & VNET_HW_IF_CAP_UDP_GSO) || gso_feature)
+    uc->cfg_flags |= UDP_CFG_F_GSO;
+}
+
 static void
 udp_connection_cleanup (udp_connection_t * uc)
 {
@@ -235,17 +285,25 @@ udp_push_one_header (vlib_main_t *vm, udp_connection_t *uc, vlib_buffer_t *b,
 
   if (!is_cless)
     {
-      vlib_buffer_push_udp (b, uc->c_lcl_port, uc->c_rmt_port,
-			    udp_csum_offload (uc));
+      /* Checksums of gso segments are computed after segmentation, so
+       * always request the offload for them */
+      u8 csum_offload =
+	udp_csum_offload (uc) || (b->flags & VNET_BUFFER_F_GSO);
+
+      vlib_buffer_push_udp (b, uc->c_lcl_port, uc->c_rmt_port, csum_offload);
 
       if (uc->c_is_ip4)
 	vlib_buffer_push_ip4_custom (vm, b, &uc->c_lcl_ip4, &uc->c_rmt_ip4,
-				     IP_PROTOCOL_UDP, udp_csum_offload (uc),
+				     IP_PROTOCOL_UDP, csum_offload,
 				     0 /* is_df */, uc->c_dscp);
       else
 	vlib_buffer_push_ip6 (vm, b, &uc->c_lcl_ip6, &uc->c_rmt_ip6,
 			      IP_PROTOCOL_UDP);
 
+      /* Session layer set gso_size if the buffer carries multiple dgrams */
+      if (b->flags & VNET_BUFFER_F_GSO)
+	vnet_buffer2 (b)->gso_l4_hdr_sz = sizeof (udp_header_t);
+
       vnet_buffer (b)->tcp.flags = 0;
     }
   else
@@ -375,6 +433,8 @@ udp_session_send_params (transport_connection_t * tconn,
   /* TODO figure out MTU of output interface */
   sp->snd_mss = uc->mss;
   sp->tx_offset = 0;
+  sp->max_gso_size =
+    (uc->cfg_flags & UDP_CFG_F_GSO) ? udp_main.max_gso_size : 0;
   sp->flags = 0;
   return 0;
 }
@@ -445,6 +505,7 @@ udp_open_connection (transport_endpoint_cfg_t * rmt)
     }
   if (!um->csum_offload)
     uc->cfg_flags |= UDP_CFG_F_NO_CSUM_OFFLOAD;
+  udp_connection_check_gso (uc);
   uc->next_node_index = rmt->next_node_index;
   uc->next_node_opaque = rmt->next_node_opaque;
 
@@ -57,7 +57,9 @@ typedef enum udp_conn_flags_
 #undef _
 } udp_conn_flags_t;
 
-#define foreach_udp_cfg_flag _ (NO_CSUM_OFFLOAD, "no-csum-offload")
+#define foreach_udp_cfg_flag                                                  \
+  _ (NO_CSUM_OFFLOAD, "no-csum-offload")                                      \
+  _ (GSO, "gso")
 
 typedef enum udp_cfg_flag_bits_
 {
@@ -91,6 +93,10 @@ typedef struct
 
 #define udp_csum_offload(uc) (!((uc)->cfg_flags & UDP_CFG_F_NO_CSUM_OFFLOAD))
 
+/** Largest udp payload that still fits in an ip4 packet */
+#define UDP_MAX_GSO_SZ                                                        \
+  (65535 - sizeof (ip4_header_t) - sizeof (udp_header_t))
+
 typedef struct
 {
   /* Name (a c string). */
@@ -155,6 +161,10 @@ typedef struct
   u16 msg_id_base;
   u8 csum_offload;
 
+  /* Max size of the gso segments built for connected sessions, 0 if gso
+   * is disabled */
+  u16 max_gso_size;
+
   u8 icmp_send_unreachable_disabled;
 } udp_main_t;
 
@@ -205,6 +215,7 @@ udp_connection_from_transport (transport_connection_t * tc)
 
 void udp_connection_free (udp_connection_t * uc);
 udp_connection_t *udp_connection_alloc (u32 thread_index);
+void udp_connection_check_gso (udp_connection_t *uc);
 
 always_inline udp_connection_t *
 udp_connection_clone_safe (u32 connection_index, u32 thread_index)
@@ -116,6 +116,7 @@ udp_connection_accept (udp_connection_t * listener, session_dgram_hdr_t * hdr,
   uc->mss = listener->mss;
   uc->flags |= UDP_CONN_F_CONNECTED;
   uc->cfg_flags = listener->cfg_flags;
+  udp_connection_check_gso (uc);
 
   if (session_dgram_accept (&uc->connection, listener->c_s_index,
 			    listener->c_thread_index))
@@ -173,17 +174,18 @@ unlock_rx_lock:
     clib_spinlock_unlock (&uc0->rx_lock);
 }
 
-always_inline session_t *
-udp_parse_and_lookup_buffer (vlib_buffer_t * b, session_dgram_hdr_t * hdr,
-			     u8 is_ip4)
+always_inline void
+udp_parse_buffer (vlib_buffer_t *b, session_dgram_hdr_t *hdr,
+		  session_lookup_key_t *key, u8 is_ip4)
 {
   udp_header_t *udp;
-  u32 fib_index;
-  session_t *s;
 
   /* udp_local hands us a pointer to the udp data */
   udp = (udp_header_t *) (vlib_buffer_get_current (b) - sizeof (*udp));
-  fib_index = vnet_buffer (b)->ip.fib_index;
+
+  key->fib_index = vnet_buffer (b)->ip.fib_index;
+  key->lcl_port = udp->dst_port;
+  key->rmt_port = udp->src_port;
 
   hdr->data_offset = 0;
   hdr->lcl_port = udp->dst_port;
@@ -201,9 +203,8 @@ udp_parse_and_lookup_buffer (vlib_buffer_t * b, session_dgram_hdr_t * hdr,
       ip_set (&hdr->rmt_ip, &ip4->src_address, 1);
       hdr->data_length = clib_net_to_host_u16 (ip4->length);
       hdr->data_length -= sizeof (ip4_header_t) + sizeof (udp_header_t);
-      s = session_lookup_safe4 (fib_index, &ip4->dst_address,
-				&ip4->src_address, udp->dst_port,
-				udp->src_port, TRANSPORT_PROTO_UDP);
+      key->lcl_ip4 = &ip4->dst_address;
+      key->rmt_ip4 = &ip4->src_address;
     }
   else
     {
@@ -214,9 +215,8 @@ udp_parse_and_lookup_buffer (vlib_buffer_t * b, session_dgram_hdr_t * hdr,
       ip_set (&hdr->rmt_ip, &ip60->src_address, 0);
       hdr->data_length = clib_net_to_host_u16 (ip60->payload_length);
       hdr->data_length -= sizeof (udp_header_t);
-      s = session_lookup_safe6 (fib_index, &ip60->dst_address,
-				&ip60->src_address, udp->dst_port,
-				udp->src_port, TRANSPORT_PROTO_UDP);
+      key->lcl_ip6 = &ip60->dst_address;
+      key->rmt_ip6 = &ip60->src_address;
     }
 
   if (PREDICT_TRUE (!(b->flags & VLIB_BUFFER_NEXT_PRESENT)))
@@ -224,8 +224,19 @@ udp_parse_and_lookup_buffer (vlib_buffer_t * b, session_dgram_hdr_t * hdr,
   else
     b->total_length_not_including_first_buffer = hdr->data_length
       - b->current_length;
+}
 
-  return s;
+always_inline session_t *
+udp_lookup_key (session_lookup_key_t *key, u8 is_ip4)
+{
+  if (is_ip4)
+    return session_lookup_safe4 (key->fib_index, key->lcl_ip4, key->rmt_ip4,
+				 key->lcl_port, key->rmt_port,
+				 TRANSPORT_PROTO_UDP);
+  else
+    return session_lookup_safe6 (key->fib_index, key->lcl_ip6, key->rmt_ip6,
+				 key->lcl_port, key->rmt_port,
+				 TRANSPORT_PROTO_UDP);
 }
 
 always_inline uword
@@ -234,23 +245,50 @@ udp46_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 {
   u32 n_left_from, *from, errors, *first_buffer;
   vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
+  session_dgram_hdr_t hdrs[VLIB_FRAME_SIZE], *hdr0;
+  session_lookup_key_t keys[VLIB_FRAME_SIZE], *key0;
+  session_t *sessions[VLIB_FRAME_SIZE], **s;
   u16 err_counters[UDP_N_ERROR] = { 0 };
   u32 thread_index = vm->thread_index;
+  u8 tables_changed = 0;
+  u32 i;
 
   from = first_buffer = vlib_frame_vector_args (frame);
   n_left_from = frame->n_vectors;
   vlib_get_buffers (vm, from, bufs, n_left_from);
 
+  /*
+   * Parse all buffers and lookup their sessions in one batch, so that
+   * session table cache misses overlap
+   */
+  for (i = 0; i < n_left_from; i++)
+    udp_parse_buffer (bufs[i], &hdrs[i], &keys[i], is_ip4);
+
+  if (is_ip4)
+    session_lookup_safe4_batch (keys, n_left_from, TRANSPORT_PROTO_UDP,
+				sessions);
+  else
+    session_lookup_safe6_batch (keys, n_left_from, TRANSPORT_PROTO_UDP,
+				sessions);
+
   b = bufs;
+  s = sessions;
+  hdr0 = hdrs;
+  key0 = keys;
 
   while (n_left_from > 0)
     {
       u32 error0 = UDP_ERROR_ENQUEUED;
-      session_dgram_hdr_t hdr0;
       udp_connection_t *uc0;
       session_t *s0;
 
-      s0 = udp_parse_and_lookup_buffer (b[0], &hdr0, is_ip4);
+      /* Sessions added while handling previous buffers in the frame may
+       * shadow the batched lookup results, so redo the lookups */
+      if (PREDICT_FALSE (tables_changed))
+	s0 = udp_lookup_key (key0, is_ip4);
+      else
+	s0 = s[0];
+
       if (PREDICT_FALSE (!s0))
 	{
 	  error0 = UDP_ERROR_NO_LISTENER;
@@ -280,17 +318,18 @@ udp46_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 		  session_dgram_connect_notify (&uc0->connection,
 						s0->thread_index, &s0);
 		  queue_event = 0;
+		  tables_changed = 1;
 		}
 	      else
 		s0->session_state = SESSION_STATE_READY;
 	    }
-	  udp_connection_enqueue (uc0, s0, &hdr0, thread_index, b[0],
+	  udp_connection_enqueue (uc0, s0, hdr0, thread_index, b[0],
 				  queue_event, &error0);
 	}
       else if (s0->session_state == SESSION_STATE_READY)
 	{
 	  uc0 = udp_connection_from_transport (session_get_transport (s0));
-	  udp_connection_enqueue (uc0, s0, &hdr0, thread_index, b[0], 1,
+	  udp_connection_enqueue (uc0, s0, hdr0, thread_index, b[0], 1,
 				  &error0);
 	}
       else if (s0->session_state == SESSION_STATE_LISTENING)
@@ -298,17 +337,18 @@ udp46_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  uc0 = udp_connection_from_transport (session_get_transport (s0));
 	  if (uc0->flags & UDP_CONN_F_CONNECTED)
 	    {
-	      uc0 = udp_connection_accept (uc0, &hdr0, thread_index);
+	      uc0 = udp_connection_accept (uc0, hdr0, thread_index);
 	      if (!uc0)
 		{
 		  error0 = UDP_ERROR_CREATE_SESSION;
 		  goto done;
 		}
+	      tables_changed = 1;
 	      s0 = session_get (uc0->c_s_index, uc0->c_thread_index);
 	      uc0->sw_if_index = vnet_buffer (b[0])->sw_if_index[VLIB_RX];
 	      error0 = UDP_ERROR_ACCEPT;
 	    }
-	  udp_connection_enqueue (uc0, s0, &hdr0, thread_index, b[0], 1,
+	  udp_connection_enqueue (uc0, s0, hdr0, thread_index, b[0], 1,
 				  &error0);
 	}
       else
@@ -321,6 +361,9 @@ udp46_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 	udp_trace_buffer (vm, node, b[0], s0, error0);
 
       b += 1;
+      s += 1;
+      hdr0 += 1;
+      key0 += 1;
       n_left_from -= 1;
 
       udp_inc_err_counter (err_counters, error0, 1);
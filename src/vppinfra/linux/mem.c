@@ -659,6 +659,46 @@ clib_mem_set_numa_affinity (u8 numa_node, int force)
   return 0;
 }
 
+__clib_export int
+clib_mem_vm_set_numa_affinity (void *start, uword size, u8 numa_node,
+			       int force)
+{
+  clib_mem_main_t *mm = &clib_mem_main;
+  clib_bitmap_t *bmp = 0;
+  int rv;
+
+  /* no numa support */
+  if (mm->numa_node_bitmap == 0)
+    {
+      if (numa_node)
+	{
+	  vec_reset_length (mm->error);
+	  mm->error = clib_error_return (mm->error, "%s: numa not supported",
+					 (char *) __func__);
+	  return CLIB_MEM_ERROR;
+	}
+      else
+	return 0;
+    }
+
+  bmp = clib_bitmap_set (bmp, numa_node, 1);
+
+  /* only sets the policy of the range, pages are placed when faulted in */
+  rv = syscall (__NR_mbind, start, size, force ? MPOL_BIND : MPOL_PREFERRED,
+		bmp, vec_len (bmp) * sizeof (bmp[0]) * 8 + 1, 0);
+
+  clib_bitmap_free (bmp);
+  vec_reset_length (mm->error);
+
+  if (rv)
+    {
+      mm->error = clib_error_return_unix (mm->error, (char *) __func__);
+      return CLIB_MEM_ERROR;
+    }
+
+  return 0;
+}
+
 __clib_export int
 clib_mem_set_default_numa_affinity ()
 {
@@ -71,7 +71,7 @@ clib_mem_vm_map_shared (void *base, uword size, int fd, uword offset,
   return rv;
 }
 
-u8 *
+__clib_export u8 *
 format_clib_mem_page_stats (u8 * s, va_list * va)
 {
   clib_mem_page_stats_t *stats = va_arg (*va, clib_mem_page_stats_t *);
@@ -419,6 +419,8 @@ u64 *clib_mem_vm_get_paddr (void *mem, clib_mem_page_sz_t log2_page_size,
 void clib_mem_destroy (void);
 int clib_mem_set_numa_affinity (u8 numa_node, int force);
 int clib_mem_set_default_numa_affinity ();
+int clib_mem_vm_set_numa_affinity (void *start, uword size, u8 numa_node,
+				   int force);
 void clib_mem_vm_randomize_va (uword * requested_va,
 			       clib_mem_page_sz_t log2_page_size);
 void mheap_trace (clib_mem_heap_t * v, int enable);
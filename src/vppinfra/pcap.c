@@ -38,7 +38,10 @@
  */
 
 #include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <vppinfra/pcap.h>
+#include <vppinfra/pcap_funcs.h>
 
 /**
  * @file
@@ -257,6 +260,131 @@ done:
 
 }
 
+/**
+ * @brief Map PCAP file
+ *
+ * Packet data stays in the mapped file: only offsets, lengths and
+ * timestamps are read, so arbitrarily large captures can be used.
+ * Packets truncated in the capture are indexed with their stored length.
+ *
+ * @return rc - clib_error_t
+ *
+ */
+__clib_export clib_error_t *
+pcap_map (pcap_main_t * pm)
+{
+  clib_error_t *error = 0;
+  pcap_file_header_t fh;
+  pcap_packet_header_t ph;
+  struct stat st;
+  u64 offset;
+  int fd, need_swap;
+  void *map;
+
+  fd = open (pm->file_name, O_RDONLY);
+  if (fd < 0)
+    return clib_error_return_unix (0, "open `%s'", pm->file_name);
+
+  if (fstat (fd, &st) < 0)
+    {
+      error = clib_error_return_unix (0, "stat `%s'", pm->file_name);
+      goto done;
+    }
+
+  if (st.st_size < sizeof (fh))
+    {
+      error = clib_error_return (0, "short file `%s'", pm->file_name);
+      goto done;
+    }
+
+  map = mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED)
+    {
+      error = clib_error_return_unix (0, "mmap `%s'", pm->file_name);
+      goto done;
+    }
+
+  pm->file_map = map;
+  pm->file_map_size = st.st_size;
+
+  clib_memcpy_fast (&fh, pm->file_map, sizeof (fh));
+
+  need_swap = 0;
+  if (fh.magic == 0xd4c3b2a1)
+    {
+      need_swap = 1;
+#define _(t,f) fh.f = clib_byte_swap_##t (fh.f);
+      foreach_pcap_file_header;
+#undef _
+    }
+
+  if (fh.magic != 0xa1b2c3d4)
+    {
+      error = clib_error_return (0, "bad magic `%s'", pm->file_name);
+      goto done;
+    }
+
+  pm->min_packet_bytes = 0;
+  pm->max_packet_bytes = 0;
+  offset = sizeof (fh);
+  while (offset + sizeof (ph) <= pm->file_map_size)
+    {
+      clib_memcpy_fast (&ph, pm->file_map + offset, sizeof (ph));
+      offset += sizeof (ph);
+
+      if (need_swap)
+	{
+#define _(t,f) ph.f = clib_byte_swap_##t (ph.f);
+	  foreach_pcap_packet_header;
+#undef _
+	}
+
+      if (offset + ph.n_packet_bytes_stored_in_file > pm->file_map_size)
+	{
+	  error = clib_error_return (0, "short read `%s'", pm->file_name);
+	  goto done;
+	}
+
+      if (vec_len (pm->packet_offsets) == 0)
+	pm->min_packet_bytes = pm->max_packet_bytes =
+	  ph.n_packet_bytes_stored_in_file;
+      else
+	{
+	  pm->min_packet_bytes =
+	    clib_min (pm->min_packet_bytes, ph.n_packet_bytes_stored_in_file);
+	  pm->max_packet_bytes =
+	    clib_max (pm->max_packet_bytes, ph.n_packet_bytes_stored_in_file);
+	}
+
+      vec_add1 (pm->packet_offsets, offset);
+      vec_add1 (pm->packet_lengths, ph.n_packet_bytes_stored_in_file);
+      vec_add1 (pm->timestamps,
+		((u64) ph.time_in_sec) * 1000000 + (u64) ph.time_in_usec);
+      offset += ph.n_packet_bytes_stored_in_file;
+    }
+
+done:
+  close (fd);
+  if (error)
+    pcap_unmap (pm);
+  return error;
+}
+
+/**
+ * @brief Unmap PCAP file mapped by pcap_map
+ */
+__clib_export void
+pcap_unmap (pcap_main_t * pm)
+{
+  if (pm->file_map)
+    munmap (pm->file_map, pm->file_map_size);
+  pm->file_map = 0;
+  pm->file_map_size = 0;
+  vec_free (pm->packet_offsets);
+  vec_free (pm->packet_lengths);
+  vec_free (pm->timestamps);
+}
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
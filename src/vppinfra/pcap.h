@@ -191,6 +191,14 @@ typedef struct
 
   /** Min/Max Packet bytes */
   u32 min_packet_bytes, max_packet_bytes;
+
+  /** File mapped by pcap_map. */
+  u8 *file_map;
+  uword file_map_size;
+
+  /** Offsets of packet data in the mapped file, and packet lengths. */
+  u64 *packet_offsets;
+  u32 *packet_lengths;
 } pcap_main_t;
 
 #define PCAP_DEF_PKT_TO_CAPTURE (100)
@@ -23,6 +23,12 @@ clib_error_t *pcap_write (pcap_main_t * pm);
 /** Read data from file. */
 clib_error_t *pcap_read (pcap_main_t * pm);
 
+/** Map file and index the packets in it, without copying packet data. */
+clib_error_t *pcap_map (pcap_main_t * pm);
+
+/** Unmap the file mapped by pcap_map function. */
+void pcap_unmap (pcap_main_t * pm);
+
 /** Close the file created by pcap_write function. */
 clib_error_t *pcap_close (pcap_main_t * pm);
 
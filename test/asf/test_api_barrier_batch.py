@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+
+import re
+import threading
+import time
+import unittest
+
+from asfframework import VppTestCase, VppTestRunner
+from vpp_papi import VPPApiClient
+
+
+class TestApiBarrierBatch(VppTestCase):
+    """API barrier batching Test Case"""
+
+    vpp_worker_count = 2
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestApiBarrierBatch, cls).setUpClass()
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestApiBarrierBatch, cls).tearDownClass()
+
+    def send_burst(self, n_bursts=16, n_msgs=8):
+        """Send bursts of non-mp-safe messages, each followed by an mp-safe
+        one, without waiting for replies. Return the replies expected and
+        the ones received, as (message name, context) lists."""
+        # apidir is set by the test's own api client
+        client = VPPApiClient(
+            logger=self.logger,
+            use_socket=True,
+            server_address=self.get_api_sock_path(),
+        )
+        replies = []
+        lock = threading.Lock()
+
+        def callback(msgname, msg):
+            with lock:
+                replies.append((msgname, msg.context))
+
+        client.connect("barrier-batch", do_async=True)
+        client.register_event_callback(callback)
+
+        expected = []
+        for _ in range(n_bursts):
+            for _ in range(n_msgs):
+                expected.append(("show_version_reply", client.api.show_version()))
+            expected.append(("control_ping_reply", client.api.control_ping()))
+
+        deadline = time.time() + 10
+        while time.time() < deadline:
+            with lock:
+                if len(replies) >= len(expected):
+                    break
+            time.sleep(0.05)
+        client.disconnect()
+        return expected, replies
+
+    def get_batch_stats(self):
+        out = self.vapi.cli("show api barrier-batch")
+        m = re.search(r"Batches: (\d+), messages: (\d+)", out)
+        if not m:
+            return out, 0, 0
+        return out, int(m.group(1)), int(m.group(2))
+
+    def test_barrier_batch(self):
+        """API barrier batching keeps replies in order"""
+        self.vapi.cli("clear api barrier-batch")
+
+        expected, replies = self.send_burst()
+        self.assertEqual(replies, expected)
+
+        # non-mp-safe messages shared barrier holds
+        out, n_batches, n_msgs = self.get_batch_stats()
+        self.assertGreater(n_batches, 0)
+        self.assertGreater(n_msgs, n_batches)
+        self.assertIn("Barrier hold: avg", out)
+
+        self.vapi.cli("clear api barrier-batch")
+        out = self.vapi.cli("show api barrier-batch")
+        self.assertIn("No barrier batches.", out)
+
+
+class TestApiBarrierBatchDisabled(TestApiBarrierBatch):
+    """API barrier batching disabled Test Case"""
+
+    extra_vpp_config = ["api-queue", "{", "barrier-batch-msgs", "1", "}"]
+
+    def test_barrier_batch(self):
+        """API barrier batching disabled keeps replies in order"""
+        expected, replies = self.send_burst()
+        self.assertEqual(replies, expected)
+
+        # each message takes the barrier on its own, nothing is batched
+        out, n_batches, n_msgs = self.get_batch_stats()
+        self.assertEqual(n_batches, 0)
+        self.assertIn("Barrier batching disabled.", out)
+
+
+if __name__ == "__main__":
+    unittest.main(testRunner=VppTestRunner)
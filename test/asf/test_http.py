@@ -38,5 +38,26 @@ class TestHttpTps(VppTestCase):
         self.assertEqual(len(r.read()), 1 << 20)
 
 
+class TestHttpParserUnitTests(VppTestCase):
+    """HTTP Parser Unit Tests Case"""
+
+    @classmethod
+    def setUpClass(cls):
+        cls.extra_vpp_plugin_config.append("plugin http_unittest_plugin.so { enable }")
+        super(TestHttpParserUnitTests, cls).setUpClass()
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestHttpParserUnitTests, cls).tearDownClass()
+
+    def test_http_parser(self):
+        """HTTP request/response parser"""
+        error = self.vapi.cli("test http parser all")
+
+        if error:
+            self.logger.critical(error)
+        self.assertNotIn("failed", error)
+
+
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
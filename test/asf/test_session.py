@@ -1,11 +1,13 @@
 #!/usr/bin/env python3
 
+import re
 import unittest
 
 from asfframework import tag_fixme_vpp_workers
 from asfframework import VppTestCase, VppTestRunner
 from asfframework import tag_run_solo
 from vpp_ip_route import VppIpTable, VppIpRoute, VppRoutePath
+from vpp_neighbor import VppNeighbor
 
 
 @tag_fixme_vpp_workers
@@ -105,6 +107,213 @@ class TestSession(VppTestCase):
         ip_t10.remove_vpp_config()
 
 
+@tag_fixme_vpp_workers
+class TestSessionNumaLocal(TestSession):
+    """Session Test Case with numa local segments"""
+
+    extra_vpp_config = [
+        "session",
+        "{",
+        "segment-numa-local",
+        "segment-page-size 4k",
+        "}",
+    ]
+
+    def test_segment_manager_alloc(self):
+        """Session Segment Manager Numa Local Segments"""
+
+        super(TestSessionNumaLocal, self).test_segment_manager_alloc()
+
+        # segments of the attached echo server report their pages
+        out = self.vapi.cli("show segment-manager segments verbose")
+        self.assertIn("echo_server", out)
+        stats = re.findall(r"page stats: page-size (\S+), total (\d+)", out)
+        self.assertGreater(len(stats), 0)
+        for page_size, total in stats:
+            self.assertEqual(page_size, "4K")
+            self.assertGreater(int(total), 0)
+
+        # segment memory prefers the local numa, nothing else in vpp does
+        try:
+            with open("/proc/%d/numa_maps" % self.vpp.pid) as f:
+                numa_maps = f.read()
+        except OSError:
+            self.skipTest("numa_maps not available")
+        self.assertRegex(numa_maps, r"prefer:\d+")
+
+
+@tag_fixme_vpp_workers
+class TestSessionUseBuffers(VppTestCase):
+    """Session Test Case with buffer mode rx fifos"""
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestSessionUseBuffers, cls).setUpClass()
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestSessionUseBuffers, cls).tearDownClass()
+
+    def setUp(self):
+        super(TestSessionUseBuffers, self).setUp()
+
+        self.vapi.session_enable_disable(is_enable=1)
+        self.create_loopback_interfaces(4)
+
+        # loop0/loop1 hold the apps, traffic between them leaves through
+        # loop2/loop3, which loop it back into the other table
+        self.tbl = VppIpTable(self, 1)
+        self.tbl.add_vpp_config()
+
+        for i, table_id in zip(self.lo_interfaces, [0, 1, 0, 1]):
+            i.admin_up()
+            i.set_table_ip4(table_id)
+            i.config_ip4()
+
+        self.vapi.app_namespace_add_del_v4(
+            namespace_id="0", sw_if_index=self.loop0.sw_if_index
+        )
+        self.vapi.app_namespace_add_del_v4(
+            namespace_id="1", sw_if_index=self.loop1.sw_if_index
+        )
+
+        self.nbrs = []
+        for i in [self.loop2, self.loop3]:
+            nbr = VppNeighbor(
+                self, i.sw_if_index, i.local_mac, i.remote_ip4, is_static=True
+            )
+            nbr.add_vpp_config()
+            self.nbrs.append(nbr)
+
+        self.routes = [
+            VppIpRoute(
+                self,
+                self.loop0.local_ip4,
+                32,
+                [VppRoutePath(self.loop2.remote_ip4, self.loop2.sw_if_index)],
+                table_id=1,
+            ),
+            VppIpRoute(
+                self,
+                self.loop1.local_ip4,
+                32,
+                [VppRoutePath(self.loop3.remote_ip4, self.loop3.sw_if_index)],
+            ),
+        ]
+        for r in self.routes:
+            r.add_vpp_config()
+
+    def tearDown(self):
+        for r in self.routes:
+            r.remove_vpp_config()
+        for nbr in self.nbrs:
+            nbr.remove_vpp_config()
+        for i in self.lo_interfaces:
+            i.unconfig_ip4()
+            i.set_table_ip4(0)
+            i.admin_down()
+
+        super(TestSessionUseBuffers, self).tearDown()
+        self.vapi.session_enable_disable(is_enable=1)
+
+    def run_echo_use_buffers(self):
+        uri = "tcp://" + self.loop0.local_ip4 + "/1234"
+        error = self.vapi.cli(
+            "test echo server appns 0 fifo-size 64 use-buffers uri " + uri
+        )
+        if error:
+            self.logger.critical(error)
+            self.assertNotIn("failed", error)
+
+        error = self.vapi.cli(
+            "test echo client mbytes 10 appns 1 "
+            + "fifo-size 64 no-output test-bytes "
+            + "syn-timeout 2 uri "
+            + uri
+        )
+        if error:
+            self.logger.critical(error)
+            self.assertNotIn("failed", error)
+
+        if self.vpp_dead:
+            self.assert_equal(0)
+
+    def test_echo_use_buffers(self):
+        """Echo client/server transfer with buffer mode rx fifos"""
+        self.run_echo_use_buffers()
+
+    def test_echo_use_buffers_loss(self):
+        """Echo transfer with buffer mode rx fifos and packet loss"""
+
+        # Every 100th packet is dropped, so receivers get ooo segments
+        self.vapi.cli(
+            "set nsim poll-main-thread delay 1 ms bandwidth 1 gbit "
+            + "packet-size 1500 packets-per-drop 100"
+        )
+        for i in [self.loop2, self.loop3]:
+            self.vapi.cli("nsim output-feature enable-disable " + i.name)
+
+        self.run_echo_use_buffers()
+
+        ooo = self.statistics.get_err_counter("/err/tcp4-established/enqueued_ooo")
+        self.assertGreater(ooo, 0)
+
+        for i in [self.loop2, self.loop3]:
+            self.vapi.cli("nsim output-feature enable-disable %s disable" % i.name)
+
+
+@tag_fixme_vpp_workers
+class TestSessionUdpGso(TestSessionUseBuffers):
+    """Session Test Case with udp gso super-buffers"""
+
+    extra_vpp_config = ["udp", "{", "gso", "}"]
+
+    def test_echo_udp_gso(self):
+        """Echo client/server udp transfer with gso super-buffers"""
+
+        # Only client to server traffic leaves through a gso interface
+        self.vapi.feature_gso_enable_disable(
+            sw_if_index=self.loop2.sw_if_index, enable_disable=1
+        )
+
+        uri = "udp://" + self.loop0.local_ip4 + "/1234"
+        error = self.vapi.cli(
+            "test echo server appns 0 fifo-size 1024 no-echo uri " + uri
+        )
+        if error:
+            self.logger.critical(error)
+            self.assertNotIn("failed", error)
+
+        # Client enqueues runs of dgrams the session layer can chain
+        error = self.vapi.cli(
+            "test echo client mbytes 10 appns 1 "
+            + "fifo-size 1024 no-output no-return dgram-burst 64 "
+            + "syn-timeout 2 uri "
+            + uri
+        )
+        if error:
+            self.logger.critical(error)
+            self.assertNotIn("failed", error)
+
+        self.vapi.cli("test echo server stop")
+        self.vapi.feature_gso_enable_disable(
+            sw_if_index=self.loop2.sw_if_index, enable_disable=0
+        )
+
+        # Every buffer sent by the session layer carried several dgrams,
+        # at most its limit of 64, and all of them made it to the server
+        n_sent = self.statistics.get_err_counter("/err/udp4-output/pkts_sent")
+        tx = self.statistics.get_counter("/interfaces/loop2/tx")
+        n_dgrams = sum(t["packets"] for t in tx)
+        self.assertGreater(n_sent, 0)
+        self.assertGreater(n_dgrams, 2 * n_sent)
+        self.assertLessEqual(n_dgrams, 64 * n_sent)
+
+        enq = self.statistics.get_err_counter("/err/udp4-input/enqueued")
+        accept = self.statistics.get_err_counter("/err/udp4-input/accept")
+        self.assertEqual(enq + accept, n_dgrams)
+
+
 @tag_fixme_vpp_workers
 class TestSessionUnitTests(VppTestCase):
     """Session Unit Tests Case"""
@@ -150,5 +150,189 @@ class TestTLS(VppTestCase):
         ip_t10.remove_vpp_config()
 
 
+class TestTLSRecordOffload(TestTLS):
+    """TLS Record Offload Test Case."""
+
+    extra_vpp_config = [
+        "tls",
+        "{",
+        "record-offload",
+        "record-key-update",
+        "64",
+        "}",
+    ]
+
+    def test_tls_record_offload(self):
+        """TLS record offload echo transfer with key updates"""
+
+        # Add inter-table routes
+        ip_t01 = VppIpRoute(
+            self,
+            self.loop1.local_ip4,
+            32,
+            [VppRoutePath("0.0.0.0", 0xFFFFFFFF, nh_table_id=1)],
+        )
+
+        ip_t10 = VppIpRoute(
+            self,
+            self.loop0.local_ip4,
+            32,
+            [VppRoutePath("0.0.0.0", 0xFFFFFFFF, nh_table_id=0)],
+            table_id=1,
+        )
+        ip_t01.add_vpp_config()
+        ip_t10.add_vpp_config()
+
+        # Start builtin server and client, server records use vnet crypto
+        uri = "tls://" + self.loop0.local_ip4 + "/1234"
+        error = self.vapi.cli(
+            "test echo server appns 0 fifo-size 64 tls-engine 1 uri " + uri
+        )
+        if error:
+            self.logger.critical(error)
+            self.assertNotIn("failed", error)
+
+        error = self.vapi.cli(
+            "test echo client mbytes 10 appns 1 "
+            "fifo-size 64 no-output test-bytes "
+            "tls-engine 1 "
+            "syn-timeout 2 uri " + uri
+        )
+        if error:
+            self.logger.critical(error)
+            self.assertNotIn("failed", error)
+
+        # Server asked for key updates and client answered with its own
+        prefix = "/err/tls-openssl-rec-flush"
+        tx = self.statistics.get_err_counter(f"{prefix}/tx_key_update")
+        rx = self.statistics.get_err_counter(f"{prefix}/rx_key_update")
+        self.assertGreater(tx, 0)
+        self.assertGreater(rx, 0)
+
+        # Delete inter-table routes
+        ip_t01.remove_vpp_config()
+        ip_t10.remove_vpp_config()
+
+
+class TestTLSResume(TestTLS):
+    """TLS Session Resumption Test Case."""
+
+    extra_vpp_config = [
+        "tls",
+        "{",
+        "ticket-key-lifetime",
+        "10",
+        "}",
+    ]
+
+    def setUp(self):
+        super(TestTLSResume, self).setUp()
+
+        # Add inter-table routes
+        self.routes = [
+            VppIpRoute(
+                self,
+                self.loop1.local_ip4,
+                32,
+                [VppRoutePath("0.0.0.0", 0xFFFFFFFF, nh_table_id=1)],
+            ),
+            VppIpRoute(
+                self,
+                self.loop0.local_ip4,
+                32,
+                [VppRoutePath("0.0.0.0", 0xFFFFFFFF, nh_table_id=0)],
+                table_id=1,
+            ),
+        ]
+        for r in self.routes:
+            r.add_vpp_config()
+        self.uri = "tls://" + self.loop0.local_ip4 + "/1234"
+
+    def tearDown(self):
+        self.vapi.cli("test echo server stop")
+        for r in self.routes:
+            r.remove_vpp_config()
+        super(TestTLSResume, self).tearDown()
+
+    def start_server(self, options=""):
+        error = self.vapi.cli(
+            "test echo server appns 0 fifo-size 64 tls-engine 1 %s uri %s"
+            % (options, self.uri)
+        )
+        if error:
+            self.logger.critical(error)
+            self.assertNotIn("failed", error)
+
+    def connect(self, options=""):
+        """Run one echo client connection, return handshake stats delta"""
+        before = self.get_tls_stats()
+        error = self.vapi.cli(
+            "test echo client bytes 1000 appns 1 fifo-size 64 no-output "
+            "test-bytes tls-engine 1 syn-timeout 2 %s uri %s" % (options, self.uri)
+        )
+        if error:
+            self.logger.critical(error)
+            self.assertNotIn("failed", error)
+        after = self.get_tls_stats()
+        return {k: after[k] - before[k] for k in after}
+
+    def get_tls_stats(self):
+        out = self.vapi.cli("show tls stats")
+        return {
+            k: int(v)
+            for k, v in re.findall(r"^(\w+ \w+) handshakes\s+(\d+)", out, re.M)
+        }
+
+    def assert_handshake(self, stats, resumed):
+        full = 0 if resumed else 1
+        for side in ["server", "client"]:
+            self.assertEqual(stats[side + " full"], full)
+            self.assertEqual(stats[side + " resumed"], 1 - full)
+
+    def test_tls_resume(self):
+        """TLS session resumption on reconnect"""
+
+        self.start_server()
+        self.connect()
+
+        # the client cache keeps the session for the next connections
+        self.assert_handshake(self.connect(), resumed=True)
+        self.assert_handshake(self.connect(), resumed=True)
+
+        # unless the client asks for a full handshake
+        self.assert_handshake(self.connect("tls-no-resume"), resumed=False)
+        self.assert_handshake(self.connect("tls-no-resume"), resumed=False)
+
+    def test_tls_resume_server_no_resume(self):
+        """TLS server refusing session resumption"""
+
+        self.start_server("tls-no-resume")
+        self.connect()
+        self.assert_handshake(self.connect(), resumed=False)
+        self.assert_handshake(self.connect(), resumed=False)
+
+    def test_tls_resume_ticket_key_rotation(self):
+        """TLS session resumption across ticket key rotation"""
+
+        self.start_server()
+        self.connect()
+
+        # the retired key still decrypts tickets, which are then renewed
+        self.virtual_sleep(15)
+        self.assert_handshake(self.connect(), resumed=True)
+        out = self.vapi.cli("show tls stats")
+        self.assertIn("ticket key 0 age 0s", out)
+        self.assertIn("ticket key 1 age 15s", out)
+
+        # the renewed ticket is still good before its key expires
+        self.virtual_sleep(15)
+        self.assert_handshake(self.connect(), resumed=True)
+
+        # keys are dropped after two lifetimes, full handshake again
+        self.virtual_sleep(25)
+        self.assert_handshake(self.connect(), resumed=False)
+        self.assert_handshake(self.connect(), resumed=True)
+
+
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
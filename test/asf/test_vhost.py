@@ -1,12 +1,158 @@
 #!/usr/bin/env python3
 
+import mmap
+import os
+import re
+import socket
+import struct
 import unittest
 
+from scapy.layers.l2 import Ether
+from scapy.layers.inet import IP, UDP
+from scapy.packet import Raw
+
 from asfframework import VppTestCase, VppTestRunner
+from vpp_papi import VppEnum
 
 from vpp_vhost_interface import VppVhostInterface
 
 
+class VhostUserFrontend:
+    """Minimal vhost-user driver, one queue pair of split vrings in a memfd"""
+
+    GET_FEATURES = 1
+    SET_FEATURES = 2
+    SET_OWNER = 3
+    SET_MEM_TABLE = 5
+    SET_VRING_NUM = 8
+    SET_VRING_ADDR = 9
+    SET_VRING_BASE = 10
+    SET_VRING_KICK = 12
+    SET_VRING_CALL = 13
+    VRING_NOFD = 0x100
+    F_ANY_LAYOUT = 1 << 27
+    F_VERSION_1 = 1 << 32
+    DESC_F_WRITE = 2
+    HDR_SZ = 12
+    BUF_SZ = 2048
+    # guest physical addresses are offsets in the memfd, user ones are not
+    USER_ADDR = 1 << 40
+
+    def __init__(self, sock_filename, qsz=1024):
+        self.sock_filename = sock_filename
+        self.qsz = qsz
+        # split vring layout, the used ring is page aligned
+        self.avail_off = 16 * qsz
+        self.used_off = self.page_align(self.avail_off + 6 + 2 * qsz)
+        self.ring_sz = self.page_align(self.used_off + 6 + 8 * qsz)
+        self.mem_sz = 2 * (self.ring_sz + qsz * self.BUF_SZ)
+        self.avail_idx = [0, 0]
+        self.last_rx = 0
+
+    @staticmethod
+    def page_align(n):
+        return (n + 4095) & ~4095
+
+    def desc(self, q):
+        return q * self.ring_sz
+
+    def avail(self, q):
+        return self.desc(q) + self.avail_off
+
+    def used(self, q):
+        return self.desc(q) + self.used_off
+
+    def buf(self, q, i):
+        return 2 * self.ring_sz + (q * self.qsz + i) * self.BUF_SZ
+
+    def msg(self, request, payload=b"", fds=None):
+        hdr = struct.pack("=III", request, 1, len(payload))
+        anc = []
+        if fds:
+            anc = [(socket.SOL_SOCKET, socket.SCM_RIGHTS, struct.pack("=i", *fds))]
+        self.sock.sendmsg([hdr + payload], anc)
+
+    def connect(self):
+        self.fd = os.memfd_create("vhost-user-frontend")
+        os.ftruncate(self.fd, self.mem_sz)
+        self.mem = mmap.mmap(self.fd, self.mem_sz)
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.connect(self.sock_filename)
+
+        self.msg(self.SET_OWNER)
+        self.msg(self.GET_FEATURES)
+        _, _, size = struct.unpack("=III", self.sock.recv(12))
+        (features,) = struct.unpack("=Q", self.sock.recv(size))
+        features &= self.F_ANY_LAYOUT | self.F_VERSION_1
+        self.msg(self.SET_FEATURES, struct.pack("=Q", features))
+        region = struct.pack("=QQQQ", 0, self.mem_sz, self.USER_ADDR, 0)
+        self.msg(self.SET_MEM_TABLE, struct.pack("=II", 1, 0) + region, [self.fd])
+        for q in range(2):
+            self.msg(self.SET_VRING_CALL, struct.pack("=Q", q | self.VRING_NOFD))
+            self.msg(self.SET_VRING_NUM, struct.pack("=II", q, self.qsz))
+            self.msg(self.SET_VRING_BASE, struct.pack("=II", q, 0))
+            self.msg(
+                self.SET_VRING_ADDR,
+                struct.pack(
+                    "=IIQQQQ",
+                    q,
+                    0,
+                    self.USER_ADDR + self.desc(q),
+                    self.USER_ADDR + self.used(q),
+                    self.USER_ADDR + self.avail(q),
+                    0,
+                ),
+            )
+            # without kick fd the vring is started right away
+            self.msg(self.SET_VRING_KICK, struct.pack("=Q", q | self.VRING_NOFD))
+
+    def close(self):
+        self.sock.close()
+        self.mem.close()
+        os.close(self.fd)
+
+    def add_desc(self, q, data, flags, length):
+        i = self.avail_idx[q] % self.qsz
+        struct.pack_into(
+            "=QIHH", self.mem, self.desc(q) + 16 * i, self.buf(q, i), length, flags, 0
+        )
+        if data:
+            self.mem[self.buf(q, i) : self.buf(q, i) + len(data)] = data
+        struct.pack_into("=H", self.mem, self.avail(q) + 4 + 2 * i, i)
+        self.avail_idx[q] += 1
+
+    def kick(self, q):
+        struct.pack_into("=H", self.mem, self.avail(q) + 2, self.avail_idx[q] & 0xFFFF)
+
+    def post_rx(self, n):
+        """Give n receive buffers to vpp"""
+        for _ in range(n):
+            self.add_desc(0, None, self.DESC_F_WRITE, self.BUF_SZ)
+        self.kick(0)
+
+    def send(self, pkts):
+        """Send packets to vpp, after a zeroed virtio net header"""
+        for p in pkts:
+            data = bytes(self.HDR_SZ) + bytes(p)
+            self.add_desc(1, data, 0, len(data))
+        self.kick(1)
+
+    def used_idx(self, q):
+        return struct.unpack_from("=H", self.mem, self.used(q) + 2)[0]
+
+    def recv(self):
+        """Packets received since the last call, without virtio net header"""
+        pkts = []
+        used_idx = self.used_idx(0)
+        while self.last_rx != used_idx:
+            i = self.last_rx % self.qsz
+            id, length = struct.unpack_from("=II", self.mem, self.used(0) + 4 + 8 * i)
+            addr = self.buf(0, id) + self.HDR_SZ
+            pkts.append(bytes(self.mem[addr : self.buf(0, id) + length]))
+            self.last_rx = (self.last_rx + 1) & 0xFFFF
+        return pkts
+
+
 class TesVhostInterface(VppTestCase):
     """Vhost User Test Case"""
 
@@ -140,6 +286,145 @@ class TesVhostInterface(VppTestCase):
         self.logger.info("Deleting VirtualEthernet")
         vhost_if.remove_vpp_config()
 
+    def test_vhost_interface_use_dma(self):
+        """Vhost User interface with dma offload test"""
+
+        # use-dma is cli only, it falls back to cpu copies without backend
+        self.vapi.cli(
+            "create vhost-user socket /tmp/sock1 server use-dma dma-threshold 128"
+        )
+        if_dump = self.vapi.sw_interface_vhost_user_dump()
+        self.assert_equal(len(if_dump), 1, "number of vhost interfaces")
+        sw_if_index = if_dump[0].sw_if_index
+
+        self.vapi.sw_interface_set_flags(
+            sw_if_index,
+            flags=VppEnum.vl_api_if_status_flags_t.IF_STATUS_API_FLAG_ADMIN_UP,
+        )
+        self.assertIn("VirtualEthernet0/0/0", self.vapi.cli("show vhost-user"))
+
+        # deleting it must not leave batches pointing at the interface
+        self.vapi.delete_vhost_user_if(sw_if_index)
+        if_dump = self.vapi.sw_interface_vhost_user_dump()
+        self.assert_equal(len(if_dump), 0, "number of vhost interfaces")
+
+        # the shared dma config is kept for the next interface
+        self.vapi.cli("create vhost-user socket /tmp/sock2 server use-dma")
+        if_dump = self.vapi.sw_interface_vhost_user_dump()
+        self.assert_equal(len(if_dump), 1, "number of vhost interfaces")
+        self.vapi.delete_vhost_user_if(if_dump[0].sw_if_index)
+
+
+class TestVhostUserDma(VppTestCase):
+    """Vhost User DMA Traffic Test Case"""
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestVhostUserDma, cls).setUpClass()
+        cls.create_pg_interfaces(range(1))
+        for i in cls.pg_interfaces:
+            i.admin_up()
+
+        # The test backend completes batches two seconds after they were
+        # submitted, and runs out of them after the first one, so vhost
+        # does the copies of the next frames on the cpu meanwhile. It must
+        # be there before the first use-dma interface.
+        cls.dma_delay = 2
+        cls.vapi.cli("test dma backend delay %d max-batches 1" % cls.dma_delay)
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestVhostUserDma, cls).tearDownClass()
+
+    def setUp(self):
+        super(TestVhostUserDma, self).setUp()
+
+        sock_filename = "%s/vhost-dma.sock" % self.tempdir
+        self.vapi.cli(
+            "create vhost-user socket %s server use-dma dma-threshold 64"
+            % sock_filename
+        )
+        [vhost] = self.vapi.sw_interface_vhost_user_dump()
+        self.sw_if_index = vhost.sw_if_index
+        self.vapi.sw_interface_set_flags(
+            self.sw_if_index,
+            flags=VppEnum.vl_api_if_status_flags_t.IF_STATUS_API_FLAG_ADMIN_UP,
+        )
+        self.vapi.cli("set interface rx-mode %s polling" % vhost.interface_name)
+        self.vapi.sw_interface_set_l2_xconnect(
+            self.pg0.sw_if_index, self.sw_if_index, enable=1
+        )
+        self.vapi.sw_interface_set_l2_xconnect(
+            self.sw_if_index, self.pg0.sw_if_index, enable=1
+        )
+
+        self.frontend = VhostUserFrontend(sock_filename)
+        self.frontend.connect()
+        self.frontend.post_rx(self.frontend.qsz)
+        for _ in range(50):
+            [ifc] = self.vapi.sw_interface_dump(sw_if_index=self.sw_if_index)
+            if ifc.flags & VppEnum.vl_api_if_status_flags_t.IF_STATUS_API_FLAG_LINK_UP:
+                break
+            self.sleep(0.1)
+        else:
+            self.fail("vhost-user interface did not come up")
+
+    def tearDown(self):
+        super(TestVhostUserDma, self).tearDown()
+        if not self.vpp_dead:
+            self.vapi.delete_vhost_user_if(self.sw_if_index)
+        self.frontend.close()
+
+    def dma_submitted(self):
+        out = self.vapi.cli("test dma backend")
+        return int(re.search(r"submitted (\d+)", out).group(1))
+
+    def create_packets(self, first, n, src, dst):
+        return [
+            Ether(src=src, dst=dst)
+            / IP(src="10.0.0.1", dst="10.0.0.2")
+            / UDP(sport=1234, dport=1234)
+            / Raw(b"%08d" % i + bytes(150))
+            for i in range(first, first + n)
+        ]
+
+    def test_vhost_dma_tx_order(self):
+        """Vhost User tx with dma and cpu copies in flight together"""
+
+        # the second burst is copied by the cpu while the dma batch of the
+        # first one is in flight, its used index must wait for that batch
+        bursts = [
+            self.create_packets(0, 256, self.pg0.remote_mac, self.pg0.local_mac),
+            self.create_packets(256, 100, self.pg0.remote_mac, self.pg0.local_mac),
+        ]
+        submitted = self.dma_submitted()
+        for pkts in bursts:
+            self.pg_send(self.pg0, pkts)
+        self.assertEqual(self.frontend.used_idx(0), 0)
+
+        self.sleep(2 * self.dma_delay)
+        rx = self.frontend.recv()
+        self.assertEqual(rx, [bytes(p) for p in bursts[0] + bursts[1]])
+        self.assertEqual(self.dma_submitted(), submitted + 1)
+
+    def test_vhost_dma_rx_order(self):
+        """Vhost User rx with dma and cpu copies in flight together"""
+
+        # the second half is received while the dma batch of the first one
+        # is in flight, it must neither overtake it nor let the driver
+        # reuse descriptors before it completes
+        pkts = self.create_packets(0, 64, self.pg0.local_mac, self.pg0.remote_mac)
+        self.pg_enable_capture(self.pg_interfaces)
+        self.frontend.send(pkts[:32])
+        self.sleep(0.2)
+        self.frontend.send(pkts[32:])
+        self.sleep(0.2)
+        self.assertEqual(self.frontend.used_idx(1), 0)
+
+        rx = self.pg0.get_capture(64, timeout=2 * self.dma_delay + 1)
+        self.assertEqual([bytes(p) for p in rx], [bytes(p) for p in pkts])
+        self.assertEqual(self.frontend.used_idx(1), 64)
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
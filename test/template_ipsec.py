@@ -1891,6 +1891,67 @@ class IpsecTun4HandoffTests(IpsecTun4):
         self.verify_counters4(p, 4 * N_PKTS, worker=0)
 
 
+class IpsecTun4MultiWorkerTests(IpsecTun4):
+    """UT test methods for Tunnel v4 with multi-worker SAs"""
+
+    vpp_worker_count = 2
+
+    def test_tun_multi_worker_44(self):
+        """ipsec 4o4 tunnel multi-worker SA test"""
+        self.vapi.cli("clear errors")
+        self.vapi.cli("clear ipsec sa")
+
+        N_PKTS = 15
+        p = self.params[socket.AF_INET]
+
+        # inject alternately on worker 0 and 1. there is no hand-off so
+        # each worker counts the packets it received
+        for worker in [0, 1, 0, 1]:
+            send_pkts = self.gen_encrypt_pkts(
+                p,
+                p.scapy_tun_sa,
+                self.tun_if,
+                src=p.remote_tun_if_host,
+                dst=self.pg1.remote_ip4,
+                count=N_PKTS,
+            )
+            recv_pkts = self.send_and_expect(
+                self.tun_if, send_pkts, self.pg1, worker=worker
+            )
+            self.verify_decrypted(p, recv_pkts)
+
+            send_pkts = self.gen_pkts(
+                self.pg1,
+                src=self.pg1.remote_ip4,
+                dst=p.remote_tun_if_host,
+                count=N_PKTS,
+            )
+            recv_pkts = self.send_and_expect(
+                self.pg1, send_pkts, self.tun_if, worker=worker
+            )
+            self.verify_encrypted(p, p.vpp_tun_sa, recv_pkts)
+
+        for worker in [0, 1]:
+            pkts = p.tun_sa_in.get_stats(worker)["packets"]
+            self.assertEqual(pkts, 2 * N_PKTS)
+            pkts = p.tun_sa_out.get_stats(worker)["packets"]
+            self.assertEqual(pkts, 2 * N_PKTS)
+
+        # replays are dropped whichever worker they arrive on
+        replay = self.gen_encrypt_pkts(
+            p,
+            p.scapy_tun_sa,
+            self.tun_if,
+            src=p.remote_tun_if_host,
+            dst=self.pg1.remote_ip4,
+            count=1,
+        )
+        self.send_and_expect(self.tun_if, replay, self.pg1, worker=0)
+        self.pg_send(self.tun_if, replay, worker=1)
+        self.pg1.assert_nothing_captured()
+        self.assertEqual(p.tun_sa_in.get_err("replay"), 1)
+
+
 class IpsecTun46Tests(IpsecTun4Tests, IpsecTun6Tests):
     """UT test methods for Tunnel v6 & v4"""
 
@@ -2,6 +2,8 @@
 """ACL plugin Test Case HLD:
 """
 
+import re
+import time
 import unittest
 import random
 
@@ -1620,6 +1622,65 @@ class TestACLplugin(VppTestCase):
 
         self.logger.info("ACLP_TEST_FINISH_0315")
 
+    def wait_for_dtree_ready(self, timeout=5):
+        """Wait for the rebuild process to publish the trees"""
+        deadline = time.time() + timeout
+        while True:
+            reply = self.vapi.cli("show acl-plugin tables dtree")
+            ready = re.findall(r"lc_index (\d+): engine dtree ready 1", reply)
+            if ready or time.time() > deadline:
+                break
+            self.sleep(0.01)
+        self.logger.info(reply)
+        self.assertNotEqual(len(ready), 0, "dtree not built in %ss" % timeout)
+        return ready
+
+    def run_tcp_permit_v4_dtree(self):
+        # Add an ACL
+        rules = []
+        rules.append(
+            self.create_rule(
+                self.IPV4, self.DENY, self.PORTS_RANGE_2, self.proto[self.IP][self.TCP]
+            )
+        )
+        rules.append(
+            self.create_rule(
+                self.IPV4, self.PERMIT, self.PORTS_RANGE, self.proto[self.IP][self.TCP]
+            )
+        )
+        # deny ip any any in the end
+        rules.append(self.create_rule(self.IPV4, self.DENY, self.PORTS_ALL, 0))
+
+        # Apply rules
+        self.apply_rules(rules, "permit ipv4 tcp dtree")
+
+        # Trees are rebuilt in the background
+        ready = self.wait_for_dtree_ready()
+
+        # Traffic should still pass
+        self.run_verify_test(self.IP, self.IPV4, self.proto[self.IP][self.TCP])
+
+        # Both engines must agree on every lookup
+        for lc_index in ready:
+            reply = self.vapi.cli(
+                "test acl-plugin lookup-engine lc_index %s count 10000" % lc_index
+            )
+            self.logger.info(reply)
+            self.assertIn("mismatches: 0", reply)
+
+    def test_0400_tcp_permit_v4_dtree(self):
+        """permit TCPv4 + non-match range, decision tree lookup"""
+        self.logger.info("ACLP_TEST_START_0400")
+
+        self.vapi.cli("set acl-plugin lookup-engine dtree")
+        try:
+            self.run_tcp_permit_v4_dtree()
+        finally:
+            # The engine is a global setting, later tests expect hash
+            self.vapi.cli("set acl-plugin lookup-engine hash")
+
+        self.logger.info("ACLP_TEST_FINISH_0400")
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
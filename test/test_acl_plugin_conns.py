@@ -20,7 +20,7 @@ from ipaddress import ip_network
 from vpp_acl import AclRule, VppAcl, VppAclInterface
 
 
-def to_acl_rule(self, is_permit, wildcard_sport=False):
+def to_acl_rule(self, is_permit, wildcard_sport=False, tcp_flags=None):
     p = self
     rule_family = AF_INET6 if p.haslayer(IPv6) else AF_INET
     rule_prefix_len = 128 if p.haslayer(IPv6) else 32
@@ -49,6 +49,10 @@ def to_acl_rule(self, is_permit, wildcard_sport=False):
         dport_from=rule_l4_dport,
         dport_to=rule_l4_dport,
     )
+    if tcp_flags is not None:
+        # match packets with exactly these flags among SYN/ACK/FIN/RST
+        new_rule.tcp_flags_mask = 0x17
+        new_rule.tcp_flags_value = tcp_flags
 
     return new_rule
 
@@ -71,14 +75,14 @@ class IterateWithSleep:
 
 
 class Conn(L4_Conn):
-    def apply_acls(self, reflect_side, acl_side):
+    def apply_acls(self, reflect_side, acl_side, tcp_flags=None):
         pkts = []
         pkts.append(self.pkt(0))
         pkts.append(self.pkt(1))
         pkt = pkts[reflect_side]
 
         r = []
-        r.append(pkt.to_acl_rule(2, wildcard_sport=True))
+        r.append(pkt.to_acl_rule(2, wildcard_sport=True, tcp_flags=tcp_flags))
         r.append(self.wildcard_rule(0))
         reflect_acl = VppAcl(self.testcase, r)
         reflect_acl.add_vpp_config()
@@ -112,6 +116,7 @@ class Conn(L4_Conn):
             )
             acl_if0.add_vpp_config()
             acl_if1.add_vpp_config()
+        return reflect_acl
 
     def wildcard_rule(self, is_permit):
         any_addr = ["0.0.0.0", "::"]
@@ -236,6 +241,57 @@ class ACLPluginConnTestCase(VppTestCase):
             p2 = None
         self.assert_equal(p2, None, "packet on supposedly deleted conn")
 
+    def run_incremental_reclassify_conn_test(self, af, acl_side):
+        """Change the ACL, only the affected conn goes away"""
+        conn1 = Conn(self, self.pg0, self.pg1, af, UDP, 43001, 4343)
+        conn2 = Conn(self, self.pg0, self.pg1, af, UDP, 43002, 4343)
+        reflect_acl = conn1.apply_acls(0, acl_side)
+        conn1.send_through(0)
+        conn1.send_through(1)
+        conn2.send_through(0)
+        conn2.send_through(1)
+        self.vapi.ppcli("set acl-plugin reclassify-sessions 1")
+        self.vapi.ppcli("set acl-plugin reclassify-sessions incremental 1")
+        # deny conn2 ahead of the reflect rule
+        rules = [conn2.pkt(0).to_acl_rule(0)] + reflect_acl.rules
+        reflect_acl.modify_vpp_config(rules)
+        self.sleep(0.2)
+        # the conn1 is not affected by the change
+        conn1.send_through(1)
+        try:
+            p2 = conn2.send_through(1).command()
+        except:
+            # If we asserted while waiting, it's good.
+            # the conn should have been reclassified and deleted.
+            p2 = None
+        self.vapi.ppcli("set acl-plugin reclassify-sessions incremental 0")
+        self.vapi.ppcli("set acl-plugin reclassify-sessions 0")
+        self.assert_equal(p2, None, "packet on reclassified conn")
+
+    def run_incremental_reclassify_tcp_flags_test(self, af, acl_side):
+        """Reclassify an established conn created by a SYN-only rule"""
+        conn1 = Conn(self, self.pg0, self.pg1, af, TCP, 53011, 5353)
+        reflect_acl = conn1.apply_acls(0, acl_side, tcp_flags=0x02)
+        conn1.send_through(0, "S")
+        conn1.send_through(1, "SA")
+        conn1.send_through(0, "A")
+        conn1.send_through(1, "A")
+        self.vapi.ppcli("set acl-plugin reclassify-sessions 1")
+        self.vapi.ppcli("set acl-plugin reclassify-sessions incremental 1")
+        # look up all the sessions again, not just the matching ones
+        self.vapi.ppcli("set acl-plugin reclassify-sessions max-changed-rules 0")
+        # an unrelated change ahead of the SYN-only reflect rule
+        other = Conn(self, self.pg0, self.pg1, af, TCP, 53012, 5454)
+        rules = [other.pkt(0).to_acl_rule(0)] + reflect_acl.rules
+        reflect_acl.modify_vpp_config(rules)
+        self.sleep(0.2)
+        self.vapi.ppcli("set acl-plugin reclassify-sessions max-changed-rules 64")
+        self.vapi.ppcli("set acl-plugin reclassify-sessions incremental 0")
+        self.vapi.ppcli("set acl-plugin reclassify-sessions 0")
+        # the conn still matches the SYN-only rule and must survive
+        conn1.send_through(1, "A")
+        conn1.send_through(0, "A")
+
     def run_tcp_transient_setup_conn_test(self, af, acl_side):
         conn1 = Conn(self, self.pg0, self.pg1, af, TCP, 53001, 5151)
         conn1.apply_acls(0, acl_side)
@@ -327,6 +383,14 @@ class ACLPluginConnTestCase(VppTestCase):
         """IPv4: reflect ingress, clear conn"""
         self.run_clear_conn_test(AF_INET, 0)
 
+    def test_0007_incremental_reclassify_conn_test(self):
+        """IPv4: reflect ingress, incremental reclassify"""
+        self.run_incremental_reclassify_conn_test(AF_INET, 0)
+
+    def test_0008_incremental_reclassify_conn_test(self):
+        """IPv4: reflect egress, incremental reclassify"""
+        self.run_incremental_reclassify_conn_test(AF_INET, 1)
+
     def test_0011_active_conn_test(self):
         """IPv4: Idle conn behind active conn, reflect on ingress"""
         self.run_active_conn_test(AF_INET, 0)
@@ -391,6 +455,14 @@ class ACLPluginConnTestCase(VppTestCase):
         """IPv4: transient TCP session (3WHS,ACK,FINACK), ref. on egress"""
         self.run_tcp_transient_teardown_conn_test(AF_INET, 1)
 
+    def test_2007_incremental_reclassify_tcp_flags_test(self):
+        """IPv4: SYN-only reflect ingress, reclassify established TCP"""
+        self.run_incremental_reclassify_tcp_flags_test(AF_INET, 0)
+
+    def test_2008_incremental_reclassify_tcp_flags_test(self):
+        """IPv4: SYN-only reflect egress, reclassify established TCP"""
+        self.run_incremental_reclassify_tcp_flags_test(AF_INET, 1)
+
     def test_3001_tcp_transient_conn_test(self):
         """IPv6: transient TCP session (incomplete 3WHS), ref. on ingress"""
         self.run_tcp_transient_setup_conn_test(AF_INET6, 0)
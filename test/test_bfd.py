@@ -7,6 +7,7 @@ import binascii
 from collections import namedtuple
 import hashlib
 import ipaddress
+import re
 import reprlib
 import time
 import unittest
@@ -1727,6 +1728,66 @@ class BFD4TestCase(VppTestCase):
         self.assertFalse(vpp_session.query_vpp_config())
 
 
+class BFD4WorkerTestCase(VppTestCase):
+    """Bidirectional Forwarding Detection (BFD) - sessions on workers"""
+
+    vpp_worker_count = 2
+    pg0 = None
+    vpp_clock_offset = None
+    vpp_session = None
+    test_session = None
+
+    @classmethod
+    def setUpClass(cls):
+        super(BFD4WorkerTestCase, cls).setUpClass()
+        try:
+            cls.create_pg_interfaces([0])
+            cls.pg0.config_ip4()
+            cls.pg0.configure_ipv4_neighbors()
+            cls.pg0.admin_up()
+            cls.pg0.resolve_arp()
+
+        except Exception:
+            super(BFD4WorkerTestCase, cls).tearDownClass()
+            raise
+
+    @classmethod
+    def tearDownClass(cls):
+        super(BFD4WorkerTestCase, cls).tearDownClass()
+
+    def setUp(self):
+        super(BFD4WorkerTestCase, self).setUp()
+        self.vapi.want_bfd_events()
+        self.pg0.enable_capture()
+        try:
+            self.vpp_session = VppBFDUDPSession(self, self.pg0, self.pg0.remote_ip4)
+            self.vpp_session.add_vpp_config()
+            self.vpp_session.admin_up()
+            self.test_session = BFDTestSession(self, self.pg0, AF_INET)
+        except BaseException:
+            self.vapi.want_bfd_events(enable_disable=0)
+            raise
+
+    def tearDown(self):
+        if not self.vpp_dead:
+            self.vapi.want_bfd_events(enable_disable=0)
+        self.vapi.collect_events()  # clear the event queue
+        super(BFD4WorkerTestCase, self).tearDown()
+
+    def test_hold_up_on_worker(self):
+        """hold BFD session up from its home worker"""
+        bfd_session_up(self)
+        for dummy in range(self.test_session.detect_mult * 2):
+            wait_for_bfd_packet(self)
+            self.test_session.send_packet()
+        self.assert_equal(len(self.vapi.collect_events()), 0, "number of bfd events")
+        # sessions are homed on workers only, never on main
+        reply = self.vapi.cli("show bfd sessions")
+        home = re.search(r"Home thread\s+(\d+)", reply)
+        self.assertIsNotNone(home)
+        self.assert_in_range(int(home.group(1)), 1, self.vpp_worker_count)
+
+
 @tag_run_solo
 @tag_fixme_vpp_workers
 @tag_fixme_ubuntu2204
@@ -409,6 +409,39 @@ class Flowprobe(MethodHolder):
         ipfix.remove_vpp_config()
         self.logger.info("FFP_TEST_FINISH_0002")
 
+    def test_sampling(self):
+        """1:N deterministic packet sampling"""
+        self.logger.info("FFP_TEST_START_0003")
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pkts = []
+
+        ipfix = VppCFLOW(test=self, active=2)
+        ipfix.add_vpp_config()
+        self.vapi.flowprobe_set_sampling(sampling_rate=5, is_random=False)
+        params = self.vapi.flowprobe_get_params()
+        self.assertEqual(params.sampling_rate, 5)
+        self.assertFalse(params.sampling_random)
+
+        ipfix_decoder = IPFIXDecoder()
+        # template packet should arrive immediately
+        templates = ipfix.verify_templates(ipfix_decoder)
+
+        # one flow, 2 out of 10 packets are metered and each of them
+        # accounts for 5, so the record matches what was sent
+        self.create_stream(packets=10, size=128)
+        self.send_packets()
+        capture = self.pg2.get_capture(10)
+
+        cflow = self.wait_for_cflow_packet(self.collector, templates[1], 15)
+        self.verify_cflow_data(ipfix_decoder, capture, cflow)
+        self.assert_error_counter_equal(
+            "/err/flowprobe-output-l2/Packets not sampled", 8
+        )
+
+        self.vapi.flowprobe_set_sampling(sampling_rate=1)
+        ipfix.remove_vpp_config()
+        self.logger.info("FFP_TEST_FINISH_0003")
+
     def test_cflow_packet(self):
         """verify cflow packet fields"""
         self.logger.info("FFP_TEST_START_0000")
@@ -379,6 +379,76 @@ class TestGSO(VppTestCase):
             sw_if_index=self.pg1.sw_if_index, enable_disable=0
         )
 
+    def test_gso_udp(self):
+        """GSO UDP test"""
+        #
+        # UDP GSO frames are segmented into independent datagrams when the
+        # egress interface only supports TCP GSO
+        #
+        self.vapi.feature_gso_enable_disable(
+            sw_if_index=self.pg3.sw_if_index, enable_disable=1
+        )
+        p41 = (
+            Ether(src=self.pg2.remote_mac, dst=self.pg2.local_mac)
+            / IP(src=self.pg2.remote_ip4, dst=self.pg3.remote_ip4, flags="DF")
+            / UDP(sport=1234, dport=1234)
+            / Raw(b"\xa5" * 14600)
+        )
+
+        rxs = self.send_and_expect(self.pg2, 5 * [p41], self.pg3, 50)
+        size = 0
+        for rx in rxs:
+            self.assertEqual(rx[Ether].src, self.pg3.local_mac)
+            self.assertEqual(rx[Ether].dst, self.pg3.remote_mac)
+            self.assertEqual(rx[IP].src, self.pg2.remote_ip4)
+            self.assertEqual(rx[IP].dst, self.pg3.remote_ip4)
+            self.assert_ip_checksum_valid(rx)
+            self.assert_udp_checksum_valid(rx, ignore_zero_checksum=False)
+            self.assertEqual(rx[UDP].len, 8 + 1460)
+            self.assertEqual(len(rx[Raw]), 1460)
+            size += len(rx[Raw])
+        self.assertEqual(size, 14600 * 5)
+
+        p61 = (
+            Ether(src=self.pg2.remote_mac, dst=self.pg2.local_mac)
+            / IPv6(src=self.pg2.remote_ip6, dst=self.pg3.remote_ip6)
+            / UDP(sport=1234, dport=1234)
+            / Raw(b"\xa5" * 14600)
+        )
+
+        rxs = self.send_and_expect(self.pg2, 5 * [p61], self.pg3, 50)
+        size = 0
+        for rx in rxs:
+            self.assertEqual(rx[IPv6].src, self.pg2.remote_ip6)
+            self.assertEqual(rx[IPv6].dst, self.pg3.remote_ip6)
+            self.assert_udp_checksum_valid(rx, ignore_zero_checksum=False)
+            self.assertEqual(rx[IPv6].plen, 8 + 1460)
+            self.assertEqual(len(rx[Raw]), 1460)
+            size += len(rx[Raw])
+        self.assertEqual(size, 14600 * 5)
+
+        #
+        # Datagrams larger than a buffer can not be segmented into single
+        # buffer segments, they are dropped instead of being split at the
+        # wrong size. pg4 has a gso size of 8940
+        #
+        self.vapi.sw_interface_set_mtu(self.pg4.sw_if_index, [9000, 0, 0, 0])
+        p44 = (
+            Ether(src=self.pg4.remote_mac, dst=self.pg4.local_mac)
+            / IP(src=self.pg4.remote_ip4, dst=self.pg3.remote_ip4)
+            / UDP(sport=1234, dport=1234)
+            / Raw(b"\xa5" * 17880)
+        )
+        self.send_and_assert_no_replies(self.pg4, 5 * [p44])
+        err = self.statistics.get_err_counter(
+            "/err/gso-ip4/udp gso size exceeds buffer size"
+        )
+        self.assertEqual(err, 5)
+
+        self.vapi.feature_gso_enable_disable(
+            sw_if_index=self.pg3.sw_if_index, enable_disable=0
+        )
+
     def test_gso_vxlan(self):
         """GSO VXLAN test"""
         self.logger.info(self.vapi.cli("sh int addr"))
@@ -1092,6 +1162,106 @@ class TestGSO(VppTestCase):
 
         self.vapi.feature_gso_enable_disable(self.pg0.sw_if_index, enable_disable=0)
 
+    def test_gso_ipsec_encrypt(self):
+        """GSO IPSEC segmentation in esp-encrypt test"""
+        #
+        # Send jumbo frame with gso enabled only on input interface,
+        # the IPIP tunnel has no gso feature so esp-encrypt segments
+        # the packet itself before encrypting the segments.
+        #
+        self.ipip4.add_vpp_config()
+
+        self.ip4_via_ip4_tunnel = VppIpRoute(
+            self,
+            "172.16.10.0",
+            24,
+            [
+                VppRoutePath(
+                    "0.0.0.0",
+                    self.ipip4.sw_if_index,
+                    proto=FibPathProto.FIB_PATH_NH_PROTO_IP4,
+                )
+            ],
+        )
+        self.ip4_via_ip4_tunnel.add_vpp_config()
+
+        # IPSec config
+        self.ipv4_params = IPsecIPv4Params()
+        self.encryption_type = ESP
+        config_tun_params(self.ipv4_params, self.encryption_type, self.ipip4)
+
+        self.tun_sa_in_v4 = VppIpsecSA(
+            self,
+            self.ipv4_params.scapy_tun_sa_id,
+            self.ipv4_params.scapy_tun_spi,
+            self.ipv4_params.auth_algo_vpp_id,
+            self.ipv4_params.auth_key,
+            self.ipv4_params.crypt_algo_vpp_id,
+            self.ipv4_params.crypt_key,
+            VppEnum.vl_api_ipsec_proto_t.IPSEC_API_PROTO_ESP,
+        )
+        self.tun_sa_in_v4.add_vpp_config()
+
+        self.tun_sa_out_v4 = VppIpsecSA(
+            self,
+            self.ipv4_params.vpp_tun_sa_id,
+            self.ipv4_params.vpp_tun_spi,
+            self.ipv4_params.auth_algo_vpp_id,
+            self.ipv4_params.auth_key,
+            self.ipv4_params.crypt_algo_vpp_id,
+            self.ipv4_params.crypt_key,
+            VppEnum.vl_api_ipsec_proto_t.IPSEC_API_PROTO_ESP,
+        )
+        self.tun_sa_out_v4.add_vpp_config()
+
+        self.tun_protect_v4 = VppIpsecTunProtect(
+            self, self.ipip4, self.tun_sa_out_v4, [self.tun_sa_in_v4]
+        )
+        self.tun_protect_v4.add_vpp_config()
+
+        self.ipip4.admin_up()
+        self.ipip4.set_unnumbered(self.pg0.sw_if_index)
+
+        n_segmented = self.statistics.get_err_counter(
+            "/err/esp4-encrypt-tun/gso_segmented"
+        )
+
+        ipsec44 = (
+            Ether(src=self.pg2.remote_mac, dst="02:fe:60:1e:a2:79")
+            / IP(src=self.pg2.remote_ip4, dst="172.16.10.3", flags="DF")
+            / TCP(sport=1234, dport=1234)
+            / Raw(b"\xa5" * 65200)
+        )
+
+        rxs = self.send_and_expect(self.pg2, [ipsec44], self.pg0, 45)
+        size = 0
+        seq = 0
+        for rx in rxs:
+            self.assertEqual(rx[IP].src, self.pg0.local_ip4)
+            self.assertEqual(rx[IP].dst, self.pg0.remote_ip4)
+            self.assertEqual(rx[IP].proto, 50)  # ESP
+            self.assertEqual(rx[ESP].spi, self.ipv4_params.vpp_tun_spi)
+            # segments are encrypted in order
+            self.assertGreater(rx[ESP].seq, seq)
+            seq = rx[ESP].seq
+            inner = self.ipv4_params.vpp_tun_sa.decrypt(rx[IP])
+            self.assertEqual(inner[IP].src, self.pg2.remote_ip4)
+            self.assertEqual(inner[IP].dst, "172.16.10.3")
+            self.assert_ip_checksum_valid(inner)
+            self.assert_tcp_checksum_valid(inner)
+            size += inner[IP].len - 20 - 20
+        self.assertEqual(size, 65200)
+        self.assertEqual(
+            self.statistics.get_err_counter("/err/esp4-encrypt-tun/gso_segmented"),
+            n_segmented + 1,
+        )
+
+        self.tun_protect_v4.remove_vpp_config()
+        self.tun_sa_in_v4.remove_vpp_config()
+        self.tun_sa_out_v4.remove_vpp_config()
+        self.ip4_via_ip4_tunnel.remove_vpp_config()
+        self.ipip4.remove_vpp_config()
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
@@ -6,6 +6,7 @@ import unittest
 from framework import tag_fixme_vpp_workers
 from framework import VppTestCase, VppTestRunner
 from template_bd import BridgeDomain
+from config import config
 
 from scapy.layers.l2 import Ether
 from scapy.packet import Raw
@@ -249,6 +250,65 @@ class TestGtpu(BridgeDomain, VppTestCase):
         # payload = self.decapsulate(pkt)
         # self.assert_eq_pkts(payload, self.frame_reply)
 
+    @unittest.skipUnless(config.extended, "part of extended tests")
+    def test_decap_scale(self):
+        """Decapsulation with many tunnels
+        Create a large number of tunnels sharing a GTPU path and
+        send frames to a sample of their TEIDs and to unknown ones
+        Verify the known TEIDs are decapsulated and forwarded on pg0
+        and the unknown ones are dropped
+        """
+        n_tunnels = 4096
+        teid_start = 100000
+        tunnels = []
+        for teid in range(teid_start, teid_start + n_tunnels):
+            r = self.vapi.gtpu_add_del_tunnel(
+                is_add=True,
+                mcast_sw_if_index=0xFFFFFFFF,
+                decap_next_index=2,  # ip4-input
+                src_address=self.pg0.local_ip4,
+                dst_address=self.pg0.remote_ip4,
+                teid=teid,
+            )
+            self.vapi.sw_interface_set_unnumbered(
+                sw_if_index=self.pg0.sw_if_index,
+                unnumbered_sw_if_index=r.sw_if_index,
+            )
+            tunnels.append(teid)
+
+        known = tunnels[::16]
+        unknown = range(teid_start + n_tunnels, teid_start + n_tunnels + 16)
+        pkts = []
+        for teid in list(known) + list(unknown):
+            pkts.append(
+                Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac)
+                / IP(src=self.pg0.remote_ip4, dst=self.pg0.local_ip4)
+                / UDP(sport=self.dport, dport=self.dport, chksum=0)
+                / GTP_U_Header(teid=teid, gtp_type=self.gtp_type)
+                / IP(src="1.2.3.4", dst=self.pg0.remote_ip4)
+                / UDP(sport=1234, dport=teid & 0xFFFF)
+                / Raw(b"\xa5" * 100)
+            )
+
+        rx = self.send_and_expect(self.pg0, pkts, self.pg0, n_rx=len(known))
+        self.assertEqual(
+            sorted(p[UDP].dport for p in rx),
+            sorted(teid & 0xFFFF for teid in known),
+        )
+        self.assert_error_counter_equal(
+            "/err/gtpu4-input/no such tunnel packets", len(unknown)
+        )
+
+        for teid in tunnels:
+            self.vapi.gtpu_add_del_tunnel(
+                is_add=False,
+                mcast_sw_if_index=0xFFFFFFFF,
+                decap_next_index=2,
+                src_address=self.pg0.local_ip4,
+                dst_address=self.pg0.remote_ip4,
+                teid=teid,
+            )
+
     @classmethod
     def create_gtpu_flood_test_bd(cls, teid, n_ucast_tunnels):
         # Create 10 ucast gtpu tunnels under bd
@@ -25,6 +25,7 @@ from template_ipsec import (
     IpsecTun6,
     IpsecTun6HandoffTests,
     IpsecTun4HandoffTests,
+    IpsecTun4MultiWorkerTests,
     IpsecTra6ExtTests,
 )
 from vpp_ipsec import VppIpsecSpd, VppIpsecSpdEntry, VppIpsecSA, VppIpsecSpdItfBinding
@@ -822,6 +823,37 @@ class TestIpsecEspAsync(TemplateIpsecEsp):
         self.p_async.spd.remove_vpp_config()
         self.p_async.sa.remove_vpp_config()
 
+    def test_sw_scheduler_queue_depth(self):
+        """sw_scheduler reports pending frames only"""
+        self.vapi.ipsec_set_async_mode(async_enable=True)
+
+        pkts = [
+            (
+                Ether(src=self.pg1.remote_mac, dst=self.pg1.local_mac)
+                / IP(src=self.pg1.remote_ip4, dst=self.p_async.remote_tun_if_host)
+                / UDP(sport=4444, dport=4444)
+                / Raw(b"0x0" * 200)
+            )
+        ] * 257
+
+        self.send_and_expect(self.pg1, pkts, self.pg0, worker=1)
+
+        # every frame has been claimed and completed, so none of the
+        # queues may report a depth; the work shows up as processed
+        processed = 0
+        for line in self.vapi.cli("show sw_scheduler workers").splitlines()[1:]:
+            fields = line.split()
+            processed += int(fields[3])
+            self.assertEqual(int(fields[5]), 0)
+            self.assertEqual(int(fields[6]), 0)
+        self.assertGreaterEqual(processed, 1)
+
+        self.p_sync.spd.remove_vpp_config()
+        self.p_sync.sa.remove_vpp_config()
+        self.p_async.spd.remove_vpp_config()
+        self.p_async.sa.remove_vpp_config()
+        self.vapi.ipsec_set_async_mode(async_enable=False)
+
 
 class TestIpsecEspHandoff(
     TemplateIpsecEsp, IpsecTun6HandoffTests, IpsecTun4HandoffTests
@@ -831,6 +863,16 @@ class TestIpsecEspHandoff(
     pass
 
 
+class TestIpsecEspMultiWorker(TemplateIpsecEsp, IpsecTun4MultiWorkerTests):
+    """Ipsec ESP - multi-worker SA tests"""
+
+    def config_network(self, params):
+        saf = VppEnum.vl_api_ipsec_sad_flags_t
+        for p in params:
+            p.flags |= saf.IPSEC_API_SAD_FLAG_MULTI_WORKER
+        super(TestIpsecEspMultiWorker, self).config_network(params)
+
+
 class TemplateIpsecEspUdp(ConfigIpsecESP):
     """
     UDP encapped ESP
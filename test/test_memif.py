@@ -1,14 +1,16 @@
+import re
 import socket
 import unittest
 
 from scapy.layers.l2 import Ether
-from scapy.layers.inet import IP, ICMP
+from scapy.layers.inet import IP, ICMP, TCP
+from scapy.packet import Raw
 
 from framework import VppTestCase, VppTestRunner
 from framework import tag_run_solo, tag_fixme_debian11, is_distro_debian11
 from asf.remote_test import RemoteClass, RemoteVppTestCase
 from vpp_memif import remove_all_memif_vpp_config, VppSocketFilename, VppMemif
-from vpp_ip_route import VppIpRoute, VppRoutePath
+from vpp_ip_route import VppIpTable, VppIpRoute, VppRoutePath
 from vpp_papi import VppEnum
 
 
@@ -46,6 +48,9 @@ class TestMemif(VppTestCase):
             pg.config_ip4()
             pg.admin_up()
             pg.resolve_arp()
+        # gso frames for the offload tests, pg1 is configured by them
+        cls.create_pg_interfaces(range(1, 2), 1, 1000)
+        cls.pg_interfaces = [cls.pg0, cls.pg1]
 
     @classmethod
     def tearDownClass(cls):
@@ -346,6 +351,215 @@ class TestMemif(VppTestCase):
         remote_memif.remove_vpp_config()
         remote_socket.remove_vpp_config()
 
+    def _create_cli_memif(self, test, role, args, socket_id=0):
+        """Create a memif with the cli, which has the offload option"""
+        memif = VppMemif(
+            test,
+            role,
+            VppEnum.vl_api_memif_mode_t.MEMIF_MODE_API_ETHERNET,
+            socket_id=socket_id,
+        )
+        old = [d.sw_if_index for d in test.vapi.memif_dump()]
+        if role == VppEnum.vl_api_memif_role_t.MEMIF_ROLE_API_MASTER:
+            args = "master " + args
+        else:
+            args = "slave " + args
+        test.vapi.cli("create interface memif socket-id %d %s" % (socket_id, args))
+        for d in test.vapi.memif_dump():
+            if d.sw_if_index not in old:
+                memif.sw_if_index = d.sw_if_index
+        return memif
+
+    def _memif_offload_round_trip(
+        self, local_args, remote_args, pkts, n_rx, pg_args=""
+    ):
+        """Send pkts from pg1 over a local slave memif created with
+        local_args to a remote master one created with remote_args, which
+        routes them back to pg0. Return the n_rx packets captured on pg0,
+        the number of packets the remote memif received and whether the
+        peers negotiated offload."""
+        remote_socket = VppSocketFilename(
+            self.remote_test, 1, "%s/memif.sock" % self.tempdir
+        )
+        remote_socket.add_vpp_config()
+
+        memif = self._create_cli_memif(
+            self, VppEnum.vl_api_memif_role_t.MEMIF_ROLE_API_SLAVE, local_args
+        )
+        remote_memif = self._create_cli_memif(
+            self.remote_test,
+            VppEnum.vl_api_memif_role_t.MEMIF_ROLE_API_MASTER,
+            remote_args,
+            socket_id=1,
+        )
+        memif.admin_up()
+        remote_memif.admin_up()
+        self.assertTrue(memif.wait_for_link_up(5))
+        self.assertTrue(remote_memif.wait_for_link_up(5))
+
+        # both sides report the same outcome of the negotiation
+        name = memif.query_vpp_config().if_name
+        remote_name = remote_memif.query_vpp_config().if_name
+        out = self.vapi.cli("show memif %s" % name)
+        remote_out = self.remote_test.vapi.cli("show memif %s" % remote_name)
+        negotiated = "offload negotiated" in out
+        self.assertEqual(negotiated, "offload negotiated" in remote_out)
+
+        self.vapi.cli("set interface ip address %s 10.10.0.1/24" % name)
+        self.remote_test.vapi.cli(
+            "set interface ip address %s 10.10.0.2/24" % remote_name
+        )
+        self.vapi.cli(
+            "set ip neighbor %s 10.10.0.2 %s"
+            % (name, remote_memif.query_vpp_config().hw_addr)
+        )
+        self.remote_test.vapi.cli(
+            "set ip neighbor %s 10.10.0.1 %s"
+            % (remote_name, memif.query_vpp_config().hw_addr)
+        )
+
+        # pg1 has its own table, where pg0 is behind the remote vpp
+        table = VppIpTable(self, 1)
+        table.add_vpp_config()
+        self.pg1.set_table_ip4(1)
+        self.pg1.config_ip4()
+        self.pg1.admin_up()
+        route = VppIpRoute(
+            self,
+            self.pg0.remote_ip4,
+            32,
+            [VppRoutePath("10.10.0.2", memif.sw_if_index)],
+            table_id=1,
+        )
+        route.add_vpp_config()
+        remote_route = VppIpRoute(
+            self.remote_test,
+            self.pg0._local_ip4_subnet,
+            24,
+            [VppRoutePath("10.10.0.1", 0xFFFFFFFF)],
+            register=False,
+        )
+        remote_route.add_vpp_config()
+
+        # super-frames are segmented on their way out to pg0, and before
+        # crossing memif when it has no offload
+        for sw_if_index in [self.pg0.sw_if_index, memif.sw_if_index]:
+            self.vapi.feature_gso_enable_disable(
+                sw_if_index=sw_if_index, enable_disable=1
+            )
+
+        self.remote_test.vapi.cli("clear interfaces")
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg1.add_stream(pkts)
+        if pg_args:
+            # recreate the stream with buffer flags, add_stream has none
+            self.vapi.cli("packet-generator delete %s" % self.pg1.get_cap_name())
+            self.vapi.cli("%s %s" % (self.pg1.get_input_cli(), pg_args))
+        self.pg_start()
+        rx = self.pg0.get_capture(n_rx, timeout=2)
+
+        out = self.remote_test.vapi.cli("show interface %s" % remote_name)
+        n_remote_rx = int(re.search(r"rx packets\s+(\d+)", out).group(1))
+
+        for sw_if_index in [self.pg0.sw_if_index, memif.sw_if_index]:
+            self.vapi.feature_gso_enable_disable(
+                sw_if_index=sw_if_index, enable_disable=0
+            )
+        remote_route.remove_vpp_config()
+        route.remove_vpp_config()
+        self.pg1.unconfig_ip4()
+        self.pg1.set_table_ip4(0)
+        table.remove_vpp_config()
+        memif.remove_vpp_config()
+        remote_memif.remove_vpp_config()
+        remote_socket.remove_vpp_config()
+
+        return rx, n_remote_rx, negotiated
+
+    def _create_tcp(self, num, size, chksum=None):
+        pkts = []
+        for i in range(num):
+            pkt = (
+                Ether(dst=self.pg1.local_mac, src=self.pg1.remote_mac)
+                / IP(src=self.pg1.remote_ip4, dst=self.pg0.remote_ip4, flags="DF")
+                / TCP(sport=1234, dport=1234, seq=i * size, chksum=chksum)
+                / Raw(bytes([i]) * size)
+            )
+            pkts.append(pkt)
+        return pkts
+
+    def _verify_tcp(self, rx, size):
+        self.assertEqual(rx[Ether].src, self.pg0.local_mac)
+        self.assertEqual(rx[Ether].dst, self.pg0.remote_mac)
+        self.assertEqual(rx[IP].src, self.pg1.remote_ip4)
+        self.assertEqual(rx[IP].dst, self.pg0.remote_ip4)
+        self.assert_ip_checksum_valid(rx)
+        self.assert_tcp_checksum_valid(rx)
+        self.assertEqual(len(rx[Raw]), size)
+
+    def test_memif_offload_negotiation(self):
+        """Memif offload negotiation with plain peers"""
+
+        # offload is only used when both sides ask for it, either side can
+        # be plain and the link still comes up and carries traffic
+        pkts = self._create_tcp(5, 200)
+        for local_args, remote_args, expected in [
+            ("offload", "offload", True),
+            ("offload", "", False),
+            ("", "offload", False),
+            ("offload no-zero-copy", "offload", True),
+        ]:
+            rx, n_remote_rx, negotiated = self._memif_offload_round_trip(
+                local_args, remote_args, pkts, len(pkts)
+            )
+            self.assertEqual(negotiated, expected)
+            self.assertEqual(n_remote_rx, len(pkts))
+            for r in rx:
+                self._verify_tcp(r, 200)
+
+    def test_memif_offload_gso(self):
+        """Memif offload gso metadata"""
+
+        # 9000 byte payloads leave pg1 as super-frames with a gso size of
+        # 1000, they only cross memif unsegmented when offload is agreed,
+        # on the zero-copy and copy paths
+        pkts = self._create_tcp(5, 9000)
+        for local_args, remote_args, n_expected in [
+            ("offload", "offload", 5),
+            ("offload no-zero-copy", "offload", 5),
+            ("offload", "", 45),
+        ]:
+            rx, n_remote_rx, negotiated = self._memif_offload_round_trip(
+                local_args, remote_args, pkts, 45
+            )
+            self.assertEqual(n_remote_rx, n_expected)
+            for r in rx:
+                self._verify_tcp(r, 1000)
+
+    def test_memif_offload_checksum(self):
+        """Memif offload checksum metadata"""
+
+        # tcp checksums are left to the output interface: with offload they
+        # are only filled in once the packets are back from the remote vpp,
+        # which relies on the metadata crossing memif both ways
+        pkts = self._create_tcp(5, 200, chksum=0)
+        for local_args, remote_args in [
+            ("offload", "offload"),
+            ("offload no-zero-copy", "offload"),
+            ("offload", ""),
+        ]:
+            rx, n_remote_rx, negotiated = self._memif_offload_round_trip(
+                local_args,
+                remote_args,
+                pkts,
+                len(pkts),
+                pg_args="buffer-flags ip4 offload "
+                "buffer-offload-flags offload-tcp-cksum",
+            )
+            self.assertEqual(n_remote_rx, len(pkts))
+            for r in rx:
+                self._verify_tcp(r, 200)
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
@@ -4892,6 +4892,118 @@ class TestNAT44EDMW(TestNAT44ED):
 
         self.assertGreaterEqual(err, sessions_per_batch)
 
+    def test_dynamic_port_block(self):
+        """NAT44ED dynamic translation test: port block allocation"""
+
+        block_size = 64
+        n_sessions = block_size + 16
+
+        self.plugin_disable()
+        self.vapi.cli(
+            f"nat44 plugin enable sessions {self.max_sessions} "
+            f"port-block-size {block_size}"
+        )
+
+        self.nat_add_inside_interface(self.pg0)
+        self.nat_add_outside_interface(self.pg1)
+        self.nat_add_address(self.nat_addr)
+
+        # all sessions of the inside host share one block, the ones which
+        # don't fit in the block are dropped
+        pkts = self.create_udp_stream(self.pg0, self.pg1, n_sessions)
+        self.pg0.add_stream(pkts)
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+        capture = self.pg1.get_capture(block_size)
+
+        err = self.statistics.get_err_counter(
+            "/err/nat44-ed-in2out-slowpath/out of ports"
+        )
+        self.assertEqual(err, n_sessions - block_size)
+
+        rx = re.compile(
+            f" *{self.pg0.remote_ip4} fib 0 -> {self.nat_addr} "
+            f"ports ([0-9]+)-([0-9]+) sessions ([0-9]+)"
+        )
+        out = self.vapi.cli("show nat44 port blocks")
+        blocks = [m.groups() for m in map(rx.match, out.splitlines()) if m]
+        self.assertEqual(len(blocks), 1)
+        start, end, n = (int(x) for x in blocks[0])
+        self.assertEqual(end - start + 1, block_size)
+        self.assertEqual(n, block_size)
+
+        ports = set()
+        for p in capture:
+            self.assertEqual(p[IP].src, self.nat_addr)
+            self.assertGreaterEqual(p[UDP].sport, start)
+            self.assertLessEqual(p[UDP].sport, end)
+            self.assertNotIn(p[UDP].sport, ports)
+            ports.add(p[UDP].sport)
+
+        # the block is released with its last session
+        self.nat_add_address(self.nat_addr, is_add=0)
+        out = self.vapi.cli("show nat44 port blocks")
+        blocks = [m for m in map(rx.match, out.splitlines()) if m]
+        self.assertEqual(len(blocks), 0)
+
+    def verify_syslog_port_block(self, message, start, end):
+        sd_params = message.sd.get("napmap")
+        self.assertTrue(sd_params is not None)
+        self.assertEqual(sd_params.get("IATYP"), "IPv4")
+        self.assertEqual(sd_params.get("ISADDR"), self.pg0.remote_ip4)
+        self.assertEqual(sd_params.get("XATYP"), "IPv4")
+        self.assertEqual(sd_params.get("XSADDR"), self.nat_addr)
+        self.assertEqual(sd_params.get("XSPORT"), "%d-%d" % (start, end))
+        self.assertEqual(sd_params.get("SVLAN"), "0")
+
+    # put zzz in front of syslog test name so that it runs as a last test
+    # setting syslog sender cannot be undone and if it is set, it messes
+    # with self.send_and_assert_no_replies functionality
+    def test_zzz_syslog_port_block(self):
+        """NAT44ED Test syslog port block allocation and release"""
+        block_size = 64
+
+        self.plugin_disable()
+        self.vapi.cli(
+            f"nat44 plugin enable sessions {self.max_sessions} "
+            f"port-block-size {block_size}"
+        )
+        self.vapi.syslog_set_filter(self.syslog_severity.SYSLOG_API_SEVERITY_INFO)
+        self.vapi.syslog_set_sender(self.pg3.local_ip4, self.pg3.remote_ip4)
+
+        self.nat_add_address(self.nat_addr)
+        self.nat_add_inside_interface(self.pg0)
+        self.nat_add_outside_interface(self.pg1)
+
+        p = (
+            Ether(dst=self.pg0.local_mac, src=self.pg0.remote_mac)
+            / IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4)
+            / UDP(sport=self.udp_port_in, dport=20)
+        )
+        self.pg_enable_capture(self.pg_interfaces)
+        capture = self.send_and_expect(self.pg0, p, self.pg1)
+        port = capture[0][UDP].sport
+
+        # session and port block creation
+        capture = self.pg3.get_capture(2)
+        messages = [SyslogMessage.parse(c[Raw].load.decode("utf-8")) for c in capture]
+        added = [m for m in messages if m.msgid == "APMADD"]
+        self.assertEqual(len(added), 1)
+        start, end = (int(x) for x in added[0].sd["napmap"]["XSPORT"].split("-"))
+        self.assertEqual(end - start + 1, block_size)
+        self.assertGreaterEqual(port, start)
+        self.assertLessEqual(port, end)
+        self.verify_syslog_port_block(added[0], start, end)
+
+        # updating the session limit drops the per-thread db, the block
+        # goes away with it and has to be reported
+        self.pg_enable_capture(self.pg_interfaces)
+        self.vapi.nat44_set_session_limit(session_limit=self.max_sessions, vrf_id=0)
+        capture = self.pg3.get_capture(1)
+        message = SyslogMessage.parse(capture[0][Raw].load.decode("utf-8"))
+        self.assertEqual(message.msgid, "APMDEL")
+        self.verify_syslog_port_block(message, start, end)
+
 
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
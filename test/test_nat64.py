@@ -2,6 +2,7 @@
 
 import ipaddress
 import random
+import re
 import socket
 import struct
 import unittest
@@ -791,6 +792,134 @@ class TestNAT64(VppTestCase):
         bibs = self.statistics.get_counter("/nat64/total-bibs")
         self.assertEqual(bibs[0][0], 0)
 
+    def test_static_bib_port_refcount(self):
+        """Static BIB entries own their outside port"""
+        in_addr = "2001:db8:85a3::8a2e:370:7334"
+        out_port = 5678
+
+        self.vapi.nat64_add_del_pool_addr_range(
+            start_addr=self.nat_addr,
+            end_addr=self.nat_addr,
+            vrf_id=0xFFFFFFFF,
+            is_add=1,
+        )
+
+        self.vapi.nat64_add_del_static_bib(
+            i_addr=in_addr,
+            o_addr=self.nat_addr,
+            i_port=1234,
+            o_port=out_port,
+            proto=IP_PROTOS.udp,
+            vrf_id=0,
+            is_add=1,
+        )
+        self.assertEqual(self.nat64_get_busy_ports("udp"), 1)
+
+        # outside port can not be shared with another static BIB entry
+        with self.vapi.assert_negative_api_retval():
+            self.vapi.nat64_add_del_static_bib(
+                i_addr=in_addr,
+                o_addr=self.nat_addr,
+                i_port=1235,
+                o_port=out_port,
+                proto=IP_PROTOS.udp,
+                vrf_id=0,
+                is_add=1,
+            )
+        self.assertEqual(self.nat64_get_busy_ports("udp"), 1)
+
+        # deleting the entry frees the port for the other one
+        self.vapi.nat64_add_del_static_bib(
+            i_addr=in_addr,
+            o_addr=self.nat_addr,
+            i_port=1234,
+            o_port=out_port,
+            proto=IP_PROTOS.udp,
+            vrf_id=0,
+            is_add=0,
+        )
+        self.assertEqual(self.nat64_get_busy_ports("udp"), 0)
+
+        self.vapi.nat64_add_del_static_bib(
+            i_addr=in_addr,
+            o_addr=self.nat_addr,
+            i_port=1235,
+            o_port=out_port,
+            proto=IP_PROTOS.udp,
+            vrf_id=0,
+            is_add=1,
+        )
+        self.assertEqual(self.nat64_get_busy_ports("udp"), 1)
+        self.vapi.nat64_add_del_static_bib(
+            i_addr=in_addr,
+            o_addr=self.nat_addr,
+            i_port=1235,
+            o_port=out_port,
+            proto=IP_PROTOS.udp,
+            vrf_id=0,
+            is_add=0,
+        )
+        self.assertEqual(self.nat64_get_busy_ports("udp"), 0)
+
+    def test_dynamic_port_refcount(self):
+        """Expired dynamic BIB entry releases its outside port"""
+        self.vapi.nat64_add_del_pool_addr_range(
+            start_addr=self.nat_addr,
+            end_addr=self.nat_addr,
+            vrf_id=0xFFFFFFFF,
+            is_add=1,
+        )
+        flags = self.config_flags.NAT_IS_INSIDE
+        self.vapi.nat64_add_del_interface(
+            is_add=1, flags=flags, sw_if_index=self.pg0.sw_if_index
+        )
+        self.vapi.nat64_add_del_interface(
+            is_add=1, flags=0, sw_if_index=self.pg1.sw_if_index
+        )
+        self.vapi.nat64_set_timeouts(
+            udp=5, tcp_established=7440, tcp_transitory=240, icmp=60
+        )
+
+        p = (
+            Ether(dst=self.pg0.local_mac, src=self.pg0.remote_mac)
+            / IPv6(src=self.pg0.remote_ip6, dst="64:ff9b::" + self.pg1.remote_ip4)
+            / UDP(sport=self.udp_port_in, dport=20)
+        )
+        self.pg0.add_stream(p)
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+        capture = self.pg1.get_capture(1)
+        out_port = capture[0][UDP].sport
+        self.assertEqual(self.nat64_get_busy_ports("udp"), 1)
+
+        # port is held by the dynamic BIB entry
+        with self.vapi.assert_negative_api_retval():
+            self.vapi.nat64_add_del_static_bib(
+                i_addr=self.pg0.remote_ip6,
+                o_addr=self.nat_addr,
+                i_port=1234,
+                o_port=out_port,
+                proto=IP_PROTOS.udp,
+                vrf_id=0,
+                is_add=1,
+            )
+
+        self.virtual_sleep(15)
+        self.assertEqual(self.nat64_get_ses_num(), 0)
+        self.assertEqual(self.nat64_get_busy_ports("udp"), 0)
+
+        # and released once the session expired
+        self.vapi.nat64_add_del_static_bib(
+            i_addr=self.pg0.remote_ip6,
+            o_addr=self.nat_addr,
+            i_port=1234,
+            o_port=out_port,
+            proto=IP_PROTOS.udp,
+            vrf_id=0,
+            is_add=1,
+        )
+        self.assertEqual(self.nat64_get_busy_ports("udp"), 1)
+
     def test_set_timeouts(self):
         """Set NAT64 timeouts"""
         # verify default values
@@ -2052,6 +2181,15 @@ class TestNAT64(VppTestCase):
         st = self.vapi.nat64_st_dump(proto=255)
         return len(st)
 
+    def nat64_get_busy_ports(self, proto):
+        """
+        Return number of busy outside ports of a protocol in the pool.
+
+        :param proto: Protocol name as shown by "show nat64 pool"
+        """
+        pool = self.vapi.cli("show nat64 pool")
+        return sum(int(n) for n in re.findall(r"(\d+) busy %s ports" % proto, pool))
+
     def clear_nat64(self):
         """
         Clear NAT64 configuration.
@@ -2108,5 +2246,116 @@ class TestNAT64(VppTestCase):
         self.assertEqual(sessions[0][0], 0)
 
 
+@tag_fixme_ubuntu2204
+class TestNAT64MW(VppTestCase):
+    """NAT64 Multi-Worker Test Cases"""
+
+    vpp_worker_count = 2
+
+    @property
+    def config_flags(self):
+        return VppEnum.vl_api_nat_config_flags_t
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestNAT64MW, cls).setUpClass()
+
+        if is_distro_ubuntu2204 == True and not hasattr(cls, "vpp"):
+            return
+        cls.nat_addr = "10.0.0.3"
+
+        cls.create_pg_interfaces(range(2))
+        cls.pg0.generate_remote_hosts(8)
+
+        cls.pg0.admin_up()
+        cls.pg0.config_ip6()
+        cls.pg0.configure_ipv6_neighbors()
+
+        cls.pg1.admin_up()
+        cls.pg1.config_ip4()
+        cls.pg1.resolve_arp()
+
+    @classmethod
+    def tearDownClass(cls):
+        super(TestNAT64MW, cls).tearDownClass()
+
+    def setUp(self):
+        super(TestNAT64MW, self).setUp()
+        self.vapi.nat64_plugin_enable_disable(enable=1, bib_buckets=128, st_buckets=256)
+
+    def tearDown(self):
+        super(TestNAT64MW, self).tearDown()
+        if not self.vpp_dead:
+            self.vapi.nat64_plugin_enable_disable(enable=0)
+
+    def show_commands_at_teardown(self):
+        self.logger.info(self.vapi.cli("show nat64 pool"))
+        self.logger.info(self.vapi.cli("show nat64 session table all"))
+
+    def test_per_thread_sessions(self):
+        """NAT64 sessions and ports are accounted per worker"""
+        self.vapi.nat64_add_del_pool_addr_range(
+            start_addr=self.nat_addr,
+            end_addr=self.nat_addr,
+            vrf_id=0xFFFFFFFF,
+            is_add=1,
+        )
+        flags = self.config_flags.NAT_IS_INSIDE
+        self.vapi.nat64_add_del_interface(
+            is_add=1, flags=flags, sw_if_index=self.pg0.sw_if_index
+        )
+        self.vapi.nat64_add_del_interface(
+            is_add=1, flags=0, sw_if_index=self.pg1.sw_if_index
+        )
+        self.vapi.nat64_set_timeouts(
+            udp=5, tcp_established=7440, tcp_transitory=240, icmp=60
+        )
+
+        # inside hosts are spread over the workers by source address
+        pkts = []
+        for host in self.pg0.remote_hosts:
+            p = (
+                Ether(dst=self.pg0.local_mac, src=host.mac)
+                / IPv6(src=host.ip6, dst="64:ff9b::" + self.pg1.remote_ip4)
+                / UDP(sport=6304, dport=20)
+            )
+            pkts.append(p)
+        self.pg0.add_stream(pkts)
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+        capture = self.pg1.get_capture(len(pkts))
+
+        sessions = self.statistics.get_counter("/nat64/total-sessions")
+        self.assertEqual(sessions[0][0], 0)
+        self.assertEqual(sum(s[0] for s in sessions), len(pkts))
+        pool = self.vapi.cli("show nat64 pool")
+        self.assertIn(" %d busy udp ports" % len(pkts), pool)
+
+        # replies are handed off to the worker owning the outside port
+        pkts = []
+        for p in capture:
+            p = (
+                Ether(dst=self.pg1.local_mac, src=self.pg1.remote_mac)
+                / IP(src=self.pg1.remote_ip4, dst=self.nat_addr)
+                / UDP(sport=20, dport=p[UDP].sport)
+            )
+            pkts.append(p)
+        self.pg1.add_stream(pkts)
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+        capture = self.pg0.get_capture(len(pkts))
+        self.assertEqual(
+            sorted(p[IPv6].dst for p in capture),
+            sorted(h.ip6 for h in self.pg0.remote_hosts),
+        )
+
+        # each worker releases its own sessions and ports
+        self.virtual_sleep(15)
+        sessions = self.statistics.get_counter("/nat64/total-sessions")
+        self.assertEqual(sum(s[0] for s in sessions), 0)
+        pool = self.vapi.cli("show nat64 pool")
+        self.assertIn(" 0 busy udp ports", pool)
+
+
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
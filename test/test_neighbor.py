@@ -2370,6 +2370,14 @@ class NeighborAgeTestCase(VppTestCase):
         self.assertFalse(
             self.vapi.ip_neighbor_dump(sw_if_index=0xFFFFFFFF, af=vaf.ADDRESS_IP4)
         )
+        self.assertEqual(
+            self.statistics.get_err_counter("/err/ip4-neighbor-age-process/probes"),
+            600,
+        )
+        self.assertEqual(
+            self.statistics.get_err_counter("/err/ip4-neighbor-age-process/aged"),
+            200,
+        )
 
         #
         # load up some neighbours again with 2s aging enabled
@@ -2450,6 +2458,53 @@ class NeighborAgeTestCase(VppTestCase):
             find_nbr(self, self.pg0.sw_if_index, self.pg0.remote_hosts[0].ip4)
         )
 
+    def test_age_short(self):
+        """Aging shorter than the timer wheel's ring"""
+
+        vaf = VppEnum.vl_api_address_family_t
+        probes = self.statistics.get_err_counter("/err/ip4-neighbor-age-process/probes")
+        aged = self.statistics.get_err_counter("/err/ip4-neighbor-age-process/aged")
+
+        self.pg0.generate_remote_hosts(10)
+        self.pg_enable_capture(self.pg_interfaces)
+
+        #
+        # with nothing to age the process is idle. Neighbours learned then
+        # must still be probed and removed on time, so wait in real time
+        #
+        self.vapi.ip_neighbor_flush(vaf.ADDRESS_IP4, self.pg0.sw_if_index)
+        self.vapi.ip_neighbor_config(
+            af=vaf.ADDRESS_IP4, max_number=200, max_age=1, recycle=False
+        )
+        self.sleep(2)
+
+        for ii in range(10):
+            VppNeighbor(
+                self,
+                self.pg0.sw_if_index,
+                self.pg0.remote_hosts[ii].mac,
+                self.pg0.remote_hosts[ii].ip4,
+            ).add_vpp_config()
+
+        # 1s age, then 3 probes a second apart
+        self.sleep(5)
+        self.assertFalse(
+            self.vapi.ip_neighbor_dump(sw_if_index=0xFFFFFFFF, af=vaf.ADDRESS_IP4)
+        )
+        self.pg0.get_capture(30, timeout=1)
+        self.assertEqual(
+            self.statistics.get_err_counter("/err/ip4-neighbor-age-process/probes"),
+            probes + 30,
+        )
+        self.assertEqual(
+            self.statistics.get_err_counter("/err/ip4-neighbor-age-process/aged"),
+            aged + 10,
+        )
+
+        self.vapi.ip_neighbor_config(
+            af=vaf.ADDRESS_IP4, max_number=50000, max_age=0, recycle=False
+        )
+
 
 class NeighborReplaceTestCase(VppTestCase):
     """ARP/ND Replacement"""
@@ -1,8 +1,10 @@
 #!/usr/bin/env python3
 
+import time
 import unittest
 
 import scapy.compat
+from scapy.utils import wrpcap
 from scapy.packet import Raw
 from scapy.layers.l2 import Ether
 from scapy.layers.inet import IP, UDP
@@ -102,5 +104,81 @@ class TestPgTun(VppTestCase):
             self.assertEqual(rx[IPv6].dst, self.pg2.remote_ip6)
 
 
+class TestPgReplay(VppTestCase):
+    """PG pcap replay Test Case"""
+
+    def setUp(self):
+        super(TestPgReplay, self).setUp()
+
+        self.create_pg_interfaces(range(2))
+        for i in self.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+    def tearDown(self):
+        for i in self.pg_interfaces:
+            i.unconfig_ip4()
+            i.admin_down()
+        super(TestPgReplay, self).tearDown()
+
+    def test_pg_replay_timing(self):
+        """pcap replay with capture timing over worker streams"""
+
+        N_PKTS = 20
+        GAP = 0.05
+        SPEED = 2
+
+        pkts = []
+        for i in range(N_PKTS):
+            p = (
+                Ether(dst=self.pg0.local_mac, src=self.pg0.remote_mac)
+                / IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4)
+                / UDP(sport=1234, dport=1234 + i)
+                / Raw("0" * 48)
+            )
+            p.time = 1000 + i * GAP
+            pkts.append(p)
+
+        pcap = "%s/replay.pcap" % self.tempdir
+        wrpcap(pcap, pkts)
+
+        self.vapi.cli(
+            "packet-generator new pcap %s source pg0 name replay "
+            "replay-speed %d workers 2" % (pcap, SPEED)
+        )
+        self.pg1.enable_capture()
+        start = time.time()
+        self.pg_start()
+        elapsed = time.time() - start
+
+        # packets go out on the capture clock, twice as fast, and not
+        # a replay pass late
+        duration = (N_PKTS - 1) * GAP / SPEED
+        self.assertGreaterEqual(elapsed, duration)
+        self.assertLess(elapsed, duration + 5 * GAP)
+        rxs = self.pg1.get_capture(N_PKTS)
+        rxs = sorted(rxs, key=lambda rx: rx[UDP].dport)
+        self.assertEqual(
+            [rx[UDP].dport for rx in rxs],
+            [1234 + i for i in range(N_PKTS)],
+        )
+
+        # each packet keeps its gap to the previous one in the capture
+        for prev, rx in zip(rxs, rxs[1:]):
+            self.assertGreater(float(rx.time - prev.time), GAP / SPEED / 2)
+        span = float(rxs[-1].time - rxs[0].time)
+        self.assertAlmostEqual(span, duration, delta=GAP)
+
+        streams = self.vapi.cli("show packet-generator")
+        self.assertIn("replay-0", streams)
+        self.assertIn("replay-1", streams)
+        self.assertIn("target", streams)
+        self.assertIn("achieved", streams)
+
+        self.vapi.cli("packet-generator delete replay-0")
+        self.vapi.cli("packet-generator delete replay-1")
+
+
 if __name__ == "__main__":
     unittest.main(testRunner=VppTestRunner)
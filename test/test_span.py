@@ -196,6 +196,12 @@ class TestSpan(VppTestCase):
         pg1_pkts = self.pg1.get_capture(n_pkts)
         pg2_pkts = self.pg2.get_capture(n_pkts)
 
+        # The single pg0 -> pg2 session counted every mirrored packet
+        mirrored = self.statistics["/span/mirrored"][:, 0].sum_packets()
+        dropped = self.statistics["/span/dropped"][:, 0].sum_packets()
+        self.assertEqual(mirrored, n_pkts)
+        self.assertEqual(dropped, 0)
+
         # Disable SPAN on pg0 (mirrored to pg2)
         self.vapi.sw_interface_span_enable_disable(
             self.pg0.sw_if_index, self.pg2.sw_if_index, state=0
@@ -80,8 +80,12 @@ class AclRule:
         sport_to=None,
         dport_from=None,
         dport_to=None,
+        tcp_flags_mask=0,
+        tcp_flags_value=0,
     ):
         self.is_permit = is_permit
+        self.tcp_flags_mask = tcp_flags_mask
+        self.tcp_flags_value = tcp_flags_value
         self.src_prefix = src_prefix
         self.dst_prefix = dst_prefix
         self._proto = proto
@@ -109,6 +113,8 @@ class AclRule:
             self.sport_to,
             self.dport_from,
             self.dport_to,
+            self.tcp_flags_mask,
+            self.tcp_flags_value,
         )
         return new_rule
 
@@ -196,6 +202,8 @@ class AclRule:
             "dstport_or_icmpcode_first": self.dport_from,
             "dstport_or_icmpcode_last": self.dport_to,
             "dst_prefix": self.dst_prefix,
+            "tcp_flags_mask": self.tcp_flags_mask,
+            "tcp_flags_value": self.tcp_flags_value,
         }
 
 